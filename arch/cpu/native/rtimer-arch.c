@@ -54,6 +54,55 @@
 #define PRINTF(...)
 #endif
 
+/*---------------------------------------------------------------------------*/
+#if NATIVE_VIRTUAL_TIME
+/* The main loop, or the simulator, runs the rtimer when the virtual
+   time reaches the deadline */
+static rtimer_clock_t deadline;
+static uint8_t scheduled;
+/*---------------------------------------------------------------------------*/
+void
+rtimer_arch_init(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_arch_schedule(rtimer_clock_t t)
+{
+  deadline = t;
+  scheduled = 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+rtimer_arch_next(rtimer_clock_t *t)
+{
+  *t = deadline;
+  return scheduled;
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_arch_run_due(void)
+{
+  if(scheduled && !RTIMER_CLOCK_LT(RTIMER_NOW(), deadline)) {
+    scheduled = 0;
+    rtimer_run_next();
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_arch_busywait_step(rtimer_clock_t until)
+{
+  int32_t left = RTIMER_CLOCK_DIFF(until, RTIMER_NOW());
+
+  if(left > RTIMER_ARCH_BUSYWAIT_STEP) {
+    left = RTIMER_ARCH_BUSYWAIT_STEP;
+  } else if(left < 1) {
+    left = 1;
+  }
+  native_clock_set_virtual(native_clock_virtual() + left);
+}
+/*---------------------------------------------------------------------------*/
+#else /* NATIVE_VIRTUAL_TIME */
 /*---------------------------------------------------------------------------*/
 static void
 interrupt(int sig)
@@ -90,3 +139,5 @@ rtimer_arch_schedule(rtimer_clock_t t)
 #endif /* !_WIN32 */
 }
 /*---------------------------------------------------------------------------*/
+#endif /* NATIVE_VIRTUAL_TIME */
+/*---------------------------------------------------------------------------*/
@@ -42,8 +42,31 @@
 
 #include "contiki.h"
 
+#if NATIVE_VIRTUAL_TIME
+/* Microseconds of virtual time */
+#define RTIMER_ARCH_SECOND 1000000
+
+#define rtimer_arch_now() ((rtimer_clock_t)native_clock_virtual())
+
+/* Busy-waiting lets virtual time pass in steps of half a byte on air */
+#define RTIMER_ARCH_BUSYWAIT_STEP 16
+
+int rtimer_arch_next(rtimer_clock_t *t);
+void rtimer_arch_run_due(void);
+void rtimer_arch_busywait_step(rtimer_clock_t until);
+
+#define RTIMER_BUSYWAIT_UNTIL_ABS(cond, t0, max_time) \
+  ({                                                                \
+    bool c;                                                         \
+    while(!(c = cond) && RTIMER_CLOCK_LT(RTIMER_NOW(), (t0) + (max_time))) { \
+      rtimer_arch_busywait_step((t0) + (max_time));                 \
+    }                                                               \
+    c;                                                              \
+  })
+#else /* NATIVE_VIRTUAL_TIME */
 #define RTIMER_ARCH_SECOND CLOCK_CONF_SECOND
 
 #define rtimer_arch_now() clock_time()
+#endif /* NATIVE_VIRTUAL_TIME */
 
 #endif /* RTIMER_ARCH_H_ */
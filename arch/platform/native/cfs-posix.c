@@ -59,7 +59,9 @@ cfs_open(const char *n, int f)
     }
     if(f & CFS_APPEND) {
       s |= O_APPEND;
-    } else {
+    } else if(!(f & CFS_READ)) {
+      /* As in Coffee, a file opened for reading and writing keeps its
+         contents, so that it can be updated in place. */
       s |= O_TRUNC;
     }
     return open(n, s, 0600);
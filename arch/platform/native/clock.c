@@ -37,7 +37,10 @@
  *         Adam Dunkels <adam@sics.se>
  */
 
+#include "contiki.h"
 #include "sys/clock.h"
+#include "sys/etimer.h"
+#include "sys/rtimer.h"
 #include <time.h>
 #include <sys/time.h>
 
@@ -67,6 +70,57 @@ get_time(clock_timespec_t *spec)
 #endif
 }
 /*---------------------------------------------------------------------------*/
+#if NATIVE_VIRTUAL_TIME
+/* The virtual time in microseconds. In the simulation, it is part of
+   the state of the node and is swapped in and out with it. */
+static uint64_t virtual_usec;
+/*---------------------------------------------------------------------------*/
+uint64_t
+native_clock_virtual(void)
+{
+  return virtual_usec;
+}
+/*---------------------------------------------------------------------------*/
+void
+native_clock_set_virtual(uint64_t usec)
+{
+  virtual_usec = usec;
+}
+/*---------------------------------------------------------------------------*/
+uint64_t
+native_clock_next_timer(void)
+{
+  uint64_t next = NATIVE_CLOCK_NEVER;
+  uint64_t t;
+  rtimer_clock_t deadline;
+  int32_t left;
+
+  if(etimer_pending()) {
+    next = (uint64_t)etimer_next_expiration_time() * (1000000 / CLOCK_SECOND);
+  }
+  if(rtimer_arch_next(&deadline)) {
+    left = RTIMER_CLOCK_DIFF(deadline, RTIMER_NOW());
+    t = virtual_usec + (left > 0 ? left : 0);
+    if(t < next) {
+      next = t;
+    }
+  }
+  return next;
+}
+/*---------------------------------------------------------------------------*/
+clock_time_t
+clock_time(void)
+{
+  return virtual_usec / (1000000 / CLOCK_SECOND);
+}
+/*---------------------------------------------------------------------------*/
+unsigned long
+clock_seconds(void)
+{
+  return virtual_usec / 1000000;
+}
+#else /* NATIVE_VIRTUAL_TIME */
+/*---------------------------------------------------------------------------*/
 clock_time_t
 clock_time(void)
 {
@@ -86,6 +140,19 @@ clock_seconds(void)
 
   return ts.tv_sec;
 }
+#endif /* NATIVE_VIRTUAL_TIME */
+/*---------------------------------------------------------------------------*/
+/* Always the monotonic clock of the host, even with virtual time: the
+   process profiler measures how long the code really runs. */
+uint32_t
+native_clock_usec(void)
+{
+  clock_timespec_t ts;
+
+  get_time(&ts);
+
+  return ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
 /*---------------------------------------------------------------------------*/
 void
 clock_delay(unsigned int d)
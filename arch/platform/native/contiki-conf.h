@@ -62,12 +62,51 @@ int select_set_callback(int fd, const struct select_callback *callback);
 
 typedef unsigned int uip_stats_t;
 
+/* NATIVE_SIM=1 in the Makefile builds the in-process multi-node
+   simulation, see native-sim.h */
+#ifdef NATIVE_CONF_SIM
+#define NATIVE_SIM NATIVE_CONF_SIM
+#else /* NATIVE_CONF_SIM */
+#define NATIVE_SIM 0
+#endif /* NATIVE_CONF_SIM */
+
+/* With virtual time, clock_time() and RTIMER_NOW() stand still while
+   the node runs and the main loop jumps to the next timer when the node
+   is idle. The simulation always runs in virtual time. */
+#ifdef NATIVE_CONF_VIRTUAL_TIME
+#define NATIVE_VIRTUAL_TIME NATIVE_CONF_VIRTUAL_TIME
+#else /* NATIVE_CONF_VIRTUAL_TIME */
+#define NATIVE_VIRTUAL_TIME NATIVE_SIM
+#endif /* NATIVE_CONF_VIRTUAL_TIME */
+
+#if NATIVE_SIM && !NATIVE_VIRTUAL_TIME
+#error "The simulation needs NATIVE_CONF_VIRTUAL_TIME"
+#endif
+
+#if NATIVE_SIM && !defined(NETSTACK_CONF_RADIO)
+#define NETSTACK_CONF_RADIO sim_radio_driver
+#endif /* NATIVE_SIM && !defined(NETSTACK_CONF_RADIO) */
+
 #ifndef UIP_CONF_BYTE_ORDER
 #define UIP_CONF_BYTE_ORDER      UIP_LITTLE_ENDIAN
 #endif
 
 #if NETSTACK_CONF_WITH_IPV6
 
+#if NATIVE_SIM
+/* Simulated nodes run 6LoWPAN. Every node has its own copy of the
+   tables, so they are sized like on a real node. */
+#ifndef NETSTACK_MAX_ROUTE_ENTRIES
+#define NETSTACK_MAX_ROUTE_ENTRIES   300
+#endif /* NETSTACK_MAX_ROUTE_ENTRIES */
+#ifndef NBR_TABLE_CONF_MAX_NEIGHBORS
+#define NBR_TABLE_CONF_MAX_NEIGHBORS 16
+#endif /* NBR_TABLE_CONF_MAX_NEIGHBORS */
+
+#ifndef QUEUEBUF_CONF_NUM
+#define QUEUEBUF_CONF_NUM 8
+#endif /* QUEUEBUF_CONF_NUM */
+#else /* NATIVE_SIM */
 #ifndef NETSTACK_CONF_NETWORK
 #define NETSTACK_CONF_NETWORK    tun6_net_driver
 #endif
@@ -90,6 +129,7 @@ typedef unsigned int uip_stats_t;
 #ifndef QUEUEBUF_CONF_NUM
 #define QUEUEBUF_CONF_NUM 64
 #endif /* QUEUEBUF_CONF_NUM */
+#endif /* NATIVE_SIM */
 
 #define UIP_CONF_IPV6_QUEUE_PKT  1
 #define UIP_ARCH_IPCHKSUM        1
@@ -102,6 +142,37 @@ typedef unsigned long clock_time_t;
 
 #define CLOCK_CONF_SECOND 1000
 
+/* The clock ticks are too coarse for profiling processes, which is
+   done with microseconds of the monotonic clock instead. */
+uint32_t native_clock_usec(void);
+#ifndef PROCESS_PROFILE_CONF_CURRENT_TIME
+#define PROCESS_PROFILE_CONF_CURRENT_TIME native_clock_usec
+#define PROCESS_PROFILE_CONF_SECOND       1000000UL
+#define PROCESS_PROFILE_CONF_TIME_T       uint32_t
+#endif /* PROCESS_PROFILE_CONF_CURRENT_TIME */
+
+#if NATIVE_VIRTUAL_TIME
+/* Virtual time in microseconds, see clock.c */
+#define NATIVE_CLOCK_NEVER UINT64_MAX
+uint64_t native_clock_virtual(void);
+void native_clock_set_virtual(uint64_t usec);
+/* The virtual time of the earliest etimer or rtimer deadline, or
+   NATIVE_CLOCK_NEVER */
+uint64_t native_clock_next_timer(void);
+#endif /* NATIVE_VIRTUAL_TIME */
+
+#if NATIVE_SIM
+/* Prefix the log messages of a node with the time and the node, like
+   Cooja does */
+uint16_t native_sim_node_id(void);
+#ifndef LOG_CONF_OUTPUT_PREFIX
+#define LOG_CONF_OUTPUT_PREFIX(level, levelstr, module) \
+  LOG_OUTPUT("%lu.%03lu ID:%u [%-4s: %-10s] ", \
+             clock_time() / CLOCK_SECOND, clock_time() % CLOCK_SECOND, \
+             native_sim_node_id(), levelstr, module)
+#endif /* LOG_CONF_OUTPUT_PREFIX */
+#endif /* NATIVE_SIM */
+
 #define LOG_CONF_ENABLED 1
 
 #define PLATFORM_SUPPORTS_BUTTON_HAL 1
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup native-sim
+ * @{
+ */
+
+/**
+ * \file
+ *         Radio driver of the nodes of the in-process simulation.
+ *
+ *         The driver keeps the frame to send and the energest state of
+ *         the node. Everything that is on the air belongs to the medium
+ *         in native-sim.c.
+ */
+
+#include "contiki.h"
+#include "native-sim.h"
+#include "dev/sim-radio.h"
+#include "sys/energest.h"
+
+#include <string.h>
+/*---------------------------------------------------------------------------*/
+#define BUFSIZE 127
+#define CHANNEL_MIN 11
+#define CHANNEL_MAX 26
+
+static uint8_t tx_buf[BUFSIZE];
+static uint8_t radio_on;
+static uint8_t send_on_cca = 1;
+static uint8_t autoack = 1;
+static uint8_t poll_mode;
+/*---------------------------------------------------------------------------*/
+static int
+init(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+prepare(const void *payload, unsigned short payload_len)
+{
+  if(payload_len > BUFSIZE) {
+    return RADIO_TX_ERR;
+  }
+  memcpy(tx_buf, payload, payload_len);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+channel_clear(void)
+{
+  return !native_sim_radio_receiving();
+}
+/*---------------------------------------------------------------------------*/
+static int
+transmit(unsigned short transmit_len)
+{
+  int ret;
+
+  if(send_on_cca && !channel_clear()) {
+    return RADIO_TX_COLLISION;
+  }
+
+  if(radio_on) {
+    ENERGEST_SWITCH(ENERGEST_TYPE_LISTEN, ENERGEST_TYPE_TRANSMIT);
+  } else {
+    ENERGEST_ON(ENERGEST_TYPE_TRANSMIT);
+  }
+
+  ret = native_sim_radio_transmit(tx_buf, transmit_len);
+
+  if(radio_on) {
+    ENERGEST_SWITCH(ENERGEST_TYPE_TRANSMIT, ENERGEST_TYPE_LISTEN);
+  } else {
+    ENERGEST_OFF(ENERGEST_TYPE_TRANSMIT);
+  }
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
+static int
+send(const void *payload, unsigned short payload_len)
+{
+  if(prepare(payload, payload_len) != 0) {
+    return RADIO_TX_ERR;
+  }
+  return transmit(payload_len);
+}
+/*---------------------------------------------------------------------------*/
+static int
+radio_read(void *buf, unsigned short buf_len)
+{
+  return native_sim_radio_read(buf, buf_len);
+}
+/*---------------------------------------------------------------------------*/
+static int
+receiving_packet(void)
+{
+  return native_sim_radio_receiving();
+}
+/*---------------------------------------------------------------------------*/
+static int
+pending_packet(void)
+{
+  return native_sim_radio_pending();
+}
+/*---------------------------------------------------------------------------*/
+static int
+on(void)
+{
+  if(!radio_on) {
+    ENERGEST_ON(ENERGEST_TYPE_LISTEN);
+    radio_on = 1;
+    native_sim_radio_on(1);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+off(void)
+{
+  if(radio_on) {
+    ENERGEST_OFF(ENERGEST_TYPE_LISTEN);
+    radio_on = 0;
+    native_sim_radio_on(0);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+get_value(radio_param_t param, radio_value_t *value)
+{
+  if(!value) {
+    return RADIO_RESULT_INVALID_VALUE;
+  }
+
+  switch(param) {
+  case RADIO_PARAM_POWER_MODE:
+    *value = radio_on ? RADIO_POWER_MODE_ON : RADIO_POWER_MODE_OFF;
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_CHANNEL:
+    *value = native_sim_radio_channel();
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_RX_MODE:
+    *value = RADIO_RX_MODE_ADDRESS_FILTER;
+    if(autoack) {
+      *value |= RADIO_RX_MODE_AUTOACK;
+    }
+    if(poll_mode) {
+      *value |= RADIO_RX_MODE_POLL_MODE;
+    }
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_TX_MODE:
+    *value = send_on_cca ? RADIO_TX_MODE_SEND_ON_CCA : 0;
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_RSSI:
+    *value = native_sim_radio_receiving() ? native_sim_radio_last_rssi() : -100;
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_LAST_RSSI:
+    *value = native_sim_radio_last_rssi();
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_LAST_LINK_QUALITY:
+    *value = 105;
+    return RADIO_RESULT_OK;
+  case RADIO_CONST_CHANNEL_MIN:
+    *value = CHANNEL_MIN;
+    return RADIO_RESULT_OK;
+  case RADIO_CONST_CHANNEL_MAX:
+    *value = CHANNEL_MAX;
+    return RADIO_RESULT_OK;
+  case RADIO_CONST_MAX_PAYLOAD_LEN:
+    *value = BUFSIZE;
+    return RADIO_RESULT_OK;
+  default:
+    return RADIO_RESULT_NOT_SUPPORTED;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+set_value(radio_param_t param, radio_value_t value)
+{
+  switch(param) {
+  case RADIO_PARAM_POWER_MODE:
+    if(value == RADIO_POWER_MODE_ON) {
+      on();
+    } else if(value == RADIO_POWER_MODE_OFF) {
+      off();
+    } else {
+      return RADIO_RESULT_INVALID_VALUE;
+    }
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_CHANNEL:
+    if(value < CHANNEL_MIN || value > CHANNEL_MAX) {
+      return RADIO_RESULT_INVALID_VALUE;
+    }
+    native_sim_radio_set_channel(value);
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_RX_MODE:
+    if(value & ~(RADIO_RX_MODE_ADDRESS_FILTER |
+                 RADIO_RX_MODE_AUTOACK | RADIO_RX_MODE_POLL_MODE)) {
+      return RADIO_RESULT_INVALID_VALUE;
+    }
+    autoack = (value & RADIO_RX_MODE_AUTOACK) != 0;
+    poll_mode = (value & RADIO_RX_MODE_POLL_MODE) != 0;
+    native_sim_radio_set_rx_mode(autoack, poll_mode);
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_TX_MODE:
+    if(value & ~RADIO_TX_MODE_SEND_ON_CCA) {
+      return RADIO_RESULT_INVALID_VALUE;
+    }
+    send_on_cca = (value & RADIO_TX_MODE_SEND_ON_CCA) != 0;
+    return RADIO_RESULT_OK;
+  default:
+    return RADIO_RESULT_NOT_SUPPORTED;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+get_object(radio_param_t param, void *dest, size_t size)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+set_object(radio_param_t param, const void *src, size_t size)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+const struct radio_driver sim_radio_driver =
+{
+  init,
+  prepare,
+  transmit,
+  send,
+  radio_read,
+  channel_clear,
+  receiving_packet,
+  pending_packet,
+  on,
+  off,
+  get_value,
+  set_value,
+  get_object,
+  set_object
+};
+/*---------------------------------------------------------------------------*/
+/** @} */
@@ -0,0 +1,826 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup native-sim
+ * @{
+ */
+
+/**
+ * \file
+ *         Scheduler and radio medium of the in-process simulation.
+ *
+ *         All state of the simulator lives on the heap, behind a
+ *         pointer that is set before the first node boots and is thus
+ *         the same in the image of every node.
+ */
+
+#include "contiki.h"
+#include "native-sim.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/mac/framer/frame802154.h"
+#include "dev/radio.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/*---------------------------------------------------------------------------*/
+/* The statically allocated state of the program, which is the state
+   of the running node */
+extern char __data_start[], _end[];
+#define IMAGE_START ((char *)__data_start)
+#define IMAGE_SIZE  ((size_t)(_end - __data_start))
+
+/* IEEE 802.15.4 at 2.4 GHz: 32 us per byte, 6 bytes of preamble, SFD
+   and length, 192 us from the end of a frame to its acknowledgement */
+#define BYTE_TIME     32
+#define PHY_OVERHEAD  6
+#define TURNAROUND    192
+#define AIRTIME(len)  (((uint64_t)(len) + PHY_OVERHEAD) * BYTE_TIME)
+#define ACK_LEN       3
+#define FRAME_MAX_LEN 127
+
+/* Signal strength at zero distance and at the edge of the range */
+#define RSSI_NEAR     -40
+#define RSSI_FAR      -80
+
+/* Calls of process_run() before a busy node gives way to the others */
+#define RUN_LIMIT     1000
+
+/*---------------------------------------------------------------------------*/
+struct sim_link {
+  uint16_t dst;
+  uint8_t prr;
+  int8_t rssi;
+};
+
+/* A frame on its way to a receiver */
+struct sim_rx {
+  struct sim_rx *next;
+  uint64_t start;
+  uint64_t end;
+  uint16_t len;
+  int8_t rssi;
+  uint8_t corrupt;
+  uint8_t acked;
+  uint8_t data[];
+};
+
+struct sim_node {
+  uint64_t wake;
+  int heap_pos;
+  uint16_t id;
+  linkaddr_t addr;
+  void *image;
+  double x;
+  double y;
+  struct sim_link *links;
+  uint16_t link_count;
+  uint16_t link_size;
+  /* Receptions in progress, ordered by their end */
+  struct sim_rx *rx;
+  uint64_t tx_end;
+  uint64_t ack_start;
+  uint64_t ack_end;
+  uint8_t ack_pending;
+  uint8_t ack_dsn;
+  uint8_t radio_on;
+  uint8_t channel;
+  uint8_t autoack;
+  uint8_t poll_mode;
+  int8_t last_rssi;
+  uint8_t rx_len;
+  uint8_t rx_buf[FRAME_MAX_LEN];
+};
+
+struct native_sim {
+  int argc;
+  char **argv;
+  uint16_t node_count;
+  uint8_t topology;
+  uint8_t prr;
+  double range;
+  uint64_t duration;
+  uint64_t now;
+  uint64_t rng;
+  struct sim_node *nodes;
+  struct sim_node *current;
+  struct sim_node **heap;
+  int heap_len;
+  void *pristine;
+  uint8_t stop;
+  struct timespec started;
+  struct native_sim_stats stats;
+};
+
+static struct native_sim *sim;
+
+int main(int argc, char **argv);
+/*---------------------------------------------------------------------------*/
+/* The medium draws from its own generator, so that the losses do not
+   depend on how often the nodes call random_rand() */
+static uint32_t
+sim_rand(void)
+{
+  uint64_t x = sim->rng;
+
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  sim->rng = x;
+  return (uint32_t)((x * 0x2545f4914f6cdd1dULL) >> 32);
+}
+/*---------------------------------------------------------------------------*/
+static int
+heap_before(const struct sim_node *a, const struct sim_node *b)
+{
+  return a->wake < b->wake || (a->wake == b->wake && a->id < b->id);
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_set(int pos, struct sim_node *n)
+{
+  sim->heap[pos] = n;
+  n->heap_pos = pos;
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_up(struct sim_node *n)
+{
+  int pos = n->heap_pos;
+
+  while(pos > 0 && heap_before(n, sim->heap[(pos - 1) / 2])) {
+    heap_set(pos, sim->heap[(pos - 1) / 2]);
+    pos = (pos - 1) / 2;
+  }
+  heap_set(pos, n);
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_push(struct sim_node *n)
+{
+  n->heap_pos = sim->heap_len++;
+  heap_up(n);
+}
+/*---------------------------------------------------------------------------*/
+static struct sim_node *
+heap_pop(void)
+{
+  struct sim_node *top = sim->heap[0];
+  struct sim_node *last = sim->heap[--sim->heap_len];
+  int pos = 0;
+  int child;
+
+  top->heap_pos = -1;
+  if(sim->heap_len > 0) {
+    while((child = 2 * pos + 1) < sim->heap_len) {
+      if(child + 1 < sim->heap_len &&
+         heap_before(sim->heap[child + 1], sim->heap[child])) {
+        child++;
+      }
+      if(!heap_before(sim->heap[child], last)) {
+        break;
+      }
+      heap_set(pos, sim->heap[child]);
+      pos = child;
+    }
+    heap_set(pos, last);
+  }
+  return top;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wake_at(struct sim_node *n, uint64_t t)
+{
+  if(t < n->wake) {
+    n->wake = t;
+    if(n->heap_pos >= 0) {
+      heap_up(n);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+switch_to(struct sim_node *n)
+{
+  if(n != sim->current) {
+    memcpy(sim->current->image, IMAGE_START, IMAGE_SIZE);
+    memcpy(IMAGE_START, n->image, IMAGE_SIZE);
+    sim->current = n;
+    sim->stats.switches++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct sim_link *
+find_link(struct sim_node *src, uint16_t dst)
+{
+  int i;
+
+  for(i = 0; i < src->link_count; i++) {
+    if(src->links[i].dst == dst) {
+      return &src->links[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_link(struct sim_node *src, uint16_t dst, uint8_t prr, int8_t rssi)
+{
+  struct sim_link *l = find_link(src, dst);
+
+  if(l == NULL) {
+    if(src->link_count == src->link_size) {
+      src->link_size = src->link_size ? 2 * src->link_size : 8;
+      src->links = realloc(src->links, src->link_size * sizeof(*l));
+      if(src->links == NULL) {
+        perror("native-sim");
+        exit(1);
+      }
+    }
+    l = &src->links[src->link_count++];
+    l->dst = dst;
+  }
+  l->prr = prr;
+  l->rssi = rssi;
+}
+/*---------------------------------------------------------------------------*/
+static void
+place_nodes(void)
+{
+  struct sim_node *a, *b;
+  unsigned side = 1;
+  double dx, dy, d2, r2;
+  int i, j;
+
+  while(side * side < sim->node_count) {
+    side++;
+  }
+
+  for(i = 0; i < sim->node_count; i++) {
+    a = &sim->nodes[i];
+    switch(sim->topology) {
+    case NATIVE_SIM_TOPOLOGY_GRID:
+      a->x = i % side;
+      a->y = i / side;
+      break;
+    case NATIVE_SIM_TOPOLOGY_RANDOM:
+      a->x = (double)sim_rand() / UINT32_MAX * side;
+      a->y = (double)sim_rand() / UINT32_MAX * side;
+      break;
+    default:
+      a->x = i;
+      a->y = 0;
+      break;
+    }
+  }
+
+  /* Every pair of nodes within range gets a link in both directions.
+     The signal strength falls with the square of the distance. */
+  r2 = sim->range * sim->range;
+  for(i = 0; i < sim->node_count; i++) {
+    a = &sim->nodes[i];
+    for(j = i + 1; j < sim->node_count; j++) {
+      b = &sim->nodes[j];
+      dx = a->x - b->x;
+      dy = a->y - b->y;
+      d2 = dx * dx + dy * dy;
+      if(d2 <= r2 * (1 + 1e-9)) {
+        int8_t rssi = RSSI_NEAR + (RSSI_FAR - RSSI_NEAR) * (d2 / r2);
+        add_link(a, b->id, sim->prr, rssi);
+        add_link(b, a->id, sim->prr, rssi);
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static const char *
+topology_name(uint8_t topology)
+{
+  switch(topology) {
+  case NATIVE_SIM_TOPOLOGY_GRID:
+    return "grid";
+  case NATIVE_SIM_TOPOLOGY_RANDOM:
+    return "random";
+  default:
+    return "line";
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+parse_args(int argc, char **argv, uint32_t *seed)
+{
+  const char *opt;
+  const char *arg;
+  int i;
+
+  for(i = 1; i + 1 < argc; i++) {
+    opt = argv[i];
+    arg = argv[i + 1];
+    if(!strcmp(opt, "-n") || !strcmp(opt, "--nodes")) {
+      sim->node_count = atoi(arg);
+    } else if(!strcmp(opt, "-t") || !strcmp(opt, "--topology")) {
+      if(!strcmp(arg, "grid")) {
+        sim->topology = NATIVE_SIM_TOPOLOGY_GRID;
+      } else if(!strcmp(arg, "random")) {
+        sim->topology = NATIVE_SIM_TOPOLOGY_RANDOM;
+      } else {
+        sim->topology = NATIVE_SIM_TOPOLOGY_LINE;
+      }
+    } else if(!strcmp(opt, "-r") || !strcmp(opt, "--range")) {
+      sim->range = atof(arg);
+    } else if(!strcmp(opt, "-p") || !strcmp(opt, "--prr")) {
+      sim->prr = atoi(arg) > 100 ? 100 : atoi(arg);
+    } else if(!strcmp(opt, "-s") || !strcmp(opt, "--seed")) {
+      *seed = strtoul(arg, NULL, 0);
+    } else if(!strcmp(opt, "-d") || !strcmp(opt, "--duration")) {
+      sim->duration = strtoull(arg, NULL, 0) * 1000000;
+    } else {
+      continue;
+    }
+    i++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+native_sim_init(int argc, char **argv)
+{
+  struct sim_node *n;
+  uint32_t seed = NATIVE_SIM_SEED;
+  int i;
+
+  if(sim != NULL) {
+    return;
+  }
+
+  sim = calloc(1, sizeof(*sim));
+  if(sim == NULL) {
+    perror("native-sim");
+    exit(1);
+  }
+  sim->argc = argc;
+  sim->argv = argv;
+  sim->node_count = NATIVE_SIM_NODES;
+  sim->topology = NATIVE_SIM_TOPOLOGY;
+  sim->range = NATIVE_SIM_RANGE;
+  sim->prr = NATIVE_SIM_PRR;
+  sim->duration = (uint64_t)NATIVE_SIM_DURATION * 1000000;
+  parse_args(argc, argv, &seed);
+  if(sim->node_count < 1 || sim->node_count > 0xfffe) {
+    fprintf(stderr, "native-sim: invalid number of nodes\n");
+    exit(1);
+  }
+  sim->rng = 0x9e3779b97f4a7c15ULL ^ seed;
+  random_init(seed);
+
+  sim->nodes = calloc(sim->node_count, sizeof(struct sim_node));
+  sim->heap = calloc(sim->node_count, sizeof(struct sim_node *));
+  sim->pristine = malloc(IMAGE_SIZE);
+  if(sim->nodes == NULL || sim->heap == NULL || sim->pristine == NULL) {
+    perror("native-sim");
+    exit(1);
+  }
+  for(i = 0; i < sim->node_count; i++) {
+    n = &sim->nodes[i];
+    n->id = i + 1;
+    n->wake = NATIVE_CLOCK_NEVER;
+    n->heap_pos = -1;
+    n->channel = IEEE802154_DEFAULT_CHANNEL;
+    n->autoack = 1;
+    n->image = malloc(IMAGE_SIZE);
+    if(n->image == NULL) {
+      perror("native-sim");
+      exit(1);
+    }
+  }
+  place_nodes();
+  sim->current = &sim->nodes[0];
+
+  /* Unbuffered output would cost a system call per log message */
+  setvbuf(stdout, NULL, _IOLBF, 0);
+  printf("Simulating %u nodes, %s topology, range %.2f, PRR %u%%, seed %lu, "
+         "%lu bytes of state per node\n",
+         sim->node_count, topology_name(sim->topology), sim->range,
+         sim->prr, (unsigned long)seed, (unsigned long)IMAGE_SIZE);
+  clock_gettime(CLOCK_MONOTONIC, &sim->started);
+
+  /* Every node boots from the state the program started with */
+  memcpy(sim->pristine, IMAGE_START, IMAGE_SIZE);
+}
+/*---------------------------------------------------------------------------*/
+static void
+deliver(struct sim_node *n, uint64_t now)
+{
+  struct sim_rx *rx;
+
+  while(n->rx != NULL && n->rx->end <= now) {
+    rx = n->rx;
+    n->rx = rx->next;
+    if(!rx->corrupt && n->radio_on) {
+      sim->stats.rx++;
+      n->last_rssi = rx->rssi;
+      if(n->poll_mode) {
+        if(n->rx_len == 0) {
+          memcpy(n->rx_buf, rx->data, rx->len);
+          n->rx_len = rx->len;
+        }
+      } else {
+        packetbuf_clear();
+        memcpy(packetbuf_dataptr(), rx->data, rx->len);
+        packetbuf_set_datalen(rx->len);
+        packetbuf_set_attr(PACKETBUF_ATTR_RSSI, rx->rssi);
+        packetbuf_set_attr(PACKETBUF_ATTR_LINK_QUALITY, 105);
+        NETSTACK_MAC.input();
+      }
+    }
+    free(rx);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint64_t
+next_wake(struct sim_node *n, uint64_t now)
+{
+  uint64_t wake;
+
+  if(process_nevents() > 0) {
+    /* The node hit RUN_LIMIT */
+    return now + 1;
+  }
+  wake = native_clock_next_timer();
+  if(n->rx != NULL && n->rx->end < wake) {
+    wake = n->rx->end;
+  }
+  /* Anything due now was handled in this run */
+  return wake <= now ? now + 1 : wake;
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_node(struct sim_node *n)
+{
+  uint64_t now;
+  int i;
+
+  switch_to(n);
+  if(native_clock_virtual() < n->wake) {
+    native_clock_set_virtual(n->wake);
+  }
+  now = native_clock_virtual();
+
+  deliver(n, now);
+  rtimer_arch_run_due();
+  etimer_request_poll();
+  for(i = 0; i < RUN_LIMIT && process_run() > 0; i++);
+
+  /* The node's clock runs ahead while it sends or busy-waits */
+  now = native_clock_virtual();
+  n->wake = next_wake(n, now);
+  sim->stats.events++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(void)
+{
+  struct timespec ended;
+  uint64_t real;
+
+  clock_gettime(CLOCK_MONOTONIC, &ended);
+  real = (ended.tv_sec - sim->started.tv_sec) * 1000000ULL +
+    (ended.tv_nsec - sim->started.tv_nsec) / 1000;
+  printf("Simulated %u nodes for %lu.%03lu s in %lu.%03lu s: "
+         "%llu events, %llu switches, %lu frames sent, %lu received, "
+         "%lu lost, %lu collided, %lu acknowledged\n",
+         sim->node_count,
+         (unsigned long)(sim->now / 1000000),
+         (unsigned long)(sim->now / 1000 % 1000),
+         (unsigned long)(real / 1000000), (unsigned long)(real / 1000 % 1000),
+         (unsigned long long)sim->stats.events,
+         (unsigned long long)sim->stats.switches,
+         (unsigned long)sim->stats.tx, (unsigned long)sim->stats.rx,
+         (unsigned long)sim->stats.lost, (unsigned long)sim->stats.collisions,
+         (unsigned long)sim->stats.acks);
+}
+/*---------------------------------------------------------------------------*/
+static void
+simulate(void)
+{
+  struct sim_node *n;
+
+  while(!sim->stop) {
+    n = sim->heap[0];
+    if(n->wake == NATIVE_CLOCK_NEVER ||
+       (sim->duration && n->wake > sim->duration)) {
+      break;
+    }
+    heap_pop();
+    sim->now = n->wake;
+    run_node(n);
+    heap_push(n);
+  }
+  report();
+  exit(0);
+}
+/*---------------------------------------------------------------------------*/
+void
+native_sim_run(void)
+{
+  struct sim_node *n = sim->current;
+
+  linkaddr_copy(&n->addr, &linkaddr_node_addr);
+  n->wake = native_clock_virtual();
+  heap_push(n);
+
+  if(n->id < sim->node_count) {
+    /* Boot the next node on the stack of this one. The stack frames
+       below are never returned to. */
+    memcpy(n->image, IMAGE_START, IMAGE_SIZE);
+    memcpy(IMAGE_START, sim->pristine, IMAGE_SIZE);
+    sim->current = &sim->nodes[n->id];
+    main(sim->argc, sim->argv);
+  }
+  simulate();
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+native_sim_node_count(void)
+{
+  return sim->node_count;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+native_sim_node_id(void)
+{
+  return sim->current->id;
+}
+/*---------------------------------------------------------------------------*/
+void
+native_sim_set_link(uint16_t src, uint16_t dst, uint8_t prr)
+{
+  struct sim_node *n;
+  struct sim_link *l;
+
+  if(src < 1 || src > sim->node_count || dst < 1 || dst > sim->node_count ||
+     src == dst) {
+    return;
+  }
+  n = &sim->nodes[src - 1];
+  if(prr > 0) {
+    l = find_link(n, dst);
+    add_link(n, dst, prr > 100 ? 100 : prr, l != NULL ? l->rssi : RSSI_FAR);
+  } else if((l = find_link(n, dst)) != NULL) {
+    *l = n->links[--n->link_count];
+  }
+}
+/*---------------------------------------------------------------------------*/
+const struct native_sim_stats *
+native_sim_stats(void)
+{
+  return &sim->stats;
+}
+/*---------------------------------------------------------------------------*/
+void
+native_sim_stop(void)
+{
+  sim->stop = 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+native_sim_radio_on(int on)
+{
+  sim->current->radio_on = on;
+}
+/*---------------------------------------------------------------------------*/
+void
+native_sim_radio_set_channel(uint8_t channel)
+{
+  sim->current->channel = channel;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+native_sim_radio_channel(void)
+{
+  return sim->current->channel;
+}
+/*---------------------------------------------------------------------------*/
+void
+native_sim_radio_set_rx_mode(int autoack, int poll_mode)
+{
+  sim->current->autoack = autoack;
+  sim->current->poll_mode = poll_mode;
+}
+/*---------------------------------------------------------------------------*/
+int8_t
+native_sim_radio_last_rssi(void)
+{
+  return sim->current->last_rssi;
+}
+/*---------------------------------------------------------------------------*/
+static int
+overlaps(const struct sim_rx *rx, uint64_t start, uint64_t end)
+{
+  return rx->start < end && start < rx->end;
+}
+/*---------------------------------------------------------------------------*/
+static void
+corrupt(struct sim_rx *rx)
+{
+  if(!rx->corrupt) {
+    rx->corrupt = 1;
+    sim->stats.collisions++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct sim_rx *
+start_rx(struct sim_node *dst, const struct sim_link *l,
+         const uint8_t *data, uint16_t len, uint64_t start, uint64_t end)
+{
+  struct sim_rx *rx, **prev;
+
+  rx = malloc(sizeof(*rx) + len);
+  if(rx == NULL) {
+    perror("native-sim");
+    exit(1);
+  }
+  rx->start = start;
+  rx->end = end;
+  rx->len = len;
+  rx->rssi = l->rssi;
+  rx->corrupt = 0;
+  rx->acked = 0;
+  memcpy(rx->data, data, len);
+
+  /* A node that is sending does not hear anything */
+  if(dst->tx_end > start) {
+    corrupt(rx);
+  }
+
+  /* Overlapping frames destroy each other, except for a frame that
+     was already acknowledged: the medium cannot take that back, so it
+     wins */
+  for(prev = &dst->rx; *prev != NULL; prev = &(*prev)->next) {
+    if(overlaps(*prev, start, end)) {
+      corrupt(rx);
+      if(!(*prev)->acked) {
+        corrupt(*prev);
+      }
+    }
+  }
+
+  for(prev = &dst->rx; *prev != NULL && (*prev)->end <= end;
+      prev = &(*prev)->next);
+  rx->next = *prev;
+  *prev = rx;
+  return rx;
+}
+/*---------------------------------------------------------------------------*/
+int
+native_sim_radio_transmit(const uint8_t *data, uint16_t len)
+{
+  struct sim_node *src = sim->current;
+  struct sim_node *dst;
+  struct sim_link *l, *back;
+  struct sim_rx *rx;
+  frame802154_t frame;
+  uint8_t buf[FRAME_MAX_LEN];
+  uint64_t start = native_clock_virtual();
+  uint64_t end = start + AIRTIME(len);
+  int ack_required;
+  int i;
+
+  if(len == 0 || len > FRAME_MAX_LEN) {
+    return RADIO_TX_ERR;
+  }
+
+  /* Half duplex: the sender loses what it was receiving */
+  for(rx = src->rx; rx != NULL; rx = rx->next) {
+    if(overlaps(rx, start, end)) {
+      corrupt(rx);
+    }
+  }
+  src->tx_end = end;
+  src->ack_pending = 0;
+  sim->stats.tx++;
+
+  memcpy(buf, data, len);
+  ack_required = frame802154_parse(buf, len, &frame) > 0 &&
+    frame.fcf.ack_required;
+
+  for(i = 0; i < src->link_count; i++) {
+    l = &src->links[i];
+    dst = &sim->nodes[l->dst - 1];
+    if(!dst->radio_on || dst->channel != src->channel) {
+      continue;
+    }
+    if(sim_rand() % 100 >= l->prr) {
+      sim->stats.lost++;
+      continue;
+    }
+    rx = start_rx(dst, l, data, len, start, end);
+    wake_at(dst, end);
+
+    /* Acknowledgements are decided now, as the sender waits for them
+       before any other node runs again */
+    if(ack_required && !rx->corrupt && dst->autoack &&
+       !memcmp(frame.dest_addr, &dst->addr, LINKADDR_SIZE)) {
+      back = find_link(dst, src->id);
+      if(back != NULL && sim_rand() % 100 < back->prr) {
+        rx->acked = 1;
+        src->ack_pending = 1;
+        src->ack_dsn = frame.seq;
+        src->ack_start = end + TURNAROUND;
+        src->ack_end = src->ack_start + AIRTIME(ACK_LEN);
+        sim->stats.acks++;
+      }
+    }
+  }
+
+  /* Sending takes the airtime of the frame */
+  native_clock_set_virtual(end);
+  return RADIO_TX_OK;
+}
+/*---------------------------------------------------------------------------*/
+int
+native_sim_radio_receiving(void)
+{
+  struct sim_node *n = sim->current;
+  uint64_t now = native_clock_virtual();
+  struct sim_rx *rx;
+
+  if(!n->radio_on) {
+    return 0;
+  }
+  if(n->ack_pending && n->ack_start <= now && now < n->ack_end) {
+    return 1;
+  }
+  for(rx = n->rx; rx != NULL; rx = rx->next) {
+    if(rx->start <= now && now < rx->end) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+native_sim_radio_pending(void)
+{
+  struct sim_node *n = sim->current;
+
+  return (n->ack_pending && n->ack_end <= native_clock_virtual()) ||
+    n->rx_len > 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+native_sim_radio_read(uint8_t *buf, uint16_t bufsize)
+{
+  struct sim_node *n = sim->current;
+  int len;
+
+  if(n->ack_pending && n->ack_end <= native_clock_virtual()) {
+    n->ack_pending = 0;
+    if(bufsize < ACK_LEN) {
+      return 0;
+    }
+    buf[0] = FRAME802154_ACKFRAME;
+    buf[1] = 0;
+    buf[2] = n->ack_dsn;
+    return ACK_LEN;
+  }
+  len = n->rx_len;
+  n->rx_len = 0;
+  if(len > bufsize) {
+    return 0;
+  }
+  memcpy(buf, n->rx_buf, len);
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
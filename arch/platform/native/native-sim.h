@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup native_platform
+ * @{
+ *
+ * \defgroup native-sim In-process multi-node simulation
+ *
+ * A build of the native platform with NATIVE_SIM=1 runs a whole network
+ * of nodes in a single Linux process. Every node executes the same
+ * firmware image, each with its own copy of all statically allocated
+ * state: the data and bss segments of the program are swapped in and
+ * out whenever the simulator switches from one node to another.
+ *
+ * The nodes are connected by a simulated IEEE 802.15.4 radio medium.
+ * Frames reach the neighbours of the sender that are listening on the
+ * same channel, with a configurable packet reception ratio per link.
+ * Frames that overlap at a receiver collide. Unicast frames that
+ * request an acknowledgement are acknowledged by the medium when the
+ * frame is sent.
+ *
+ * Time is virtual. The simulator always runs the node with the
+ * earliest pending event, be it an event in its process queue, an
+ * etimer, an rtimer or the end of a frame on air, so that idle periods
+ * take no time at all.
+ *
+ * The size of the network and the topology are set with the
+ * NATIVE_SIM_CONF_ defaults below or on the command line:
+ *
+ * - -n, --nodes N: number of nodes
+ * - -t, --topology line|grid|random: node placement
+ * - -r, --range R: radio range, in units of the node spacing
+ * - -p, --prr P: packet reception ratio of the links, in percent
+ * - -s, --seed S: seed of the random number generators
+ * - -d, --duration S: stop after S seconds of virtual time
+ *
+ * @{
+ */
+
+/**
+ * \file
+ *         In-process multi-node simulation on the native platform.
+ */
+
+#ifndef NATIVE_SIM_H_
+#define NATIVE_SIM_H_
+
+#include "contiki.h"
+
+#include <stdint.h>
+/*---------------------------------------------------------------------------*/
+/** \name Topologies */
+/** @{ */
+#define NATIVE_SIM_TOPOLOGY_LINE   0 /**< Node i at (i, 0) */
+#define NATIVE_SIM_TOPOLOGY_GRID   1 /**< Square grid, filled row by row */
+#define NATIVE_SIM_TOPOLOGY_RANDOM 2 /**< Uniform in a square of area n */
+/** @} */
+/*---------------------------------------------------------------------------*/
+/** \brief Number of nodes, unless given on the command line */
+#ifdef NATIVE_SIM_CONF_NODES
+#define NATIVE_SIM_NODES NATIVE_SIM_CONF_NODES
+#else /* NATIVE_SIM_CONF_NODES */
+#define NATIVE_SIM_NODES 2
+#endif /* NATIVE_SIM_CONF_NODES */
+
+/** \brief Node placement, unless given on the command line */
+#ifdef NATIVE_SIM_CONF_TOPOLOGY
+#define NATIVE_SIM_TOPOLOGY NATIVE_SIM_CONF_TOPOLOGY
+#else /* NATIVE_SIM_CONF_TOPOLOGY */
+#define NATIVE_SIM_TOPOLOGY NATIVE_SIM_TOPOLOGY_LINE
+#endif /* NATIVE_SIM_CONF_TOPOLOGY */
+
+/** \brief Radio range in units of the node spacing */
+#ifdef NATIVE_SIM_CONF_RANGE
+#define NATIVE_SIM_RANGE NATIVE_SIM_CONF_RANGE
+#else /* NATIVE_SIM_CONF_RANGE */
+#define NATIVE_SIM_RANGE 1.0
+#endif /* NATIVE_SIM_CONF_RANGE */
+
+/** \brief Packet reception ratio of every link, in percent */
+#ifdef NATIVE_SIM_CONF_PRR
+#define NATIVE_SIM_PRR NATIVE_SIM_CONF_PRR
+#else /* NATIVE_SIM_CONF_PRR */
+#define NATIVE_SIM_PRR 100
+#endif /* NATIVE_SIM_CONF_PRR */
+
+/** \brief Seed of the medium and of random_rand() */
+#ifdef NATIVE_SIM_CONF_SEED
+#define NATIVE_SIM_SEED NATIVE_SIM_CONF_SEED
+#else /* NATIVE_SIM_CONF_SEED */
+#define NATIVE_SIM_SEED 1
+#endif /* NATIVE_SIM_CONF_SEED */
+
+/** \brief Virtual time in seconds after which to stop, 0 for never */
+#ifdef NATIVE_SIM_CONF_DURATION
+#define NATIVE_SIM_DURATION NATIVE_SIM_CONF_DURATION
+#else /* NATIVE_SIM_CONF_DURATION */
+#define NATIVE_SIM_DURATION 0
+#endif /* NATIVE_SIM_CONF_DURATION */
+/*---------------------------------------------------------------------------*/
+/** \brief Counters of the simulator, shared by all nodes */
+struct native_sim_stats {
+  uint64_t events;      /**< Times a node was run */
+  uint64_t switches;    /**< Times the node image was swapped */
+  uint32_t tx;          /**< Frames transmitted */
+  uint32_t rx;          /**< Frames delivered to a node */
+  uint32_t lost;        /**< Receptions lost on the link */
+  uint32_t collisions;  /**< Receptions corrupted by another frame */
+  uint32_t acks;        /**< Acknowledgements sent by the medium */
+};
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Set up the simulation, once, from the command line
+ *
+ * Called by the platform before the first node boots. Later calls,
+ * as every node goes through main(), return immediately.
+ */
+void native_sim_init(int argc, char **argv);
+
+/**
+ * \brief Hand the booted node over to the simulator
+ *
+ * Called by the platform instead of entering its main loop. Boots the
+ * next node, or runs the simulation once all nodes have booted. Does
+ * not return.
+ */
+void native_sim_run(void);
+
+/** \brief The number of nodes in the simulation */
+uint16_t native_sim_node_count(void);
+
+/**
+ * \brief The node that is currently running
+ * \return The node number, from 1 to native_sim_node_count()
+ */
+uint16_t native_sim_node_id(void);
+
+/**
+ * \brief Set the quality of the link from one node to another
+ * \param src The sending node, from 1 to native_sim_node_count()
+ * \param dst The receiving node
+ * \param prr The packet reception ratio in percent, 0 to remove the link
+ */
+void native_sim_set_link(uint16_t src, uint16_t dst, uint8_t prr);
+
+/** \brief The counters of the simulator */
+const struct native_sim_stats *native_sim_stats(void);
+
+/**
+ * \brief End the simulation
+ *
+ * The simulator stops after the current node has run and the program
+ * exits.
+ */
+void native_sim_stop(void);
+/*---------------------------------------------------------------------------*/
+/** \name Radio medium, for the simulated radio driver */
+/** @{ */
+void native_sim_radio_on(int on);
+void native_sim_radio_set_channel(uint8_t channel);
+uint8_t native_sim_radio_channel(void);
+int native_sim_radio_transmit(const uint8_t *data, uint16_t len);
+int native_sim_radio_receiving(void);
+int native_sim_radio_pending(void);
+int native_sim_radio_read(uint8_t *buf, uint16_t bufsize);
+void native_sim_radio_set_rx_mode(int autoack, int poll_mode);
+int8_t native_sim_radio_last_rssi(void);
+/** @} */
+/*---------------------------------------------------------------------------*/
+#endif /* NATIVE_SIM_H_ */
+/*---------------------------------------------------------------------------*/
+/**
+ * @}
+ * @}
+ */
@@ -64,6 +64,10 @@
 #include "net/ipv6/uip-debug.h"
 #include "net/queuebuf.h"
 
+#if NATIVE_SIM
+#include "native-sim.h"
+#endif /* NATIVE_SIM */
+
 #if NETSTACK_CONF_WITH_IPV6
 #include "net/ipv6/uip-ds6.h"
 #endif /* NETSTACK_CONF_WITH_IPV6 */
@@ -196,10 +200,15 @@ set_lladdr(void)
     addr.u8[i] = mac_addr[7 - i];
   }
 #endif
+#if NATIVE_SIM
+  /* The node number makes the address, and thus the node ID */
+  addr.u8[LINKADDR_SIZE - 2] = native_sim_node_id() >> 8;
+  addr.u8[LINKADDR_SIZE - 1] = native_sim_node_id() & 0xff;
+#endif /* NATIVE_SIM */
   linkaddr_set_node_addr(&addr);
 }
 /*---------------------------------------------------------------------------*/
-#if NETSTACK_CONF_WITH_IPV6
+#if NETSTACK_CONF_WITH_IPV6 && !NATIVE_SIM
 static void
 set_global_address(void)
 {
@@ -246,6 +255,10 @@ platform_process_args(int argc, char **argv)
   contiki_argv++;
 #endif
 #endif
+
+#if NATIVE_SIM
+  native_sim_init(argc, argv);
+#endif /* NATIVE_SIM */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -273,22 +286,43 @@ platform_init_stage_two()
 void
 platform_init_stage_three()
 {
-#if NETSTACK_CONF_WITH_IPV6
+/* Simulated nodes get their addresses from the network */
+#if NETSTACK_CONF_WITH_IPV6 && !NATIVE_SIM
 #ifdef __CYGWIN__
   process_start(&wpcap_process, NULL);
 #endif
 
   set_global_address();
 
-#endif /* NETSTACK_CONF_WITH_IPV6 */
+#endif /* NETSTACK_CONF_WITH_IPV6 && !NATIVE_SIM */
 
+#if !NATIVE_SIM
   /* Make standard output unbuffered. */
   setvbuf(stdout, (char *)NULL, _IONBF, 0);
+#endif /* !NATIVE_SIM */
 }
 /*---------------------------------------------------------------------------*/
+#if NATIVE_VIRTUAL_TIME
+/* Nothing happens until the next timer, so skip to it */
+static void
+skip_to_next_timer(void)
+{
+  uint64_t next = native_clock_next_timer();
+
+  if(next != NATIVE_CLOCK_NEVER && next > native_clock_virtual()) {
+    native_clock_set_virtual(next);
+  }
+  rtimer_arch_run_due();
+}
+#endif /* NATIVE_VIRTUAL_TIME */
+/*---------------------------------------------------------------------------*/
 void
 platform_main_loop()
 {
+#if NATIVE_SIM
+  native_sim_run();
+#endif /* NATIVE_SIM */
+
 #if SELECT_STDIN
   select_set_callback(STDIN_FILENO, &stdin_fd);
 #endif /* SELECT_STDIN */
@@ -299,11 +333,22 @@ platform_main_loop()
     int i;
     int retval;
     struct timeval tv;
+    struct timeval *tvp = &tv;
 
     retval = process_run();
 
+#if NATIVE_VIRTUAL_TIME
+    /* Only poll the file descriptors, unless nothing but input can
+       wake the node up */
+    tv.tv_sec = 0;
+    tv.tv_usec = 0;
+    if(!retval && native_clock_next_timer() == NATIVE_CLOCK_NEVER) {
+      tvp = NULL;
+    }
+#else /* NATIVE_VIRTUAL_TIME */
     tv.tv_sec = retval ? 0 : SELECT_TIMEOUT / 1000;
     tv.tv_usec = retval ? 1 : (SELECT_TIMEOUT * 1000) % 1000000;
+#endif /* NATIVE_VIRTUAL_TIME */
 
     FD_ZERO(&fdr);
     FD_ZERO(&fdw);
@@ -314,7 +359,7 @@ platform_main_loop()
       }
     }
 
-    retval = select(maxfd + 1, &fdr, &fdw, NULL, &tv);
+    retval = select(maxfd + 1, &fdr, &fdw, NULL, tvp);
     if(retval < 0) {
       if(errno != EINTR) {
         perror("select");
@@ -328,6 +373,12 @@ platform_main_loop()
       }
     }
 
+#if NATIVE_VIRTUAL_TIME
+    if(process_nevents() == 0) {
+      skip_to_next_timer();
+    }
+#endif /* NATIVE_VIRTUAL_TIME */
+
     etimer_request_poll();
   }
 
@@ -46,6 +46,7 @@
 #include "sys/platform.h"
 #include "sys/energest.h"
 #include "sys/stack-check.h"
+#include "sys/process-profile.h"
 #include "dev/watchdog.h"
 
 #include "net/queuebuf.h"
@@ -80,6 +81,9 @@ main(void)
   rtimer_init();
   process_init();
   process_start(&etimer_process, NULL);
+#if LOG_DEFERRED
+  log_deferred_init();
+#endif /* LOG_DEFERRED */
   ctimer_init();
   watchdog_init();
 
@@ -89,6 +93,10 @@ main(void)
   stack_check_init();
 #endif
 
+#if PROCESS_PROFILE_ENABLED
+  process_profile_init();
+#endif
+
   platform_init_stage_two();
 
 #if QUEUEBUF_ENABLED
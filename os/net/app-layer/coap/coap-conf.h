@@ -98,6 +98,17 @@
 #define COAP_MAX_OBSERVERS    COAP_MAX_OPEN_TRANSACTIONS - 1
 #endif /* COAP_MAX_OBSERVERS */
 
+/* Number of rendered notifications that can be held for retransmission.
+   A notification is rendered once and sent to all observers of the
+   resource; observers with an unacknowledged CON notification share a
+   copy of it from this pool. When the pool is full, only the observers
+   due a CON notification miss it. */
+#ifdef COAP_CONF_MAX_SHARED_NOTIFICATIONS
+#define COAP_MAX_SHARED_NOTIFICATIONS COAP_CONF_MAX_SHARED_NOTIFICATIONS
+#else
+#define COAP_MAX_SHARED_NOTIFICATIONS  2
+#endif /* COAP_MAX_SHARED_NOTIFICATIONS */
+
 /* Interval in notifies in which NON notifies are changed to CON notifies to check client. */
 #ifdef COAP_CONF_OBSERVE_REFRESH_INTERVAL
 #define COAP_OBSERVE_REFRESH_INTERVAL COAP_CONF_OBSERVE_REFRESH_INTERVAL
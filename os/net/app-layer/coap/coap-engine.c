@@ -301,6 +301,8 @@ coap_receive(const coap_endpoint_t *src,
       } else if(message->type == COAP_TYPE_ACK) {
         /* transactions are closed through lookup below */
         LOG_DBG("Received ACK\n");
+        /* notifications are sent without a transaction */
+        coap_observe_ack(src, message->mid);
       } else if(message->type == COAP_TYPE_RST) {
         LOG_INFO("Received RST\n");
         /* cancel possible subscriptions */
@@ -42,6 +42,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "coap-observe.h"
 #include "coap-engine.h"
@@ -53,9 +54,32 @@
 #define LOG_MODULE "coap"
 #define LOG_LEVEL  LOG_LEVEL_COAP
 
+/*---------------------------------------------------------------------------*/
+/*
+ * A notification is rendered once per coap_notify_observers() call and
+ * serialized without token and with a three-byte Observe placeholder. The
+ * per-observer message is assembled from it by patching the header and
+ * inserting the token and the observer's Observe value.
+ *
+ * It is rendered into a scratch buffer. Only observers sent a CON
+ * notification need it after the call, for retransmissions: they share
+ * one copy from the pool, so a full pool never holds back NON ones.
+ */
+typedef struct coap_notification {
+  uint16_t refs;
+  uint16_t len;
+  /* Offset of the Observe option placeholder in data, 0 if none */
+  uint16_t observe_offset;
+  uint8_t data[COAP_MAX_PACKET_SIZE + 1];
+} coap_notification_t;
+
+#define OBSERVE_PLACEHOLDER     0xFFFFFF
+#define OBSERVE_PLACEHOLDER_LEN 3
 /*---------------------------------------------------------------------------*/
 MEMB(observers_memb, coap_observer_t, COAP_MAX_OBSERVERS);
 LIST(observers_list);
+MEMB(notifications_memb, coap_notification_t, COAP_MAX_SHARED_NOTIFICATIONS);
+static coap_notification_t scratch;
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -79,6 +103,9 @@ add_observer(const coap_endpoint_t *endpoint, const uint8_t *token,
     o->token_len = token_len;
     memcpy(o->token, token, token_len);
     o->last_mid = 0;
+    o->obs_counter = 0;
+    o->pending = NULL;
+    o->retrans_counter = 0;
 
     LOG_INFO("Adding observer (%u/%u) for /%s [0x%02X%02X]\n",
              list_length(observers_list) + 1, COAP_MAX_OBSERVERS,
@@ -89,6 +116,14 @@ add_observer(const coap_endpoint_t *endpoint, const uint8_t *token,
   return o;
 }
 /*---------------------------------------------------------------------------*/
+static void
+release_notification(coap_notification_t *n)
+{
+  if(--n->refs == 0) {
+    memb_free(&notifications_memb, n);
+  }
+}
+/*---------------------------------------------------------------------------*/
 /*- Removal -----------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
 void
@@ -97,6 +132,11 @@ coap_remove_observer(coap_observer_t *o)
   LOG_INFO("Removing observer for /%s [0x%02X%02X]\n", o->url, o->token[0],
            o->token[1]);
 
+  if(o->pending != NULL) {
+    coap_timer_stop(&o->retrans_timer);
+    release_notification(o->pending);
+    o->pending = NULL;
+  }
   memb_free(&observers_memb, o);
   list_remove(observers_list, o);
 }
@@ -106,12 +146,14 @@ coap_remove_observer_by_client(const coap_endpoint_t *endpoint)
 {
   int removed = 0;
   coap_observer_t *obs = NULL;
+  coap_observer_t *next;
 
   LOG_DBG("Remove check client ");
   LOG_DBG_COAP_EP(endpoint);
   LOG_DBG_("\n");
-  for(obs = (coap_observer_t *)list_head(observers_list); obs;
-      obs = obs->next) {
+  for(obs = (coap_observer_t *)list_head(observers_list); obs; obs = next) {
+    /* removal clears the link to the next observer */
+    next = obs->next;
     if(coap_endpoint_cmp(&obs->endpoint, endpoint)) {
       coap_remove_observer(obs);
       removed++;
@@ -126,9 +168,10 @@ coap_remove_observer_by_token(const coap_endpoint_t *endpoint,
 {
   int removed = 0;
   coap_observer_t *obs = NULL;
+  coap_observer_t *next;
 
-  for(obs = (coap_observer_t *)list_head(observers_list); obs;
-      obs = obs->next) {
+  for(obs = (coap_observer_t *)list_head(observers_list); obs; obs = next) {
+    next = obs->next;
     LOG_DBG("Remove check Token 0x%02X%02X\n", token[0], token[1]);
     if(coap_endpoint_cmp(&obs->endpoint, endpoint)
        && obs->token_len == token_len
@@ -146,9 +189,10 @@ coap_remove_observer_by_uri(const coap_endpoint_t *endpoint,
 {
   int removed = 0;
   coap_observer_t *obs = NULL;
+  coap_observer_t *next;
 
-  for(obs = (coap_observer_t *)list_head(observers_list); obs;
-      obs = obs->next) {
+  for(obs = (coap_observer_t *)list_head(observers_list); obs; obs = next) {
+    next = obs->next;
     LOG_DBG("Remove check URL %p\n", uri);
     if((endpoint == NULL
         || (coap_endpoint_cmp(&obs->endpoint, endpoint)))
@@ -165,9 +209,10 @@ coap_remove_observer_by_mid(const coap_endpoint_t *endpoint, uint16_t mid)
 {
   int removed = 0;
   coap_observer_t *obs = NULL;
+  coap_observer_t *next;
 
-  for(obs = (coap_observer_t *)list_head(observers_list); obs;
-      obs = obs->next) {
+  for(obs = (coap_observer_t *)list_head(observers_list); obs; obs = next) {
+    next = obs->next;
     LOG_DBG("Remove check MID %u\n", mid);
     if(coap_endpoint_cmp(&obs->endpoint, endpoint)
        && obs->last_mid == mid) {
@@ -178,20 +223,280 @@ coap_remove_observer_by_mid(const coap_endpoint_t *endpoint, uint16_t mid)
   return removed;
 }
 /*---------------------------------------------------------------------------*/
+int
+coap_observe_ack(const coap_endpoint_t *endpoint, uint16_t mid)
+{
+  coap_observer_t *obs = NULL;
+
+  for(obs = (coap_observer_t *)list_head(observers_list); obs;
+      obs = obs->next) {
+    if(obs->pending != NULL && obs->last_mid == mid
+       && coap_endpoint_cmp(&obs->endpoint, endpoint)) {
+      LOG_DBG("Notification %u acknowledged\n", mid);
+      coap_timer_stop(&obs->retrans_timer);
+      release_notification(obs->pending);
+      obs->pending = NULL;
+      obs->retrans_counter = 0;
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
 /*- Notification ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
+static uint16_t
+find_observe_option(const uint8_t *data, uint16_t len)
+{
+  uint16_t offset = COAP_HEADER_LEN;
+  unsigned int number = 0;
+
+  /* The template has no token, options start right after the header */
+  while(offset < len && data[offset] != 0xFF) {
+    unsigned int delta = data[offset] >> 4;
+    unsigned int length = data[offset] & 0x0F;
+    uint16_t pos = offset + 1;
+
+    if(delta == 13) {
+      delta = 13 + data[pos++];
+    } else if(delta == 14) {
+      delta = 269 + (data[pos] << 8 | data[pos + 1]);
+      pos += 2;
+    }
+    if(length == 13) {
+      length = 13 + data[pos++];
+    } else if(length == 14) {
+      length = 269 + (data[pos] << 8 | data[pos + 1]);
+      pos += 2;
+    }
+
+    number += delta;
+    if(number == COAP_OPTION_OBSERVE) {
+      return offset;
+    } else if(number > COAP_OPTION_OBSERVE) {
+      break;
+    }
+    offset = pos + length;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static coap_notification_t *
+render_notification(coap_resource_t *resource, coap_message_t *request)
+{
+  coap_message_t notification[1]; /* this way the message can be treated as pointer as usual */
+  coap_notification_t *n = &scratch;
+  int32_t new_offset = 0;
+
+  coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
+
+  /* Either old style get_handler or the full handler */
+  if(coap_call_handlers(request, notification, n->data + COAP_MAX_HEADER_SIZE,
+                        COAP_MAX_CHUNK_SIZE, &new_offset) > 0) {
+    LOG_DBG("Notification on new handlers\n");
+  } else {
+    if(resource != NULL) {
+      resource->get_handler(request, notification,
+                            n->data + COAP_MAX_HEADER_SIZE,
+                            COAP_MAX_CHUNK_SIZE, &new_offset);
+    } else {
+      /* What to do here? */
+      notification->code = BAD_REQUEST_4_00;
+    }
+  }
+
+  if(notification->code < BAD_REQUEST_4_00) {
+    /* Patched with the observer's sequence number when sending */
+    coap_set_header_observe(notification, OBSERVE_PLACEHOLDER);
+  }
+
+  if(new_offset != 0) {
+    coap_set_header_block2(notification,
+                           0,
+                           new_offset != -1,
+                           COAP_MAX_BLOCK_SIZE);
+    coap_set_payload(notification,
+                     notification->payload,
+                     MIN(notification->payload_len,
+                         COAP_MAX_BLOCK_SIZE));
+  }
+
+  n->len = coap_serialize_message(notification, n->data);
+  if(n->len == 0) {
+    LOG_WARN("Failed to serialize notification\n");
+    return NULL;
+  }
+
+  n->observe_offset = 0;
+  if(notification->code < BAD_REQUEST_4_00) {
+    n->observe_offset = find_observe_option(n->data, n->len);
+  }
+
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/* Copies a rendered notification into the pool, for retransmissions */
+static coap_notification_t *
+keep_notification(const coap_notification_t *n)
+{
+  coap_notification_t *kept;
+
+  kept = memb_alloc(&notifications_memb);
+  if(kept == NULL) {
+    return NULL;
+  }
+  kept->refs = 1;
+  kept->len = n->len;
+  kept->observe_offset = n->observe_offset;
+  memcpy(kept->data, n->data, n->len);
+  return kept;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_notification(const coap_notification_t *n, coap_observer_t *obs,
+                  coap_message_type_t type)
+{
+  static uint8_t buffer[COAP_MAX_PACKET_SIZE + COAP_TOKEN_LEN + 1];
+  const uint8_t *rest = n->data + COAP_HEADER_LEN;
+  uint8_t *p = buffer;
+  size_t len;
+
+  /* Header with the observer's type, token length and MID */
+  *p++ = (n->data[0] & ~(COAP_HEADER_TYPE_MASK | COAP_HEADER_TOKEN_LEN_MASK))
+    | (COAP_HEADER_TYPE_MASK & type << COAP_HEADER_TYPE_POSITION)
+    | (COAP_HEADER_TOKEN_LEN_MASK
+       & obs->token_len << COAP_HEADER_TOKEN_LEN_POSITION);
+  *p++ = n->data[1];
+  *p++ = (uint8_t)(obs->last_mid >> 8);
+  *p++ = (uint8_t)(obs->last_mid);
+
+  memcpy(p, obs->token, obs->token_len);
+  p += obs->token_len;
+
+  if(n->observe_offset != 0) {
+    /* the sequence number was advanced when the notification was queued */
+    uint32_t observe = (obs->obs_counter - 1) & 0xffffff;
+    uint8_t observe_len = (observe > 0xFFFF) ? 3 : (observe > 0xFF) ? 2 :
+      (observe > 0) ? 1 : 0;
+
+    len = n->observe_offset - COAP_HEADER_LEN;
+    memcpy(p, rest, len);
+    p += len;
+
+    /* Observe is option 6, so its delta always fits in the first byte */
+    *p++ = (n->data[n->observe_offset] & 0xF0) | observe_len;
+    while(observe_len > 0) {
+      *p++ = (uint8_t)(observe >> (8 * --observe_len));
+    }
+    rest = n->data + n->observe_offset + 1 + OBSERVE_PLACEHOLDER_LEN;
+  }
+
+  len = n->data + n->len - rest;
+  memcpy(p, rest, len);
+  p += len;
+
+  coap_sendto(&obs->endpoint, buffer, p - buffer);
+}
+/*---------------------------------------------------------------------------*/
+static void
+retransmit_notification(coap_timer_t *timer)
+{
+  coap_observer_t *obs = coap_timer_get_user_data(timer);
+  coap_endpoint_t endpoint;
+
+  if(obs->pending == NULL) {
+    return;
+  }
+
+  if(++obs->retrans_counter > COAP_MAX_RETRANSMIT) {
+    /* timed out */
+    LOG_DBG("Notification %u timed out\n", obs->last_mid);
+    coap_endpoint_copy(&endpoint, &obs->endpoint);
+    coap_remove_observer_by_client(&endpoint);
+    return;
+  }
+
+  obs->retrans_interval <<= 1;  /* double */
+  LOG_DBG("Retransmitting notification %u (%u)\n", obs->last_mid,
+          obs->retrans_counter);
+  send_notification(obs->pending, obs, COAP_TYPE_CON);
+  coap_timer_set(&obs->retrans_timer, obs->retrans_interval);
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Sends the rendered notification n to an observer. kept is the copy of
+ * n shared by the observers sent a CON notification, made by the first.
+ */
+static void
+notify_observer(const coap_notification_t *n, coap_notification_t **kept,
+                coap_observer_t *obs)
+{
+  coap_message_type_t type = COAP_TYPE_NON;
+
+  /* if COAP_OBSERVE_REFRESH_INTERVAL is zero, never send observations as
+     confirmable messages, unless one is still outstanding */
+  if(obs->pending != NULL
+     || (COAP_OBSERVE_REFRESH_INTERVAL != 0
+         && (obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0))) {
+    LOG_DBG("           Force Confirmable for\n");
+    type = COAP_TYPE_CON;
+    if(*kept == NULL) {
+      *kept = keep_notification(n);
+      if(*kept == NULL) {
+        /* Like a lack of transactions: only this observer misses it */
+        LOG_WARN("No buffer for confirmable notification\n");
+        return;
+      }
+    }
+  }
+
+  LOG_DBG("           Observer ");
+  LOG_DBG_COAP_EP(&obs->endpoint);
+  LOG_DBG_("\n");
+
+  /* update last MID for RST matching */
+  obs->last_mid = coap_get_mid();
+
+  if(n->observe_offset != 0) {
+    (obs->obs_counter)++;
+    /* mask out to keep the CoAP observe option length <= 3 bytes */
+    obs->obs_counter &= 0xffffff;
+  }
+
+  if(type == COAP_TYPE_CON) {
+    if(obs->pending == NULL) {
+      coap_timer_set_callback(&obs->retrans_timer, retransmit_notification);
+      coap_timer_set_user_data(&obs->retrans_timer, obs);
+      obs->retrans_counter = 0;
+      obs->retrans_interval =
+        COAP_RESPONSE_TIMEOUT_TICKS + (rand() %
+                                       COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
+    } else {
+      /* A newer notification replaces the outstanding one and inherits
+         its retransmission state (RFC 7641, section 4.5.2) */
+      release_notification(obs->pending);
+    }
+    obs->pending = *kept;
+    (*kept)->refs++;
+    coap_timer_set(&obs->retrans_timer, obs->retrans_interval);
+  }
+
+  send_notification(n, obs, type);
+}
+/*---------------------------------------------------------------------------*/
 void
 coap_notify_observers(coap_resource_t *resource)
 {
   coap_notify_observers_sub(resource, NULL);
 }
 /* Can be used either for sub - or when there is not resource - just
-   a handler */
-void
-coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
+   a handler. With exact set only observers of the URL itself match. */
+static void
+notify_observers(coap_resource_t *resource, const char *subpath, int exact)
 {
   /* build notification */
-  coap_message_t notification[1]; /* this way the message can be treated as pointer as usual */
+  coap_notification_t *notification = NULL;
+  coap_notification_t *kept = NULL;
   coap_message_t request[1]; /* this way the message can be treated as pointer as usual */
   coap_observer_t *obs = NULL;
   int url_len, obs_url_len;
@@ -216,7 +521,6 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
   /* url now contains the notify URL that needs to match the observer */
   LOG_INFO("Notification from %s\n", url);
 
-  coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
   /* create a "fake" request for the URI */
   coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
   coap_set_header_uri_path(request, url);
@@ -224,7 +528,8 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
   /* iterate over observers */
   url_len = strlen(url);
   /* Assumes lazy evaluation... */
-  sub_ok = (resource == NULL) || (resource->flags & HAS_SUB_RESOURCES);
+  sub_ok = !exact &&
+    ((resource == NULL) || (resource->flags & HAS_SUB_RESOURCES));
   for(obs = (coap_observer_t *)list_head(observers_list); obs;
       obs = obs->next) {
     obs_url_len = strlen(obs->url);
@@ -239,71 +544,35 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
             && sub_ok
             && obs->url[url_len] == '/'))
        && strncmp(url, obs->url, url_len) == 0) {
-      coap_transaction_t *transaction = NULL;
-
-      /*TODO implement special transaction for CON, sharing the same buffer to allow for more observers */
 
-      if((transaction = coap_new_transaction(coap_get_mid(), &obs->endpoint))) {
-        /* if COAP_OBSERVE_REFRESH_INTERVAL is zero, never send observations as confirmable messages */
-        if(COAP_OBSERVE_REFRESH_INTERVAL != 0
-            && (obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0)) {
-          LOG_DBG("           Force Confirmable for\n");
-          notification->type = COAP_TYPE_CON;
+      /* The representation is the same for every observer: render it
+         on the first match only */
+      if(notification == NULL) {
+        notification = render_notification(resource, request);
+        if(notification == NULL) {
+          return;
         }
-
-        LOG_DBG("           Observer ");
-        LOG_DBG_COAP_EP(&obs->endpoint);
-        LOG_DBG_("\n");
-
-        /* update last MID for RST matching */
-        obs->last_mid = transaction->mid;
-
-        /* prepare response */
-        notification->mid = transaction->mid;
-
-	int32_t new_offset = 0;
-
-        /* Either old style get_handler or the full handler */
-        if(coap_call_handlers(request, notification, transaction->message +
-                              COAP_MAX_HEADER_SIZE, COAP_MAX_CHUNK_SIZE,
-                              &new_offset) > 0) {
-          LOG_DBG("Notification on new handlers\n");
-        } else {
-          if(resource != NULL) {
-            resource->get_handler(request, notification,
-                                  transaction->message + COAP_MAX_HEADER_SIZE,
-                                  COAP_MAX_CHUNK_SIZE, &new_offset);
-          } else {
-            /* What to do here? */
-            notification->code = BAD_REQUEST_4_00;
-          }
-        }
-
-        if(notification->code < BAD_REQUEST_4_00) {
-          coap_set_header_observe(notification, (obs->obs_counter)++);
-          /* mask out to keep the CoAP observe option length <= 3 bytes */
-          obs->obs_counter &= 0xffffff;
-        }
-        coap_set_token(notification, obs->token, obs->token_len);
-
-	if(new_offset != 0) {
-	  coap_set_header_block2(notification,
-				 0,
-				 new_offset != -1,
-				 COAP_MAX_BLOCK_SIZE);
-	  coap_set_payload(notification,
-			   notification->payload,
-			   MIN(notification->payload_len,
-			       COAP_MAX_BLOCK_SIZE));
-	}
-
-        transaction->message_len =
-          coap_serialize_message(notification, transaction->message);
-
-        coap_send_transaction(transaction);
       }
+
+      notify_observer(notification, &kept, obs);
     }
   }
+
+  if(kept != NULL) {
+    release_notification(kept);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
+{
+  notify_observers(resource, subpath, 0);
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_notify_observers_exact(const char *path)
+{
+  notify_observers(NULL, path, 1);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -359,10 +628,13 @@ uint8_t
 coap_has_observers(char *path)
 {
   coap_observer_t *obs = NULL;
+  size_t len = strlen(path);
 
   for(obs = (coap_observer_t *)list_head(observers_list); obs;
       obs = obs->next) {
-    if((strncmp(obs->url, path, strlen(path))) == 0) {
+    /* The path, or a path below it: "3" matches "3/0" but not "3303" */
+    if(strncmp(obs->url, path, len) == 0 &&
+       (obs->url[len] == '\0' || obs->url[len] == '/')) {
       return 1;
     }
   }
@@ -59,7 +59,10 @@ typedef struct coap_observer {
 
   int32_t obs_counter;
 
+  /* Retransmission state of an outstanding confirmable notification */
+  struct coap_notification *pending;
   coap_timer_t retrans_timer;
+  uint32_t retrans_interval;
   uint8_t retrans_counter;
 } coap_observer_t;
 
@@ -72,9 +75,23 @@ int coap_remove_observer_by_uri(const coap_endpoint_t *ep,
 int coap_remove_observer_by_mid(const coap_endpoint_t *ep,
                                 uint16_t mid);
 
+/**
+ * \brief Acknowledge a confirmable notification
+ * \param ep The endpoint the ACK was received from
+ * \param mid The message ID of the ACK
+ * \return 1 if the ACK matched an outstanding notification, 0 otherwise
+ */
+int coap_observe_ack(const coap_endpoint_t *ep, uint16_t mid);
+
 void coap_notify_observers(coap_resource_t *resource);
 void coap_notify_observers_sub(coap_resource_t *resource, const char *subpath);
 
+/**
+ * \brief Notify the observers of a path but not those of its sub-paths
+ * \param path The path handled by a CoAP handler, without leading slash
+ */
+void coap_notify_observers_exact(const char *path);
+
 void coap_observe_handler(coap_resource_t *resource, coap_message_t *request,
                           coap_message_t *response);
 
@@ -49,6 +49,7 @@
 #include "sys/clock.h"
 #include "sys/etimer.h"
 #include "sys/process.h"
+#include "sys/energest.h"
 
 /* Log configuration */
 #include "coap-log.h"
@@ -121,6 +122,8 @@ uptime(void)
 static void
 init(void)
 {
+  /* The timers are used for retransmissions and observations */
+  ENERGEST_TAG_PROCESS(&coap_timer_process, ENERGEST_TAG_COAP);
   process_start(&coap_timer_process, NULL);
 }
 /*---------------------------------------------------------------------------*/
@@ -50,6 +50,7 @@
 #include "net/ipv6/uip-udp-packet.h"
 #include "net/ipv6/uiplib.h"
 #include "net/routing/routing.h"
+#include "sys/energest.h"
 #include "coap.h"
 #include "coap-engine.h"
 #include "coap-endpoint.h"
@@ -327,6 +328,7 @@ coap_databuf(void)
 void
 coap_transport_init(void)
 {
+  ENERGEST_TAG_PROCESS(&coap_engine, ENERGEST_TAG_COAP);
   process_start(&coap_engine, NULL);
 #ifdef WITH_DTLS
   dtls_init();
@@ -43,238 +43,345 @@ LIST(socketlist);
 
 static void removesocket(struct http_socket *s);
 /*---------------------------------------------------------------------------*/
+/* Response parser states */
+enum {
+  PARSE_STATUS,
+  PARSE_HEADERS,
+  PARSE_BODY,
+  PARSE_CHUNK_SIZE,
+  PARSE_CHUNK_DATA,
+  PARSE_CHUNK_END,
+  PARSE_TRAILER,
+  PARSE_UNTIL_CLOSE,
+  PARSE_IGNORE,
+};
+
+#define PARSE_FLAG_CHUNKED 0x01
+#define PARSE_FLAG_CLOSE   0x02
+/*---------------------------------------------------------------------------*/
 static void
 call_callback(struct http_socket *s, http_socket_event_t e,
               const uint8_t *data, uint16_t datalen)
 {
-  if(s->callback != NULL) {
-    s->callback(s, s->callbackptr, e,
-                data, datalen);
+  http_socket_callback_t callback = s->callback;
+  void *callbackptr = s->callbackptr;
+
+  /* Events for a response go to the request it answers */
+  if(s->pending_len > 0) {
+    callback = s->pending[s->pending_start].callback;
+    callbackptr = s->pending[s->pending_start].callbackptr;
+  }
+  if(callback != NULL) {
+    callback(s, callbackptr, e,
+             data, datalen);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Ends every request that still waits for its response with event e.
+ * The data, if any, belongs to the first one; the others get none.
+ */
+static void
+fail_requests(struct http_socket *s, http_socket_event_t e,
+              const uint8_t *data, uint16_t datalen)
+{
+  struct http_socket_request failed[HTTP_SOCKET_PIPELINE];
+  int count;
+  int i;
+
+  if(s->pending_len == 0) {
+    call_callback(s, e, data, datalen);
+    return;
+  }
+
+  /* The callbacks may start new requests on the socket */
+  count = s->pending_len;
+  for(i = 0; i < count; i++) {
+    failed[i] = s->pending[(s->pending_start + i) % HTTP_SOCKET_PIPELINE];
+  }
+  s->pending_len = 0;
+
+  for(i = 0; i < count; i++) {
+    if(failed[i].callback != NULL) {
+      failed[i].callback(s, failed[i].callbackptr, e,
+                         i == 0 ? data : NULL, i == 0 ? datalen : 0);
+    }
   }
 }
 /*---------------------------------------------------------------------------*/
 static void
-parse_header_init(struct http_socket *s)
+start_timeout_timer(struct http_socket *s, clock_time_t timeout)
 {
-  PT_INIT(&s->headerpt);
+  PROCESS_CONTEXT_BEGIN(&http_socket_process);
+  etimer_set(&s->timeout_timer, timeout);
+  PROCESS_CONTEXT_END(&http_socket_process);
+  s->timeout_timer_started = 1;
 }
 /*---------------------------------------------------------------------------*/
-static int
-parse_header_byte(struct http_socket *s, char c)
+static void
+close_connection(struct http_socket *s)
 {
-  PT_BEGIN(&s->headerpt);
-
-  memset(&s->header, -1, sizeof(s->header));
-
-  /* Skip the HTTP response */
-  while(c != ' ') {
-    PT_YIELD(&s->headerpt);
+  s->connected = 0;
+  s->parse_state = PARSE_IGNORE;
+  tcp_socket_close(&s->s);
+}
+/*---------------------------------------------------------------------------*/
+static void
+response_done(struct http_socket *s)
+{
+  struct http_socket_request r;
+
+  r.callback = s->callback;
+  r.callbackptr = s->callbackptr;
+  if(s->pending_len > 0) {
+    r = s->pending[s->pending_start];
+    s->pending_start = (s->pending_start + 1) % HTTP_SOCKET_PIPELINE;
+    s->pending_len--;
+  }
+  s->parse_state = PARSE_STATUS;
+  if(!s->keep_alive || (s->parse_flags & PARSE_FLAG_CLOSE)) {
+    close_connection(s);
   }
 
-  /* Skip the space */
-  PT_YIELD(&s->headerpt);
-  /* Read three characters of HTTP status and convert to BCD */
-  s->header.status_code = 0;
-  for(s->header_chars = 0; s->header_chars < 3; s->header_chars++) {
-    s->header.status_code = s->header.status_code << 4 | (c - '0');
-    PT_YIELD(&s->headerpt);
+  /* The callback may already send the next request */
+  if(r.callback != NULL) {
+    r.callback(s, r.callbackptr, HTTP_SOCKET_COMPLETE, NULL, 0);
+  }
+  if(s->connected && s->pending_len == 0) {
+    start_timeout_timer(s, HTTP_SOCKET_IDLE_TIMEOUT);
   }
+}
+/*---------------------------------------------------------------------------*/
+static int64_t
+parse_number(const char **strptr)
+{
+  const char *str = *strptr;
+  int64_t n = 0;
 
-  if(s->header.status_code == 0x200 || s->header.status_code == 0x206) {
-    /* Read headers until data */
+  while(*str == ' ' || *str == '\t') {
+    str++;
+  }
+  while(isdigit((int)*str)) {
+    n = n * 10 + *str++ - '0';
+  }
+  while(*str == ' ' || *str == '\t') {
+    str++;
+  }
+  *strptr = str;
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/* The value of a header line for the given (lower case) field, or NULL */
+static const char *
+header_value(const char *line, const char *field)
+{
+  int len = strlen(field);
 
-    while(1) {
-      /* Skip characters until end of line */
-      do {
-        while(c != '\r') {
-          s->header_chars++;
-          PT_YIELD(&s->headerpt);
-        }
-        s->header_chars++;
-        PT_YIELD(&s->headerpt);
-      } while(c != '\n');
-      s->header_chars--;
-      PT_YIELD(&s->headerpt);
-
-      if(s->header_chars == 0) {
-        /* This was an empty line, i.e. the end of headers */
-        break;
-      }
+  if(strncmp(line, field, len) != 0) {
+    return NULL;
+  }
+  line += len;
+  while(*line == ' ' || *line == '\t') {
+    line++;
+  }
+  if(*line != ':') {
+    return NULL;
+  }
+  line++;
+  while(*line == ' ' || *line == '\t') {
+    line++;
+  }
+  return line;
+}
+/*---------------------------------------------------------------------------*/
+static void
+parse_status_line(struct http_socket *s)
+{
+  const char *p;
+  int i;
 
-      /* Start of line */
-      s->header_chars = 0;
+  memset(&s->header, -1, sizeof(s->header));
+  s->parse_flags = 0;
+  if(strncmp(s->line, "http/1.0", 8) == 0) {
+    s->parse_flags |= PARSE_FLAG_CLOSE;
+  }
 
-      /* Read header field */
-      while(c != ' ' && c != '\t' && c != ':' && c != '\r' &&
-            s->header_chars < sizeof(s->header_field) - 1) {
-        s->header_field[s->header_chars++] = c;
-        PT_YIELD(&s->headerpt);
-      }
-      s->header_field[s->header_chars] = '\0';
-      /* Skip linear white spaces */
-      while(c == ' ' || c == '\t') {
-        s->header_chars++;
-        PT_YIELD(&s->headerpt);
-      }
-      if(c == ':') {
-        /* Skip the colon */
-        s->header_chars++;
-        PT_YIELD(&s->headerpt);
-        /* Skip linear white spaces */
-        while(c == ' ' || c == '\t') {
-          s->header_chars++;
-          PT_YIELD(&s->headerpt);
+  /* Skip the HTTP version and convert the status code to BCD */
+  p = strchr(s->line, ' ');
+  if(p == NULL) {
+    p = s->line + s->line_len;
+  }
+  while(*p == ' ') {
+    p++;
+  }
+  s->header.status_code = 0;
+  for(i = 0; i < 3 && isdigit((int)*p); i++) {
+    s->header.status_code = s->header.status_code << 4 | (*p++ - '0');
+  }
+  s->parse_state = PARSE_HEADERS;
+}
+/*---------------------------------------------------------------------------*/
+static void
+parse_header_line(struct http_socket *s)
+{
+  const char *value;
+
+  if((value = header_value(s->line, "content-length")) != NULL) {
+    s->header.content_length = parse_number(&value);
+  } else if((value = header_value(s->line, "content-range")) != NULL) {
+    /* Skip the bytes-unit token */
+    while(*value != ' ' && *value != '\t' && *value != '\0') {
+      value++;
+    }
+    s->header.content_range.first_byte_pos = parse_number(&value);
+    if(*value == '-') {
+      value++;
+      s->header.content_range.last_byte_pos = parse_number(&value);
+      if(*value == '/') {
+        value++;
+        while(*value == ' ' || *value == '\t') {
+          value++;
         }
-        if(!strcmp(s->header_field, "Content-Length")) {
-          s->header.content_length = 0;
-          while(isdigit((int)c)) {
-            s->header.content_length = s->header.content_length * 10 + c - '0';
-            s->header_chars++;
-            PT_YIELD(&s->headerpt);
-          }
-        } else if(!strcmp(s->header_field, "Content-Range")) {
-          /* Skip the bytes-unit token */
-          while(c != ' ' && c != '\t') {
-            s->header_chars++;
-            PT_YIELD(&s->headerpt);
-          }
-          /* Skip linear white spaces */
-          while(c == ' ' || c == '\t') {
-            s->header_chars++;
-            PT_YIELD(&s->headerpt);
-          }
-          s->header.content_range.first_byte_pos = 0;
-          while(isdigit((int)c)) {
-            s->header.content_range.first_byte_pos =
-              s->header.content_range.first_byte_pos * 10 + c - '0';
-            s->header_chars++;
-            PT_YIELD(&s->headerpt);
-          }
-          /* Skip linear white spaces */
-          while(c == ' ' || c == '\t') {
-            s->header_chars++;
-            PT_YIELD(&s->headerpt);
-          }
-          if(c == '-') {
-            /* Skip the dash */
-            s->header_chars++;
-            PT_YIELD(&s->headerpt);
-            /* Skip linear white spaces */
-            while(c == ' ' || c == '\t') {
-              s->header_chars++;
-              PT_YIELD(&s->headerpt);
-            }
-            s->header.content_range.last_byte_pos = 0;
-            while(isdigit((int)c)) {
-              s->header.content_range.last_byte_pos =
-                s->header.content_range.last_byte_pos * 10 + c - '0';
-              s->header_chars++;
-              PT_YIELD(&s->headerpt);
-            }
-            /* Skip linear white spaces */
-            while(c == ' ' || c == '\t') {
-              s->header_chars++;
-              PT_YIELD(&s->headerpt);
-            }
-            if(c == '/') {
-              /* Skip the slash */
-              s->header_chars++;
-              PT_YIELD(&s->headerpt);
-              /* Skip linear white spaces */
-              while(c == ' ' || c == '\t') {
-                s->header_chars++;
-                PT_YIELD(&s->headerpt);
-              }
-              if(c != '*') {
-                s->header.content_range.instance_length = 0;
-                while(isdigit((int)c)) {
-                  s->header.content_range.instance_length =
-                    s->header.content_range.instance_length * 10 + c - '0';
-                  s->header_chars++;
-                  PT_YIELD(&s->headerpt);
-                }
-              }
-            }
-          }
+        if(*value != '*') {
+          s->header.content_range.instance_length = parse_number(&value);
         }
       }
     }
-
-    /* All headers read, now read data */
-    call_callback(s, HTTP_SOCKET_HEADER, (void *)&s->header, sizeof(s->header));
-
-    /* Should exit the pt here to indicate that all headers have been
-       read */
-    PT_EXIT(&s->headerpt);
-  } else {
+  } else if((value = header_value(s->line, "transfer-encoding")) != NULL) {
+    if(strstr(value, "chunked") != NULL) {
+      s->parse_flags |= PARSE_FLAG_CHUNKED;
+    }
+  } else if((value = header_value(s->line, "connection")) != NULL) {
+    if(strstr(value, "close") != NULL) {
+      s->parse_flags |= PARSE_FLAG_CLOSE;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+headers_done(struct http_socket *s)
+{
+  if(s->header.status_code != 0x200 && s->header.status_code != 0x206) {
     if(s->header.status_code == 0x404) {
       printf("File not found\n");
     } else if(s->header.status_code == 0x301 || s->header.status_code == 0x302) {
       printf("File moved (not handled)\n");
     }
 
-    call_callback(s, HTTP_SOCKET_ERR, (void *)&s->header, sizeof(s->header));
-    tcp_socket_close(&s->s);
+    fail_requests(s, HTTP_SOCKET_ERR, (void *)&s->header, sizeof(s->header));
+    close_connection(s);
     removesocket(s);
-    PT_EXIT(&s->headerpt);
+    return;
   }
 
+  /* All headers read, now read data */
+  call_callback(s, HTTP_SOCKET_HEADER, (void *)&s->header, sizeof(s->header));
 
-  PT_END(&s->headerpt);
+  s->bodylen = 0;
+  if(s->parse_flags & PARSE_FLAG_CHUNKED) {
+    s->parse_state = PARSE_CHUNK_SIZE;
+  } else if(s->header.content_length > 0) {
+    s->body_left = s->header.content_length;
+    s->parse_state = PARSE_BODY;
+  } else if(s->header.content_length == 0) {
+    response_done(s);
+  } else {
+    /* The body ends when the server closes the connection */
+    s->parse_flags |= PARSE_FLAG_CLOSE;
+    s->parse_state = PARSE_UNTIL_CLOSE;
+  }
 }
 /*---------------------------------------------------------------------------*/
-static int
-input_pt(struct http_socket *s,
-         const uint8_t *inputptr, int inputdatalen)
+static void
+parse_line(struct http_socket *s)
 {
-  int i;
-  PT_BEGIN(&s->pt);
-
-  /* Parse the header */
-  s->header_received = 0;
-  do {
-    for(i = 0; i < inputdatalen; i++) {
-      if(!PT_SCHEDULE(parse_header_byte(s, inputptr[i]))) {
-        s->header_received = 1;
-        break;
-      }
+  const char *p;
+  int digit;
+
+  switch(s->parse_state) {
+  case PARSE_STATUS:
+    /* Tolerate empty lines before the status line */
+    if(s->line_len > 0) {
+      parse_status_line(s);
     }
-    inputdatalen -= i;
-    inputptr += i;
-
-    if(s->header_received == 0) {
-      /* If we have not yet received the full header, we wait for the
-         next packet to arrive. */
-      PT_YIELD(&s->pt);
+    break;
+  case PARSE_HEADERS:
+    if(s->line_len == 0) {
+      headers_done(s);
+    } else {
+      parse_header_line(s);
     }
-  } while(s->header_received == 0);
-
-  s->bodylen = 0;
-  do {
-    /* Receive the data */
-    call_callback(s, HTTP_SOCKET_DATA, inputptr, inputdatalen);
-
-    /* Close the connection if the expected content length has been received */
-    if(s->header.content_length >= 0 && s->bodylen < s->header.content_length) {
-      s->bodylen += inputdatalen;
-      if(s->bodylen >= s->header.content_length) {
-        tcp_socket_close(&s->s);
-      }
+    break;
+  case PARSE_CHUNK_SIZE:
+    /* Chunk extensions after the size are ignored */
+    s->body_left = 0;
+    for(p = s->line; isxdigit((int)*p); p++) {
+      digit = isdigit((int)*p) ? *p - '0' : *p - 'a' + 10;
+      s->body_left = s->body_left << 4 | digit;
     }
-
-    PT_YIELD(&s->pt);
-  } while(inputdatalen > 0);
-
-  PT_END(&s->pt);
+    s->parse_state = s->body_left > 0 ? PARSE_CHUNK_DATA : PARSE_TRAILER;
+    break;
+  case PARSE_CHUNK_END:
+    s->parse_state = PARSE_CHUNK_SIZE;
+    break;
+  case PARSE_TRAILER:
+    if(s->line_len == 0) {
+      response_done(s);
+    }
+    break;
+  }
 }
 /*---------------------------------------------------------------------------*/
-static void
-start_timeout_timer(struct http_socket *s)
+/*
+ * Parses the start of the input and returns the number of bytes it
+ * used. Body data is passed on as it is; lines are collected, in lower
+ * case and without the line end, and parsed once complete.
+ */
+static int
+parse(struct http_socket *s, const uint8_t *data, int len)
 {
-  PROCESS_CONTEXT_BEGIN(&http_socket_process);
-  etimer_set(&s->timeout_timer, HTTP_SOCKET_TIMEOUT);
-  PROCESS_CONTEXT_END(&http_socket_process);
-  s->timeout_timer_started = 1;
+  const uint8_t *end;
+  int n, copylen;
+
+  switch(s->parse_state) {
+  case PARSE_BODY:
+  case PARSE_CHUNK_DATA:
+    n = MIN((uint64_t)len, s->body_left);
+    s->body_left -= n;
+    s->bodylen += n;
+    call_callback(s, HTTP_SOCKET_DATA, data, n);
+    if(s->body_left == 0) {
+      if(s->parse_state == PARSE_BODY) {
+        response_done(s);
+      } else {
+        s->parse_state = PARSE_CHUNK_END;
+      }
+    }
+    return n;
+  case PARSE_UNTIL_CLOSE:
+    s->bodylen += len;
+    call_callback(s, HTTP_SOCKET_DATA, data, len);
+    return len;
+  case PARSE_IGNORE:
+    return len;
+  }
+
+  end = memchr(data, '\n', len);
+  n = end == NULL ? len : end - data + 1;
+  copylen = MIN(end == NULL ? n : n - 1,
+                (int)sizeof(s->line) - 1 - s->line_len);
+  while(copylen-- > 0) {
+    s->line[s->line_len++] = tolower((int)*data++);
+  }
+  if(end != NULL) {
+    if(s->line_len > 0 && s->line[s->line_len - 1] == '\r') {
+      s->line_len--;
+    }
+    s->line[s->line_len] = '\0';
+    parse_line(s);
+    s->line_len = 0;
+  }
+  return n;
 }
 /*---------------------------------------------------------------------------*/
 static int
@@ -282,9 +389,16 @@ input(struct tcp_socket *tcps, void *ptr,
       const uint8_t *inputptr, int inputdatalen)
 {
   struct http_socket *s = ptr;
+  int len;
 
-  input_pt(s, inputptr, inputdatalen);
-  start_timeout_timer(s);
+  while(inputdatalen > 0) {
+    len = parse(s, inputptr, inputdatalen);
+    inputptr += len;
+    inputdatalen -= len;
+  }
+  if(s->pending_len > 0) {
+    start_timeout_timer(s, HTTP_SOCKET_TIMEOUT);
+  }
 
   return 0; /* all data consumed */
 }
@@ -391,96 +505,140 @@ removesocket(struct http_socket *s)
 {
   etimer_stop(&s->timeout_timer);
   s->timeout_timer_started = 0;
+  s->connected = 0;
   list_remove(socketlist, s);
 }
 /*---------------------------------------------------------------------------*/
+static int
+send_str(struct http_socket *s, int send, const char *str)
+{
+  if(send) {
+    tcp_socket_send_str(&s->s, str);
+  }
+  return strlen(str);
+}
+/*---------------------------------------------------------------------------*/
 static void
-event(struct tcp_socket *tcps, void *ptr,
-      tcp_socket_event_t e)
+send_postdata(struct http_socket *s)
+{
+  int len;
+
+  /* Refer to the data rather than copy it, while the socket has room
+     for another piece */
+  len = tcp_socket_send_ref(&s->s, s->postdata, s->postdatalen);
+  if(len <= 0) {
+    len = tcp_socket_send(&s->s, s->postdata, s->postdatalen);
+  }
+  if(len > 0) {
+    s->postdata += len;
+    s->postdatalen -= len;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Sends the request, or only counts the length of its header if send
+ * is zero. Returns the header length, or -1 if the URL is bad.
+ */
+static int
+send_request(struct http_socket *s, int send)
 {
-  struct http_socket *s = ptr;
   char host[MAX_HOSTLEN];
   char path[MAX_PATHLEN];
   uint16_t port;
   char str[42];
-  int len;
+  int len = 0;
 
-  if(e == TCP_SOCKET_CONNECTED) {
-    printf("Connected\n");
-    if(parse_url(s->url, host, &port, path)) {
-      tcp_socket_send_str(tcps, s->postdata != NULL ? "POST " : "GET ");
-      if(s->proxy_port != 0) {
-        /* If we are configured to route through a proxy, we should
-           provide the full URL as the path. */
-        tcp_socket_send_str(tcps, s->url);
+  if(!parse_url(s->url, host, &port, path)) {
+    return -1;
+  }
+
+  len += send_str(s, send, s->postdata != NULL ? "POST " : "GET ");
+  if(s->proxy_port != 0) {
+    /* If we are configured to route through a proxy, we should
+       provide the full URL as the path. */
+    len += send_str(s, send, s->url);
+  } else {
+    len += send_str(s, send, path);
+  }
+  len += send_str(s, send, " HTTP/1.1\r\n");
+  if(!s->keep_alive) {
+    len += send_str(s, send, "Connection: close\r\n");
+  }
+  len += send_str(s, send, "Host: ");
+  /* If we have IPv6 host, add the '[' and the ']' characters
+     to the host. As in rfc2732. */
+  if(memchr(host, ':', MAX_HOSTLEN)) {
+    len += send_str(s, send, "[");
+  }
+  len += send_str(s, send, host);
+  if(memchr(host, ':', MAX_HOSTLEN)) {
+    len += send_str(s, send, "]");
+  }
+  len += send_str(s, send, "\r\n");
+  if(s->postdata != NULL) {
+    if(s->content_type) {
+      len += send_str(s, send, "Content-Type: ");
+      len += send_str(s, send, s->content_type);
+      len += send_str(s, send, "\r\n");
+    }
+    len += send_str(s, send, "Content-Length: ");
+    sprintf(str, "%u", s->postdatalen);
+    len += send_str(s, send, str);
+    len += send_str(s, send, "\r\n");
+  } else if(s->length || s->pos > 0) {
+    len += send_str(s, send, "Range: bytes=");
+    if(s->length) {
+      if(s->pos >= 0) {
+        sprintf(str, "%llu-%llu",
+          (long long unsigned int)s->pos, (long long unsigned int)s->pos + s->length - 1);
       } else {
-        tcp_socket_send_str(tcps, path);
-      }
-      tcp_socket_send_str(tcps, " HTTP/1.1\r\n");
-      tcp_socket_send_str(tcps, "Connection: close\r\n");
-      tcp_socket_send_str(tcps, "Host: ");
-      /* If we have IPv6 host, add the '[' and the ']' characters
-         to the host. As in rfc2732. */
-      if(memchr(host, ':', MAX_HOSTLEN)) {
-        tcp_socket_send_str(tcps, "[");
-      }
-      tcp_socket_send_str(tcps, host);
-      if(memchr(host, ':', MAX_HOSTLEN)) {
-        tcp_socket_send_str(tcps, "]");
-      }
-      tcp_socket_send_str(tcps, "\r\n");
-      if(s->postdata != NULL) {
-        if(s->content_type) {
-          tcp_socket_send_str(tcps, "Content-Type: ");
-          tcp_socket_send_str(tcps, s->content_type);
-          tcp_socket_send_str(tcps, "\r\n");
-        }
-        tcp_socket_send_str(tcps, "Content-Length: ");
-        sprintf(str, "%u", s->postdatalen);
-        tcp_socket_send_str(tcps, str);
-        tcp_socket_send_str(tcps, "\r\n");
-      } else if(s->length || s->pos > 0) {
-        tcp_socket_send_str(tcps, "Range: bytes=");
-        if(s->length) {
-          if(s->pos >= 0) {
-            sprintf(str, "%llu-%llu",
-              (long long unsigned int)s->pos, (long long unsigned int)s->pos + s->length - 1);
-          } else {
-            sprintf(str, "-%llu", (long long unsigned int)s->length);
-          }
-        } else {
-          sprintf(str, "%llu-", (long long unsigned int)s->pos);
-        }
-        tcp_socket_send_str(tcps, str);
-        tcp_socket_send_str(tcps, "\r\n");
-      }
-      tcp_socket_send_str(tcps, "\r\n");
-      if(s->postdata != NULL && s->postdatalen) {
-        len = tcp_socket_send(tcps, s->postdata, s->postdatalen);
-        s->postdata += len;
-        s->postdatalen -= len;
+        sprintf(str, "-%llu", (long long unsigned int)s->length);
       }
+    } else {
+      sprintf(str, "%llu-", (long long unsigned int)s->pos);
     }
-    parse_header_init(s);
+    len += send_str(s, send, str);
+    len += send_str(s, send, "\r\n");
+  }
+  len += send_str(s, send, "\r\n");
+  if(send && s->postdata != NULL && s->postdatalen) {
+    send_postdata(s);
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static void
+event(struct tcp_socket *tcps, void *ptr,
+      tcp_socket_event_t e)
+{
+  struct http_socket *s = ptr;
+
+  if(e == TCP_SOCKET_CONNECTED) {
+    printf("Connected\n");
+    s->connected = 1;
+    s->parse_state = PARSE_STATUS;
+    s->line_len = 0;
+    send_request(s, 1);
   } else if(e == TCP_SOCKET_CLOSED) {
-    call_callback(s, HTTP_SOCKET_CLOSED, NULL, 0);
+    if(s->parse_state == PARSE_UNTIL_CLOSE) {
+      response_done(s);
+    }
+    fail_requests(s, HTTP_SOCKET_CLOSED, NULL, 0);
     removesocket(s);
     printf("Closed\n");
   } else if(e == TCP_SOCKET_TIMEDOUT) {
-    call_callback(s, HTTP_SOCKET_TIMEDOUT, NULL, 0);
+    fail_requests(s, HTTP_SOCKET_TIMEDOUT, NULL, 0);
     removesocket(s);
     printf("Timedout\n");
   } else if(e == TCP_SOCKET_ABORTED) {
-    call_callback(s, HTTP_SOCKET_ABORTED, NULL, 0);
+    fail_requests(s, HTTP_SOCKET_ABORTED, NULL, 0);
     removesocket(s);
     printf("Aborted\n");
   } else if(e == TCP_SOCKET_DATA_SENT) {
     if(s->postdata != NULL && s->postdatalen) {
-      len = tcp_socket_send(tcps, s->postdata, s->postdatalen);
-      s->postdata += len;
-      s->postdatalen -= len;
-    } else {
-      start_timeout_timer(s);
+      send_postdata(s);
+    } else if(s->pending_len > 0) {
+      start_timeout_timer(s, HTTP_SOCKET_TIMEOUT);
     }
   }
 }
@@ -564,7 +722,7 @@ PROCESS_THREAD(http_socket_process, ev, data)
             start_request(s);
           } else {
             /* Hostname not found, kill connection. */
-            call_callback(s, HTTP_SOCKET_HOSTNAME_NOT_FOUND, NULL, 0);
+            fail_requests(s, HTTP_SOCKET_HOSTNAME_NOT_FOUND, NULL, 0);
             removesocket(s);
           }
         }
@@ -581,7 +739,7 @@ PROCESS_THREAD(http_socket_process, ev, data)
           s != NULL;
           s = list_item_next(s)) {
         if(timeout_timer == &s->timeout_timer && s->timeout_timer_started) {
-          tcp_socket_close(&s->s);
+          close_connection(s);
           break;
         }
       }
@@ -608,23 +766,80 @@ http_socket_init(struct http_socket *s)
   init();
   uip_create_unspecified(&s->proxy_addr);
   s->proxy_port = 0;
+  s->keep_alive = HTTP_SOCKET_KEEP_ALIVE;
+  s->connected = 0;
 }
 /*---------------------------------------------------------------------------*/
 static void
-initialize_socket(struct http_socket *s)
+add_pending(struct http_socket *s,
+            http_socket_callback_t callback, void *callbackptr)
+{
+  struct http_socket_request *r;
+
+  r = &s->pending[(s->pending_start + s->pending_len) % HTTP_SOCKET_PIPELINE];
+  r->callback = callback;
+  r->callbackptr = callbackptr;
+  s->pending_len++;
+  s->callback = callback;
+  s->callbackptr = callbackptr;
+}
+/*---------------------------------------------------------------------------*/
+static void
+initialize_socket(struct http_socket *s,
+                  http_socket_callback_t callback, void *callbackptr)
 {
   s->pos = 0;
   s->length = 0;
   s->postdata = NULL;
   s->postdatalen = 0;
+  s->content_type = NULL;
   s->timeout_timer_started = 0;
-  PT_INIT(&s->pt);
+  s->connected = 0;
+  s->pending_start = 0;
+  s->pending_len = 0;
+  add_pending(s, callback, callbackptr);
+  s->parse_state = PARSE_IGNORE;
   tcp_socket_register(&s->s, s,
                       s->inputbuf, sizeof(s->inputbuf),
                       s->outputbuf, sizeof(s->outputbuf),
                       input, event);
 }
 /*---------------------------------------------------------------------------*/
+/* Whether the socket has an open connection the URL can use */
+static int
+is_reusable(struct http_socket *s, const char *url)
+{
+  char host[MAX_HOSTLEN];
+  char current_host[MAX_HOSTLEN];
+  uint16_t port, current_port;
+
+  return s->keep_alive && s->connected &&
+    parse_url(url, host, &port, NULL) &&
+    parse_url(s->url, current_host, &current_port, NULL) &&
+    port == current_port && strcmp(host, current_host) == 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Sends a request on the open connection, after the ones before it */
+static int
+pipeline_request(struct http_socket *s, const char *url,
+                 http_socket_callback_t callback, void *callbackptr)
+{
+  int len;
+
+  strncpy(s->url, url, sizeof(s->url));
+  len = send_request(s, 0);
+  if(s->pending_len == HTTP_SOCKET_PIPELINE || len < 0 ||
+     len > tcp_socket_max_sendlen(&s->s)) {
+    s->postdata = NULL;
+    s->postdatalen = 0;
+    return HTTP_SOCKET_ERR;
+  }
+  add_pending(s, callback, callbackptr);
+  send_request(s, 1);
+  start_timeout_timer(s, HTTP_SOCKET_TIMEOUT);
+  return HTTP_SOCKET_OK;
+}
+/*---------------------------------------------------------------------------*/
 int
 http_socket_get(struct http_socket *s,
                 const char *url,
@@ -633,12 +848,22 @@ http_socket_get(struct http_socket *s,
                 http_socket_callback_t callback,
                 void *callbackptr)
 {
-  initialize_socket(s);
+  if(is_reusable(s, url)) {
+    if(s->postdatalen > 0) {
+      /* The previous request is still being sent */
+      return HTTP_SOCKET_ERR;
+    }
+    s->pos = pos;
+    s->length = length;
+    s->postdata = NULL;
+    s->postdatalen = 0;
+    return pipeline_request(s, url, callback, callbackptr);
+  }
+
+  initialize_socket(s, callback, callbackptr);
   strncpy(s->url, url, sizeof(s->url));
   s->pos = pos;
   s->length = length;
-  s->callback = callback;
-  s->callbackptr = callbackptr;
 
   s->did_tcp_connect = 0;
 
@@ -656,15 +881,25 @@ http_socket_post(struct http_socket *s,
                  http_socket_callback_t callback,
                  void *callbackptr)
 {
-  initialize_socket(s);
+  if(is_reusable(s, url)) {
+    if(s->postdatalen > 0) {
+      /* The previous request is still being sent */
+      return HTTP_SOCKET_ERR;
+    }
+    s->pos = 0;
+    s->length = 0;
+    s->postdata = postdata;
+    s->postdatalen = postdatalen;
+    s->content_type = content_type;
+    return pipeline_request(s, url, callback, callbackptr);
+  }
+
+  initialize_socket(s, callback, callbackptr);
   strncpy(s->url, url, sizeof(s->url));
   s->postdata = postdata;
   s->postdatalen = postdatalen;
   s->content_type = content_type;
 
-  s->callback = callback;
-  s->callbackptr = callbackptr;
-
   s->did_tcp_connect = 0;
 
   list_add(socketlist, s);
@@ -680,7 +915,7 @@ http_socket_close(struct http_socket *socket)
       s != NULL;
       s = list_item_next(s)) {
     if(s == socket) {
-      tcp_socket_close(&s->s);
+      close_connection(s);
       removesocket(s);
       return 1;
     }
@@ -696,3 +931,9 @@ http_socket_set_proxy(struct http_socket *s,
   s->proxy_port = port;
 }
 /*---------------------------------------------------------------------------*/
+void
+http_socket_set_keep_alive(struct http_socket *s, int keep_alive)
+{
+  s->keep_alive = keep_alive != 0;
+}
+/*---------------------------------------------------------------------------*/
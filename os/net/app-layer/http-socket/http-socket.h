@@ -45,6 +45,7 @@ typedef enum {
   HTTP_SOCKET_TIMEDOUT,
   HTTP_SOCKET_ABORTED,
   HTTP_SOCKET_HOSTNAME_NOT_FOUND,
+  HTTP_SOCKET_COMPLETE,
 } http_socket_event_t;
 
 struct http_socket_header {
@@ -70,6 +71,39 @@ typedef void (* http_socket_callback_t)(struct http_socket *s,
 
 #define HTTP_SOCKET_TIMEOUT       ((2 * 60 + 30) * CLOCK_SECOND)
 
+/* Keep the connection open for further requests to the same host */
+#ifdef HTTP_SOCKET_CONF_KEEP_ALIVE
+#define HTTP_SOCKET_KEEP_ALIVE HTTP_SOCKET_CONF_KEEP_ALIVE
+#else
+#define HTTP_SOCKET_KEEP_ALIVE 0
+#endif
+
+/* How long an idle kept-alive connection stays open */
+#ifdef HTTP_SOCKET_CONF_IDLE_TIMEOUT
+#define HTTP_SOCKET_IDLE_TIMEOUT HTTP_SOCKET_CONF_IDLE_TIMEOUT
+#else
+#define HTTP_SOCKET_IDLE_TIMEOUT (30 * CLOCK_SECOND)
+#endif
+
+/* Requests that may await their responses on one connection */
+#ifdef HTTP_SOCKET_CONF_PIPELINE
+#define HTTP_SOCKET_PIPELINE HTTP_SOCKET_CONF_PIPELINE
+#else
+#define HTTP_SOCKET_PIPELINE 2
+#endif
+
+/* Longest response header line kept; the rest of a line is ignored */
+#ifdef HTTP_SOCKET_CONF_LINELEN
+#define HTTP_SOCKET_LINELEN HTTP_SOCKET_CONF_LINELEN
+#else
+#define HTTP_SOCKET_LINELEN 64
+#endif
+
+struct http_socket_request {
+  http_socket_callback_t callback;
+  void *callbackptr;
+};
+
 struct http_socket {
   struct http_socket *next;
   struct tcp_socket s;
@@ -88,13 +122,23 @@ struct http_socket {
 
   struct etimer timeout_timer;
   uint8_t timeout_timer_started;
-  struct pt pt, headerpt;
-  int header_chars;
-  char header_field[15];
   struct http_socket_header header;
-  uint8_t header_received;
   uint64_t bodylen;
   const char *content_type;
+
+  /* Requests sent and awaiting their responses, oldest first */
+  struct http_socket_request pending[HTTP_SOCKET_PIPELINE];
+  uint8_t pending_start;
+  uint8_t pending_len;
+  uint8_t keep_alive;
+  uint8_t connected;
+
+  /* Response parser */
+  uint8_t parse_state;
+  uint8_t parse_flags;
+  uint8_t line_len;
+  char line[HTTP_SOCKET_LINELEN];
+  uint64_t body_left;
 };
 
 void http_socket_init(struct http_socket *s);
@@ -104,6 +148,10 @@ int http_socket_get(struct http_socket *s, const char *url,
                     http_socket_callback_t callback,
                     void *callbackptr);
 
+/*
+ * The POST data is sent from where it is, so it must stay unchanged
+ * until the response arrives.
+ */
 int http_socket_post(struct http_socket *s, const char *url,
                      const void *postdata,
                      uint16_t postdatalen,
@@ -116,5 +164,14 @@ int http_socket_close(struct http_socket *socket);
 void http_socket_set_proxy(struct http_socket *s,
                            const uip_ipaddr_t *addr, uint16_t port);
 
+/*
+ * With keep-alive, the connection stays open after a response. A
+ * request for the same host and port is then sent on it right away,
+ * also while up to HTTP_SOCKET_PIPELINE earlier responses are still
+ * outstanding. Each response ends with HTTP_SOCKET_COMPLETE, given to
+ * the callback of its request.
+ */
+void http_socket_set_keep_alive(struct http_socket *s, int keep_alive);
+
 
 #endif /* HTTP_SOCKET_H */
@@ -61,15 +61,8 @@ LIST(websocketlist);
 
 #define WEBSOCKET_MASK_BIT      0x80
 #define WEBSOCKET_LEN_MASK      0x7f
-struct websocket_frame_hdr {
-  uint8_t opcode;
-  uint8_t len;
-  uint8_t extlen[4];
-};
 
-struct websocket_frame_mask {
-  uint8_t mask[4];
-};
+#define WEBSOCKET_CONTROL_BIT   0x08
 
 /*---------------------------------------------------------------------------*/
 static int
@@ -99,20 +92,40 @@ parse_url(const char *url, char *host, uint16_t *portptr, char *path)
   }
 
   /* Find host part of the URL. */
-  for(i = 0; i < MAX_HOSTLEN; ++i) {
-    if(*urlptr == 0 ||
-       *urlptr == '/' ||
-       *urlptr == ' ' ||
-       *urlptr == ':') {
+  if(*urlptr == '[') {
+    /* Handle IPv6 addresses - scan for matching ']' */
+    urlptr++;
+    for(i = 0; i < MAX_HOSTLEN; ++i) {
+      if(*urlptr == ']' || *urlptr == 0) {
+        if(host != NULL) {
+          host[i] = 0;
+        }
+        if(*urlptr == ']') {
+          urlptr++;
+        }
+        break;
+      }
       if(host != NULL) {
-	host[i] = 0;
+        host[i] = *urlptr;
       }
-      break;
+      ++urlptr;
     }
-    if(host != NULL) {
-      host[i] = *urlptr;
+  } else {
+    for(i = 0; i < MAX_HOSTLEN; ++i) {
+      if(*urlptr == 0 ||
+         *urlptr == '/' ||
+         *urlptr == ' ' ||
+         *urlptr == ':') {
+        if(host != NULL) {
+          host[i] = 0;
+        }
+        break;
+      }
+      if(host != NULL) {
+        host[i] = *urlptr;
+      }
+      ++urlptr;
     }
-    ++urlptr;
   }
 
   /* Find the port. Default is 0, which lets the underlying transport
@@ -269,66 +282,222 @@ websocket_http_client_connected(struct websocket_http_client_state *client_state
 
   LOG_INFO("Websocket connected\n");
   s->state = WEBSOCKET_STATE_WAITING_FOR_HEADER;
+  s->msgopcode = 0;
+  s->sending_fragments = 0;
   call(s, WEBSOCKET_CONNECTED, NULL, 0);
 }
 /*---------------------------------------------------------------------------*/
-/* The websocket header may potentially be split into multiple TCP
-   segments. This function eats one byte each, puts it into
-   s->headercache, and checks whether or not the full header has been
-   received. */
 static int
-receive_header_byte(struct websocket *s, uint8_t byte)
+send_frame(struct websocket *s, uint8_t opcode,
+           const uint8_t *data, uint16_t datalen)
 {
-  int len;
-  int expected_len;
-  struct websocket_frame_hdr *hdr;
-
-  /* Take the next byte of data and place it in the header cache. */
-  if(s->state == WEBSOCKET_STATE_RECEIVING_HEADER) {
-    s->headercache[s->headercacheptr] = byte;
-    s->headercacheptr++;
-    if(s->headercacheptr >= sizeof(s->headercache)) {
-      /* Something bad happened: we ad read 10 bytes and had not yet
-         found a reasonable header, so we close the socket. */
-      websocket_close(s);
-    }
+  uint8_t hdr[8];
+  int hdrlen;
+
+  if(s->state == WEBSOCKET_STATE_CLOSED ||
+     s->state == WEBSOCKET_STATE_DNS_REQUEST_SENT ||
+     s->state == WEBSOCKET_STATE_HTTP_REQUEST_SENT) {
+    /* Trying to send data on a non-connected websocket. */
+    LOG_ERR("send fail: not connected\n");
+    return -1;
   }
 
-  len = s->headercacheptr;
-  hdr = (struct websocket_frame_hdr *)s->headercache;
+  hdr[0] = opcode;
 
-  /* Check the header that we have received to see if it is long
-     enough. */
+  /* If the datalen is larger than 125 bytes, we need to send the data
+     length as two bytes. If the data length would be larger than 64k,
+     we should send the length as 8 bytes, but since we specify the
+     datalen as an unsigned 16-bit int, we do not handle the 64k case
+     here. Data from client must always have the mask bit set. */
+  if(datalen > 125) {
+    hdr[1] = 126 | WEBSOCKET_MASK_BIT;
+    hdr[2] = datalen >> 8;
+    hdr[3] = datalen & 0xff;
+    hdrlen = 4;
+  } else {
+    hdr[1] = datalen | WEBSOCKET_MASK_BIT;
+    hdrlen = 2;
+  }
+
+  /* The data mask follows the header. A mask of zero leaves the data
+     as it is, so the data goes to the output buffer without being
+     copied anywhere else first. */
+  memset(&hdr[hdrlen], 0, 4);
+  hdrlen += 4;
+
+  if(hdrlen + datalen > websocket_http_client_sendbuflen(&s->s)) {
+    LOG_ERR("too few bytes left (%d left, %d needed)\n",
+           websocket_http_client_sendbuflen(&s->s),
+           hdrlen + datalen);
+    return -1;
+  }
+
+  websocket_http_client_send(&s->s, hdr, hdrlen);
+  if(datalen > 0) {
+    websocket_http_client_send(&s->s, data, datalen);
+  }
+  return hdrlen + datalen;
+}
+/*---------------------------------------------------------------------------*/
+static int
+header_len(const uint8_t *hdr)
+{
+  int len = 2;
+
+  /* The length byte determines how many length bytes are included in
+     the header. If the option has the mask bit set, we should expect
+     to see 4 mask bytes at the end of the header. */
+  if((hdr[1] & WEBSOCKET_LEN_MASK) == 126) {
+    len += 2;
+  } else if((hdr[1] & WEBSOCKET_LEN_MASK) == 127) {
+    len += 8;
+  }
+  if((hdr[1] & WEBSOCKET_MASK_BIT) != 0) {
+    len += 4;
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+/* The websocket header may potentially be split into multiple TCP
+   segments. This function takes the bytes still missing from the
+   header into s->headercache, and returns how many it took. */
+static int
+receive_header(struct websocket *s, const uint8_t *data, uint16_t datalen)
+{
+  int expected_len;
+  int len, n = 0;
 
   /* We start with expecting a length of at least two bytes (opcode +
      1 length byte). */
   expected_len = 2;
+  if(s->headercacheptr >= 2) {
+    expected_len = header_len(s->headercache);
+  }
 
-  if(len >= expected_len) {
-
-    /* We check how many more bytes we should expect to see. The
-       length byte determines how many length bytes are included in
-       the header. */
-    if((hdr->len & WEBSOCKET_LEN_MASK) == 126) {
-      expected_len += 2;
-    } else if((hdr->len & WEBSOCKET_LEN_MASK) == 127) {
-      expected_len += 4;
+  while(n < datalen && s->headercacheptr < expected_len) {
+    len = MIN(expected_len - s->headercacheptr, datalen - n);
+    memcpy(&s->headercache[s->headercacheptr], &data[n], len);
+    s->headercacheptr += len;
+    n += len;
+    if(s->headercacheptr == 2) {
+      expected_len = header_len(s->headercache);
     }
+  }
+
+  if(s->headercacheptr == expected_len) {
+    s->state = WEBSOCKET_STATE_HEADER_RECEIVED;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static void
+end_frame(struct websocket *s)
+{
+  s->state = WEBSOCKET_STATE_WAITING_FOR_HEADER;
+
+  if(s->opcode == WEBSOCKET_OPCODE_PING) {
+    /* If the opcode is ping, we send the data back in a pong. */
+    send_frame(s, WEBSOCKET_FIN_BIT | WEBSOCKET_OPCODE_PONG,
+               s->control, s->controllen);
+    LOG_INFO("Got ping\n");
+    call(s, WEBSOCKET_PINGED, NULL, 0);
+  } else if(s->opcode == WEBSOCKET_OPCODE_PONG) {
+    /* If the opcode is pong, we call the application to let it
+       know we got a pong. */
+    LOG_INFO("Got pong\n");
+    call(s, WEBSOCKET_PONG_RECEIVED, NULL, 0);
+  } else if(s->opcode == WEBSOCKET_OPCODE_CLOSE) {
+    /* If the opcode is a close, we send a close frame back, with the
+       status code from the server. */
+    send_frame(s, WEBSOCKET_FIN_BIT | WEBSOCKET_OPCODE_CLOSE,
+               s->control, MIN(s->controllen, 2));
+    LOG_INFO("Got close, sending close\n");
+    websocket_http_client_close(&s->s);
+  } else if((s->headercache[0] & WEBSOCKET_FIN_BIT) != 0) {
+    /* The last frame of a message */
+    s->msgopcode = 0;
+    call(s, WEBSOCKET_DATA_RECEIVED, NULL, s->msglen);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+start_frame(struct websocket *s)
+{
+  const uint8_t *hdr = s->headercache;
+  const uint8_t *maskptr;
+
+  /* We first read out the length of the application data chunk. The
+     s->left field holds the length that we are about to receive. If
+     the length is >= 126 bytes, it is encoded in two or eight more
+     bytes, of which we use the lowest four. The mask follows the
+     length. */
+  if((hdr[1] & WEBSOCKET_LEN_MASK) < 126) {
+    s->len = hdr[1] & WEBSOCKET_LEN_MASK;
+    maskptr = &hdr[2];
+  } else if((hdr[1] & WEBSOCKET_LEN_MASK) == 126) {
+    s->len = ((uint32_t)hdr[2] << 8) + hdr[3];
+    maskptr = &hdr[4];
+  } else {
+    s->len = ((uint32_t)hdr[6] << 24) + ((uint32_t)hdr[7] << 16) +
+      ((uint32_t)hdr[8] << 8) + hdr[9];
+    maskptr = &hdr[10];
+  }
+  s->left = s->len;
 
-    /* If the option has the mask bit set, we should expect to see 4
-       mask bytes at the end of the header. */
-    if((hdr->len & WEBSOCKET_MASK_BIT ) != 0) {
-      expected_len += 4;
+  if((hdr[1] & WEBSOCKET_MASK_BIT) == 0) {
+    memset(s->mask, 0, sizeof(s->mask));
+  } else {
+    memcpy(s->mask, maskptr, sizeof(s->mask));
+  }
+
+  /* Remember the opcode of the application chunk, put it in the
+   * s->opcode field. Continuation frames belong to the message that
+   * the last text or binary frame started; control frames may come
+   * in between. */
+  s->opcode = hdr[0] & WEBSOCKET_OPCODE_MASK;
+  if(s->opcode & WEBSOCKET_CONTROL_BIT) {
+    s->controllen = 0;
+  } else if(s->opcode == WEBSOCKET_OPCODE_CONT) {
+    if(s->msgopcode == 0) {
+      LOG_WARN("continuation without a message, closing\n");
+      websocket_close(s);
+      return;
     }
+  } else {
+    s->msgopcode = s->opcode;
+    s->msglen = 0;
+  }
 
-    /* Now we know how long our header if expected to be. If it is
-       this long, we are done and we set the state to reflect this. */
-    if(len == expected_len) {
-      s->state = WEBSOCKET_STATE_HEADER_RECEIVED;
-      return 1;
+  s->state = WEBSOCKET_STATE_RECEIVING_DATA;
+  if(s->left == 0) {
+    end_frame(s);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+receive_data(struct websocket *s, uint8_t *data, uint16_t datalen)
+{
+  uint32_t pos;
+  uint16_t i;
+
+  /* Unmask the data where it is. */
+  if(s->mask[0] | s->mask[1] | s->mask[2] | s->mask[3]) {
+    pos = s->len - s->left;
+    for(i = 0; i < datalen; i++) {
+      data[i] ^= s->mask[(pos + i) & 3];
     }
   }
-  return 0;
+
+  if(s->opcode & WEBSOCKET_CONTROL_BIT) {
+    i = MIN(datalen, sizeof(s->control) - s->controllen);
+    memcpy(&s->control[s->controllen], data, i);
+    s->controllen += i;
+  } else {
+    /* If data arrives in multiple packets, it is up to the
+       application to put it back together again. */
+    s->msglen += datalen;
+    call(s, WEBSOCKET_DATA, data, datalen);
+  }
 }
 /*---------------------------------------------------------------------------*/
 /* Callback function. Called from the webclient module when HTTP data
@@ -340,175 +509,48 @@ websocket_http_client_datahandler(struct websocket_http_client_state *client_sta
 {
   struct websocket *s = (struct websocket *)
     ((char *)client_state - offsetof(struct websocket, s));
-  struct websocket_frame_hdr *hdr;
-  struct websocket_frame_mask *maskptr;
+  uint16_t len;
 
   if(data == NULL) {
     call(s, WEBSOCKET_CLOSED, NULL, 0);
-  } else {
-    /* This function is a state machine that does different things
-       depending on the state. If we are waiting for header (the
-       default state), we change to the RECEIVING_HEADER state when we
-       get the first byte. If we are receiving header, we put all
-       bytes we have into a header buffer until the full header has
-       been received. If we have received the header, we parse it. If
-       we have received and parsed the header, we are ready to receive
-       data. Finally, if there is data left in the incoming packet, we
-       repeat the process. */
+    return;
+  }
 
+  /* This is a state machine that does different things depending on
+     the state. If we are waiting for header (the default state), we
+     change to the RECEIVING_HEADER state. If we are receiving header,
+     we put the bytes it needs into a header buffer until the full
+     header has been received, and then parse it. If we have received
+     and parsed the header, we are ready to receive data. Finally, if
+     there is data left in the incoming packet, we repeat the
+     process. */
+  while(datalen > 0 &&
+        s->state != WEBSOCKET_STATE_CLOSED) {
     if(s->state == WEBSOCKET_STATE_WAITING_FOR_HEADER) {
       s->state = WEBSOCKET_STATE_RECEIVING_HEADER;
       s->headercacheptr = 0;
     }
 
     if(s->state == WEBSOCKET_STATE_RECEIVING_HEADER) {
-      while(datalen > 0 && s->state == WEBSOCKET_STATE_RECEIVING_HEADER) {
-        receive_header_byte(s, data[0]);
-        data++;
-        datalen--;
-      }
-    }
-
-    if(s->state == WEBSOCKET_STATE_HEADER_RECEIVED) {
-      /* If this is the start of an incoming websocket data frame, we
-         decode the header and check if we should act on in. If not, we
-         pipe the data to the application through a callback handler. If
-         data arrives in multiple packets, it is up to the application to
-         put it back together again. */
-
-      /* The websocket header is at the start of the incoming data. */
-      hdr = (struct websocket_frame_hdr *)s->headercache;
-
-      /* The s->left field holds the length of the application data
-       * chunk that we are about to receive. */
-      s->len = s->left = 0;
-
-      /* The s->mask field holds the bitmask of the data chunk, if
-       * any. */
-      memset(s->mask, 0, sizeof(s->mask));
-
-      /* We first read out the length of the application data
-         chunk. The length may be encoded over multiple bytes. If the
-         length is >= 126 bytes, it is encoded as two or more
-         bytes. The first length field determines if it is in 2 or 4
-         bytes. We also keep track of where the bitmask is held - its
-         place also differs depending on how the length is encoded.  */
-      maskptr = (struct websocket_frame_mask *)hdr->extlen;
-      if((hdr->len & WEBSOCKET_LEN_MASK) < 126) {
-        s->len = s->left = hdr->len & WEBSOCKET_LEN_MASK;
-      } else if(hdr->len == 126) {
-        s->len = s->left = (hdr->extlen[0] << 8) + hdr->extlen[1];
-        maskptr = (struct websocket_frame_mask *)&hdr->extlen[2];
-      } else if(hdr->len == 127) {
-        s->len = s->left = ((uint32_t)hdr->extlen[0] << 24) +
-          ((uint32_t)hdr->extlen[1] << 16) +
-          ((uint32_t)hdr->extlen[2] << 8) +
-          hdr->extlen[3];
-        maskptr = (struct websocket_frame_mask *)&hdr->extlen[4];
-      }
-
-      /* Set user_data to point to the first byte of application data.
-         See if the application data chunk is masked or not. If it is,
-         we copy the bitmask into the s->mask field. */
-      if((hdr->len & WEBSOCKET_MASK_BIT) == 0) {
-        /*        LOG_INFO("No mask\n");*/
-      } else {
-        memcpy(s->mask, &maskptr->mask, sizeof(s->mask));
-        /*        LOG_INFO("There was a mask, %02x %02x %02x %02x\n",
-                  s->mask[0], s->mask[1], s->mask[2], s->mask[3]);*/
-      }
-
-      /* Remember the opcode of the application chunk, put it in the
-       * s->opcode field. */
-      s->opcode = hdr->opcode & WEBSOCKET_OPCODE_MASK;
-
-      if(s->opcode == WEBSOCKET_OPCODE_PING) {
-        /* If the opcode is ping, we change the opcode to a pong, and
-         * send the data back. */
-        hdr->opcode = (hdr->opcode & (~WEBSOCKET_OPCODE_MASK)) |
-          WEBSOCKET_OPCODE_PONG;
-        websocket_http_client_send(&s->s, (const uint8_t*)hdr, 2);
-        if(s->left > 0) {
-          websocket_http_client_send(&s->s, (const uint8_t*)data, s->left);
-        }
-        LOG_INFO("Got ping\n");
-        call(s, WEBSOCKET_PINGED, NULL, 0);
-        s->state = WEBSOCKET_STATE_WAITING_FOR_HEADER;
-      } else if(s->opcode == WEBSOCKET_OPCODE_PONG) {
-          /* If the opcode is pong, we call the application to let it
-           know we got a pong. */
-        LOG_INFO("Got pong\n");
-        call(s, WEBSOCKET_PONG_RECEIVED, NULL, 0);
-        s->state = WEBSOCKET_STATE_WAITING_FOR_HEADER;
-      } else if(s->opcode == WEBSOCKET_OPCODE_CLOSE) {
-        /* If the opcode is a close, we send a close frame back. */
-        hdr->opcode = (hdr->opcode & (~WEBSOCKET_OPCODE_MASK)) |
-          WEBSOCKET_OPCODE_CLOSE;
-        websocket_http_client_send(&s->s, (const uint8_t*)hdr, 2);
-        if(s->left > 0) {
-          websocket_http_client_send(&s->s, (const uint8_t*)data, s->left);
-        }
-        LOG_INFO("Got close, sending close\n");
-        s->state = WEBSOCKET_STATE_WAITING_FOR_HEADER;
-        websocket_http_client_close(&s->s);
-      } else if(s->opcode == WEBSOCKET_OPCODE_BIN ||
-                s->opcode == WEBSOCKET_OPCODE_TEXT) {
-
-        /* If the opcode is bin or text, and there is application
-         * layer data in the packet, we call the application to
-         * process it. */
-        if(s->left > 0) {
-          s->state = WEBSOCKET_STATE_RECEIVING_DATA;
-          if(datalen > 0) {
-            int len;
-
-            len = MIN(s->left, datalen);
-            /* XXX todo: mask if needed. */
-            call(s, WEBSOCKET_DATA, data, len);
-            data += len;
-            s->left -= len;
-            datalen -= len;
-          }
-        }
-      }
-
-      if(s->left == 0) {
-        call(s, WEBSOCKET_DATA_RECEIVED, NULL, s->len);
-        s->state = WEBSOCKET_STATE_WAITING_FOR_HEADER;
-
-        /* Need to keep parsing the incoming data to check for more
-           frames, if the incoming datalen is > than s->left. */
-        if(datalen > 0) {
-          websocket_http_client_datahandler(client_state,
-                                            data, datalen);
-        }
+      len = receive_header(s, data, datalen);
+      data += len;
+      datalen -= len;
+      if(s->state == WEBSOCKET_STATE_HEADER_RECEIVED) {
+        start_frame(s);
       }
     } else if(s->state == WEBSOCKET_STATE_RECEIVING_DATA) {
-      /* XXX todo: mask if needed. */
-      if(datalen > 0) {
-        if(datalen < s->left) {
-          call(s, WEBSOCKET_DATA, data, datalen);
-          s->left -= datalen;
-          data += datalen;
-          datalen = 0;
-        } else {
-          call(s, WEBSOCKET_DATA, data, s->left);
-          data += s->left;
-          datalen -= s->left;
-          s->left = 0;
-        }
-      }
+      len = MIN(s->left, datalen);
+      /* The data is in the input buffer of the client, and is
+         unmasked in place. */
+      receive_data(s, (uint8_t *)data, len);
+      data += len;
+      datalen -= len;
+      s->left -= len;
       if(s->left == 0) {
-        call(s, WEBSOCKET_DATA_RECEIVED, NULL, s->len);
-        s->state = WEBSOCKET_STATE_WAITING_FOR_HEADER;
-        /* Need to keep parsing the incoming data to check for more
-           frames, if the incoming datalen is > than len. */
-        if(datalen > 0) {
-          websocket_http_client_datahandler(client_state,
-                                            data, datalen);
-
-        }
+        end_frame(s);
       }
+    } else {
+      break;
     }
   }
 }
@@ -599,73 +641,42 @@ static int
 send_data(struct websocket *s, const void *data,
           uint16_t datalen, uint8_t data_type_opcode)
 {
-  uint8_t buf[WEBSOCKET_MAX_MSGLEN + 4 + 4]; /* The extra + 4 + 4 here
-                                                comes from the size of
-                                                the websocket framing
-                                                header. */
-  struct websocket_frame_hdr *hdr;
-  struct websocket_frame_mask *mask;
+  const uint8_t *dataptr = data;
+  uint16_t frames, len;
+  int ret, sent = 0;
 
   LOG_INFO("send data len %d %.*s\n", datalen, datalen, (char *)data);
-  if(s->state == WEBSOCKET_STATE_CLOSED ||
-     s->state == WEBSOCKET_STATE_DNS_REQUEST_SENT ||
-     s->state == WEBSOCKET_STATE_HTTP_REQUEST_SENT) {
-    /* Trying to send data on a non-connected websocket. */
-    LOG_ERR("send fail: not connected\n");
+  if(s->sending_fragments) {
+    LOG_ERR("send fail: a fragmented message is being sent\n");
     return -1;
   }
 
-  /* We need to have 4 + 4 additional bytes for the websocket framing
-     header. */
-  if(4 + 4 + datalen > websocket_http_client_sendbuflen(&s->s)) {
+  /* Messages longer than WEBSOCKET_MAX_MSGLEN are sent as several
+     frames. All of them must fit in the output buffer, with 4 + 4
+     bytes of framing header each. */
+  frames = datalen > WEBSOCKET_MAX_MSGLEN ?
+    (datalen + WEBSOCKET_MAX_MSGLEN - 1) / WEBSOCKET_MAX_MSGLEN : 1;
+  if(frames * (4 + 4) + datalen > websocket_http_client_sendbuflen(&s->s)) {
     LOG_ERR("too few bytes left (%d left, %d needed)\n",
            websocket_http_client_sendbuflen(&s->s),
-           4 + 4 + datalen);
+           frames * (4 + 4) + datalen);
     return -1;
   }
 
-  if(datalen > sizeof(buf) - 4 - 4) {
-    LOG_ERR("trying to send too large data chunk %d > %d\n",
-           datalen, (int)sizeof(buf) - 4 - 4);
-    return -1;
-  }
-
-  hdr = (struct websocket_frame_hdr *)&buf[0];
-  hdr->opcode = WEBSOCKET_FIN_BIT | data_type_opcode;
+  do {
+    len = MIN(datalen, WEBSOCKET_MAX_MSGLEN);
+    ret = send_frame(s, (sent == 0 ? data_type_opcode : WEBSOCKET_OPCODE_CONT) |
+                     (len == datalen ? WEBSOCKET_FIN_BIT : 0),
+                     dataptr, len);
+    if(ret < 0) {
+      return -1;
+    }
+    sent += ret;
+    dataptr += len;
+    datalen -= len;
+  } while(datalen > 0);
 
-  /* If the datalen is larger than 125 bytes, we need to send the data
-     length as two bytes. If the data length would be larger than 64k,
-     we should send the length as 4 bytes, but since we specify the
-     datalen as an unsigned 16-bit int, we do not handle the 64k case
-     here. */
-  if(datalen > 125) {
-    /* Data from client must always have the mask bit set, and a data
-       mask sent right after the header. */
-    hdr->len = 126 | WEBSOCKET_MASK_BIT;
-    hdr->extlen[0] = datalen >> 8;
-    hdr->extlen[1] = datalen & 0xff;
-
-    mask = (struct websocket_frame_mask *)&buf[4];
-    mask->mask[0] =
-      mask->mask[1] =
-      mask->mask[2] =
-      mask->mask[3] = 0;
-    memcpy(&buf[8], data, datalen);
-    return websocket_http_client_send(&s->s, buf, 8 + datalen);
-  } else {
-    /* Data from client must always have the mask bit set, and a data
-       mask sent right after the header. */
-    hdr->len = datalen | WEBSOCKET_MASK_BIT;
-
-    mask = (struct websocket_frame_mask *)&buf[2];
-    mask->mask[0] =
-      mask->mask[1] =
-      mask->mask[2] =
-      mask->mask[3] = 0;
-    memcpy(&buf[6], data, datalen);
-    return websocket_http_client_send(&s->s, buf, 6 + datalen);
-  }
-  return -1;
+  return sent;
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -682,34 +693,35 @@ websocket_send(struct websocket *s, const uint8_t *data,
 }
 /*---------------------------------------------------------------------------*/
 int
+websocket_send_fragment(struct websocket *s,
+                        const uint8_t *data, uint16_t datalen,
+                        int text, int last)
+{
+  uint8_t opcode;
+  int ret;
+
+  if(s->sending_fragments) {
+    opcode = WEBSOCKET_OPCODE_CONT;
+  } else {
+    opcode = text ? WEBSOCKET_OPCODE_TEXT : WEBSOCKET_OPCODE_BIN;
+  }
+  if(last) {
+    opcode |= WEBSOCKET_FIN_BIT;
+  }
+
+  ret = send_frame(s, opcode, data, datalen);
+  if(ret >= 0) {
+    s->sending_fragments = !last;
+  }
+  return ret;
+}
+/*---------------------------------------------------------------------------*/
+int
 websocket_ping(struct websocket *s)
 {
-  uint8_t buf[sizeof(struct websocket_frame_hdr) +
-              sizeof(struct websocket_frame_mask)];
-  struct websocket_frame_hdr *hdr;
-  struct websocket_frame_mask *mask;
-
-  /* We need 2 + 4 additional bytes for the websocket framing
-     header. */
-  if(2 + 4 > websocket_http_client_sendbuflen(&s->s)) {
+  if(send_frame(s, WEBSOCKET_FIN_BIT | WEBSOCKET_OPCODE_PING, NULL, 0) < 0) {
     return -1;
   }
-
-  hdr = (struct websocket_frame_hdr *)&buf[0];
-  mask = (struct websocket_frame_mask *)&buf[2];
-  hdr->opcode = WEBSOCKET_FIN_BIT | WEBSOCKET_OPCODE_PING;
-
-  /* Data from client must always have the mask bit set, and a data
-     mask sent right after the header. */
-  hdr->len = 0 | WEBSOCKET_MASK_BIT;
-
-  /* XXX: We just set a dummy mask of 0 for now and hope that this
-     works. */
-  mask->mask[0] =
-    mask->mask[1] =
-    mask->mask[2] =
-    mask->mask[3] = 0;
-  websocket_http_client_send(&s->s, buf, 2 + 4);
   return 1;
 }
 /*---------------------------------------------------------------------------*/
@@ -54,12 +54,20 @@ typedef void (* websocket_callback)(struct websocket *s,
 				    websocket_result_t result,
 				    const uint8_t *data,
 				    uint16_t datalen);
+/* Longer messages are sent as fragments of this size */
 #ifdef WEBSOCKET_CONF_MAX_MSGLEN
 #define WEBSOCKET_MAX_MSGLEN WEBSOCKET_CONF_MAX_MSGLEN
 #else /* WEBSOCKET_CONF_MAX_MSGLEN */
 #define WEBSOCKET_MAX_MSGLEN 200
 #endif /* WEBSOCKET_CONF_MAX_MSGLEN */
 
+/* Ping and close payload kept for the reply; the rest is dropped */
+#ifdef WEBSOCKET_CONF_MAX_CONTROLLEN
+#define WEBSOCKET_MAX_CONTROLLEN WEBSOCKET_CONF_MAX_CONTROLLEN
+#else /* WEBSOCKET_CONF_MAX_CONTROLLEN */
+#define WEBSOCKET_MAX_CONTROLLEN 16
+#endif /* WEBSOCKET_CONF_MAX_CONTROLLEN */
+
 struct websocket {
   struct websocket *next;     /* Must be first. */
   struct websocket_http_client_state s;
@@ -71,9 +79,19 @@ struct websocket {
 
   uint8_t state;
 
+  /* The data message being received, which may span several frames */
+  uint8_t msgopcode;
+  uint32_t msglen;
+
+  /* A message is being sent with websocket_send_fragment() */
+  uint8_t sending_fragments;
+
+  uint8_t controllen;
+  uint8_t control[WEBSOCKET_MAX_CONTROLLEN];
+
   uint8_t headercacheptr;
-  uint8_t headercache[10]; /* The maximum websocket header + mask is 6
-                              + 4 bytes long */
+  uint8_t headercache[14]; /* The maximum websocket header + mask is
+                              2 + 8 + 4 bytes long */
 };
 
 enum {
@@ -104,6 +122,16 @@ int websocket_send(struct websocket *s,
 int websocket_send_str(struct websocket *s,
                        const char *strptr);
 
+/*
+ * Sends a part of a message, which can then be larger than the output
+ * buffer. The first part decides whether the message is text. The
+ * message ends with the part for which last is set, and no other
+ * message can be sent until then.
+ */
+int websocket_send_fragment(struct websocket *s,
+                            const uint8_t *data, uint16_t datalen,
+                            int text, int last);
+
 void websocket_close(struct websocket *s);
 
 int websocket_ping(struct websocket *s);
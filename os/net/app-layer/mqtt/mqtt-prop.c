@@ -335,12 +335,9 @@ decode_prop_fixed_len_int(struct mqtt_connection *conn,
 
   data_out = (uint32_t *)data;
 
-  for(i = 0; i < 4; i++) {
-    *data_out = *data_out << 8;
-
-    if(i < len) {
-      *data_out += buf_in[i];
-    }
+  /* Big-endian on the wire, host order in the returned uint32_t */
+  for(i = 0; i < len; i++) {
+    *data_out = (*data_out << 8) | buf_in[i];
   }
 
   return len;
@@ -535,33 +532,41 @@ mqtt_prop_parse_connack_props(struct mqtt_connection *conn)
   while(prop_len) {
     switch(prop_id) {
     case MQTT_VHDR_PROP_RETAIN_AVAIL: {
-      val_int = (uint32_t)*data;
+      memcpy(&val_int, data, sizeof(val_int));
       if(val_int == 0) {
         conn->srv_feature_en &= ~MQTT_CAP_RETAIN_AVAIL;
       }
       break;
     }
     case MQTT_VHDR_PROP_WILD_SUB_AVAIL: {
-      val_int = (uint32_t)*data;
+      memcpy(&val_int, data, sizeof(val_int));
       if(val_int == 0) {
         conn->srv_feature_en &= ~MQTT_CAP_WILD_SUB_AVAIL;
       }
       break;
     }
     case MQTT_VHDR_PROP_SUB_ID_AVAIL: {
-      val_int = (uint32_t)*data;
+      memcpy(&val_int, data, sizeof(val_int));
       if(val_int == 0) {
         conn->srv_feature_en &= ~MQTT_CAP_SUB_ID_AVAIL;
       }
       break;
     }
     case MQTT_VHDR_PROP_SHARED_SUB_AVAIL:  {
-      val_int = (uint32_t)*data;
+      memcpy(&val_int, data, sizeof(val_int));
       if(val_int == 0) {
         conn->srv_feature_en &= ~MQTT_CAP_SHARED_SUB_AVAIL;
       }
       break;
     }
+    case MQTT_VHDR_PROP_RECEIVE_MAX: {
+      /* Never keep more QoS > 0 packets in flight than the server accepts */
+      memcpy(&val_int, data, sizeof(val_int));
+      if(val_int > 0 && val_int < conn->inflight_max) {
+        conn->inflight_max = val_int;
+      }
+      break;
+    }
     default:
       DBG("MQTT - Error, unexpected CONNACK property '%i'", prop_id);
       return;
@@ -632,7 +637,7 @@ mqtt_prop_print_input_props(struct mqtt_connection *conn)
     case MQTT_VHDR_PROP_RECEIVE_MAX:
     case MQTT_VHDR_PROP_TOPIC_ALIAS_MAX:
     case MQTT_VHDR_PROP_SUB_ID: {
-      DBG("MQTT - Decoded property value '%i'\n", (uint32_t)*data);
+      DBG("MQTT - Decoded property value '%i'\n", *(uint32_t *)data);
       break;
     }
     case MQTT_VHDR_PROP_CONTENT_TYPE:
@@ -166,6 +166,11 @@ typedef enum {
 #define RESPONSE_WAIT_TIMEOUT (CLOCK_SECOND * 10)
 /*---------------------------------------------------------------------------*/
 #define INCREMENT_MID(conn)   (conn)->mid_counter += 2
+#define OUT_QUEUE_INDEX(conn, i) \
+  (((conn)->out_queue_head + (i)) % MQTT_OUT_QUEUE_SIZE)
+#define IN_PACKET_LENGTH(conn) (MQTT_FHDR_SIZE +                             \
+                                (conn)->in_packet.remaining_length_bytes +    \
+                                (conn)->in_packet.remaining_length)
 #define MQTT_STRING_LENGTH(s) (((s)->length) == 0 ? 0 : (MQTT_STRING_LEN_SIZE + (s)->length))
 /*---------------------------------------------------------------------------*/
 /* Protothread send macros */
@@ -206,9 +211,7 @@ typedef enum {
 static process_event_t mqtt_do_connect_tcp_event;
 static process_event_t mqtt_do_connect_mqtt_event;
 static process_event_t mqtt_do_disconnect_mqtt_event;
-static process_event_t mqtt_do_subscribe_event;
-static process_event_t mqtt_do_unsubscribe_event;
-static process_event_t mqtt_do_publish_event;
+static process_event_t mqtt_do_send_event;
 static process_event_t mqtt_do_pingreq_event;
 static process_event_t mqtt_continue_send_event;
 static process_event_t mqtt_abort_now_event;
@@ -232,6 +235,7 @@ static void tcp_event(struct tcp_socket *s, void *ptr,
                       tcp_socket_event_t event);
 
 static void reset_packet(struct mqtt_in_packet *packet);
+static void set_ack_timer(struct mqtt_connection *conn);
 /*---------------------------------------------------------------------------*/
 LIST(mqtt_conn_list);
 /*---------------------------------------------------------------------------*/
@@ -255,6 +259,7 @@ reset_defaults(struct mqtt_connection *conn)
 
   reset_packet(&conn->in_packet);
   conn->out_buffer_sent = 0;
+  conn->inflight_max = MQTT_MAX_INFLIGHT;
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -263,8 +268,13 @@ abort_connection(struct mqtt_connection *conn)
   conn->out_buffer_ptr = conn->out_buffer;
   conn->out_queue_full = 0;
 
-  /* Reset outgoing packet */
+  /* Reset outgoing packet and drop queued requests */
   memset(&conn->out_packet, 0, sizeof(conn->out_packet));
+  conn->out_queue_head = 0;
+  conn->out_queue_len = 0;
+  conn->out_queue_sent = 0;
+  conn->inflight = 0;
+  ctimer_stop(&conn->ack_timer);
 
   tcp_socket_close(&conn->socket);
   tcp_socket_unregister(&conn->socket);
@@ -313,8 +323,12 @@ send_out_buffer(struct mqtt_connection *conn)
   DBG("MQTT - (send_out_buffer) Space used in buffer: %i\n",
       conn->out_buffer_ptr - conn->out_buffer);
 
-  tcp_socket_send(&conn->socket, conn->out_buffer,
-                  conn->out_buffer_ptr - conn->out_buffer);
+  /* The buffer is only reused once all of it has been acknowledged */
+  if(tcp_socket_send_ref(&conn->socket, conn->out_buffer,
+                         conn->out_buffer_ptr - conn->out_buffer) <= 0) {
+    tcp_socket_send(&conn->socket, conn->out_buffer,
+                    conn->out_buffer_ptr - conn->out_buffer);
+  }
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -461,6 +475,147 @@ reset_packet(struct mqtt_in_packet *packet)
   memset(packet, 0, sizeof(struct mqtt_in_packet));
 }
 /*---------------------------------------------------------------------------*/
+static struct mqtt_out_packet *
+queue_out_packet(struct mqtt_connection *conn, uint8_t type)
+{
+  struct mqtt_out_packet *packet;
+
+  if(conn->out_queue_len >= MQTT_OUT_QUEUE_SIZE) {
+    return NULL;
+  }
+
+  packet = &conn->out_queue[OUT_QUEUE_INDEX(conn, conn->out_queue_len)];
+  memset(packet, 0, sizeof(struct mqtt_out_packet));
+  packet->fhdr = type;
+  packet->qos_state = MQTT_QOS_STATE_NO_ACK;
+
+  conn->out_queue_len++;
+  conn->out_queue_full = conn->out_queue_len >= MQTT_OUT_QUEUE_SIZE;
+
+  /* Nothing else waiting to be sent: start sending */
+  if(conn->out_queue_len - conn->out_queue_sent == 1) {
+    process_post(&mqtt_process, mqtt_do_send_event, conn);
+  }
+
+  return packet;
+}
+/*---------------------------------------------------------------------------*/
+static void
+reclaim_out_queue(struct mqtt_connection *conn)
+{
+  /* Completed requests are reclaimed in order, oldest first */
+  while(conn->out_queue_sent > 0 &&
+        conn->out_queue[conn->out_queue_head].qos_state ==
+        MQTT_QOS_STATE_GOT_ACK) {
+    conn->out_queue_head = OUT_QUEUE_INDEX(conn, 1);
+    conn->out_queue_len--;
+    conn->out_queue_sent--;
+  }
+  conn->out_queue_full = conn->out_queue_len >= MQTT_OUT_QUEUE_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static int
+out_packet_needs_ack(const struct mqtt_out_packet *packet)
+{
+  return (packet->fhdr & 0xF0) != MQTT_FHDR_MSG_TYPE_PUBLISH ||
+         packet->qos > MQTT_QOS_LEVEL_0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+ack_timeout_callback(void *ptr)
+{
+  struct mqtt_connection *conn = ptr;
+  struct mqtt_out_packet *packet;
+  uint8_t i;
+
+  for(i = 0; i < conn->out_queue_sent; i++) {
+    packet = &conn->out_queue[OUT_QUEUE_INDEX(conn, i)];
+    if(packet->qos_state == MQTT_QOS_STATE_NO_ACK &&
+       clock_time() - packet->sent_time >= RESPONSE_WAIT_TIMEOUT) {
+      DBG("MQTT - Timeout waiting for ACK of MID %u\n", packet->mid);
+      packet->qos_state = MQTT_QOS_STATE_GOT_ACK;
+      conn->inflight--;
+    }
+  }
+  reclaim_out_queue(conn);
+  set_ack_timer(conn);
+
+  if(conn->out_queue_sent < conn->out_queue_len) {
+    process_post(&mqtt_process, mqtt_do_send_event, conn);
+  }
+  process_post(conn->app_process, mqtt_update_event, NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_ack_timer(struct mqtt_connection *conn)
+{
+  struct mqtt_out_packet *packet;
+  clock_time_t elapsed;
+  uint8_t i;
+
+  /* Requests are sent in order, so the oldest one waiting expires first */
+  for(i = 0; i < conn->out_queue_sent; i++) {
+    packet = &conn->out_queue[OUT_QUEUE_INDEX(conn, i)];
+    if(packet->qos_state == MQTT_QOS_STATE_NO_ACK) {
+      elapsed = clock_time() - packet->sent_time;
+      ctimer_set(&conn->ack_timer,
+                 elapsed < RESPONSE_WAIT_TIMEOUT ?
+                 RESPONSE_WAIT_TIMEOUT - elapsed : 0,
+                 ack_timeout_callback, conn);
+      return;
+    }
+  }
+  ctimer_stop(&conn->ack_timer);
+}
+/*---------------------------------------------------------------------------*/
+static void
+out_packet_written(struct mqtt_connection *conn)
+{
+  struct mqtt_out_packet *packet;
+
+  packet = &conn->out_queue[OUT_QUEUE_INDEX(conn, conn->out_queue_sent)];
+  conn->out_queue_sent++;
+
+  if(conn->out_packet.remaining_length_enc_bytes > 4 ||
+     !out_packet_needs_ack(packet)) {
+    /* Dropped on error, or a QoS 0 PUBLISH that is complete once written */
+    packet->qos_state = MQTT_QOS_STATE_GOT_ACK;
+    reclaim_out_queue(conn);
+    process_post(conn->app_process, mqtt_update_event, NULL);
+    return;
+  }
+
+  packet->sent_time = clock_time();
+  if(++conn->inflight == 1) {
+    set_ack_timer(conn);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+ack_out_packet(struct mqtt_connection *conn, uint8_t type, uint16_t mid)
+{
+  struct mqtt_out_packet *packet;
+  uint8_t i;
+
+  for(i = 0; i < conn->out_queue_sent; i++) {
+    packet = &conn->out_queue[OUT_QUEUE_INDEX(conn, i)];
+    if(packet->qos_state == MQTT_QOS_STATE_NO_ACK &&
+       (packet->fhdr & 0xF0) == type && packet->mid == mid) {
+      packet->qos_state = MQTT_QOS_STATE_GOT_ACK;
+      conn->inflight--;
+      reclaim_out_queue(conn);
+      set_ack_timer(conn);
+
+      /* The in-flight window has moved */
+      if(conn->out_queue_sent < conn->out_queue_len) {
+        process_post(&mqtt_process, mqtt_do_send_event, conn);
+      }
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
 #if MQTT_5
 static
 PT_THREAD(write_out_props(struct pt *pt, struct mqtt_connection *conn,
@@ -730,23 +885,6 @@ PT_THREAD(subscribe_pt(struct pt *pt, struct mqtt_connection *conn))
   PT_MQTT_WRITE_BYTE(conn, conn->out_packet.qos);
 #endif
 
-  /* Send out buffer */
-  send_out_buffer(conn);
-  timer_set(&conn->t, RESPONSE_WAIT_TIMEOUT);
-
-  /* Wait for SUBACK. */
-  reset_packet(&conn->in_packet);
-  PT_WAIT_UNTIL(pt, conn->out_packet.qos_state == MQTT_QOS_STATE_GOT_ACK ||
-                timer_expired(&conn->t));
-
-  if(timer_expired(&conn->t)) {
-    DBG("Timeout waiting for SUBACK\n");
-  }
-  reset_packet(&conn->in_packet);
-
-  /* This is clear after the entire transaction is complete */
-  conn->out_queue_full = 0;
-
   DBG("MQTT - Done in send_subscribe!\n");
 
   PT_END(pt);
@@ -804,25 +942,7 @@ PT_THREAD(unsubscribe_pt(struct pt *pt, struct mqtt_connection *conn))
   PT_MQTT_WRITE_BYTES(conn, (uint8_t *)conn->out_packet.topic,
                       conn->out_packet.topic_length);
 
-  /* Send out buffer */
-  send_out_buffer(conn);
-  timer_set(&conn->t, RESPONSE_WAIT_TIMEOUT);
-
-  /* Wait for UNSUBACK */
-  reset_packet(&conn->in_packet);
-  PT_WAIT_UNTIL(pt, conn->out_packet.qos_state == MQTT_QOS_STATE_GOT_ACK ||
-                timer_expired(&conn->t));
-
-  if(timer_expired(&conn->t)) {
-    DBG("Timeout waiting for UNSUBACK\n");
-  }
-
-  reset_packet(&conn->in_packet);
-
-  /* This is clear after the entire transaction is complete */
-  conn->out_queue_full = 0;
-
-  DBG("MQTT - Done writing subscribe message to out buffer!\n");
+  DBG("MQTT - Done writing unsubscribe message to out buffer!\n");
 
   PT_END(pt);
 }
@@ -895,40 +1015,55 @@ PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
                       conn->out_packet.payload,
                       conn->out_packet.payload_size);
 
-  send_out_buffer(conn);
-  timer_set(&conn->t, RESPONSE_WAIT_TIMEOUT);
-
-  /*
-   * If QoS is zero then wait until the message has been sent, since there is
-   * no ACK to wait for.
-   *
-   * Also notify the app will not be notified via PUBACK or PUBCOMP
-   */
-  if(conn->out_packet.qos == 0) {
-    process_post(conn->app_process, mqtt_update_event, NULL);
-  } else if(conn->out_packet.qos == 1) {
-    /* Wait for PUBACK */
-    reset_packet(&conn->in_packet);
-    PT_WAIT_UNTIL(pt, conn->out_packet.qos_state == MQTT_QOS_STATE_GOT_ACK ||
-                  timer_expired(&conn->t));
-    if(timer_expired(&conn->t)) {
-      DBG("Timeout waiting for PUBACK\n");
-    }
-    if(conn->in_packet.mid != conn->out_packet.mid) {
-      DBG("MQTT - Warning, got PUBACK with none matching MID. Currently there "
-          "is no support for several concurrent PUBLISH messages.\n");
-    }
-  } else if(conn->out_packet.qos == 2) {
+  if(conn->out_packet.qos == 2) {
     DBG("MQTT - QoS not implemented yet.\n");
     /* Should wait for PUBREC, send PUBREL and then wait for PUBCOMP */
   }
 
-  reset_packet(&conn->in_packet);
+  DBG("MQTT - Publish written to out buffer\n");
 
-  /* This is clear after the entire transaction is complete */
-  conn->out_queue_full = 0;
+  PT_END(pt);
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Writes the queued requests the in-flight window allows to the out buffer
+ * and sends them together; the buffer is only flushed early when full.
+ */
+static
+PT_THREAD(send_queue_pt(struct pt *pt, struct mqtt_connection *conn))
+{
+  PT_BEGIN(pt);
 
-  DBG("MQTT - Publish Enqueued\n");
+  while(conn->out_queue_sent < conn->out_queue_len) {
+    conn->out_packet =
+      conn->out_queue[OUT_QUEUE_INDEX(conn, conn->out_queue_sent)];
+    if(out_packet_needs_ack(&conn->out_packet) &&
+       conn->inflight >= conn->inflight_max) {
+      DBG("MQTT - In-flight window full (%u)\n", conn->inflight);
+      break;
+    }
+#if MQTT_5
+    conn->out_props = conn->out_packet.props;
+#endif
+
+    /* No switch here: it would interfere with the protothread */
+    if((conn->out_packet.fhdr & 0xF0) == MQTT_FHDR_MSG_TYPE_SUBSCRIBE) {
+      PT_SPAWN(pt, &conn->out_packet_thread,
+               subscribe_pt(&conn->out_packet_thread, conn));
+    } else if((conn->out_packet.fhdr & 0xF0) ==
+              MQTT_FHDR_MSG_TYPE_UNSUBSCRIBE) {
+      PT_SPAWN(pt, &conn->out_packet_thread,
+               unsubscribe_pt(&conn->out_packet_thread, conn));
+    } else {
+      PT_SPAWN(pt, &conn->out_packet_thread,
+               publish_pt(&conn->out_packet_thread, conn));
+    }
+
+    out_packet_written(conn);
+  }
+
+  send_out_buffer(conn);
+  PT_WAIT_UNTIL(pt, conn->out_buffer_sent);
 
   PT_END(pt);
 }
@@ -1088,7 +1223,10 @@ handle_suback(struct mqtt_connection *conn)
     DBG("MQTT - Error, SUBACK with > 1 topic, not supported.\n");
   }
 
-  conn->out_packet.qos_state = MQTT_QOS_STATE_GOT_ACK;
+  if(!ack_out_packet(conn, MQTT_FHDR_MSG_TYPE_SUBSCRIBE, conn->in_packet.mid)) {
+    DBG("MQTT - Warning, got SUBACK with unknown MID %u\n",
+        conn->in_packet.mid);
+  }
 
   suback_event.mid = conn->in_packet.mid;
 
@@ -1117,11 +1255,6 @@ handle_suback(struct mqtt_connection *conn)
   suback_event.qos_level = conn->in_packet.payload_start[0];
 #endif
 
-  if(conn->in_packet.mid != conn->out_packet.mid) {
-    DBG("MQTT - Warning, got SUBACK with none matching MID. Currently there is"
-        "no support for several concurrent SUBSCRIBE messages.\n");
-  }
-
   /* Always reset packet before callback since it might be used directly */
   call_event(conn, MQTT_EVENT_SUBACK, &suback_event);
 }
@@ -1131,11 +1264,10 @@ handle_unsuback(struct mqtt_connection *conn)
 {
   DBG("MQTT - Got UNSUBACK\n");
 
-  conn->out_packet.qos_state = MQTT_QOS_STATE_GOT_ACK;
-
-  if(conn->in_packet.mid != conn->out_packet.mid) {
-    DBG("MQTT - Warning, got UNSUBACK with none matching MID. Currently there is"
-        "no support for several concurrent UNSUBSCRIBE messages.\n");
+  if(!ack_out_packet(conn, MQTT_FHDR_MSG_TYPE_UNSUBSCRIBE,
+                     conn->in_packet.mid)) {
+    DBG("MQTT - Warning, got UNSUBACK with unknown MID %u\n",
+        conn->in_packet.mid);
   }
 
   call_event(conn, MQTT_EVENT_UNSUBACK, &conn->in_packet.mid);
@@ -1146,7 +1278,10 @@ handle_puback(struct mqtt_connection *conn)
 {
   DBG("MQTT - Got PUBACK\n");
 
-  conn->out_packet.qos_state = MQTT_QOS_STATE_GOT_ACK;
+  if(!ack_out_packet(conn, MQTT_FHDR_MSG_TYPE_PUBLISH, conn->in_packet.mid)) {
+    DBG("MQTT - Warning, got PUBACK with unknown MID %u\n",
+        conn->in_packet.mid);
+  }
 
   call_event(conn, MQTT_EVENT_PUBACK, &conn->in_packet.mid);
 }
@@ -1337,13 +1472,15 @@ parse_vhdr(struct mqtt_connection *conn)
 #endif
 }
 /*---------------------------------------------------------------------------*/
+/*
+ * Reads (part of) one MQTT packet. Returns the number of bytes consumed, or 0
+ * if the remaining input must be dropped.
+ */
 static int
-tcp_input(struct tcp_socket *s,
-          void *ptr,
-          const uint8_t *input_data_ptr,
-          int input_data_len)
+input_packet(struct mqtt_connection *conn,
+             const uint8_t *input_data_ptr,
+             int input_data_len)
 {
-  struct mqtt_connection *conn = ptr;
   uint32_t pos = 0;
   uint32_t copy_bytes = 0;
   mqtt_pub_status_t pub_status;
@@ -1367,7 +1504,7 @@ tcp_input(struct tcp_socket *s,
     DBG("MQTT - Read VHDR '%02X'\n", conn->in_packet.fhdr);
 
     if(pos >= input_data_len) {
-      return 0;
+      return pos;
     }
   }
 
@@ -1385,6 +1522,7 @@ tcp_input(struct tcp_socket *s,
 
     DBG("MQTT - Finished reading remaining length byte\n");
     conn->in_packet.has_remaining_length = 1;
+    conn->in_packet.remaining_length_bytes = remaining_length_bytes;
   }
 
   /*
@@ -1398,12 +1536,13 @@ tcp_input(struct tcp_socket *s,
 
     PRINTF("MQTT - Error, unsupported payload size for non-PUBLISH message\n");
 
-    conn->in_packet.byte_counter += input_data_len;
-    if(conn->in_packet.byte_counter >=
-       (MQTT_FHDR_SIZE + conn->in_packet.remaining_length)) {
+    copy_bytes = MIN(input_data_len - pos,
+                     IN_PACKET_LENGTH(conn) - conn->in_packet.byte_counter);
+    conn->in_packet.byte_counter += copy_bytes;
+    if(conn->in_packet.byte_counter >= IN_PACKET_LENGTH(conn)) {
       conn->in_packet.packet_received = 1;
     }
-    return 0;
+    return pos + copy_bytes;
   }
 
   /*
@@ -1412,8 +1551,7 @@ tcp_input(struct tcp_socket *s,
    * Note: There will always be at least one byte left to read when we enter
    *       this loop.
    */
-  while(conn->in_packet.byte_counter <
-        (MQTT_FHDR_SIZE + conn->in_packet.remaining_length)) {
+  while(conn->in_packet.byte_counter < IN_PACKET_LENGTH(conn)) {
 
     if((conn->in_packet.fhdr & 0xF0) == MQTT_FHDR_MSG_TYPE_PUBLISH &&
        conn->in_packet.topic_received == 0) {
@@ -1423,6 +1561,8 @@ tcp_input(struct tcp_socket *s,
     /* Read in as much as we can into the packet payload */
     copy_bytes = MIN(input_data_len - pos,
                      MQTT_INPUT_BUFF_SIZE - conn->in_packet.payload_pos);
+    copy_bytes = MIN(copy_bytes,
+                     IN_PACKET_LENGTH(conn) - conn->in_packet.byte_counter);
     DBG("- Copied %i payload bytes\n", copy_bytes);
     memcpy(&conn->in_packet.payload[conn->in_packet.payload_pos],
            &input_data_ptr[pos],
@@ -1472,8 +1612,8 @@ tcp_input(struct tcp_socket *s,
     }
 
     if(pos >= input_data_len &&
-       (conn->in_packet.byte_counter < (MQTT_FHDR_SIZE + conn->in_packet.remaining_length))) {
-      return 0;
+       (conn->in_packet.byte_counter < IN_PACKET_LENGTH(conn))) {
+      return pos;
     }
   }
 
@@ -1484,8 +1624,7 @@ tcp_input(struct tcp_socket *s,
   /* Take care of input */
   DBG("MQTT - Finished reading packet!\n");
   /* What to return? */
-  DBG("MQTT - total data was %i bytes of data. \n",
-      (MQTT_FHDR_SIZE + conn->in_packet.remaining_length));
+  DBG("MQTT - total data was %i bytes of data. \n", IN_PACKET_LENGTH(conn));
 
 #if MQTT_5
   if(conn->in_packet.has_reason_code &&
@@ -1563,6 +1702,28 @@ tcp_input(struct tcp_socket *s,
 
   conn->in_packet.packet_received = 1;
 
+  return pos;
+}
+/*---------------------------------------------------------------------------*/
+static int
+tcp_input(struct tcp_socket *s,
+          void *ptr,
+          const uint8_t *input_data_ptr,
+          int input_data_len)
+{
+  struct mqtt_connection *conn = ptr;
+  int used;
+
+  /* A segment may carry several packets, e.g. back-to-back PUBACKs */
+  while(input_data_len > 0) {
+    used = input_packet(conn, input_data_ptr, input_data_len);
+    if(used <= 0) {
+      break;
+    }
+    input_data_ptr += used;
+    input_data_len -= used;
+  }
+
   return 0;
 }
 /*---------------------------------------------------------------------------*/
@@ -1608,6 +1769,11 @@ tcp_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
     if(conn->socket.output_data_len == 0) {
       conn->out_buffer_sent = 1;
       conn->out_buffer_ptr = conn->out_buffer;
+
+      /* Requests queued while the buffer was busy */
+      if(conn->out_queue_sent < conn->out_queue_len) {
+        process_post(&mqtt_process, mqtt_do_send_event, conn);
+      }
     }
 
     ctimer_restart(&conn->keep_alive_timer);
@@ -1687,41 +1853,15 @@ PROCESS_THREAD(mqtt_process, ev, data)
         }
       }
     }
-    if(ev == mqtt_do_subscribe_event) {
-      conn = data;
-      DBG("MQTT - Got mqtt_do_subscribe_mqtt_event!\n");
-
-      if(conn->out_buffer_sent == 1 &&
-         conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
-        PT_INIT(&conn->out_proto_thread);
-        while(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER &&
-              subscribe_pt(&conn->out_proto_thread, conn) < PT_EXITED) {
-          PT_MQTT_WAIT_SEND();
-        }
-      }
-    }
-    if(ev == mqtt_do_unsubscribe_event) {
-      conn = data;
-      DBG("MQTT - Got mqtt_do_unsubscribe_mqtt_event!\n");
-
-      if(conn->out_buffer_sent == 1 &&
-         conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
-        PT_INIT(&conn->out_proto_thread);
-        while(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER &&
-              unsubscribe_pt(&conn->out_proto_thread, conn) < PT_EXITED) {
-          PT_MQTT_WAIT_SEND();
-        }
-      }
-    }
-    if(ev == mqtt_do_publish_event) {
+    if(ev == mqtt_do_send_event) {
       conn = data;
-      DBG("MQTT - Got mqtt_do_publish_mqtt_event!\n");
+      DBG("MQTT - Got mqtt_do_send_event!\n");
 
       if(conn->out_buffer_sent == 1 &&
          conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
         PT_INIT(&conn->out_proto_thread);
         while(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER &&
-              publish_pt(&conn->out_proto_thread, conn) < PT_EXITED) {
+              send_queue_pt(&conn->out_proto_thread, conn) < PT_EXITED) {
           PT_MQTT_WAIT_SEND();
         }
       }
@@ -1755,9 +1895,7 @@ mqtt_init(void)
 
     mqtt_do_connect_mqtt_event = process_alloc_event();
     mqtt_do_disconnect_mqtt_event = process_alloc_event();
-    mqtt_do_subscribe_event = process_alloc_event();
-    mqtt_do_unsubscribe_event = process_alloc_event();
-    mqtt_do_publish_event = process_alloc_event();
+    mqtt_do_send_event = process_alloc_event();
     mqtt_do_pingreq_event = process_alloc_event();
     mqtt_update_event = process_alloc_event();
     mqtt_abort_now_event = process_alloc_event();
@@ -1895,44 +2033,43 @@ mqtt_subscribe(struct mqtt_connection *conn, uint16_t *mid, char *topic,
                mqtt_qos_level_t qos_level)
 #endif
 {
+  struct mqtt_out_packet *packet;
+
   if(conn->state != MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
     return MQTT_STATUS_NOT_CONNECTED_ERROR;
   }
 
   DBG("MQTT - Call to mqtt_subscribe...\n");
 
-  /* Currently don't have a queue, so only one item at a time */
-  if(conn->out_queue_full) {
+  packet = queue_out_packet(conn, MQTT_FHDR_MSG_TYPE_SUBSCRIBE);
+  if(packet == NULL) {
     DBG("MQTT - Not accepted!\n");
     return MQTT_STATUS_OUT_QUEUE_FULL;
   }
-  conn->out_queue_full = 1;
   DBG("MQTT - Accepted!\n");
 
-  conn->out_packet.mid = INCREMENT_MID(conn);
-  conn->out_packet.topic = topic;
-  conn->out_packet.topic_length = strlen(topic);
-  conn->out_packet.qos_state = MQTT_QOS_STATE_NO_ACK;
+  packet->mid = INCREMENT_MID(conn);
+  packet->topic = topic;
+  packet->topic_length = strlen(topic);
 
   if(mid) {
-    *mid = conn->out_packet.mid;
+    *mid = packet->mid;
   }
 
 #if MQTT_5
-  conn->out_packet.sub_options = 0x00;
-  conn->out_packet.sub_options |= qos_level & MQTT_SUB_OPTION_QOS;
-  conn->out_packet.sub_options |= nl & MQTT_SUB_OPTION_NL;
-  conn->out_packet.sub_options |= rap & MQTT_SUB_OPTION_RAP;
-  conn->out_packet.sub_options |= ret_handling & MQTT_SUB_OPTION_RETAIN_HANDLING;
+  packet->sub_options = 0x00;
+  packet->sub_options |= qos_level & MQTT_SUB_OPTION_QOS;
+  packet->sub_options |= nl & MQTT_SUB_OPTION_NL;
+  packet->sub_options |= rap & MQTT_SUB_OPTION_RAP;
+  packet->sub_options |= ret_handling & MQTT_SUB_OPTION_RETAIN_HANDLING;
 #else
-  conn->out_packet.qos = qos_level;
+  packet->qos = qos_level;
 #endif
 
 #if MQTT_5
-  conn->out_props = prop_list;
+  packet->props = prop_list;
 #endif
 
-  process_post(&mqtt_process, mqtt_do_subscribe_event, conn);
   return MQTT_STATUS_OK;
 }
 /*----------------------------------------------------------------------------*/
@@ -1945,33 +2082,33 @@ mqtt_unsubscribe(struct mqtt_connection *conn, uint16_t *mid,
                  char *topic)
 #endif
 {
+  struct mqtt_out_packet *packet;
+
   if(conn->state != MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
     return MQTT_STATUS_NOT_CONNECTED_ERROR;
   }
 
   DBG("MQTT - Call to mqtt_unsubscribe...\n");
-  /* Currently don't have a queue, so only one item at a time */
-  if(conn->out_queue_full) {
+
+  packet = queue_out_packet(conn, MQTT_FHDR_MSG_TYPE_UNSUBSCRIBE);
+  if(packet == NULL) {
     DBG("MQTT - Not accepted!\n");
     return MQTT_STATUS_OUT_QUEUE_FULL;
   }
-  conn->out_queue_full = 1;
   DBG("MQTT - Accepted!\n");
 
-  conn->out_packet.mid = INCREMENT_MID(conn);
-  conn->out_packet.topic = topic;
-  conn->out_packet.topic_length = strlen(topic);
-  conn->out_packet.qos_state = MQTT_QOS_STATE_NO_ACK;
+  packet->mid = INCREMENT_MID(conn);
+  packet->topic = topic;
+  packet->topic_length = strlen(topic);
 
   if(mid) {
-    *mid = conn->out_packet.mid;
+    *mid = packet->mid;
   }
 
 #if MQTT_5
-  conn->out_props = prop_list;
+  packet->props = prop_list;
 #endif
 
-  process_post(&mqtt_process, mqtt_do_unsubscribe_event, conn);
   return MQTT_STATUS_OK;
 }
 /*----------------------------------------------------------------------------*/
@@ -1987,53 +2124,52 @@ mqtt_publish(struct mqtt_connection *conn, uint16_t *mid, char *topic,
              mqtt_retain_t retain)
 #endif
 {
+  struct mqtt_out_packet *packet;
+
   if(conn->state != MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
     return MQTT_STATUS_NOT_CONNECTED_ERROR;
   }
 
   DBG("MQTT - Call to mqtt_publish...\n");
 
-  /* Currently don't have a queue, so only one item at a time */
-  if(conn->out_queue_full) {
+  packet = queue_out_packet(conn, MQTT_FHDR_MSG_TYPE_PUBLISH);
+  if(packet == NULL) {
     DBG("MQTT - Not accepted!\n");
     return MQTT_STATUS_OUT_QUEUE_FULL;
   }
-  conn->out_queue_full = 1;
   DBG("MQTT - Accepted!\n");
 
-  conn->out_packet.mid = INCREMENT_MID(conn);
-  conn->out_packet.retain = retain;
+  packet->mid = INCREMENT_MID(conn);
+  packet->retain = retain;
 #if MQTT_5
   if(topic_alias_en == MQTT_TOPIC_ALIAS_ON) {
-    conn->out_packet.topic = "";
-    conn->out_packet.topic_length = 0;
-    conn->out_packet.topic_alias = topic_alias;
+    packet->topic = "";
+    packet->topic_length = 0;
+    packet->topic_alias = topic_alias;
     if(topic_alias == 0) {
       DBG("MQTT - Error, a topic alias of 0 is not permitted! It won't be sent.\n");
     }
   } else {
-    conn->out_packet.topic = topic;
-    conn->out_packet.topic_length = strlen(topic);
-    conn->out_packet.topic_alias = 0;
+    packet->topic = topic;
+    packet->topic_length = strlen(topic);
+    packet->topic_alias = 0;
   }
 #else
-  conn->out_packet.topic = topic;
-  conn->out_packet.topic_length = strlen(topic);
+  packet->topic = topic;
+  packet->topic_length = strlen(topic);
 #endif
-  conn->out_packet.payload = payload;
-  conn->out_packet.payload_size = payload_size;
-  conn->out_packet.qos = qos_level;
-  conn->out_packet.qos_state = MQTT_QOS_STATE_NO_ACK;
+  packet->payload = payload;
+  packet->payload_size = payload_size;
+  packet->qos = qos_level;
 
   if(mid) {
-    *mid = conn->out_packet.mid;
+    *mid = packet->mid;
   }
 
 #if MQTT_5
-  conn->out_props = prop_list;
+  packet->props = prop_list;
 #endif
 
-  process_post(&mqtt_process, mqtt_do_publish_event, conn);
   return MQTT_STATUS_OK;
 }
 /*----------------------------------------------------------------------------*/
@@ -129,6 +129,29 @@
 #define MQTT_MAX_TOPIC_LENGTH 64
 #define MQTT_MAX_TOPICS_PER_SUBSCRIBE 1
 
+/*
+ * Number of PUBLISH, SUBSCRIBE and UNSUBSCRIBE requests that can be queued,
+ * counting those sent and still waiting for their acknowledgement. With the
+ * default of 1 a new request is accepted only once the previous one has
+ * completed. With a larger queue, topic and payload buffers passed to the
+ * API must stay untouched until the request has been sent.
+ */
+#ifdef MQTT_CONF_OUT_QUEUE_SIZE
+#define MQTT_OUT_QUEUE_SIZE MQTT_CONF_OUT_QUEUE_SIZE
+#else
+#define MQTT_OUT_QUEUE_SIZE 1
+#endif /* MQTT_CONF_OUT_QUEUE_SIZE */
+
+/*
+ * Maximum number of sent requests waiting for an acknowledgement. An MQTT 5
+ * server may lower it further with its Receive Maximum.
+ */
+#ifdef MQTT_CONF_MAX_INFLIGHT
+#define MQTT_MAX_INFLIGHT MQTT_CONF_MAX_INFLIGHT
+#else
+#define MQTT_MAX_INFLIGHT MQTT_OUT_QUEUE_SIZE
+#endif /* MQTT_CONF_MAX_INFLIGHT */
+
 #define MQTT_FHDR_SIZE 1
 #define MQTT_MAX_REMAINING_LENGTH_BYTES 4
 #if MQTT_31
@@ -435,6 +458,7 @@ struct mqtt_in_packet {
 
   /* Helper variables needed to decode the remaining_length */
   uint8_t has_remaining_length;
+  uint8_t remaining_length_bytes;
 
   /* Not the same as payload in the MQTT sense, it also contains the variable
    * header.
@@ -478,11 +502,14 @@ struct mqtt_out_packet {
   mqtt_qos_level_t qos;
   mqtt_qos_state_t qos_state;
   mqtt_retain_t retain;
+  /* When a queued request was sent, for the acknowledgement timeout */
+  clock_time_t sent_time;
 #if MQTT_5
   uint8_t topic_alias;
   uint8_t sub_options;
   /* Continue Auth or Re-auth */
   uint8_t auth_reason_code;
+  struct mqtt_prop_list *props;
 #endif
 };
 /*---------------------------------------------------------------------------*/
@@ -550,6 +577,20 @@ struct mqtt_connection {
   uint8_t out_buffer_sent;
   struct mqtt_out_packet out_packet;
   struct pt out_proto_thread;
+  struct pt out_packet_thread;
+
+  /*
+   * Queued requests, oldest first from out_queue_head. The first
+   * out_queue_sent of them have been sent and wait for their ACK, unless
+   * already released.
+   */
+  struct mqtt_out_packet out_queue[MQTT_OUT_QUEUE_SIZE];
+  uint8_t out_queue_head;
+  uint8_t out_queue_len;
+  uint8_t out_queue_sent;
+  uint16_t inflight;
+  uint16_t inflight_max;
+  struct ctimer ack_timer;
   uint32_t out_write_pos;
   uint16_t max_segment_size;
 
@@ -1652,6 +1652,10 @@ output(const linkaddr_t *localdest)
   /* copy over the retransmission count from uipbuf attributes */
   packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
                      uipbuf_get_attr(UIPBUF_ATTR_MAX_MAC_TRANSMISSIONS));
+#if ENERGEST_TAGS
+  /* The radio time of the packet is attributed to the sending subsystem */
+  packetbuf_set_attr(PACKETBUF_ATTR_ENERGEST_TAG, uipbuf_energest_tag());
+#endif /* ENERGEST_TAGS */
 
 /* Calculate NETSTACK_FRAMER's header length, that will be added in the NETSTACK_MAC */
   packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &dest);
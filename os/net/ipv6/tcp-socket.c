@@ -45,6 +45,19 @@
 static void relisten(struct tcp_socket *s);
 
 LIST(socketlist);
+
+#if TCP_SOCKET_STATS
+struct tcp_socket_stats tcp_socket_stats;
+#define TCP_SOCKET_STAT(code) (code)
+#else
+#define TCP_SOCKET_STAT(code)
+#endif
+
+#define SLICE(s, i) \
+  (&(s)->output_slices[((s)->output_slices_start + (i)) % TCP_SOCKET_MAX_SLICES])
+
+/* Segments are assembled directly where uip_send() expects them */
+#define SEND_BUF ((uint8_t *)&uip_buf[UIP_IPTCPH_LEN])
 /*---------------------------------------------------------------------------*/
 PROCESS(tcp_socket_process, "TCP socket process");
 /*---------------------------------------------------------------------------*/
@@ -57,45 +70,130 @@ call_event(struct tcp_socket *s, tcp_socket_event_t event)
 }
 /*---------------------------------------------------------------------------*/
 static void
+ring_read(struct tcp_socket *s, uint16_t pos, uint8_t *dst, uint16_t len)
+{
+  uint16_t first;
+
+  pos = (s->output_ring_start + pos) % s->output_data_maxlen;
+  first = MIN(len, s->output_data_maxlen - pos);
+  memcpy(dst, &s->output_data_ptr[pos], first);
+  memcpy(dst + first, s->output_data_ptr, len - first);
+}
+/*---------------------------------------------------------------------------*/
+static void
+consume(struct tcp_socket *s, uint16_t len)
+{
+  struct tcp_socket_slice *slice;
+  uint16_t n;
+
+  while(len > 0 && s->output_slices_len > 0) {
+    slice = SLICE(s, 0);
+    n = MIN(slice->len, len);
+    if(slice->data == NULL) {
+      s->output_ring_start = (s->output_ring_start + n) % s->output_data_maxlen;
+      s->output_ring_len -= n;
+    } else {
+      slice->data += n;
+    }
+    slice->len -= n;
+    len -= n;
+    if(slice->len == 0) {
+      s->output_slices_start = (s->output_slices_start + 1) % TCP_SOCKET_MAX_SLICES;
+      s->output_slices_len--;
+    }
+  }
+  if(s->output_ring_len == 0) {
+    s->output_ring_start = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
 senddata(struct tcp_socket *s)
 {
+  struct tcp_socket_slice *slice;
+  uint16_t ring_pos = 0;
   int len = MIN(s->output_data_max_seg, uip_mss());
+  int pos, n;
+  uint8_t i;
+
+  if(s->output_data_len > 0) {
+    len = MIN(s->output_data_len, len);
+    len = MIN(len, UIP_BUFSIZE - UIP_IPTCPH_LEN);
+    if(uip_rexmit() && s->output_data_send_nxt > 0) {
+      /* uIP resends only what was sent before, not data queued since */
+      len = MIN(len, s->output_data_send_nxt);
+    }
 
-  if(s->output_senddata_len > 0) {
-    len = MIN(s->output_senddata_len, len);
+    /* Gather the slices straight into the packet buffer */
+    for(i = 0, pos = 0; pos < len; i++) {
+      slice = SLICE(s, i);
+      n = MIN(slice->len, len - pos);
+      if(slice->data == NULL) {
+        ring_read(s, ring_pos, SEND_BUF + pos, n);
+        ring_pos += slice->len;
+      } else {
+        memcpy(SEND_BUF + pos, slice->data, n);
+      }
+      pos += n;
+    }
+
+#if UIP_TCP_SLIDING_WINDOW
+    /* uIP keeps its own copy of the segment until it is acknowledged,
+       so the data leaves the queue now and the next segment can follow
+       without waiting for the ACK */
+    if(len > 0) {
+      consume(s, len);
+      s->output_data_len -= len;
+      TCP_SOCKET_STAT(tcp_socket_stats.bytes_sent += len);
+      if(s->output_data_len > 0) {
+        tcpip_poll_tcp(s->c);
+      }
+    }
+#else /* UIP_TCP_SLIDING_WINDOW */
     s->output_data_send_nxt = len;
-    uip_send(s->output_data_ptr, len);
+#endif /* UIP_TCP_SLIDING_WINDOW */
+    uip_send(SEND_BUF, len);
   }
 }
 /*---------------------------------------------------------------------------*/
 static void
+reset_output(struct tcp_socket *s)
+{
+  /* Drop queued data, including references the caller may now reuse */
+  s->output_data_len = 0;
+  s->output_data_send_nxt = 0;
+  s->output_ring_start = 0;
+  s->output_ring_len = 0;
+  s->output_slices_start = 0;
+  s->output_slices_len = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
 acked(struct tcp_socket *s)
 {
-  if(s->output_senddata_len > 0) {
-    /* Copy the data in the outputbuf down and update outputbufptr and
-       outputbuf_lastsent */
-
-    if(s->output_data_send_nxt > 0) {
-      memmove(&s->output_data_ptr[0],
-              &s->output_data_ptr[s->output_data_send_nxt],
-              s->output_data_maxlen - s->output_data_send_nxt);
-    }
+#if UIP_TCP_SLIDING_WINDOW
+  call_event(s, TCP_SOCKET_DATA_SENT);
+#else /* UIP_TCP_SLIDING_WINDOW */
+  if(s->output_data_send_nxt > 0) {
     if(s->output_data_len < s->output_data_send_nxt) {
       PRINTF("tcp: acked assertion failed s->output_data_len (%d) < s->output_data_send_nxt (%d)\n",
              s->output_data_len,
              s->output_data_send_nxt);
       tcp_markconn(uip_conn, NULL);
       uip_abort();
+      reset_output(s);
       call_event(s, TCP_SOCKET_ABORTED);
       relisten(s);
       return;
     }
+    consume(s, s->output_data_send_nxt);
     s->output_data_len -= s->output_data_send_nxt;
-    s->output_senddata_len = s->output_data_len;
+    TCP_SOCKET_STAT(tcp_socket_stats.bytes_sent += s->output_data_send_nxt);
     s->output_data_send_nxt = 0;
 
     call_event(s, TCP_SOCKET_DATA_SENT);
   }
+#endif /* UIP_TCP_SLIDING_WINDOW */
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -185,12 +283,18 @@ appcall(void *state)
   }
 
   if(uip_timedout()) {
+    if(s != NULL) {
+      reset_output(s);
+    }
     call_event(s, TCP_SOCKET_TIMEDOUT);
     relisten(s);
   }
 
   if(uip_aborted()) {
     tcp_markconn(uip_conn, NULL);
+    if(s != NULL) {
+      reset_output(s);
+    }
     call_event(s, TCP_SOCKET_ABORTED);
     relisten(s);
 
@@ -229,6 +333,7 @@ appcall(void *state)
   if(uip_closed()) {
     tcp_markconn(uip_conn, NULL);
     s->c = NULL;
+    reset_output(s);
     call_event(s, TCP_SOCKET_CLOSED);
     relisten(s);
   }
@@ -274,9 +379,9 @@ tcp_socket_register(struct tcp_socket *s, void *ptr,
   s->ptr = ptr;
   s->input_data_ptr = input_databuf;
   s->input_data_maxlen = input_databuf_len;
-  s->output_data_len = 0;
   s->output_data_ptr = output_databuf;
   s->output_data_maxlen = output_databuf_len;
+  reset_output(s);
   s->input_callback = input_callback;
   s->event_callback = event_callback;
   list_add(socketlist, s);
@@ -338,25 +443,79 @@ tcp_socket_unlisten(struct tcp_socket *s)
   return 1;
 }
 /*---------------------------------------------------------------------------*/
+static struct tcp_socket_slice *
+add_slice(struct tcp_socket *s, const uint8_t *data)
+{
+  struct tcp_socket_slice *slice;
+
+  /* Copied bytes directly following copied bytes extend their slice */
+  if(data == NULL && s->output_slices_len > 0) {
+    slice = SLICE(s, s->output_slices_len - 1);
+    if(slice->data == NULL) {
+      return slice;
+    }
+  }
+  if(s->output_slices_len == TCP_SOCKET_MAX_SLICES) {
+    return NULL;
+  }
+  slice = SLICE(s, s->output_slices_len);
+  slice->data = data;
+  slice->len = 0;
+  s->output_slices_len++;
+  return slice;
+}
+/*---------------------------------------------------------------------------*/
 int
 tcp_socket_send(struct tcp_socket *s,
                 const uint8_t *data, int datalen)
 {
+  struct tcp_socket_slice *slice;
+  uint16_t pos, first;
   int len;
 
   if(s == NULL) {
     return -1;
   }
 
-  len = MIN(datalen, s->output_data_maxlen - s->output_data_len);
+  len = MIN(datalen, tcp_socket_max_sendlen(s));
+  if(len <= 0 || (slice = add_slice(s, NULL)) == NULL) {
+    return 0;
+  }
+
+  pos = (s->output_ring_start + s->output_ring_len) % s->output_data_maxlen;
+  first = MIN(len, s->output_data_maxlen - pos);
+  memcpy(&s->output_data_ptr[pos], data, first);
+  memcpy(s->output_data_ptr, data + first, len - first);
+  TCP_SOCKET_STAT(tcp_socket_stats.bytes_copied += len);
 
-  memmove(&s->output_data_ptr[s->output_data_len], data, len);
+  slice->len += len;
+  s->output_ring_len += len;
   s->output_data_len += len;
 
-  if(s->output_senddata_len == 0) {
-    s->output_senddata_len = s->output_data_len;
+  tcpip_poll_tcp(s->c);
+
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+int
+tcp_socket_send_ref(struct tcp_socket *s,
+                    const uint8_t *data, int datalen)
+{
+  struct tcp_socket_slice *slice;
+  int len;
+
+  if(s == NULL || data == NULL) {
+    return -1;
   }
 
+  len = MIN(datalen, 0xffff - s->output_data_len);
+  if(len <= 0 || (slice = add_slice(s, data)) == NULL) {
+    return 0;
+  }
+
+  slice->len = len;
+  s->output_data_len += len;
+
   tcpip_poll_tcp(s->c);
 
   return len;
@@ -398,7 +557,16 @@ tcp_socket_unregister(struct tcp_socket *s)
 int
 tcp_socket_max_sendlen(struct tcp_socket *s)
 {
-  return s->output_data_maxlen - s->output_data_len;
+  struct tcp_socket_slice *slice;
+
+  if(s->output_slices_len == TCP_SOCKET_MAX_SLICES) {
+    slice = SLICE(s, s->output_slices_len - 1);
+    if(slice->data != NULL) {
+      /* No room for another piece */
+      return 0;
+    }
+  }
+  return s->output_data_maxlen - s->output_ring_len;
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -34,6 +34,23 @@
 
 #include "uip.h"
 
+/*
+ * Number of pieces of output data a socket can keep queued. Bytes added
+ * with tcp_socket_send() back to back share one piece; each call to
+ * tcp_socket_send_ref() takes one of its own.
+ */
+#ifdef TCP_SOCKET_CONF_MAX_SLICES
+#define TCP_SOCKET_MAX_SLICES TCP_SOCKET_CONF_MAX_SLICES
+#else
+#define TCP_SOCKET_MAX_SLICES 4
+#endif /* TCP_SOCKET_CONF_MAX_SLICES */
+
+#ifdef TCP_SOCKET_CONF_STATS
+#define TCP_SOCKET_STATS TCP_SOCKET_CONF_STATS
+#else
+#define TCP_SOCKET_STATS 0
+#endif /* TCP_SOCKET_CONF_STATS */
+
 struct tcp_socket;
 
 typedef enum {
@@ -80,6 +97,13 @@ typedef void (* tcp_socket_event_callback_t)(struct tcp_socket *s,
                                              void *ptr,
                                              tcp_socket_event_t event);
 
+/* A piece of queued output data */
+struct tcp_socket_slice {
+  /* Caller-owned data, or NULL for bytes in the output ring buffer */
+  const uint8_t *data;
+  uint16_t len;
+};
+
 struct tcp_socket {
   struct tcp_socket *next;
 
@@ -95,11 +119,19 @@ struct tcp_socket {
   uint16_t input_data_maxlen;
   uint16_t input_data_len;
   uint16_t output_data_maxlen;
+  /* Queued bytes, both copied and referenced, not yet acknowledged */
   uint16_t output_data_len;
   uint16_t output_data_send_nxt;
-  uint16_t output_senddata_len;
   uint16_t output_data_max_seg;
 
+  /* The output buffer is a ring: copied bytes start at output_ring_start */
+  uint16_t output_ring_start;
+  uint16_t output_ring_len;
+
+  struct tcp_socket_slice output_slices[TCP_SOCKET_MAX_SLICES];
+  uint8_t output_slices_start;
+  uint8_t output_slices_len;
+
   uint8_t flags;
   uint16_t listen_port;
   struct uip_conn *c;
@@ -111,6 +143,18 @@ enum {
   TCP_SOCKET_FLAGS_CLOSING   = 0x02,
 };
 
+#if TCP_SOCKET_STATS
+struct tcp_socket_stats {
+  /* Bytes copied into socket output buffers */
+  uint32_t bytes_copied;
+  /* Bytes acknowledged by the remote ends, or with
+     UIP_TCP_SLIDING_WINDOW, bytes handed over to uIP */
+  uint32_t bytes_sent;
+};
+
+extern struct tcp_socket_stats tcp_socket_stats;
+#endif /* TCP_SOCKET_STATS */
+
 /**
  * \brief      Register a TCP socket
  * \param s    A pointer to a TCP socket
@@ -229,6 +273,28 @@ int tcp_socket_send(struct tcp_socket *s,
                     const uint8_t *dataptr,
                     int datalen);
 
+/**
+ * \brief      Send caller-owned data on a connected TCP socket without copying it
+ * \param s    A pointer to a TCP socket that must have been previously registered with tcp_socket_register()
+ * \param dataptr A pointer to the data to be sent
+ * \param datalen The length of the data to be sent
+ * \retval -1  If an error occurs
+ * \return     The number of bytes that were queued for sending
+ *
+ *             This function queues a reference to the data instead
+ *             of copying it into the output buffer. The data is
+ *             sent in order with the data given to
+ *             tcp_socket_send(), straight from where it is. It must
+ *             therefore stay unchanged until it has been
+ *             acknowledged, i.e., until tcp_socket_queuelen() is no
+ *             larger than the number of bytes queued after it. The
+ *             socket can hold TCP_SOCKET_MAX_SLICES pieces of data;
+ *             when they are all taken, 0 is returned.
+ */
+int tcp_socket_send_ref(struct tcp_socket *s,
+                        const uint8_t *dataptr,
+                        int datalen);
+
 /**
  * \brief      Send a string on a connected TCP socket
  * \param s    A pointer to a TCP socket that must have been previously registered with tcp_socket_register()
@@ -559,11 +559,10 @@ get_nexthop(uip_ipaddr_t *addr)
 static int
 queue_packet(uip_ds6_nbr_t *nbr)
 {
-  /* Copy outgoing pkt in the queuing buffer for later transmit. */
+  /* Park outgoing pkt in the queuing buffer for later transmit. With a
+     uIP buffer pool, uip_buf continues in a fresh buffer afterwards. */
 #if UIP_CONF_IPV6_QUEUE_PKT
-  if(uip_packetqueue_alloc(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME) != NULL) {
-    memcpy(uip_packetqueue_buf(&nbr->packethandle), UIP_IP_BUF, uip_len);
-    uip_packetqueue_set_buflen(&nbr->packethandle, uip_len);
+  if(uip_packetqueue_put(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME) != NULL) {
     return 0;
   }
 #endif
@@ -582,10 +581,7 @@ send_queued(uip_ds6_nbr_t *nbr)
    * NA after sendiong a NS, you receive a NS with SLLAO: the entry moves
    * to STALE, and you must both send a NA and the queued packet.
    */
-  if(uip_packetqueue_buflen(&nbr->packethandle) != 0) {
-    uip_len = uip_packetqueue_buflen(&nbr->packethandle);
-    memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
-    uip_packetqueue_free(&nbr->packethandle);
+  if(uip_packetqueue_get(&nbr->packethandle) != 0) {
     tcpip_output(uip_ds6_nbr_get_ll(nbr));
   }
 #endif /*UIP_CONF_IPV6_QUEUE_PKT*/
@@ -598,21 +594,24 @@ send_nd6_ns(const uip_ipaddr_t *nexthop)
 
 #if UIP_ND6_SEND_NS
    uip_ds6_nbr_t *nbr = NULL;
+   uip_ipaddr_t src;
+   uip_ipaddr_t *srcp = NULL;
   if((nbr = uip_ds6_nbr_add(nexthop, NULL, 0, NBR_INCOMPLETE, NBR_TABLE_REASON_IPV6_ND, NULL)) != NULL) {
     err = 0;
 
-    queue_packet(nbr);
   /* RFC4861, 7.2.2:
    * "If the source address of the packet prompting the solicitation is the
    * same as one of the addresses assigned to the outgoing interface, that
    * address SHOULD be placed in the IP Source Address of the outgoing
    * solicitation.  Otherwise, any one of the addresses assigned to the
-   * interface should be used."*/
+   * interface should be used."
+   * The source is saved first as queueing may hand over uip_buf. */
    if(uip_ds6_is_my_addr(&UIP_IP_BUF->srcipaddr)){
-      uip_nd6_ns_output(&UIP_IP_BUF->srcipaddr, NULL, &nbr->ipaddr);
-    } else {
-      uip_nd6_ns_output(NULL, NULL, &nbr->ipaddr);
+      uip_ipaddr_copy(&src, &UIP_IP_BUF->srcipaddr);
+      srcp = &src;
     }
+    queue_packet(nbr);
+    uip_nd6_ns_output(srcp, NULL, &nbr->ipaddr);
 
     stimer_set(&nbr->sendns, uip_ds6_if.retrans_timer / 1000);
     nbr->nscount = 1;
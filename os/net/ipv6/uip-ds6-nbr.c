@@ -53,6 +53,7 @@
 #include "net/ipv6/uip-ds6.h"
 #include "net/ipv6/uip-ds6-nbr.h"
 #include "net/ipv6/uip-nd6.h"
+#include "net/ipv6/tcpip.h"
 #include "net/routing/routing.h"
 
 #if UIP_DS6_NBR_MULTI_IPV6_ADDRS
@@ -577,11 +578,38 @@ uip_ds6_link_callback(int status, int numtx)
 }
 #if UIP_ND6_SEND_NS
 /*---------------------------------------------------------------------------*/
+/* Number of NS that may still be sent in the current periodic run */
+static uint8_t nud_budget;
+/*---------------------------------------------------------------------------*/
+static int
+nud_probe_allowed(void)
+{
+  if(nud_budget == 0) {
+    UIP_ND6_STAT(uip_nd6_stats.nud_deferred++);
+    return 0;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+nud_probe_sent(void)
+{
+  nud_budget--;
+  UIP_ND6_STAT(uip_nd6_stats.nud_probes++);
+  if(nud_budget > 0 && uip_len > 0) {
+    /* uip_buf holds a single packet: send this probe out now so that the
+       next one can be built. The last one is sent by our caller. */
+    tcpip_ipv6_output();
+  }
+}
+/*---------------------------------------------------------------------------*/
 /** Periodic processing on neighbors */
 void
 uip_ds6_neighbor_periodic(void)
 {
   uip_ds6_nbr_t *nbr = uip_ds6_nbr_head();
+
+  nud_budget = UIP_ND6_NUD_PROBES_PER_PERIOD;
   while(nbr != NULL) {
     switch(nbr->state) {
     case NBR_REACHABLE:
@@ -617,11 +645,13 @@ uip_ds6_neighbor_periodic(void)
     case NBR_INCOMPLETE:
       if(nbr->nscount >= UIP_ND6_MAX_MULTICAST_SOLICIT) {
         uip_ds6_nbr_rm(nbr);
-      } else if(stimer_expired(&nbr->sendns) && (uip_len == 0)) {
+      } else if(stimer_expired(&nbr->sendns) && (uip_len == 0) &&
+                nud_probe_allowed()) {
         nbr->nscount++;
         LOG_INFO("NBR_INCOMPLETE: NS %u\n", nbr->nscount);
         uip_nd6_ns_output(NULL, NULL, &nbr->ipaddr);
         stimer_set(&nbr->sendns, uip_ds6_if.retrans_timer / 1000);
+        nud_probe_sent();
       }
       break;
     case NBR_DELAY:
@@ -642,11 +672,13 @@ uip_ds6_neighbor_periodic(void)
           }
         }
         uip_ds6_nbr_rm(nbr);
-      } else if(stimer_expired(&nbr->sendns) && (uip_len == 0)) {
+      } else if(stimer_expired(&nbr->sendns) && (uip_len == 0) &&
+                nud_probe_allowed()) {
         nbr->nscount++;
         LOG_INFO("PROBE: NS %u\n", nbr->nscount);
         uip_nd6_ns_output(NULL, &nbr->ipaddr, &nbr->ipaddr);
         stimer_set(&nbr->sendns, uip_ds6_if.retrans_timer / 1000);
+        nud_probe_sent();
       }
       break;
     default:
@@ -100,6 +100,10 @@
 #define ND6_OPT_RDNSS_BUF(opt)             ((uip_nd6_opt_dns *)ND6_OPT(opt))
 /** @} */
 
+#if UIP_ND6_STATS
+struct uip_nd6_stats uip_nd6_stats;
+#endif /* UIP_ND6_STATS */
+
 #if UIP_ND6_SEND_NS || UIP_ND6_SEND_NA || UIP_ND6_SEND_RA || !UIP_CONF_ROUTER
 static uint16_t nd6_opt_offset; /** Offset from the end of the icmpv6 header to the option in uip_buf*/
 static uint8_t *nd6_opt_llao;   /**  Pointer to llao option in uip_buf */
@@ -145,6 +149,69 @@ create_llao(uint8_t *llao, uint8_t type)
   memset(&llao[UIP_ND6_OPT_DATA_OFFSET + UIP_LLADDR_LEN], 0,
          UIP_ND6_OPT_LLAO_LEN - 2 - UIP_LLADDR_LEN);
 }
+#if UIP_ND6_FAST_PATH
+/*------------------------------------------------------------------*/
+/*
+ * NS and NA with a LLAO only differ in their addresses and NA flags, so
+ * the LLAO and the checksum of everything else are computed once, and
+ * again only when our link-layer address changes.
+ */
+static struct {
+  uip_lladdr_t lladdr;
+  uint8_t llao[UIP_ND6_OPT_LLAO_LEN];
+  uint16_t llao_sum; /* Host order, computed with a zero option type */
+  uint8_t valid;
+} nd6_tmpl;
+/*------------------------------------------------------------------*/
+static uint16_t
+chksum_add(uint16_t sum, uint16_t val)
+{
+  sum += val;
+  return sum < val ? sum + 1 : sum;
+}
+/*------------------------------------------------------------------*/
+static void
+tmpl_refresh(void)
+{
+  if(nd6_tmpl.valid &&
+     memcmp(&nd6_tmpl.lladdr, &uip_lladdr, sizeof(uip_lladdr_t)) == 0) {
+    return;
+  }
+  memcpy(&nd6_tmpl.lladdr, &uip_lladdr, sizeof(uip_lladdr_t));
+  create_llao(nd6_tmpl.llao, 0);
+  nd6_tmpl.llao_sum = uip_ntohs(uip_chksum((uint16_t *)nd6_tmpl.llao,
+                                           UIP_ND6_OPT_LLAO_LEN));
+  nd6_tmpl.valid = 1;
+}
+/*------------------------------------------------------------------*/
+/* Copy the cached LLAO and finish a NS or NA (with the addresses already
+ * in place in uip_buf) by computing its ICMPv6 checksum incrementally. */
+static void
+tmpl_finish(uint8_t opt_type, uint16_t opt_offset, uint8_t first_byte)
+{
+  uint16_t sum;
+
+  tmpl_refresh();
+  memcpy(ND6_OPT(opt_offset), nd6_tmpl.llao, UIP_ND6_OPT_LLAO_LEN);
+  *ND6_OPT(opt_offset) = opt_type;
+
+  /* Pseudo header length and next header. This addition cannot carry. */
+  sum = uipbuf_get_len_field(UIP_IP_BUF) + UIP_PROTO_ICMP6;
+  sum = chksum_add(sum, uip_ntohs(uip_chksum((uint16_t *)&UIP_IP_BUF->srcipaddr,
+                                             2 * sizeof(uip_ipaddr_t))));
+  /* ICMPv6 type and code, then first byte of NA flags / NS reserved */
+  sum = chksum_add(sum, UIP_ICMP_BUF->type << 8);
+  sum = chksum_add(sum, first_byte << 8);
+  /* NS and NA have the target at the same offset */
+  sum = chksum_add(sum, uip_ntohs(uip_chksum((uint16_t *)&UIP_ND6_NS_BUF->tgtipaddr,
+                                             sizeof(uip_ipaddr_t))));
+  sum = chksum_add(sum, nd6_tmpl.llao_sum);
+  sum = chksum_add(sum, opt_type << 8);
+
+  UIP_ICMP_BUF->icmpchksum = ~((sum == 0) ? 0xffff : uip_htons(sum));
+  UIP_ND6_STAT(uip_nd6_stats.fast_path++);
+}
+#endif /* UIP_ND6_FAST_PATH */
 #endif /* UIP_ND6_SEND_NA */
 /*------------------------------------------------------------------*/
  /**
@@ -182,6 +249,7 @@ ns_input(void)
   LOG_INFO_6ADDR((uip_ipaddr_t *) (&UIP_ND6_NS_BUF->tgtipaddr));
   LOG_INFO_("\n");
   UIP_STAT(++uip_stat.nd6.recv);
+  UIP_ND6_STAT(uip_nd6_stats.ns_recv++);
 
 #if UIP_CONF_IPV6_CHECKS
   if((UIP_IP_BUF->ttl != UIP_ND6_HOP_LIMIT) ||
@@ -301,7 +369,7 @@ ns_input(void)
     }
 
     /* NUD CASE */
-    if(uip_ds6_addr_lookup(&UIP_IP_BUF->destipaddr) == addr) {
+    if(uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &addr->ipaddr)) {
       uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &UIP_IP_BUF->srcipaddr);
       uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &UIP_ND6_NS_BUF->tgtipaddr);
       flags = UIP_ND6_NA_FLAG_SOLICITED | UIP_ND6_NA_FLAG_OVERRIDE;
@@ -334,17 +402,23 @@ create_na:
   UIP_ICMP_BUF->icode = 0;
 
   UIP_ND6_NA_BUF->flagsreserved = flags;
+  memset(UIP_ND6_NA_BUF->reserved, 0, sizeof(UIP_ND6_NA_BUF->reserved));
   memcpy(&UIP_ND6_NA_BUF->tgtipaddr, &addr->ipaddr, sizeof(uip_ipaddr_t));
 
+#if UIP_ND6_FAST_PATH
+  tmpl_finish(UIP_ND6_OPT_TLLAO, UIP_ND6_NA_LEN, flags);
+#else /* UIP_ND6_FAST_PATH */
   create_llao(&uip_buf[uip_l3_icmp_hdr_len + UIP_ND6_NA_LEN],
               UIP_ND6_OPT_TLLAO);
 
   UIP_ICMP_BUF->icmpchksum = 0;
   UIP_ICMP_BUF->icmpchksum = ~uip_icmp6chksum();
+#endif /* UIP_ND6_FAST_PATH */
 
   uipbuf_set_len(UIP_IPH_LEN + UIP_ICMPH_LEN + UIP_ND6_NA_LEN + UIP_ND6_OPT_LLAO_LEN);
 
   UIP_STAT(++uip_stat.nd6.sent);
+  UIP_ND6_STAT(uip_nd6_stats.na_sent++);
   LOG_INFO("Sending NA to ");
   LOG_INFO_6ADDR(&UIP_IP_BUF->destipaddr);
   LOG_INFO_(" from ");
@@ -399,21 +473,29 @@ uip_nd6_ns_output(uip_ipaddr_t * src, uip_ipaddr_t * dest, uip_ipaddr_t * tgt)
     }
     uipbuf_set_len_field(UIP_IP_BUF, UIP_ICMPH_LEN + UIP_ND6_NS_LEN + UIP_ND6_OPT_LLAO_LEN);
 
+    uip_len =
+      UIP_IPH_LEN + UIP_ICMPH_LEN + UIP_ND6_NS_LEN + UIP_ND6_OPT_LLAO_LEN;
+
+#if UIP_ND6_FAST_PATH
+    tmpl_finish(UIP_ND6_OPT_SLLAO, UIP_ND6_NS_LEN, 0);
+#else /* UIP_ND6_FAST_PATH */
     create_llao(&uip_buf[uip_l3_icmp_hdr_len + UIP_ND6_NS_LEN],
                 UIP_ND6_OPT_SLLAO);
 
-    uip_len =
-      UIP_IPH_LEN + UIP_ICMPH_LEN + UIP_ND6_NS_LEN + UIP_ND6_OPT_LLAO_LEN;
+    UIP_ICMP_BUF->icmpchksum = 0;
+    UIP_ICMP_BUF->icmpchksum = ~uip_icmp6chksum();
+#endif /* UIP_ND6_FAST_PATH */
   } else {
     uip_create_unspecified(&UIP_IP_BUF->srcipaddr);
     UIP_IP_BUF->len[1] = UIP_ICMPH_LEN + UIP_ND6_NS_LEN;
     uip_len = UIP_IPH_LEN + UIP_ICMPH_LEN + UIP_ND6_NS_LEN;
-  }
 
-  UIP_ICMP_BUF->icmpchksum = 0;
-  UIP_ICMP_BUF->icmpchksum = ~uip_icmp6chksum();
+    UIP_ICMP_BUF->icmpchksum = 0;
+    UIP_ICMP_BUF->icmpchksum = ~uip_icmp6chksum();
+  }
 
   UIP_STAT(++uip_stat.nd6.sent);
+  UIP_ND6_STAT(uip_nd6_stats.ns_sent++);
   LOG_INFO("Sending NS to ");
   LOG_INFO_6ADDR(&UIP_IP_BUF->destipaddr);
   LOG_INFO_(" from ");
@@ -461,6 +543,7 @@ na_input(void)
   LOG_INFO_6ADDR((uip_ipaddr_t *) (&UIP_ND6_NA_BUF->tgtipaddr));
   LOG_INFO_("\n");
   UIP_STAT(++uip_stat.nd6.recv);
+  UIP_ND6_STAT(uip_nd6_stats.na_recv++);
 
   /*
    * booleans. the three last one are not 0 or 1 but 0 or 0x80, 0x40, 0x20
@@ -590,10 +673,7 @@ na_input(void)
     nbr->queue_buf_len = 0;
     return;
     }*/
-  if(uip_packetqueue_buflen(&nbr->packethandle) != 0) {
-    uip_len = uip_packetqueue_buflen(&nbr->packethandle);
-    memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
-    uip_packetqueue_free(&nbr->packethandle);
+  if(uip_packetqueue_get(&nbr->packethandle) != 0) {
     return;
   }
 
@@ -618,6 +698,7 @@ rs_input(void)
   LOG_INFO_6ADDR(&UIP_IP_BUF->destipaddr);
   LOG_INFO_("\n");
   UIP_STAT(++uip_stat.nd6.recv);
+  UIP_ND6_STAT(uip_nd6_stats.rs_recv++);
 
 
 #if UIP_CONF_IPV6_CHECKS
@@ -755,7 +836,13 @@ uip_nd6_ra_output(uip_ipaddr_t * dest)
   }
 
   /* Source link-layer option */
+#if UIP_ND6_FAST_PATH
+  tmpl_refresh();
+  memcpy(ND6_OPT(nd6_opt_offset), nd6_tmpl.llao, UIP_ND6_OPT_LLAO_LEN);
+  *ND6_OPT(nd6_opt_offset) = UIP_ND6_OPT_SLLAO;
+#else /* UIP_ND6_FAST_PATH */
   create_llao((uint8_t *)ND6_OPT_HDR_BUF(nd6_opt_offset), UIP_ND6_OPT_SLLAO);
+#endif /* UIP_ND6_FAST_PATH */
 
   uip_len += UIP_ND6_OPT_LLAO_LEN;
   nd6_opt_offset += UIP_ND6_OPT_LLAO_LEN;
@@ -799,6 +886,7 @@ uip_nd6_ra_output(uip_ipaddr_t * dest)
   UIP_ICMP_BUF->icmpchksum = ~uip_icmp6chksum();
 
   UIP_STAT(++uip_stat.nd6.sent);
+  UIP_ND6_STAT(uip_nd6_stats.ra_sent++);
   LOG_INFO("Sending RA to ");
   LOG_INFO_6ADDR(&UIP_IP_BUF->destipaddr);
   LOG_INFO_(" from ");
@@ -839,6 +927,7 @@ uip_nd6_rs_output(void)
   UIP_ICMP_BUF->icmpchksum = ~uip_icmp6chksum();
 
   UIP_STAT(++uip_stat.nd6.sent);
+  UIP_ND6_STAT(uip_nd6_stats.rs_sent++);
   LOG_INFO("Sending RS to ");
   LOG_INFO_6ADDR(&UIP_IP_BUF->destipaddr);
   LOG_INFO_(" from ");
@@ -867,6 +956,7 @@ ra_input(void)
   LOG_INFO_6ADDR(&UIP_IP_BUF->destipaddr);
   LOG_INFO_("\n");
   UIP_STAT(++uip_stat.nd6.recv);
+  UIP_ND6_STAT(uip_nd6_stats.ra_recv++);
 
 #if UIP_CONF_IPV6_CHECKS
   if((UIP_IP_BUF->ttl != UIP_ND6_HOP_LIMIT) ||
@@ -1074,10 +1164,7 @@ ra_input(void)
     nbr->queue_buf_len = 0;
     return;
     }*/
-  if(nbr != NULL && uip_packetqueue_buflen(&nbr->packethandle) != 0) {
-    uip_len = uip_packetqueue_buflen(&nbr->packethandle);
-    memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
-    uip_packetqueue_free(&nbr->packethandle);
+  if(nbr != NULL && uip_packetqueue_get(&nbr->packethandle) != 0) {
     return;
   }
 
@@ -174,6 +174,33 @@ be added regardless of their reachability and liveness.  */
 /** @} */
 
 
+/** \name ND fast path and NUD probe scheduling */
+/** @{ */
+/** \brief Build NS/NA options from a cached template and compute their
+ * checksum incrementally from the variable fields only */
+#ifdef UIP_CONF_ND6_FAST_PATH
+#define UIP_ND6_FAST_PATH               UIP_CONF_ND6_FAST_PATH
+#else
+#define UIP_ND6_FAST_PATH               1
+#endif
+
+/** \brief Max number of NS sent for NUD and address resolution in a single
+ * run of uip_ds6_neighbor_periodic(). Probes above the limit are deferred
+ * to the next period. */
+#ifdef UIP_CONF_ND6_NUD_PROBES_PER_PERIOD
+#define UIP_ND6_NUD_PROBES_PER_PERIOD   UIP_CONF_ND6_NUD_PROBES_PER_PERIOD
+#else
+#define UIP_ND6_NUD_PROBES_PER_PERIOD   1
+#endif
+
+/** \brief Keep per-message-type ND counters in uip_nd6_stats */
+#ifdef UIP_CONF_ND6_STATS
+#define UIP_ND6_STATS                   UIP_CONF_ND6_STATS
+#else
+#define UIP_ND6_STATS                   0
+#endif
+/** @} */
+
 /** \name RFC 6106 RA DNS Options Constants  */
 /** @{ */
 #ifndef UIP_CONF_ND6_RA_RDNSS
@@ -420,6 +447,29 @@ void uip_nd6_rs_output(void);
 void uip_nd6_init(void);
 /** @} */
 
+#if UIP_ND6_STATS
+/** \brief Per-message-type ND counters */
+struct uip_nd6_stats {
+  uint32_t ns_recv;      /**< Received NS */
+  uint32_t ns_sent;      /**< Sent NS */
+  uint32_t na_recv;      /**< Received NA */
+  uint32_t na_sent;      /**< Sent NA */
+  uint32_t rs_recv;      /**< Received RS */
+  uint32_t rs_sent;      /**< Sent RS */
+  uint32_t ra_recv;      /**< Received RA */
+  uint32_t ra_sent;      /**< Sent RA */
+  uint32_t fast_path;    /**< NS/NA built from the cached template */
+  uint32_t nud_probes;   /**< NS sent from uip_ds6_neighbor_periodic() */
+  uint32_t nud_deferred; /**< NS postponed by the per-period probe limit */
+};
+
+extern struct uip_nd6_stats uip_nd6_stats;
+
+#define UIP_ND6_STAT(code) (code)
+#else /* UIP_ND6_STATS */
+#define UIP_ND6_STAT(code)
+#endif /* UIP_ND6_STATS */
+
 
 void
 uip_appserver_addr_get(uip_ipaddr_t *ipaddr);
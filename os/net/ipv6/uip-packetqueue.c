@@ -6,7 +6,12 @@
 
 #include "net/ipv6/uip-packetqueue.h"
 
+#if UIP_BUF_POOL_SIZE > 1
+/* Every queued packet parks one pool buffer; keep one for uip_buf */
+#define MAX_NUM_QUEUED_PACKETS (UIP_BUF_POOL_SIZE - 1)
+#else
 #define MAX_NUM_QUEUED_PACKETS 2
+#endif
 MEMB(packets_memb, struct uip_packetqueue_packet, MAX_NUM_QUEUED_PACKETS);
 
 #define DEBUG 0
@@ -17,6 +22,16 @@ MEMB(packets_memb, struct uip_packetqueue_packet, MAX_NUM_QUEUED_PACKETS);
 #define PRINTF(...)
 #endif
 
+/*---------------------------------------------------------------------------*/
+static void
+packet_release(struct uip_packetqueue_handle *h)
+{
+#if UIP_BUF_POOL_SIZE > 0
+  uipbuf_pool_free(h->packet->queue_buf);
+#endif
+  memb_free(&packets_memb, h->packet);
+  h->packet = NULL;
+}
 /*---------------------------------------------------------------------------*/
 static void
 packet_timedout(void *ptr)
@@ -24,8 +39,7 @@ packet_timedout(void *ptr)
   struct uip_packetqueue_handle *h = ptr;
 
   PRINTF("uip_packetqueue_free timed out %p\n", h);
-  memb_free(&packets_memb, h->packet);
-  h->packet = NULL;
+  packet_release(h);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -44,6 +58,15 @@ uip_packetqueue_alloc(struct uip_packetqueue_handle *handle, clock_time_t lifeti
     return NULL;
   }
   handle->packet = memb_alloc(&packets_memb);
+#if UIP_BUF_POOL_SIZE > 0
+  if(handle->packet != NULL) {
+    handle->packet->queue_buf = uipbuf_pool_alloc();
+    if(handle->packet->queue_buf == NULL) {
+      memb_free(&packets_memb, handle->packet);
+      handle->packet = NULL;
+    }
+  }
+#endif
   if(handle->packet != NULL) {
     ctimer_set(&handle->packet->lifetimer, lifetime,
                packet_timedout, handle);
@@ -59,15 +82,18 @@ uip_packetqueue_free(struct uip_packetqueue_handle *handle)
   PRINTF("uip_packetqueue_free %p\n", handle);
   if(handle->packet != NULL) {
     ctimer_stop(&handle->packet->lifetimer);
-    memb_free(&packets_memb, handle->packet);
-    handle->packet = NULL;
+    packet_release(handle);
   }
 }
 /*---------------------------------------------------------------------------*/
 uint8_t *
 uip_packetqueue_buf(struct uip_packetqueue_handle *h)
 {
+#if UIP_BUF_POOL_SIZE > 0
+  return h->packet != NULL? h->packet->queue_buf->u8: NULL;
+#else
   return h->packet != NULL? h->packet->queue_buf: NULL;
+#endif
 }
 /*---------------------------------------------------------------------------*/
 uint16_t
@@ -84,3 +110,55 @@ uip_packetqueue_set_buflen(struct uip_packetqueue_handle *h, uint16_t len)
   }
 }
 /*---------------------------------------------------------------------------*/
+struct uip_packetqueue_packet *
+uip_packetqueue_put(struct uip_packetqueue_handle *h, clock_time_t lifetime)
+{
+#if UIP_BUF_POOL_SIZE > 0
+  uip_buf_t *buf;
+
+  if(h->packet != NULL) {
+    return NULL;
+  }
+  h->packet = memb_alloc(&packets_memb);
+  if(h->packet == NULL) {
+    PRINTF("uip_packetqueue_put failed\n");
+    return NULL;
+  }
+  buf = uipbuf_pool_detach();
+  if(buf == NULL) {
+    PRINTF("uip_packetqueue_put no free uip buffer\n");
+    memb_free(&packets_memb, h->packet);
+    h->packet = NULL;
+    return NULL;
+  }
+  h->packet->queue_buf = buf;
+  ctimer_set(&h->packet->lifetimer, lifetime, packet_timedout, h);
+#else /* UIP_BUF_POOL_SIZE > 0 */
+  if(uip_packetqueue_alloc(h, lifetime) == NULL) {
+    return NULL;
+  }
+  memcpy(h->packet->queue_buf, uip_buf, uip_len);
+#endif /* UIP_BUF_POOL_SIZE > 0 */
+  h->packet->queue_buf_len = uip_len;
+  return h->packet;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_packetqueue_get(struct uip_packetqueue_handle *h)
+{
+  if(h->packet == NULL || h->packet->queue_buf_len == 0) {
+    return 0;
+  }
+  ctimer_stop(&h->packet->lifetimer);
+#if UIP_BUF_POOL_SIZE > 0
+  /* The queued buffer becomes uip_buf, the current one goes back */
+  uipbuf_pool_attach(h->packet->queue_buf);
+  h->packet->queue_buf = NULL;
+#else /* UIP_BUF_POOL_SIZE > 0 */
+  memcpy(uip_buf, h->packet->queue_buf, h->packet->queue_buf_len);
+#endif /* UIP_BUF_POOL_SIZE > 0 */
+  uip_len = h->packet->queue_buf_len;
+  packet_release(h);
+  return uip_len;
+}
+/*---------------------------------------------------------------------------*/
@@ -1,13 +1,18 @@
 #ifndef UIP_PACKETQUEUE_H
 #define UIP_PACKETQUEUE_H
 
+#include "net/ipv6/uip.h"
 #include "sys/ctimer.h"
 
 struct uip_packetqueue_handle;
 
 struct uip_packetqueue_packet {
   struct uip_ds6_queued_packet *next;
+#if UIP_BUF_POOL_SIZE > 0
+  uip_buf_t *queue_buf;
+#else /* UIP_BUF_POOL_SIZE > 0 */
   uint8_t queue_buf[UIP_BUFSIZE];
+#endif /* UIP_BUF_POOL_SIZE > 0 */
   uint16_t queue_buf_len;
   struct ctimer lifetimer;
   struct uip_packetqueue_handle *handle;
@@ -31,5 +36,20 @@ uint8_t *uip_packetqueue_buf(struct uip_packetqueue_handle *h);
 uint16_t uip_packetqueue_buflen(struct uip_packetqueue_handle *h);
 void uip_packetqueue_set_buflen(struct uip_packetqueue_handle *h, uint16_t len);
 
+/**
+ * Queue the packet in uip_buf. With a uIP buffer pool the current
+ * buffer is handed over to the queue instead of being copied, and
+ * uip_buf continues in a fresh buffer. Returns NULL if the handle
+ * already holds a packet or no memory is available.
+ */
+struct uip_packetqueue_packet *
+uip_packetqueue_put(struct uip_packetqueue_handle *h, clock_time_t lifetime);
+
+/**
+ * Move the queued packet back into uip_buf, set uip_len and free the
+ * queue entry. Returns the packet length, or 0 if nothing was queued.
+ */
+uint16_t uip_packetqueue_get(struct uip_packetqueue_handle *h);
+
 
 #endif /* UIP_PACKETQUEUE_H */
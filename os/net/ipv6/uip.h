@@ -497,17 +497,27 @@ void uip_reass_over(void);
  * packets. The device driver should place incoming data into this
  * buffer. When sending data, the device driver should read the
  * outgoing data from this buffer.
+ *
+ * With UIP_CONF_BUF_POOL_SIZE set, uip_buf instead refers to the
+ * current buffer of the uipbuf pool, see uipbuf_pool_detach().
 */
 
-typedef union {
+typedef union uip_buf_data {
   uint32_t u32[(UIP_BUFSIZE + 3) / 4];
   uint8_t u8[UIP_BUFSIZE];
 } uip_buf_t;
 
+#if UIP_BUF_POOL_SIZE > 0
+extern uip_buf_t *uip_current_buf;
+
+/** Macro to access the current pool buffer as an array of bytes */
+#define uip_buf (uip_current_buf->u8)
+#else /* UIP_BUF_POOL_SIZE > 0 */
 extern uip_buf_t uip_aligned_buf;
 
 /** Macro to access uip_aligned_buf as an array of bytes */
 #define uip_buf (uip_aligned_buf.u8)
+#endif /* UIP_BUF_POOL_SIZE > 0 */
 
 
 /** @} */
@@ -819,7 +829,9 @@ void uip_send(const void *data, int len);
  * The current maximum segment size that can be sent on the
  * connection is computed from the receiver's window and the MSS of
  * the connection (which also is available by calling
- * uip_initialmss()).
+ * uip_initialmss()). With UIP_TCP_SLIDING_WINDOW it is also bounded
+ * by the free space in the window, and 0 while no new data can be
+ * sent.
  *
  * \hideinitializer
  */
@@ -1341,6 +1353,15 @@ struct uip_conn {
   uint8_t timer;         /**< The retransmission timer. */
   uint8_t nrtx;          /**< The number of retransmissions for the last
                               segment sent. */
+#if UIP_TCP_SLIDING_WINDOW
+  uint16_t sent;         /**< How much of the outstanding data has been
+                              sent since the last retransmission timeout. */
+  uint16_t snd_wnd;      /**< The window advertised by the remote host. */
+  uint16_t sndbuf_start; /**< Start of the outstanding data in sndbuf. */
+  uint8_t ack_pending;   /**< Data segments received but not acknowledged. */
+  uint8_t close_pending; /**< Close once all data has been acknowledged. */
+  uint8_t sndbuf[UIP_TCP_SEND_WINDOW]; /**< The retransmission buffer. */
+#endif /* UIP_TCP_SLIDING_WINDOW */
   uip_tcp_appstate_t appstate; /** The application state. */
 };
 
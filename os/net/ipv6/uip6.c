@@ -141,7 +141,9 @@ uint8_t uip_last_proto = 0;
  */
 /** Packet buffer for incoming and outgoing packets */
 #ifndef UIP_CONF_EXTERNAL_BUFFER
+#if UIP_BUF_POOL_SIZE == 0
 uip_buf_t uip_aligned_buf;
+#endif /* UIP_BUF_POOL_SIZE == 0 */
 #endif /* UIP_CONF_EXTERNAL_BUFFER */
 
 /* The uip_appdata pointer points to application data. */
@@ -274,6 +276,66 @@ uip_add32(uint8_t *op32, uint16_t op16)
     }
   }
 }
+#if UIP_TCP_SLIDING_WINDOW
+/*---------------------------------------------------------------------------*/
+static uint32_t
+seq32(const uint8_t *seq)
+{
+  return ((uint32_t)seq[0] << 24) | ((uint32_t)seq[1] << 16) |
+    ((uint32_t)seq[2] << 8) | seq[3];
+}
+/*---------------------------------------------------------------------------*/
+static void
+reset_window(struct uip_conn *conn)
+{
+  conn->sent = 0;
+  conn->snd_wnd = 0;
+  conn->sndbuf_start = 0;
+  conn->ack_pending = 0;
+  conn->close_pending = 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Copies between linear memory and the retransmission buffer, a ring */
+static void
+sndbuf_copy(struct uip_conn *conn, uint16_t offset, uint8_t *data,
+            uint16_t len, bool to_sndbuf)
+{
+  uint16_t pos, first;
+
+  pos = (conn->sndbuf_start + offset) % UIP_TCP_SEND_WINDOW;
+  first = MIN(len, UIP_TCP_SEND_WINDOW - pos);
+  if(to_sndbuf) {
+    memcpy(&conn->sndbuf[pos], data, first);
+    memcpy(conn->sndbuf, data + first, len - first);
+  } else {
+    memcpy(data, &conn->sndbuf[pos], first);
+    memcpy(data + first, conn->sndbuf, len - first);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Sets conn->mss to how much new data the application may send now */
+static void
+update_send_room(struct uip_conn *conn)
+{
+  uint16_t wnd;
+
+  wnd = MIN(conn->snd_wnd, UIP_TCP_SEND_WINDOW);
+  if(conn->sent < conn->len || conn->close_pending) {
+    /* Data to retransmit goes first */
+    conn->mss = 0;
+  } else if(conn->len == 0) {
+    /* A zero window is probed with a full segment, as without the
+       sliding window */
+    conn->mss = wnd == 0 ? conn->initialmss : MIN(conn->initialmss, wnd);
+  } else if(wnd > conn->len &&
+            wnd - conn->len >= MIN(conn->initialmss, wnd / 2)) {
+    conn->mss = MIN(conn->initialmss, wnd - conn->len);
+  } else {
+    /* Avoid trickling out small segments into a nearly full window */
+    conn->mss = 0;
+  }
+}
+#endif /* UIP_TCP_SLIDING_WINDOW */
 #endif /* UIP_TCP */
 
 #if ! UIP_ARCH_CHKSUM
@@ -484,6 +546,9 @@ uip_connect(const uip_ipaddr_t *ripaddr, uint16_t rport)
   conn->lport = uip_htons(lastport);
   conn->rport = rport;
   uip_ipaddr_copy(&conn->ripaddr, ripaddr);
+#if UIP_TCP_SLIDING_WINDOW
+  reset_window(conn);
+#endif /* UIP_TCP_SLIDING_WINDOW */
 
   return conn;
 }
@@ -956,6 +1021,11 @@ uip_process(uint8_t flag)
   uint16_t tmp16;
   uint8_t opt;
   register struct uip_conn *uip_connr = uip_conn;
+#if UIP_TCP_SLIDING_WINDOW
+  /* Offset of a data segment from the oldest unacknowledged byte */
+  int32_t seq_offset = -1;
+  uint32_t acked;
+#endif /* UIP_TCP_SLIDING_WINDOW */
 #endif /* UIP_TCP */
 #if UIP_UDP
   if(flag == UIP_UDP_SEND_CONN) {
@@ -968,11 +1038,19 @@ uip_process(uint8_t flag)
      particular connection. */
   if(flag == UIP_POLL_REQUEST) {
 #if UIP_TCP
+#if UIP_TCP_SLIDING_WINDOW
+    if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED) {
+      /* The application may send whenever there is room in the window */
+      uip_flags = UIP_POLL;
+      uip_slen = 0;
+      goto tcp_appcall;
+#else /* UIP_TCP_SLIDING_WINDOW */
     if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
        !uip_outstanding(uip_connr)) {
       uip_flags = UIP_POLL;
       UIP_APPCALL();
       goto appsend;
+#endif /* UIP_TCP_SLIDING_WINDOW */
 #if UIP_ACTIVE_OPEN
     } else if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_SYN_SENT) {
       /* In the SYN_SENT state, we retransmit out SYN. */
@@ -1065,6 +1143,16 @@ uip_process(uint8_t flag)
 #endif /* UIP_ACTIVE_OPEN */
 
           case UIP_ESTABLISHED:
+#if UIP_TCP_SLIDING_WINDOW
+            /*
+             * Go back to the oldest unacknowledged byte and resend
+             * from the retransmission buffer. The rest follows as
+             * ACKs come in.
+             */
+            uip_connr->sent = 0;
+            uip_flags = 0;
+            goto tcp_send_sndbuf;
+#else /* UIP_TCP_SLIDING_WINDOW */
             /*
              * In the ESTABLISHED state, we call upon the application
              * to do the actual retransmit after which we jump into
@@ -1074,6 +1162,7 @@ uip_process(uint8_t flag)
             uip_flags = UIP_REXMIT;
             UIP_APPCALL();
             goto apprexmit;
+#endif /* UIP_TCP_SLIDING_WINDOW */
 
           case UIP_FIN_WAIT_1:
           case UIP_CLOSING:
@@ -1082,6 +1171,17 @@ uip_process(uint8_t flag)
             goto tcp_send_finack;
           }
         }
+#if UIP_TCP_SLIDING_WINDOW
+      }
+      if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED) {
+        /*
+         * If there was no need for a retransmission, we poll the
+         * application for new data, which also sends a delayed ACK.
+         */
+        uip_flags = UIP_POLL;
+        goto tcp_appcall;
+      }
+#else /* UIP_TCP_SLIDING_WINDOW */
       } else if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED) {
         /*
          * If there was no need for a retransmission, we poll the
@@ -1091,6 +1191,7 @@ uip_process(uint8_t flag)
         UIP_APPCALL();
         goto appsend;
       }
+#endif /* UIP_TCP_SLIDING_WINDOW */
     }
     goto drop;
 #endif /* UIP_TCP */
@@ -1752,6 +1853,9 @@ uip_process(uint8_t flag)
   uip_connr->rport = UIP_TCP_BUF->srcport;
   uip_ipaddr_copy(&uip_connr->ripaddr, &UIP_IP_BUF->srcipaddr);
   uip_connr->tcpstateflags = UIP_SYN_RCVD;
+#if UIP_TCP_SLIDING_WINDOW
+  reset_window(uip_connr);
+#endif /* UIP_TCP_SLIDING_WINDOW */
 
   uip_connr->snd_nxt[0] = iss[0];
   uip_connr->snd_nxt[1] = iss[1];
@@ -1887,6 +1991,39 @@ uip_process(uint8_t flag)
      the outstanding data, calculate RTT estimations, and reset the
      retransmission timer. */
   if((UIP_TCP_BUF->flags & TCP_ACK) && uip_outstanding(uip_connr)) {
+#if UIP_TCP_SLIDING_WINDOW
+    /* In the window, any ACK for data sent so far acknowledges part
+       of it */
+    acked = seq32(UIP_TCP_BUF->ackno) - seq32(uip_connr->snd_nxt);
+    if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED) {
+      if(acked > 0 && acked <= uip_connr->len) {
+        uip_add32(uip_connr->snd_nxt, acked);
+        memcpy(uip_connr->snd_nxt, uip_acc32, 4);
+
+        if(uip_connr->nrtx == 0) {
+          signed char m;
+          m = uip_connr->rto - uip_connr->timer;
+          m = m - (uip_connr->sa >> 3);
+          uip_connr->sa += m;
+          if(m < 0) {
+            m = -m;
+          }
+          m = m - (uip_connr->sv >> 2);
+          uip_connr->sv += m;
+          uip_connr->rto = (uip_connr->sa >> 3) + uip_connr->sv;
+        }
+        uip_flags = UIP_ACKDATA;
+        uip_connr->timer = uip_connr->rto;
+        uip_connr->nrtx = 0;
+
+        uip_connr->sndbuf_start =
+          (uip_connr->sndbuf_start + acked) % UIP_TCP_SEND_WINDOW;
+        uip_connr->len -= acked;
+        uip_connr->sent = acked < uip_connr->sent ? uip_connr->sent - acked : 0;
+      }
+      goto tcp_acked;
+    }
+#endif /* UIP_TCP_SLIDING_WINDOW */
     uip_add32(uip_connr->snd_nxt, uip_connr->len);
 
     if(UIP_TCP_BUF->ackno[0] == uip_acc32[0] &&
@@ -1924,6 +2061,9 @@ uip_process(uint8_t flag)
     }
 
   }
+#if UIP_TCP_SLIDING_WINDOW
+  tcp_acked:
+#endif /* UIP_TCP_SLIDING_WINDOW */
 
   /* Do different things depending on in what state the connection is. */
   switch(uip_connr->tcpstateflags & UIP_TS_MASK) {
@@ -1945,6 +2085,11 @@ uip_process(uint8_t flag)
         uip_add_rcv_nxt(uip_len);
       }
       uip_slen = 0;
+#if UIP_TCP_SLIDING_WINDOW
+      uip_connr->snd_wnd = ((uint16_t)UIP_TCP_BUF->wnd[0] << 8) +
+        (uint16_t)UIP_TCP_BUF->wnd[1];
+      update_send_room(uip_connr);
+#endif /* UIP_TCP_SLIDING_WINDOW */
       UIP_APPCALL();
       goto appsend;
     }
@@ -2002,6 +2147,11 @@ uip_process(uint8_t flag)
       uip_add_rcv_nxt(1);
       uip_flags = UIP_CONNECTED | UIP_NEWDATA;
       uip_connr->len = 0;
+#if UIP_TCP_SLIDING_WINDOW
+      uip_connr->snd_wnd = ((uint16_t)UIP_TCP_BUF->wnd[0] << 8) +
+        (uint16_t)UIP_TCP_BUF->wnd[1];
+      update_send_room(uip_connr);
+#endif /* UIP_TCP_SLIDING_WINDOW */
       uipbuf_clear();
       uip_slen = 0;
       UIP_APPCALL();
@@ -2093,11 +2243,15 @@ uip_process(uint8_t flag)
          "persistent timer" and uses the retransmission mechanim.
      */
     tmp16 = ((uint16_t)UIP_TCP_BUF->wnd[0] << 8) + (uint16_t)UIP_TCP_BUF->wnd[1];
+#if UIP_TCP_SLIDING_WINDOW
+    uip_connr->snd_wnd = tmp16;
+#else /* UIP_TCP_SLIDING_WINDOW */
     if(tmp16 > uip_connr->initialmss ||
         tmp16 == 0) {
       tmp16 = uip_connr->initialmss;
     }
     uip_connr->mss = tmp16;
+#endif /* UIP_TCP_SLIDING_WINDOW */
 
     /* If this packet constitutes an ACK for outstanding data (flagged
          by the UIP_ACKDATA flag, we should call the application since it
@@ -2117,7 +2271,15 @@ uip_process(uint8_t flag)
          send, uip_len must be set to 0. */
     if(uip_flags & (UIP_NEWDATA | UIP_ACKDATA)) {
       uip_slen = 0;
+#if UIP_TCP_SLIDING_WINDOW
+      tcp_appcall:
+      update_send_room(uip_connr);
+      if(!uip_connr->close_pending) {
+        UIP_APPCALL();
+      }
+#else /* UIP_TCP_SLIDING_WINDOW */
       UIP_APPCALL();
+#endif /* UIP_TCP_SLIDING_WINDOW */
 
       appsend:
 
@@ -2128,8 +2290,21 @@ uip_process(uint8_t flag)
         goto tcp_send_nodata;
       }
 
+#if UIP_TCP_SLIDING_WINDOW
+      if((uip_flags & UIP_CLOSE) && uip_outstanding(uip_connr)) {
+        /* Send the FIN once all data has been acknowledged */
+        uip_connr->close_pending = 1;
+        uip_flags &= ~UIP_CLOSE;
+        uip_slen = 0;
+      }
+#endif /* UIP_TCP_SLIDING_WINDOW */
+
       if(uip_flags & UIP_CLOSE) {
         uip_slen = 0;
+#if UIP_TCP_SLIDING_WINDOW
+        tcp_send_fin:
+        uip_connr->close_pending = 0;
+#endif /* UIP_TCP_SLIDING_WINDOW */
         uip_connr->len = 1;
         uip_connr->tcpstateflags = UIP_FIN_WAIT_1;
         uip_connr->nrtx = 0;
@@ -2137,6 +2312,57 @@ uip_process(uint8_t flag)
         goto tcp_send_nodata;
       }
 
+#if UIP_TCP_SLIDING_WINDOW
+      /* New data is sent right away and kept for retransmission */
+      if(uip_slen > 0 && uip_connr->mss > 0) {
+        if(uip_slen > uip_connr->mss) {
+          uip_slen = uip_connr->mss;
+        }
+        sndbuf_copy(uip_connr, uip_connr->len, uip_sappdata, uip_slen, true);
+        if(uip_connr->len == 0) {
+          uip_connr->timer = uip_connr->rto;
+        }
+        seq_offset = uip_connr->len;
+        uip_connr->len += uip_slen;
+        uip_connr->sent = uip_connr->len;
+        uip_len = uip_slen + UIP_IPTCPH_LEN;
+        UIP_TCP_BUF->flags = TCP_ACK | TCP_PSH;
+        goto tcp_send_noopts;
+      }
+
+      if(uip_connr->close_pending && !uip_outstanding(uip_connr)) {
+        goto tcp_send_fin;
+      }
+
+      /* Resend what is left after a retransmission timeout, within the
+         window of the remote host */
+      tcp_send_sndbuf:
+      if(uip_connr->sent < uip_connr->len &&
+         (uip_connr->sent == 0 || uip_connr->sent < uip_connr->snd_wnd)) {
+        uip_slen = MIN(uip_connr->len - uip_connr->sent, uip_connr->initialmss);
+        sndbuf_copy(uip_connr, uip_connr->sent, uip_sappdata, uip_slen, false);
+        seq_offset = uip_connr->sent;
+        uip_connr->sent += uip_slen;
+        uip_len = uip_slen + UIP_IPTCPH_LEN;
+        UIP_TCP_BUF->flags = TCP_ACK | TCP_PSH;
+        goto tcp_send_noopts;
+      }
+
+      /* Acknowledge every second data segment at once, and the
+         others on the next periodic timer tick. A segment that leaves
+         no room in our window for another is acknowledged at once, as
+         the remote host cannot send more before it gets the ACK. */
+      if((uip_flags & UIP_NEWDATA) &&
+         (!UIP_TCP_DELAYED_ACK || 2 * uip_len > UIP_RECEIVE_WINDOW ||
+          ++uip_connr->ack_pending >= 2)) {
+        goto tcp_send_ack;
+      }
+      if(uip_connr->ack_pending && (uip_flags & UIP_POLL)) {
+        goto tcp_send_ack;
+      }
+      goto drop;
+#else /* UIP_TCP_SLIDING_WINDOW */
+
       /* If uip_slen > 0, the application has data to be sent. */
       if(uip_slen > 0) {
 
@@ -2190,6 +2416,7 @@ uip_process(uint8_t flag)
         UIP_TCP_BUF->flags = TCP_ACK;
         goto tcp_send_noopts;
       }
+#endif /* UIP_TCP_SLIDING_WINDOW */
     }
     goto drop;
   case UIP_LAST_ACK:
@@ -2282,10 +2509,20 @@ uip_process(uint8_t flag)
   UIP_TCP_BUF->ackno[2] = uip_connr->rcv_nxt[2];
   UIP_TCP_BUF->ackno[3] = uip_connr->rcv_nxt[3];
 
+#if UIP_TCP_SLIDING_WINDOW
+  /* Segments other than data carry the next new sequence number */
+  uip_add32(uip_connr->snd_nxt,
+            seq_offset >= 0 ? seq_offset : uip_connr->sent);
+  memcpy(UIP_TCP_BUF->seqno, uip_acc32, 4);
+  if(UIP_TCP_BUF->flags & TCP_ACK) {
+    uip_connr->ack_pending = 0;
+  }
+#else /* UIP_TCP_SLIDING_WINDOW */
   UIP_TCP_BUF->seqno[0] = uip_connr->snd_nxt[0];
   UIP_TCP_BUF->seqno[1] = uip_connr->snd_nxt[1];
   UIP_TCP_BUF->seqno[2] = uip_connr->snd_nxt[2];
   UIP_TCP_BUF->seqno[3] = uip_connr->snd_nxt[3];
+#endif /* UIP_TCP_SLIDING_WINDOW */
 
   UIP_TCP_BUF->srcport  = uip_connr->lport;
   UIP_TCP_BUF->destport = uip_connr->rport;
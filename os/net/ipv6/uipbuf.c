@@ -32,6 +32,7 @@
 #include "contiki.h"
 #include "net/ipv6/uip.h"
 #include "net/ipv6/uipbuf.h"
+#include "net/ipv6/uip-icmp6.h"
 #include <string.h>
 
 /*---------------------------------------------------------------------------*/
@@ -39,6 +40,13 @@
 static uint16_t uipbuf_attrs[UIPBUF_ATTR_MAX];
 static uint16_t uipbuf_default_attrs[UIPBUF_ATTR_MAX];
 
+#if UIP_BUF_POOL_SIZE > 0
+static uip_buf_t uipbuf_pool[UIP_BUF_POOL_SIZE];
+/* The first buffer is current from the start */
+static bool uipbuf_pool_used[UIP_BUF_POOL_SIZE] = { true };
+uip_buf_t *uip_current_buf = &uipbuf_pool[0];
+#endif /* UIP_BUF_POOL_SIZE > 0 */
+
 /*---------------------------------------------------------------------------*/
 void
 uipbuf_clear(void)
@@ -182,6 +190,50 @@ uipbuf_search_header(uint8_t *buffer, uint16_t size, uint8_t protocol)
  *
  */
 /*---------------------------------------------------------------------------*/
+#if ENERGEST_TAGS
+/* The well-known CoAP ports, without depending on the CoAP stack */
+#define COAP_PORT        5683
+#define COAP_SECURE_PORT 5684
+
+static bool
+is_coap_port(uint16_t port)
+{
+  return port == UIP_HTONS(COAP_PORT) || port == UIP_HTONS(COAP_SECURE_PORT);
+}
+/*---------------------------------------------------------------------------*/
+energest_tag_t
+uipbuf_energest_tag(void)
+{
+  uint8_t *header;
+  uint8_t protocol;
+  struct uip_udp_hdr *udp;
+
+  header = uipbuf_get_last_header(uip_buf, uip_len, &protocol);
+  if(header != NULL && protocol == UIP_PROTO_ICMP6) {
+    switch(((struct uip_icmp_hdr *)header)->type) {
+    case ICMP6_RPL:
+      return ENERGEST_TAG_ROUTING;
+    case ICMP6_RS:
+    case ICMP6_RA:
+    case ICMP6_NS:
+    case ICMP6_NA:
+    case ICMP6_REDIRECT:
+      return ENERGEST_TAG_ND;
+    }
+  } else if(header != NULL && protocol == UIP_PROTO_UDP) {
+    udp = (struct uip_udp_hdr *)header;
+    if(is_coap_port(udp->srcport) || is_coap_port(udp->destport)) {
+      return ENERGEST_TAG_COAP;
+    }
+  }
+
+  if(energest_current_tag[ENERGEST_TYPE_CPU] != ENERGEST_TAG_OTHER) {
+    return energest_current_tag[ENERGEST_TYPE_CPU];
+  }
+  return ENERGEST_TAG_APP;
+}
+#endif /* ENERGEST_TAGS */
+/*---------------------------------------------------------------------------*/
 uint16_t
 uipbuf_get_attr(uint8_t type)
 {
@@ -251,3 +303,72 @@ uipbuf_init(void)
 }
 
 /*---------------------------------------------------------------------------*/
+#if UIP_BUF_POOL_SIZE > 0
+uip_buf_t *
+uipbuf_pool_alloc(void)
+{
+  int i;
+
+  for(i = 0; i < UIP_BUF_POOL_SIZE; i++) {
+    if(!uipbuf_pool_used[i]) {
+      uipbuf_pool_used[i] = true;
+      return &uipbuf_pool[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+void
+uipbuf_pool_free(uip_buf_t *buf)
+{
+  if(buf == NULL || buf == uip_current_buf ||
+     buf < uipbuf_pool || buf >= &uipbuf_pool[UIP_BUF_POOL_SIZE]) {
+    return;
+  }
+  uipbuf_pool_used[buf - uipbuf_pool] = false;
+}
+/*---------------------------------------------------------------------------*/
+uip_buf_t *
+uipbuf_pool_detach(void)
+{
+  uip_buf_t *fresh;
+  uip_buf_t *old;
+
+  fresh = uipbuf_pool_alloc();
+  if(fresh == NULL) {
+    return NULL;
+  }
+  old = uip_current_buf;
+  uip_current_buf = fresh;
+  return old;
+}
+/*---------------------------------------------------------------------------*/
+void
+uipbuf_pool_attach(uip_buf_t *buf)
+{
+  uip_buf_t *old;
+
+  if(buf == NULL || buf == uip_current_buf) {
+    return;
+  }
+  old = uip_current_buf;
+  uip_current_buf = buf;
+  uipbuf_pool_free(old);
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+uipbuf_pool_num_free(void)
+{
+  uint8_t count;
+  int i;
+
+  count = 0;
+  for(i = 0; i < UIP_BUF_POOL_SIZE; i++) {
+    if(!uipbuf_pool_used[i]) {
+      count++;
+    }
+  }
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* UIP_BUF_POOL_SIZE > 0 */
@@ -34,7 +34,9 @@
 #define UIPBUF_H_
 
 #include "contiki.h"
+#include "sys/energest.h"
 struct uip_ip_hdr;
+union uip_buf_data;
 
 /**
  * \brief          Resets uIP buffer
@@ -104,6 +106,18 @@ uint8_t *uipbuf_get_last_header(uint8_t *buffer, uint16_t size, uint8_t *protoco
  */
 uint8_t *uipbuf_search_header(uint8_t *buffer, uint16_t size, uint8_t protocol);
 
+#if ENERGEST_TAGS
+/**
+ * \brief          Get the energest tag of the packet in the uIP buffer
+ * \retval         the tag of the subsystem that sends the packet
+ *
+ *                 RPL and ND messages and CoAP traffic are recognized by
+ *                 their headers. Other packets get the tag of the running
+ *                 process, or ENERGEST_TAG_APP if it has none.
+ */
+energest_tag_t uipbuf_energest_tag(void);
+#endif /* ENERGEST_TAGS */
+
 /**
  * \brief          Get the value of the attribute
  * \param type     The attribute to get the value of
@@ -178,6 +192,47 @@ void uipbuf_clear_attr(void);
  */
 void uipbuf_init(void);
 
+#if UIP_BUF_POOL_SIZE > 0
+/**
+ * \brief          Allocate a buffer from the uIP buffer pool.
+ * \retval         A free buffer, or NULL if the pool is exhausted
+ *
+ *                 A driver can fill the returned buffer while the stack
+ *                 is still busy with the current packet, and later make
+ *                 it current with uipbuf_pool_attach().
+ */
+union uip_buf_data *uipbuf_pool_alloc(void);
+
+/**
+ * \brief          Return a buffer to the uIP buffer pool.
+ * \param buf      The buffer. Freeing the current buffer is a no-op.
+ */
+void uipbuf_pool_free(union uip_buf_data *buf);
+
+/**
+ * \brief          Hand over the current buffer and continue in a fresh one.
+ * \retval         The buffer holding the current packet, or NULL if no
+ *                 free buffer was available (uip_buf is then unchanged)
+ *
+ *                 The caller owns the returned buffer until it passes it
+ *                 to uipbuf_pool_attach() or uipbuf_pool_free(). The
+ *                 uip_len and other packet variables are left untouched.
+ */
+union uip_buf_data *uipbuf_pool_detach(void);
+
+/**
+ * \brief          Make a buffer current and free the previous current one.
+ * \param buf      A buffer obtained from uipbuf_pool_alloc() or
+ *                 uipbuf_pool_detach()
+ */
+void uipbuf_pool_attach(union uip_buf_data *buf);
+
+/**
+ * \brief          Get the number of free buffers in the uIP buffer pool.
+ */
+uint8_t uipbuf_pool_num_free(void);
+#endif /* UIP_BUF_POOL_SIZE > 0 */
+
 /**
  * \brief The bits defined for uipbuf attributes flag.
  *
@@ -136,6 +136,23 @@
 #define UIP_BUFSIZE (UIP_CONF_BUFFER_SIZE)
 #endif /* UIP_CONF_BUFFER_SIZE */
 
+/**
+ * The number of uIP packet buffers.
+ *
+ * When set to zero (the default), uip_buf is a single static buffer.
+ * When larger than zero, uip_buf refers to the current buffer of a
+ * pool of this many buffers. A packet can then be parked, e.g. while
+ * waiting for address resolution, by handing over the current buffer
+ * and continuing in a fresh one instead of copying it.
+ *
+ * \hideinitializer
+ */
+#ifndef UIP_CONF_BUF_POOL_SIZE
+#define UIP_BUF_POOL_SIZE 0
+#else /* UIP_CONF_BUF_POOL_SIZE */
+#define UIP_BUF_POOL_SIZE (UIP_CONF_BUF_POOL_SIZE)
+#endif /* UIP_CONF_BUF_POOL_SIZE */
+
 /**
  * Determines if statistics support should be compiled in.
  *
@@ -440,6 +457,53 @@ void uip_log(char *msg);
 #define UIP_RECEIVE_WINDOW (UIP_CONF_RECEIVE_WINDOW)
 #endif
 
+/**
+ * Toggles the sliding-window mode of uIP TCP.
+ *
+ * By default a connection has at most one unacknowledged segment in
+ * flight and the application regenerates its data on a
+ * retransmission. In the sliding-window mode, uIP keeps the sent data
+ * in a per-connection retransmission buffer of UIP_TCP_SEND_WINDOW
+ * bytes, so that several segments may be in flight. The application
+ * is polled while there is room in the window, uip_mss() tells how
+ * much it may send, and it is never asked to retransmit.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_SLIDING_WINDOW
+#define UIP_TCP_SLIDING_WINDOW (UIP_CONF_TCP_SLIDING_WINDOW)
+#else
+#define UIP_TCP_SLIDING_WINDOW 0
+#endif
+
+/**
+ * The size of the per-connection retransmission buffer, and the
+ * maximum amount of unacknowledged data, in the sliding-window mode.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_SEND_WINDOW
+#define UIP_TCP_SEND_WINDOW (UIP_CONF_TCP_SEND_WINDOW)
+#else
+#define UIP_TCP_SEND_WINDOW (2 * UIP_TCP_MSS)
+#endif
+#if UIP_TCP_SLIDING_WINDOW && UIP_TCP_SEND_WINDOW < UIP_TCP_MSS
+#error UIP_CONF_TCP_SEND_WINDOW must hold at least one UIP_TCP_MSS segment
+#endif
+
+/**
+ * Delay pure ACKs in the sliding-window mode: every second data
+ * segment is acknowledged at once, a single one on the next periodic
+ * TCP timer tick at the latest, unless data is sent first.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_DELAYED_ACK
+#define UIP_TCP_DELAYED_ACK (UIP_CONF_TCP_DELAYED_ACK)
+#else
+#define UIP_TCP_DELAYED_ACK UIP_TCP_SLIDING_WINDOW
+#endif
+
 /**
  * How long a connection should stay in the TIME_WAIT state.
  *
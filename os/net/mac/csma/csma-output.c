@@ -190,6 +190,13 @@ send_one_packet(struct neighbor_queue *n, struct packet_queue *q)
     uint8_t dsn;
     dsn = ((uint8_t *)packetbuf_hdrptr())[2] & 0xff;
 
+#if ENERGEST_TAGS
+    /* Frames without a tag are sent by the MAC layer itself. The time
+       until the ACK is received counts for the frame as well. */
+    ENERGEST_TAG_RADIO(packetbuf_attr(PACKETBUF_ATTR_ENERGEST_TAG) != ENERGEST_TAG_OTHER ?
+                       packetbuf_attr(PACKETBUF_ATTR_ENERGEST_TAG) : ENERGEST_TAG_MAC);
+#endif /* ENERGEST_TAGS */
+
     NETSTACK_RADIO.prepare(packetbuf_hdrptr(), packetbuf_totlen());
 
     is_broadcast = packetbuf_holds_broadcast();
@@ -249,6 +256,9 @@ send_one_packet(struct neighbor_queue *n, struct packet_queue *q)
     last_sent_ok = 1;
   }
 
+  /* Idle listening is not caused by any frame */
+  ENERGEST_TAG_RADIO(ENERGEST_TAG_OTHER);
+
   packet_sent(n, q, ret, 1);
   return last_sent_ok;
 }
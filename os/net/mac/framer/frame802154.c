@@ -132,6 +132,82 @@ frame802154_set_pan_id(uint16_t pan_id)
 {
   mac_pan_id = pan_id;
 }
+#if FRAME802154_LAYOUT_TABLE
+/*----------------------------------------------------------------------------*/
+/*
+ * Header layout for every combination of the FCF bits that determine it:
+ * b0: ACK frame, b1: PAN ID compression, b2-3: destination address mode,
+ * b4-5: frame version, b6-7: source address mode.
+ * Each entry holds b0: destination PAN ID present, b1: source PAN ID
+ * present, b2-7: total length of the addressing fields.
+ * The PAN ID rules are the same as in the non-table frame802154_has_panid()
+ * (IEEE 802.15.4-2015 Table 7-2 for frame version 0b10).
+ */
+#define LAYOUT_DEST_PID(v, c, d, s, ack) \
+  ((v) == FRAME802154_IEEE802154_2015 ? \
+   (((d) == 0 && (s) == 0 && (c) == 1) || \
+    ((d) != 0 && (s) == 0 && (c) == 0) || \
+    ((d) == 3 && (s) == 3 && (c) == 0) || \
+    ((d) == 2 && (s) != 0) || \
+    ((d) != 0 && (s) == 2)) : \
+   (!(ack) && (d) != 0))
+#define LAYOUT_SRC_PID(v, c, d, s, ack) \
+  ((v) == FRAME802154_IEEE802154_2015 ? \
+   ((c) == 0 && \
+    (((d) == 0 && (s) == 3) || ((d) == 0 && (s) == 2) || \
+     ((d) == 2 && (s) == 2) || ((d) == 2 && (s) == 3) || \
+     ((d) == 3 && (s) == 2))) : \
+   (!(ack) && !(c) && (s) != 0))
+#define LAYOUT_ADDR_LEN(m) ((m) == 2 ? 2 : ((m) == 3 ? 8 : 0))
+#define LAYOUT_ENTRY(v, c, d, s, ack) \
+  (LAYOUT_DEST_PID(v, c, d, s, ack) | \
+   LAYOUT_SRC_PID(v, c, d, s, ack) << 1 | \
+   (2 * LAYOUT_DEST_PID(v, c, d, s, ack) + LAYOUT_ADDR_LEN(d) + \
+    2 * LAYOUT_SRC_PID(v, c, d, s, ack) + LAYOUT_ADDR_LEN(s)) << 2)
+#define LAYOUT(i) LAYOUT_ENTRY(((i) >> 4) & 3, ((i) >> 1) & 1, \
+                               ((i) >> 2) & 3, ((i) >> 6) & 3, (i) & 1)
+#define LAYOUT4(i) LAYOUT(i), LAYOUT(i + 1), LAYOUT(i + 2), LAYOUT(i + 3)
+#define LAYOUT16(i) LAYOUT4(i), LAYOUT4(i + 4), LAYOUT4(i + 8), LAYOUT4(i + 12)
+#define LAYOUT64(i) LAYOUT16(i), LAYOUT16(i + 16), LAYOUT16(i + 32), LAYOUT16(i + 48)
+
+static const uint8_t layouts[256] = {
+  LAYOUT64(0), LAYOUT64(64), LAYOUT64(128), LAYOUT64(192)
+};
+
+#define LAYOUT_HAS_DEST_PID(l)  ((l) & 1)
+#define LAYOUT_HAS_SRC_PID(l)   (((l) >> 1) & 1)
+#define LAYOUT_ADDRS_LEN(l)     ((l) >> 2)
+/*----------------------------------------------------------------------------*/
+static uint8_t
+fcf_layout(const frame802154_fcf_t *fcf)
+{
+  return layouts[(fcf->src_addr_mode & 3) << 6 |
+                 (fcf->frame_version & 3) << 4 |
+                 (fcf->dest_addr_mode & 3) << 2 |
+                 (fcf->panid_compression & 1) << 1 |
+                 (fcf->frame_type == FRAME802154_ACKFRAME)];
+}
+/*----------------------------------------------------------------------------*/
+/* Tells whether a given Frame Control Field indicates a frame with
+ * source PANID and/or destination PANID */
+void
+frame802154_has_panid(frame802154_fcf_t *fcf, int *has_src_pan_id, int *has_dest_pan_id)
+{
+  uint8_t layout;
+
+  if(fcf == NULL) {
+    return;
+  }
+
+  layout = fcf_layout(fcf);
+  if(has_src_pan_id != NULL) {
+    *has_src_pan_id = LAYOUT_HAS_SRC_PID(layout);
+  }
+  if(has_dest_pan_id != NULL) {
+    *has_dest_pan_id = LAYOUT_HAS_DEST_PID(layout);
+  }
+}
+#else /* FRAME802154_LAYOUT_TABLE */
 /*----------------------------------------------------------------------------*/
 /* Tells whether a given Frame Control Field indicates a frame with
  * source PANID and/or destination PANID */
@@ -200,6 +276,7 @@ frame802154_has_panid(frame802154_fcf_t *fcf, int *has_src_pan_id, int *has_dest
     *has_dest_pan_id = dest_pan_id;
   }
 }
+#endif /* FRAME802154_LAYOUT_TABLE */
 /*---------------------------------------------------------------------------*/
 /* Check if the destination PAN ID, if any, matches ours */
 int
@@ -524,18 +601,32 @@ frame802154_parse(uint8_t *data, int len, frame802154_t *pf)
     p++;
   }
 
+#if FRAME802154_LAYOUT_TABLE
+  {
+    uint8_t layout = fcf_layout(&fcf);
+    /* Reject frames too short for their addressing fields before reading
+       them */
+    if(p - data + LAYOUT_ADDRS_LEN(layout) > len) {
+      return 0;
+    }
+    has_src_panid = LAYOUT_HAS_SRC_PID(layout);
+    has_dest_panid = LAYOUT_HAS_DEST_PID(layout);
+  }
+#else /* FRAME802154_LAYOUT_TABLE */
   frame802154_has_panid(&fcf, &has_src_panid, &has_dest_panid);
+#endif /* FRAME802154_LAYOUT_TABLE */
+
+  /* Destination PAN, if any. With frame version 0b10 it may be present
+     without a destination address (Table 7-2 in IEEE 802.15.4-2015) */
+  if(has_dest_panid) {
+    pf->dest_pid = p[0] + (p[1] << 8);
+    p += 2;
+  } else {
+    pf->dest_pid = 0;
+  }
 
   /* Destination address, if any */
   if(fcf.dest_addr_mode) {
-    if(has_dest_panid) {
-      /* Destination PAN */
-      pf->dest_pid = p[0] + (p[1] << 8);
-      p += 2;
-    } else {
-      pf->dest_pid = 0;
-    }
-
     /* Destination address */
 /*     l = addr_len(fcf.dest_addr_mode); */
 /*     for(c = 0; c < l; c++) { */
@@ -555,7 +646,6 @@ frame802154_parse(uint8_t *data, int len, frame802154_t *pf)
     }
   } else {
     linkaddr_copy((linkaddr_t *)&(pf->dest_addr), &linkaddr_null);
-    pf->dest_pid = 0;
   }
 
   /* Source address, if any */
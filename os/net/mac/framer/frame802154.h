@@ -92,6 +92,15 @@ frame-filtering-friendly on some platforms) */
 #define FRAME802154_SUPPR_SEQNO 0
 #endif /* FRAME802154_CONF_SUPPR_SEQNO */
 
+/* Look up PAN ID presence and addressing field length in a table indexed
+ * by the FCF bits instead of evaluating the PAN ID compression rules for
+ * every frame */
+#ifdef FRAME802154_CONF_LAYOUT_TABLE
+#define FRAME802154_LAYOUT_TABLE FRAME802154_CONF_LAYOUT_TABLE
+#else /* FRAME802154_CONF_LAYOUT_TABLE */
+#define FRAME802154_LAYOUT_TABLE 1
+#endif /* FRAME802154_CONF_LAYOUT_TABLE */
+
 /* Macros & Defines */
 
 /** \brief These are some definitions of values used in the FCF.  See the 802.15.4 spec for details.
@@ -480,6 +480,20 @@ frame802154e_parse_information_elements(const uint8_t *buf, uint8_t buf_size,
     return -1;
   }
 
+  /* Fast path for the IE list of enhanced ACKs: a single ACK/NACK time
+   * correction header IE and no payload IE. Parsed exactly as the generic
+   * loop below would. */
+  if(buf_size == 4 && buf[0] == 0x02 &&
+     buf[1] == (HEADER_IE_ACK_NACK_TIME_CORRECTION >> 1)) {
+    if(frame802154e_parse_header_ie(buf + 2, 2,
+                                    HEADER_IE_ACK_NACK_TIME_CORRECTION,
+                                    ies) == -1) {
+      return -1;
+    }
+    ies->ie_payload_ie_offset = 4;
+    return 4;
+  }
+
   /* Always look for a header IE first (at least "list termination 1") */
   parsing_state = PARSING_HEADER_IE;
   ies->ie_payload_ie_offset = 0;
@@ -280,6 +280,32 @@
 #define TSCH_MAX_INCOMING_PACKETS 4
 #endif
 
+/* Size of the ring buffer storing incoming packets while acting as
+ * coordinator. The root receives the bulk of the upward traffic and may
+ * need a deeper ring to absorb bursts. Must be power of two */
+#ifdef TSCH_CONF_MAX_INCOMING_PACKETS_ROOT
+#define TSCH_MAX_INCOMING_PACKETS_ROOT TSCH_CONF_MAX_INCOMING_PACKETS_ROOT
+#else
+#define TSCH_MAX_INCOMING_PACKETS_ROOT TSCH_MAX_INCOMING_PACKETS
+#endif
+
+/* Storage for incoming packets, large enough for either role */
+#if TSCH_MAX_INCOMING_PACKETS_ROOT > TSCH_MAX_INCOMING_PACKETS
+#define TSCH_INCOMING_PACKETS_ARRAY_SIZE TSCH_MAX_INCOMING_PACKETS_ROOT
+#else
+#define TSCH_INCOMING_PACKETS_ARRAY_SIZE TSCH_MAX_INCOMING_PACKETS
+#endif
+
+/* Maximum time, in rtimer ticks, spent passing incoming packets to the
+ * upper layers per poll of the pending events process. When exceeded, the
+ * process polls itself again so that other processes can run before the
+ * rest of the ring is drained. 0 for no limit */
+#ifdef TSCH_CONF_RX_PROCESS_BUDGET
+#define TSCH_RX_PROCESS_BUDGET TSCH_CONF_RX_PROCESS_BUDGET
+#else
+#define TSCH_RX_PROCESS_BUDGET (RTIMER_SECOND / 100)
+#endif
+
 /* The maximum number of outgoing packets towards each neighbor
  * Must be power of two to enable atomic ringbuf operations.
  * Note: the total number of outgoing packets in the system (for
@@ -353,6 +379,15 @@
 #define TSCH_SCHEDULE_MAX_LINKS 32
 #endif
 
+/* Max number of neighbors whose Tx link counters can be updated
+ * incrementally at the end of a schedule update batch. Larger batches
+ * fall back to recounting all links */
+#ifdef TSCH_SCHEDULE_CONF_BATCH_MAX_NBRS
+#define TSCH_SCHEDULE_BATCH_MAX_NBRS TSCH_SCHEDULE_CONF_BATCH_MAX_NBRS
+#else
+#define TSCH_SCHEDULE_BATCH_MAX_NBRS 8
+#endif
+
 /* To include Sixtop Implementation */
 #ifdef TSCH_CONF_WITH_SIXTOP
 #define TSCH_WITH_SIXTOP TSCH_CONF_WITH_SIXTOP
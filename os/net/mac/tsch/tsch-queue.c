@@ -75,6 +75,15 @@ NBR_TABLE(struct tsch_neighbor, tsch_neighbors);
 struct tsch_neighbor *n_broadcast;
 struct tsch_neighbor *n_eb;
 
+/*---------------------------------------------------------------------------*/
+/* Can the queues be accessed? Yes if TSCH is unlocked, or if the lock is
+ * held by a schedule update batch, e.g. when a schedule callback flushes
+ * the packets of a removed neighbor */
+static int
+queue_is_accessible(void)
+{
+  return !tsch_is_locked() || tsch_schedule_update_in_progress();
+}
 /*---------------------------------------------------------------------------*/
 /* Add a TSCH neighbor */
 struct tsch_neighbor *
@@ -109,7 +118,7 @@ tsch_queue_add_nbr(const linkaddr_t *addr)
 struct tsch_neighbor *
 tsch_queue_get_nbr(const linkaddr_t *addr)
 {
-  if(!tsch_is_locked()) {
+  if(queue_is_accessible()) {
     return (struct tsch_neighbor *)nbr_table_get_from_lladdr(tsch_neighbors, addr);
   }
   return NULL;
@@ -137,6 +146,24 @@ tsch_queue_get_nbr_address(const struct tsch_neighbor *n)
   return nbr_table_get_lladdr(tsch_neighbors, n);
 }
 /*---------------------------------------------------------------------------*/
+struct tsch_neighbor *
+tsch_queue_first_nbr(void)
+{
+  if(!tsch_is_locked()) {
+    return (struct tsch_neighbor *)nbr_table_head(tsch_neighbors);
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+struct tsch_neighbor *
+tsch_queue_next_nbr(struct tsch_neighbor *n)
+{
+  if(!tsch_is_locked()) {
+    return (struct tsch_neighbor *)nbr_table_next(tsch_neighbors, n);
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
 /* Update TSCH time source */
 int
 tsch_queue_update_time_source(const linkaddr_t *new_addr)
@@ -295,7 +322,7 @@ tsch_queue_nbr_packet_count(const struct tsch_neighbor *n)
 struct tsch_packet *
 tsch_queue_remove_packet_from_queue(struct tsch_neighbor *n)
 {
-  if(!tsch_is_locked()) {
+  if(queue_is_accessible()) {
     if(n != NULL) {
       /* Get and remove packet from ringbuf (remove committed through an atomic operation */
       int16_t get_index = ringbufindex_get(&n->tx_ringbuf);
@@ -324,7 +351,7 @@ void
 tsch_queue_free_packets_to(const linkaddr_t *addr)
 {
   struct tsch_neighbor *n = NULL;
-  if(!tsch_is_locked()) {
+  if(queue_is_accessible()) {
     n = tsch_queue_get_nbr(addr);
     if(n != NULL) {
       tsch_queue_flush_nbr_queue(n);
@@ -417,7 +444,7 @@ tsch_queue_free_unused_neighbors(void)
 int
 tsch_queue_is_empty(const struct tsch_neighbor *n)
 {
-  return !tsch_is_locked() && n != NULL && ringbufindex_empty(&n->tx_ringbuf);
+  return queue_is_accessible() && n != NULL && ringbufindex_empty(&n->tx_ringbuf);
 }
 /*---------------------------------------------------------------------------*/
 /* Returns the first packet from a neighbor queue */
@@ -76,6 +76,17 @@ struct tsch_neighbor *tsch_queue_get_time_source(void);
  * \return The link-layer address of the neighbor.
  */
 linkaddr_t *tsch_queue_get_nbr_address(const struct tsch_neighbor *);
+/**
+ * \brief Get the first TSCH neighbor
+ * \return The first neighbor, NULL if there is none or TSCH is locked
+ */
+struct tsch_neighbor *tsch_queue_first_nbr(void);
+/**
+ * \brief Get the next TSCH neighbor
+ * \param n The current neighbor
+ * \return The next neighbor, NULL if there is none or TSCH is locked
+ */
+struct tsch_neighbor *tsch_queue_next_nbr(struct tsch_neighbor *n);
 /**
  * \brief Update TSCH time source
  * \param new_addr The address of the new TSCH time source
@@ -68,6 +68,164 @@ MEMB(slotframe_memb, struct tsch_slotframe, TSCH_SCHEDULE_MAX_SLOTFRAMES);
 /* List of slotframes (each slotframe holds its own list of links) */
 LIST(slotframe_list);
 
+/* Nesting depth of schedule update batches. While non-zero, the TSCH lock
+ * is held on behalf of the batch and the functions below do not take it */
+static uint8_t batch_depth;
+
+/* Tx link counter updates deferred until the end of the batch */
+struct batch_nbr_update {
+  linkaddr_t addr;
+  int8_t tx_links;
+  int8_t dedicated_tx_links;
+};
+static struct batch_nbr_update batch_updates[TSCH_SCHEDULE_BATCH_MAX_NBRS];
+static uint8_t batch_num_updates;
+/* Set when batch_updates overflowed: recount all links at commit */
+static uint8_t batch_recount;
+
+/*---------------------------------------------------------------------------*/
+static int
+schedule_lock(void)
+{
+  return batch_depth > 0 || tsch_get_lock();
+}
+/*---------------------------------------------------------------------------*/
+static void
+schedule_unlock(void)
+{
+  if(batch_depth == 0) {
+    tsch_release_lock();
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Can the schedule be accessed, i.e. is TSCH unlocked or locked by us? */
+static int
+schedule_is_accessible(void)
+{
+  return batch_depth > 0 || !tsch_is_locked();
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_schedule_update_in_progress(void)
+{
+  return batch_depth > 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+batch_record(const linkaddr_t *addr, uint8_t link_options, int delta)
+{
+  struct batch_nbr_update *u;
+  int i;
+
+  for(i = 0; i < batch_num_updates; i++) {
+    if(linkaddr_cmp(&batch_updates[i].addr, addr)) {
+      break;
+    }
+  }
+  u = &batch_updates[i];
+  if(i == batch_num_updates) {
+    if(batch_num_updates == TSCH_SCHEDULE_BATCH_MAX_NBRS) {
+      batch_recount = 1;
+      return;
+    }
+    batch_num_updates++;
+    linkaddr_copy(&u->addr, addr);
+    u->tx_links = 0;
+    u->dedicated_tx_links = 0;
+  }
+  u->tx_links += delta;
+  if(!(link_options & LINK_OPTION_SHARED)) {
+    u->dedicated_tx_links += delta;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Update the Tx link counters of a neighbor after a link was added
+ * (delta 1) or removed (delta -1). Must be called without the lock. */
+static void
+update_tx_links_count(const linkaddr_t *addr, uint8_t link_options, int delta)
+{
+  struct tsch_neighbor *n;
+
+  if(!(link_options & LINK_OPTION_TX)) {
+    return;
+  }
+  if(batch_depth > 0) {
+    batch_record(addr, link_options, delta);
+    return;
+  }
+  n = delta > 0 ? tsch_queue_add_nbr(addr) : tsch_queue_get_nbr(addr);
+  if(n != NULL) {
+    n->tx_links_count += delta;
+    if(!(link_options & LINK_OPTION_SHARED)) {
+      n->dedicated_tx_links_count += delta;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Recompute the Tx link counters of all neighbors from the schedule */
+static void
+recount_tx_links(void)
+{
+  struct tsch_neighbor *n;
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+
+  for(n = tsch_queue_first_nbr(); n != NULL; n = tsch_queue_next_nbr(n)) {
+    n->tx_links_count = 0;
+    n->dedicated_tx_links_count = 0;
+  }
+  for(sf = list_head(slotframe_list); sf != NULL; sf = list_item_next(sf)) {
+    for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+      update_tx_links_count(&l->addr, l->link_options, 1);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_schedule_update_begin(void)
+{
+  if(batch_depth == 0) {
+    if(!tsch_get_lock()) {
+      LOG_ERR("! update_begin couldn't take lock\n");
+      return 0;
+    }
+    batch_num_updates = 0;
+    batch_recount = 0;
+  }
+  batch_depth++;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_schedule_update_commit(void)
+{
+  int i;
+
+  if(batch_depth == 0 || --batch_depth > 0) {
+    return;
+  }
+  tsch_release_lock();
+
+  if(batch_recount) {
+    recount_tx_links();
+    return;
+  }
+  for(i = 0; i < batch_num_updates; i++) {
+    struct batch_nbr_update *u = &batch_updates[i];
+    struct tsch_neighbor *n;
+
+    if(u->tx_links == 0 && u->dedicated_tx_links == 0) {
+      continue;
+    }
+    n = u->tx_links > 0 ? tsch_queue_add_nbr(&u->addr) : tsch_queue_get_nbr(&u->addr);
+    if(n != NULL) {
+      n->tx_links_count += u->tx_links;
+      n->dedicated_tx_links_count += u->dedicated_tx_links;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+
 /* Adds and returns a slotframe (NULL if failure) */
 struct tsch_slotframe *
 tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
@@ -81,7 +239,7 @@ tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
     return NULL;
   }
 
-  if(tsch_get_lock()) {
+  if(schedule_lock()) {
     struct tsch_slotframe *sf = memb_alloc(&slotframe_memb);
     if(sf != NULL) {
       /* Initialize the slotframe */
@@ -93,7 +251,7 @@ tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
     }
     LOG_INFO("add_slotframe %u %u\n",
            handle, size);
-    tsch_release_lock();
+    schedule_unlock();
     return sf;
   }
   return NULL;
@@ -124,11 +282,11 @@ tsch_schedule_remove_slotframe(struct tsch_slotframe *slotframe)
     }
 
     /* Now that the slotframe has no links, remove it. */
-    if(tsch_get_lock()) {
+    if(schedule_lock()) {
       LOG_INFO("remove slotframe %u %u\n", slotframe->handle, slotframe->size.val);
       memb_free(&slotframe_memb, slotframe);
       list_remove(slotframe_list, slotframe);
-      tsch_release_lock();
+      schedule_unlock();
       return 1;
     }
   }
@@ -139,7 +297,7 @@ tsch_schedule_remove_slotframe(struct tsch_slotframe *slotframe)
 struct tsch_slotframe *
 tsch_schedule_get_slotframe_by_handle(uint16_t handle)
 {
-  if(!tsch_is_locked()) {
+  if(schedule_is_accessible()) {
     struct tsch_slotframe *sf = list_head(slotframe_list);
     while(sf != NULL) {
       if(sf->handle == handle) {
@@ -155,7 +313,7 @@ tsch_schedule_get_slotframe_by_handle(uint16_t handle)
 struct tsch_link *
 tsch_schedule_get_link_by_handle(uint16_t handle)
 {
-  if(!tsch_is_locked()) {
+  if(schedule_is_accessible()) {
     struct tsch_slotframe *sf = list_head(slotframe_list);
     while(sf != NULL) {
       struct tsch_link *l = list_head(sf->links_list);
@@ -232,16 +390,15 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
        * to keep neighbor state in sync with link options etc.) */
       tsch_schedule_remove_link_by_timeslot(slotframe, timeslot, channel_offset);
     }
-    if(!tsch_get_lock()) {
+    if(!schedule_lock()) {
       LOG_ERR("! add_link memb_alloc couldn't take lock\n");
     } else {
       l = memb_alloc(&link_memb);
       if(l == NULL) {
         LOG_ERR("! add_link memb_alloc failed\n");
-        tsch_release_lock();
+        schedule_unlock();
       } else {
         static int current_link_handle = 0;
-        struct tsch_neighbor *n;
         /* Add the link to the slotframe */
         list_add(slotframe->links_list, l);
         /* Initialize link */
@@ -264,18 +421,10 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
         LOG_INFO_LLADDR(address);
         LOG_INFO_("\n");
         /* Release the lock before we update the neighbor (will take the lock) */
-        tsch_release_lock();
-
-        if(l->link_options & LINK_OPTION_TX) {
-          n = tsch_queue_add_nbr(&l->addr);
-          /* We have a tx link to this neighbor, update counters */
-          if(n != NULL) {
-            n->tx_links_count++;
-            if(!(l->link_options & LINK_OPTION_SHARED)) {
-              n->dedicated_tx_links_count++;
-            }
-          }
-        }
+        schedule_unlock();
+
+        /* If we have a tx link to this neighbor, update counters */
+        update_tx_links_count(&l->addr, l->link_options, 1);
       }
     }
   }
@@ -287,7 +436,7 @@ int
 tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
 {
   if(slotframe != NULL && l != NULL && l->slotframe_handle == slotframe->handle) {
-    if(tsch_get_lock()) {
+    if(schedule_lock()) {
       uint8_t link_options;
       linkaddr_t addr;
 
@@ -312,18 +461,10 @@ tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
       memb_free(&link_memb, l);
 
       /* Release the lock before we update the neighbor (will take the lock) */
-      tsch_release_lock();
-
-      /* This was a tx link to this neighbor, update counters */
-      if(link_options & LINK_OPTION_TX) {
-        struct tsch_neighbor *n = tsch_queue_get_nbr(&addr);
-        if(n != NULL) {
-          n->tx_links_count--;
-          if(!(link_options & LINK_OPTION_SHARED)) {
-            n->dedicated_tx_links_count--;
-          }
-        }
-      }
+      schedule_unlock();
+
+      /* If this was a tx link to this neighbor, update counters */
+      update_tx_links_count(&addr, link_options, -1);
 
       return 1;
     } else {
@@ -339,7 +480,7 @@ tsch_schedule_remove_link_by_timeslot(struct tsch_slotframe *slotframe,
                                       uint16_t timeslot, uint16_t channel_offset)
 {
   int ret = 0;
-  if(!tsch_is_locked()) {
+  if(schedule_is_accessible()) {
     if(slotframe != NULL) {
       struct tsch_link *l = list_head(slotframe->links_list);
       /* Loop over all items and remove all matching links */
@@ -362,7 +503,7 @@ struct tsch_link *
 tsch_schedule_get_link_by_timeslot(struct tsch_slotframe *slotframe,
                                    uint16_t timeslot, uint16_t channel_offset)
 {
-  if(!tsch_is_locked()) {
+  if(schedule_is_accessible()) {
     if(slotframe != NULL) {
       struct tsch_link *l = list_head(slotframe->links_list);
       /* Loop over all items. Assume there is max one link per timeslot and channel_offset */
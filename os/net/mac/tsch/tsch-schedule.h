@@ -149,6 +149,30 @@ int tsch_schedule_remove_link_by_timeslot(struct tsch_slotframe *slotframe,
 struct tsch_link * tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset,
     struct tsch_link **backup_link);
 
+/**
+ * \brief Start a batch of schedule updates. The TSCH lock is taken once
+ * and held until tsch_schedule_update_commit(), instead of once per
+ * slotframe or link call made in between. Tx link counters of the
+ * neighbors are updated at commit time. Batches may be nested; slot
+ * operation is suspended until the outermost batch is committed, so
+ * keep batches short.
+ * \return 1 if the batch was started, 0 if the lock could not be taken.
+ * Commit only if the batch was started.
+ */
+int tsch_schedule_update_begin(void);
+
+/**
+ * \brief Ends a batch of schedule updates started with
+ * tsch_schedule_update_begin()
+ */
+void tsch_schedule_update_commit(void);
+
+/**
+ * \brief Is a batch of schedule updates in progress?
+ * \return 1 if the TSCH lock is currently held by a batch, 0 otherwise
+ */
+int tsch_schedule_update_in_progress(void);
+
 /**
  * \brief Access the first item in the list of slotframes
  * \return The first slotframe in the schedule if any, NULL otherwise
@@ -81,6 +81,11 @@
 #error TSCH_MAX_INCOMING_PACKETS must be power of two
 #endif
 
+/* Check if TSCH_MAX_INCOMING_PACKETS_ROOT is power of two */
+#if (TSCH_MAX_INCOMING_PACKETS_ROOT & (TSCH_MAX_INCOMING_PACKETS_ROOT - 1)) != 0
+#error TSCH_MAX_INCOMING_PACKETS_ROOT must be power of two
+#endif
+
 /* Check if TSCH_DEQUEUED_ARRAY_SIZE is power of two and greater or equal to QUEUEBUF_NUM */
 #if TSCH_DEQUEUED_ARRAY_SIZE < QUEUEBUF_NUM
 #error TSCH_DEQUEUED_ARRAY_SIZE must be greater or equal to QUEUEBUF_NUM
@@ -125,7 +130,7 @@ struct tsch_packet *dequeued_array[TSCH_DEQUEUED_ARRAY_SIZE];
 /* A ringbuf storing incoming packets.
  * Will be processed layer by tsch_rx_process_pending */
 struct ringbufindex input_ringbuf;
-struct input_packet input_array[TSCH_MAX_INCOMING_PACKETS];
+struct input_packet input_array[TSCH_INCOMING_PACKETS_ARRAY_SIZE];
 
 /* Updates and reads of the next two variables must be atomic (i.e. both together) */
 /* Last time we received Sync-IE (ACK or data packet from a time source) */
@@ -136,6 +141,10 @@ clock_time_t tsch_last_sync_time; /* Same info, in clock_time_t units */
 static volatile int tsch_locked = 0;
 /* As long as this is set, skip all slot operation */
 static volatile int tsch_lock_requested = 0;
+#if TSCH_STATS_ON
+/* When the lock was last taken */
+static rtimer_clock_t tsch_lock_time;
+#endif
 
 /* Last estimated drift in RTIMER ticks
  * (Sky: 1 tick = 30.517578125 usec exactly) */
@@ -210,6 +219,9 @@ tsch_get_lock(void)
       /* Take the lock if it is free */
       tsch_locked = 1;
       tsch_lock_requested = 0;
+#if TSCH_STATS_ON
+      tsch_lock_time = RTIMER_NOW();
+#endif
       if(busy_wait) {
         /* Issue a log whenever we had to busy wait until getting the lock */
         TSCH_LOG_ADD(tsch_log_message,
@@ -231,6 +243,11 @@ tsch_get_lock(void)
 void
 tsch_release_lock(void)
 {
+#if TSCH_STATS_ON
+  if(tsch_locked) {
+    tsch_stats_lock_released(RTIMER_NOW() - tsch_lock_time);
+  }
+#endif
   tsch_locked = 0;
 }
 
@@ -526,6 +543,13 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       /* get payload */
       packet = queuebuf_dataptr(current_packet->qb);
       packet_len = queuebuf_datalen(current_packet->qb);
+#if ENERGEST_TAGS
+      /* Frames without a tag, such as EBs and keepalives, are sent by
+         TSCH itself. The time until the ACK is received counts for the
+         frame as well. */
+      ENERGEST_TAG_RADIO(queuebuf_attr(current_packet->qb, PACKETBUF_ATTR_ENERGEST_TAG) != ENERGEST_TAG_OTHER ?
+                         queuebuf_attr(current_packet->qb, PACKETBUF_ATTR_ENERGEST_TAG) : ENERGEST_TAG_MAC);
+#endif /* ENERGEST_TAGS */
       /* if is this a broadcast packet, don't wait for ack */
       do_wait_for_ack = !current_neighbor->is_broadcast;
       /* Unicast. More packets in queue for the neighbor? */
@@ -780,6 +804,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
   input_index = ringbufindex_peek_put(&input_ringbuf);
   if(input_index == -1) {
     input_queue_drop++;
+    tsch_stats_input_queue_drop();
   } else {
     static struct input_packet *current_input;
     /* Estimated drift based on RX time */
@@ -796,6 +821,9 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 
     current_input = &input_array[input_index];
 
+    /* Listening in scheduled Rx slots is a cost of TSCH */
+    ENERGEST_TAG_RADIO(ENERGEST_TAG_MAC);
+
     /* Wait before starting to listen */
     TSCH_SCHEDULE_AND_YIELD(pt, t, current_slot_start, tsch_timing[tsch_ts_rx_offset] - RADIO_DELAY_BEFORE_RX, "RxBeforeListen");
     TSCH_DEBUG_RX_EVENT();
@@ -959,6 +987,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 
             /* Add current input to ringbuf */
             ringbufindex_put(&input_ringbuf);
+            tsch_stats_input_queue_put(ringbufindex_elements(&input_ringbuf));
 
             /* If the neighbor is known, update its stats */
             if(n != NULL) {
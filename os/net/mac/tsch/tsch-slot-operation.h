@@ -54,7 +54,7 @@ extern struct tsch_packet *dequeued_array[TSCH_DEQUEUED_ARRAY_SIZE];
 /* A ringbuf storing incoming packets.
  * Will be processed layer by tsch_rx_process_pending */
 extern struct ringbufindex input_ringbuf;
-extern struct input_packet input_array[TSCH_MAX_INCOMING_PACKETS];
+extern struct input_packet input_array[TSCH_INCOMING_PACKETS_ARRAY_SIZE];
 /* Last clock_time_t where synchronization happened */
 extern clock_time_t tsch_last_sync_time;
 /* Counts the length of the current burst */
@@ -137,6 +137,35 @@ tsch_stats_on_time_synchronization(int32_t sync_error)
 }
 /*---------------------------------------------------------------------------*/
 void
+tsch_stats_input_queue_put(uint8_t elements)
+{
+  /* Called from the slot operation, right after an input was queued */
+  if(elements > tsch_stats.input_queue_max) {
+    tsch_stats.input_queue_max = elements;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_stats_input_queue_drop(void)
+{
+  tsch_stats.input_queue_drops++;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_stats_input_queue_deferred(void)
+{
+  tsch_stats.input_queue_deferred++;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_stats_lock_released(rtimer_clock_t held)
+{
+  tsch_stats.lock_count++;
+  tsch_stats.lock_held_ticks += held;
+  tsch_stats.lock_held_max_ticks = MAX(tsch_stats.lock_held_max_ticks, held);
+}
+/*---------------------------------------------------------------------------*/
+void
 tsch_stats_sample_rssi(void)
 {
 #if TSCH_STATS_SAMPLE_NOISE_RSSI
@@ -143,6 +143,17 @@ struct tsch_global_stats {
   uint32_t max_sync_error;
   /* number of disassociations */
   uint16_t num_disassociations;
+  /* the highest number of packets seen in the input ring */
+  uint8_t input_queue_max;
+  /* number of incoming packets dropped because the input ring was full */
+  uint32_t input_queue_drops;
+  /* number of times the input ring was not drained within the budget */
+  uint32_t input_queue_deferred;
+  /* number of times the TSCH lock was taken */
+  uint32_t lock_count;
+  /* total and maximum time the TSCH lock was held, in rtimer ticks */
+  uint32_t lock_held_ticks;
+  uint32_t lock_held_max_ticks;
 #if TSCH_STATS_SAMPLE_NOISE_RSSI
   /* per-channel noise estimates */
   tsch_stat_t noise_rssi[TSCH_STATS_NUM_CHANNELS];
@@ -190,6 +201,14 @@ void tsch_stats_on_time_synchronization(int32_t sync_error);
 
 void tsch_stats_sample_rssi(void);
 
+void tsch_stats_input_queue_put(uint8_t elements);
+
+void tsch_stats_input_queue_drop(void);
+
+void tsch_stats_input_queue_deferred(void);
+
+void tsch_stats_lock_released(rtimer_clock_t held);
+
 struct tsch_neighbor_stats *tsch_stats_get_from_neighbor(struct tsch_neighbor *);
 
 void tsch_stats_reset_neighbor_stats(void);
@@ -201,6 +220,10 @@ void tsch_stats_reset_neighbor_stats(void);
 #define tsch_stats_rx_packet(n, rssi, lqi, channel)
 #define tsch_stats_on_time_synchronization(sync_error)
 #define tsch_stats_sample_rssi()
+#define tsch_stats_input_queue_put(elements)
+#define tsch_stats_input_queue_drop()
+#define tsch_stats_input_queue_deferred()
+#define tsch_stats_lock_released(held)
 #define tsch_stats_get_from_neighbor(neighbor) NULL
 #define tsch_stats_reset_neighbor_stats()
 
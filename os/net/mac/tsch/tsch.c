@@ -57,6 +57,7 @@
 #include "net/mac/mac-sequence.h"
 #include "lib/random.h"
 #include "net/routing/routing.h"
+#include "sys/energest.h"
 #include <inttypes.h>
 
 #if TSCH_WITH_SIXTOP
@@ -491,11 +492,15 @@ eb_input(struct input_packet *current_input)
   }
 }
 /*---------------------------------------------------------------------------*/
-/* Process pending input packet(s) */
-static void
+/* Process pending input packet(s), for at most TSCH_RX_PROCESS_BUDGET.
+ * Returns 1 if the budget ran out before the ring was drained. */
+static int
 tsch_rx_process_pending()
 {
   int16_t input_index;
+#if TSCH_RX_PROCESS_BUDGET
+  rtimer_clock_t start = RTIMER_NOW();
+#endif
   /* Loop on accessing (without removing) a pending input packet */
   while((input_index = ringbufindex_peek_get(&input_ringbuf)) != -1) {
     struct input_packet *current_input = &input_array[input_index];
@@ -523,6 +528,27 @@ tsch_rx_process_pending()
 
     /* Remove input from ringbuf */
     ringbufindex_get(&input_ringbuf);
+
+#if TSCH_RX_PROCESS_BUDGET
+    if(!ringbufindex_empty(&input_ringbuf)
+       && RTIMER_CLOCK_DIFF(RTIMER_NOW(), start) >= TSCH_RX_PROCESS_BUDGET) {
+      tsch_stats_input_queue_deferred();
+      return 1;
+    }
+#endif
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Size the input ring for the current role. Only called while slot
+ * operation is stopped, as any pending input is discarded. */
+static void
+tsch_rx_ring_init(void)
+{
+  uint8_t size = tsch_is_coordinator ?
+    TSCH_MAX_INCOMING_PACKETS_ROOT : TSCH_MAX_INCOMING_PACKETS;
+  if(ringbufindex_size(&input_ringbuf) != size) {
+    ringbufindex_init(&input_ringbuf, size);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -570,6 +596,7 @@ tsch_start_coordinator(void)
       frame802154_get_pan_id(), tsch_current_asn.ms1b, tsch_current_asn.ls4b);
 
   /* Start slot operation */
+  tsch_rx_ring_init();
   tsch_slot_operation_sync(RTIMER_NOW(), &tsch_current_asn);
 }
 /*---------------------------------------------------------------------------*/
@@ -721,6 +748,7 @@ tsch_associate(const struct input_packet *input_eb, rtimer_clock_t timestamp)
       frame802154_set_pan_id(frame.src_pid);
 
       /* Synchronize on EB */
+      tsch_rx_ring_init();
       tsch_slot_operation_sync(timestamp - tsch_timing[tsch_ts_tx_offset], &tsch_current_asn);
 
       /* Update global flags */
@@ -969,7 +997,10 @@ PROCESS_THREAD(tsch_pending_events_process, ev, data)
   PROCESS_BEGIN();
   while(1) {
     PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
-    tsch_rx_process_pending();
+    if(tsch_rx_process_pending()) {
+      /* Out of budget: let other processes run, then resume draining */
+      process_poll(&tsch_pending_events_process);
+    }
     tsch_tx_process_pending();
     tsch_log_process_pending();
     tsch_keepalive_process_pending();
@@ -1055,7 +1086,7 @@ tsch_init(void)
   tsch_queue_init();
   tsch_schedule_init();
   tsch_log_init();
-  ringbufindex_init(&input_ringbuf, TSCH_MAX_INCOMING_PACKETS);
+  tsch_rx_ring_init();
   ringbufindex_init(&dequeued_ringbuf, TSCH_DEQUEUED_ARRAY_SIZE);
 
   tsch_packet_seqno = random_rand();
@@ -1209,6 +1240,10 @@ turn_on(void)
     tsch_is_started = 1;
     /* Process tx/rx callback and log messages whenever polled */
     process_start(&tsch_pending_events_process, NULL);
+    /* The pending events process delivers received packets to the
+       upper layers, so that its CPU time is not attributed to TSCH. */
+    ENERGEST_TAG_PROCESS(&tsch_send_eb_process, ENERGEST_TAG_MAC);
+    ENERGEST_TAG_PROCESS(&tsch_process, ENERGEST_TAG_MAC);
     if(TSCH_EB_PERIOD > 0) {
       /* periodically send TSCH EBs */
       process_start(&tsch_send_eb_process, NULL);
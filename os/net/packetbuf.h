@@ -57,6 +57,7 @@
 #include "net/mac/llsec802154.h"
 #include "net/mac/csma/csma-security.h"
 #include "net/mac/tsch/tsch-conf.h"
+#include "sys/energest.h"
 
 /**
  * \brief      The size of the packetbuf, in bytes
@@ -229,6 +230,9 @@ enum {
   PACKETBUF_ATTR_TSCH_TIMESLOT,
   PACKETBUF_ATTR_TSCH_CHANNEL_OFFSET,
 #endif /* TSCH_WITH_LINK_SELECTOR */
+#if ENERGEST_TAGS
+  PACKETBUF_ATTR_ENERGEST_TAG,
+#endif /* ENERGEST_TAGS */
 
   /* Scope 1 attributes: used between two neighbors only. */
   PACKETBUF_ATTR_FRAME_TYPE,
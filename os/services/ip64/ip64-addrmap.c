@@ -46,14 +46,50 @@
 #define NUM_ENTRIES 32
 #endif /* IP64_ADDRMAP_CONF_ENTRIES */
 
+/* Number of buckets in each of the two hash tables */
+#ifdef IP64_ADDRMAP_CONF_HASH_SIZE
+#define HASH_SIZE IP64_ADDRMAP_CONF_HASH_SIZE
+#else /* IP64_ADDRMAP_CONF_HASH_SIZE */
+#define HASH_SIZE 16
+#endif /* IP64_ADDRMAP_CONF_HASH_SIZE */
+
+/* The timer wheel has WHEEL_SLOTS slots of WHEEL_TICK clock ticks each */
+#ifdef IP64_ADDRMAP_CONF_WHEEL_SLOTS
+#define WHEEL_SLOTS IP64_ADDRMAP_CONF_WHEEL_SLOTS
+#else /* IP64_ADDRMAP_CONF_WHEEL_SLOTS */
+#define WHEEL_SLOTS 32
+#endif /* IP64_ADDRMAP_CONF_WHEEL_SLOTS */
+
+#ifdef IP64_ADDRMAP_CONF_WHEEL_TICK
+#define WHEEL_TICK IP64_ADDRMAP_CONF_WHEEL_TICK
+#else /* IP64_ADDRMAP_CONF_WHEEL_TICK */
+#define WHEEL_TICK (2 * CLOCK_SECOND)
+#endif /* IP64_ADDRMAP_CONF_WHEEL_TICK */
+
 MEMB(entrymemb, struct ip64_addrmap_entry, NUM_ENTRIES);
 LIST(entrylist);
 
+#ifdef IP64_ADDRMAP_CONF_FIRST_MAPPED_PORT
+#define FIRST_MAPPED_PORT IP64_ADDRMAP_CONF_FIRST_MAPPED_PORT
+#else /* IP64_ADDRMAP_CONF_FIRST_MAPPED_PORT */
 #define FIRST_MAPPED_PORT 10000
+#endif /* IP64_ADDRMAP_CONF_FIRST_MAPPED_PORT */
+
+#ifdef IP64_ADDRMAP_CONF_LAST_MAPPED_PORT
+#define LAST_MAPPED_PORT IP64_ADDRMAP_CONF_LAST_MAPPED_PORT
+#else /* IP64_ADDRMAP_CONF_LAST_MAPPED_PORT */
 #define LAST_MAPPED_PORT  20000
-static uint16_t mapped_port = FIRST_MAPPED_PORT;
+#endif /* IP64_ADDRMAP_CONF_LAST_MAPPED_PORT */
+
+#define NUM_MAPPED_PORTS (LAST_MAPPED_PORT - FIRST_MAPPED_PORT)
 
-#define printf(...)
+/* Mapped ports in use, one bit per port */
+static uint32_t port_bitmap[(NUM_MAPPED_PORTS + 31) / 32];
+
+static struct ip64_addrmap_entry *tuple_hash[HASH_SIZE];
+static struct ip64_addrmap_entry *port_hash[HASH_SIZE];
+static struct ip64_addrmap_entry *wheel[WHEEL_SLOTS];
+static clock_time_t wheel_tick;
 
 /*---------------------------------------------------------------------------*/
 struct ip64_addrmap_entry *
@@ -67,11 +103,131 @@ ip64_addrmap_init(void)
 {
   memb_init(&entrymemb);
   list_init(entrylist);
-  mapped_port = FIRST_MAPPED_PORT;
+  memset(port_bitmap, 0, sizeof(port_bitmap));
+  memset(tuple_hash, 0, sizeof(tuple_hash));
+  memset(port_hash, 0, sizeof(port_hash));
+  memset(wheel, 0, sizeof(wheel));
+  wheel_tick = clock_time() / WHEEL_TICK;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+tuple_bucket(const uip_ip6addr_t *ip6addr, uint16_t ip6port,
+             const uip_ip4addr_t *ip4addr, uint16_t ip4port,
+             uint8_t protocol)
+{
+  uint32_t h;
+  int i;
+
+  h = protocol;
+  for(i = 0; i < 8; i++) {
+    h = h * 31 + ip6addr->u16[i];
+  }
+  h = h * 31 + ip4addr->u16[0];
+  h = h * 31 + ip4addr->u16[1];
+  h = h * 31 + ip6port;
+  h = h * 31 + ip4port;
+  return (h ^ (h >> 16)) % HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+port_bucket(uint16_t mapped_port)
+{
+  return mapped_port % HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_add(struct ip64_addrmap_entry *e)
+{
+  unsigned slot;
+
+  e->wheel_expiry = (e->timer.start + e->timer.interval) / WHEEL_TICK;
+  slot = e->wheel_expiry % WHEEL_SLOTS;
+  e->wheel_next = wheel[slot];
+  wheel[slot] = e;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_remove(struct ip64_addrmap_entry *e)
+{
+  struct ip64_addrmap_entry **pp;
+
+  for(pp = &wheel[e->wheel_expiry % WHEEL_SLOTS];
+      *pp != NULL; pp = &(*pp)->wheel_next) {
+    if(*pp == e) {
+      *pp = e->wheel_next;
+      break;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_entry(struct ip64_addrmap_entry *e)
+{
+  struct ip64_addrmap_entry **pp;
+  unsigned port;
+
+  pp = &tuple_hash[tuple_bucket(&e->ip6addr, e->ip6port,
+                                &e->ip4addr, e->ip4port, e->protocol)];
+  for(; *pp != NULL; pp = &(*pp)->hash_next) {
+    if(*pp == e) {
+      *pp = e->hash_next;
+      break;
+    }
+  }
+  for(pp = &port_hash[port_bucket(e->mapped_port)];
+      *pp != NULL; pp = &(*pp)->port_next) {
+    if(*pp == e) {
+      *pp = e->port_next;
+      break;
+    }
+  }
+  wheel_remove(e);
+
+  port = e->mapped_port - FIRST_MAPPED_PORT;
+  port_bitmap[port / 32] &= ~((uint32_t)1 << (port % 32));
+
+  list_remove(entrylist, e);
+  memb_free(&entrymemb, e);
+}
+/*---------------------------------------------------------------------------*/
+static void
+sweep_slot(unsigned slot)
+{
+  struct ip64_addrmap_entry *m, *next;
+
+  /* Entries whose lifetime has been extended since they were added
+     to the slot move on to the slot of their new expiry time here. */
+  m = wheel[slot];
+  wheel[slot] = NULL;
+  for(; m != NULL; m = next) {
+    next = m->wheel_next;
+    if(timer_expired(&m->timer)) {
+      m->wheel_next = NULL;
+      remove_entry(m);
+    } else {
+      wheel_add(m);
+    }
+  }
 }
 /*---------------------------------------------------------------------------*/
 static void
 check_age(void)
+{
+  clock_time_t now_tick;
+  unsigned n;
+
+  /* Sweep the slots of the wheel that have passed since last time,
+     each at most once. */
+  now_tick = clock_time() / WHEEL_TICK;
+  for(n = 0; wheel_tick != now_tick && n < WHEEL_SLOTS; n++) {
+    sweep_slot(wheel_tick % WHEEL_SLOTS);
+    wheel_tick++;
+  }
+  wheel_tick = now_tick;
+}
+/*---------------------------------------------------------------------------*/
+static void
+expire_all(void)
 {
   struct ip64_addrmap_entry *m;
 
@@ -80,8 +236,7 @@ check_age(void)
   m = list_head(entrylist);
   while(m != NULL) {
     if(timer_expired(&m->timer)) {
-      list_remove(entrylist, m);
-      memb_free(&entrymemb, m);
+      remove_entry(m);
       m = list_head(entrylist);
     } else {
       m = list_item_next(m);
@@ -95,9 +250,6 @@ recycle(void)
   /* Find the oldest recyclable mapping and remove it. */
   struct ip64_addrmap_entry *m, *oldest;
 
-  /* Walk through the list of address mappings, throw away the ones
-     that are too old. */
-
   oldest = NULL;
   for(m = list_head(entrylist);
       m != NULL;
@@ -117,8 +269,7 @@ recycle(void)
   /* If we found an oldest recyclable entry, remove it and return
      non-zero. */
   if(oldest != NULL) {
-    list_remove(entrylist, oldest);
-    memb_free(&entrymemb, oldest);
+    remove_entry(oldest);
     return 1;
   }
 
@@ -134,21 +285,20 @@ ip64_addrmap_lookup(const uip_ip6addr_t *ip6addr,
 {
   struct ip64_addrmap_entry *m;
 
-  printf("lookup ip4port %d ip6port %d\n", uip_htons(ip4port),
-	 uip_htons(ip6port));
   check_age();
-  for(m = list_head(entrylist); m != NULL; m = list_item_next(m)) {
-    printf("protocol %d %d, ip4port %d %d, ip6port %d %d, ip4 %d ip6 %d\n",
-	   m->protocol, protocol,
-	   m->ip4port, ip4port,
-	   m->ip6port, ip6port,
-	   uip_ip4addr_cmp(&m->ip4addr, ip4addr),
-	   uip_ip6addr_cmp(&m->ip6addr, ip6addr));
+  for(m = tuple_hash[tuple_bucket(ip6addr, ip6port, ip4addr, ip4port,
+                                  protocol)];
+      m != NULL; m = m->hash_next) {
     if(m->protocol == protocol &&
        m->ip4port == ip4port &&
        m->ip6port == ip6port &&
        uip_ip4addr_cmp(&m->ip4addr, ip4addr) &&
        uip_ip6addr_cmp(&m->ip6addr, ip6addr)) {
+      if(timer_expired(&m->timer)) {
+        /* Expired, but its wheel slot has not been swept yet */
+        remove_entry(m);
+        return NULL;
+      }
       m->ip6to4++;
       return m;
     }
@@ -162,12 +312,13 @@ ip64_addrmap_lookup_port(uint16_t mapped_port, uint8_t protocol)
   struct ip64_addrmap_entry *m;
 
   check_age();
-  for(m = list_head(entrylist); m != NULL; m = list_item_next(m)) {
-    printf("mapped port %d %d, protocol %d %d\n",
-	   m->mapped_port, mapped_port,
-	   m->protocol, protocol);
+  for(m = port_hash[port_bucket(mapped_port)]; m != NULL; m = m->port_next) {
     if(m->mapped_port == mapped_port &&
        m->protocol == protocol) {
+      if(timer_expired(&m->timer)) {
+        remove_entry(m);
+        return NULL;
+      }
       m->ip4to6++;
       return m;
     }
@@ -175,11 +326,30 @@ ip64_addrmap_lookup_port(uint16_t mapped_port, uint8_t protocol)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
-static void
-increase_mapped_port(void)
+static int
+allocate_mapped_port(uint16_t *port)
 {
-  mapped_port = (random_rand() % (LAST_MAPPED_PORT - FIRST_MAPPED_PORT)) +
-    FIRST_MAPPED_PORT;
+  unsigned p, i, skip;
+
+  /* Start at a random port and take the next free one, skipping
+     fully used words of the bitmap */
+  p = random_rand() % NUM_MAPPED_PORTS;
+  for(i = 0; i < NUM_MAPPED_PORTS + 32; i += skip) {
+    if(port_bitmap[p / 32] == 0xffffffff) {
+      skip = 32 - p % 32;
+    } else if((port_bitmap[p / 32] & ((uint32_t)1 << (p % 32))) == 0) {
+      port_bitmap[p / 32] |= (uint32_t)1 << (p % 32);
+      *port = FIRST_MAPPED_PORT + p;
+      return 1;
+    } else {
+      skip = 1;
+    }
+    p += skip;
+    if(p >= NUM_MAPPED_PORTS) {
+      p = 0;
+    }
+  }
+  return 0;
 }
 /*---------------------------------------------------------------------------*/
 struct ip64_addrmap_entry *
@@ -190,17 +360,24 @@ ip64_addrmap_create(const uip_ip6addr_t *ip6addr,
 		    uint8_t protocol)
 {
   struct ip64_addrmap_entry *m;
+  unsigned bucket;
 
   check_age();
   m = memb_alloc(&entrymemb);
   if(m == NULL) {
-    /* We could not allocate an entry, try to recycle one and try to
-       allocate again. */
-    if(recycle()) {
+    /* We could not allocate an entry, throw away all old ones or try
+       to recycle one and try to allocate again. */
+    expire_all();
+    m = memb_alloc(&entrymemb);
+    if(m == NULL && recycle()) {
       m = memb_alloc(&entrymemb);
     }
   }
   if(m != NULL) {
+    if(!allocate_mapped_port(&m->mapped_port)) {
+      memb_free(&entrymemb, m);
+      return NULL;
+    }
     uip_ip4addr_copy(&m->ip4addr, ip4addr);
     m->ip4port = ip4port;
     uip_ip6addr_copy(&m->ip6addr, ip6addr);
@@ -211,23 +388,13 @@ ip64_addrmap_create(const uip_ip6addr_t *ip6addr,
     m->ip4to6 = 0;
     timer_set(&m->timer, 0);
 
-    /* Pick a new, unused local port. First make sure that the
-       mapped_port number does not belong to any active connection. If
-       so, we keep increasing the mapped_port until we're free. */
-    {
-      struct ip64_addrmap_entry *n;
-      n = list_head(entrylist);
-      while(n != NULL) {
-	if(n->mapped_port == mapped_port) {
-	  increase_mapped_port();
-	  n = list_head(entrylist);
-	} else {
-	  n = list_item_next(m);
-	}
-      }
-    }
-    m->mapped_port = mapped_port;
-    increase_mapped_port();
+    bucket = tuple_bucket(ip6addr, ip6port, ip4addr, ip4port, protocol);
+    m->hash_next = tuple_hash[bucket];
+    tuple_hash[bucket] = m;
+    bucket = port_bucket(m->mapped_port);
+    m->port_next = port_hash[bucket];
+    port_hash[bucket] = m;
+    wheel_add(m);
 
     list_add(entrylist, m);
     return m;
@@ -241,6 +408,12 @@ ip64_addrmap_set_lifetime(struct ip64_addrmap_entry *e,
 {
   if(e != NULL) {
     timer_set(&e->timer, time);
+    /* An extended lifetime is picked up when the entry's current
+       wheel slot is swept, a shortened one needs an earlier slot */
+    if((e->timer.start + time) / WHEEL_TICK < e->wheel_expiry) {
+      wheel_remove(e);
+      wheel_add(e);
+    }
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -38,7 +38,11 @@
 
 struct ip64_addrmap_entry {
   struct ip64_addrmap_entry *next;
+  /* Chains of the hash tables and of the timer wheel slot */
+  struct ip64_addrmap_entry *hash_next, *port_next, *wheel_next;
   struct timer timer;
+  /* The timer wheel tick the entry is filed under */
+  clock_time_t wheel_expiry;
   uip_ip6addr_t ip6addr;
   uip_ip4addr_t ip4addr;
   uint32_t ip6to4, ip4to6;
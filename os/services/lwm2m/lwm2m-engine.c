@@ -90,6 +90,26 @@
 #include "lwm2m-rd-client.h"
 #endif
 
+/* Number of object instances that can have a serialization template */
+#ifdef LWM2M_ENGINE_CONF_TEMPLATES
+#define LWM2M_ENGINE_TEMPLATES LWM2M_ENGINE_CONF_TEMPLATES
+#else
+#define LWM2M_ENGINE_TEMPLATES 0
+#endif /* LWM2M_ENGINE_CONF_TEMPLATES */
+
+#ifdef LWM2M_ENGINE_CONF_TEMPLATE_SIZE
+#define LWM2M_ENGINE_TEMPLATE_SIZE LWM2M_ENGINE_CONF_TEMPLATE_SIZE
+#else
+#define LWM2M_ENGINE_TEMPLATE_SIZE COAP_MAX_BLOCK_SIZE
+#endif /* LWM2M_ENGINE_CONF_TEMPLATE_SIZE */
+
+/* Must not be more than the bits in the dirty mask */
+#ifdef LWM2M_ENGINE_CONF_TEMPLATE_MAX_RESOURCES
+#define LWM2M_ENGINE_TEMPLATE_MAX_RESOURCES LWM2M_ENGINE_CONF_TEMPLATE_MAX_RESOURCES
+#else
+#define LWM2M_ENGINE_TEMPLATE_MAX_RESOURCES 16
+#endif /* LWM2M_ENGINE_CONF_TEMPLATE_MAX_RESOURCES */
+
 #if LWM2M_QUEUE_MODE_ENABLED
 #include "lwm2m-queue-mode.h"
 #include "lwm2m-notification-queue.h"
@@ -127,6 +147,28 @@ static uint64_t lwm2m_buf_lock_timeout = 0;
 static lwm2m_write_opaque_callback current_opaque_callback;
 static int current_opaque_offset = 0;
 
+#if LWM2M_ENGINE_TEMPLATES
+/* An instance read serialized with one writer. Resource at position i
+   of the instance occupies offset[i] .. offset[i] + length[i] in data. */
+typedef struct {
+  uint16_t object_id;
+  uint16_t instance_id;
+  /* NULL while the template needs to be (re)built */
+  const lwm2m_writer_t *writer;
+  uint32_t dirty;
+  uint16_t len;
+  /* where the first resource starts - after the writer's header */
+  uint16_t head;
+  uint16_t count;
+  uint16_t offset[LWM2M_ENGINE_TEMPLATE_MAX_RESOURCES];
+  uint16_t length[LWM2M_ENGINE_TEMPLATE_MAX_RESOURCES];
+  uint8_t used;
+  uint8_t data[LWM2M_ENGINE_TEMPLATE_SIZE];
+} lwm2m_template_t;
+
+static lwm2m_template_t templates[LWM2M_ENGINE_TEMPLATES];
+#endif /* LWM2M_ENGINE_TEMPLATES */
+
 static coap_handler_status_t lwm2m_handler_callback(coap_message_t *request,
                                                     coap_message_t *response,
                                                     uint8_t *buffer,
@@ -257,8 +299,9 @@ double_buffer_flush(lwm2m_buffer_t *ctxbuf, lwm2m_buffer_t *outbuf, int size)
     LOG_DBG("Double buffer - copying out %d bytes remaining: %d\n",
             size, ctxbuf->len - size);
     memcpy(outbuf->buffer, ctxbuf->buffer, size);
-    memcpy(ctxbuf->buffer, &ctxbuf->buffer[size],
-           ctxbuf->len - size);
+    if(ctxbuf->len > size) {
+      memmove(ctxbuf->buffer, &ctxbuf->buffer[size], ctxbuf->len - size);
+    }
     ctxbuf->len -= size;
     outbuf->len = size;
     return outbuf->len;
@@ -266,6 +309,107 @@ double_buffer_flush(lwm2m_buffer_t *ctxbuf, lwm2m_buffer_t *outbuf, int size)
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+#if LWM2M_ENGINE_TEMPLATES
+static lwm2m_template_t *
+get_template(uint16_t object_id, uint16_t instance_id)
+{
+  int i;
+  for(i = 0; i < LWM2M_ENGINE_TEMPLATES; i++) {
+    if(templates[i].used && templates[i].object_id == object_id &&
+       templates[i].instance_id == instance_id) {
+      return &templates[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Rebuild the templates of an instance, or of all instances of the
+   object with LWM2M_OBJECT_INSTANCE_NONE */
+static void
+invalidate_templates(uint16_t object_id, uint16_t instance_id)
+{
+  int i;
+  for(i = 0; i < LWM2M_ENGINE_TEMPLATES; i++) {
+    if(templates[i].object_id == object_id &&
+       (instance_id == LWM2M_OBJECT_INSTANCE_NONE ||
+        templates[i].instance_id == instance_id)) {
+      templates[i].writer = NULL;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Re-encode the changed resources in place and copy the template out.
+   Returns zero if the template could not be used and must be rebuilt. */
+static int
+refresh_template(lwm2m_template_t *t, lwm2m_object_instance_t *instance,
+                 lwm2m_context_t *ctx)
+{
+  lwm2m_buffer_t *outbuf = ctx->outbuf;
+  lwm2m_status_t success;
+  uint16_t start, oldlen, newlen;
+  int pos, i;
+
+  if(t->writer != ctx->writer || t->count != instance->resource_count) {
+    return 0;
+  }
+
+  /* The double buffer is free here and holds each re-encoded value */
+  ctx->outbuf = &lwm2m_buf;
+  for(pos = 0; pos < t->count && t->dirty != 0; pos++) {
+    if((t->dirty & (1UL << pos)) == 0) {
+      continue;
+    }
+    t->dirty &= ~(1UL << pos);
+    if(!RSC_READABLE(instance->resource_ids[pos])) {
+      continue;
+    }
+
+    start = t->offset[pos];
+    oldlen = t->length[pos];
+    lwm2m_buf.len = 0;
+    ctx->level = 3;
+    ctx->resource_id = RSC_ID(instance->resource_ids[pos]);
+    ctx->writer_flags = start > t->head ? WRITER_OUTPUT_VALUE : 0;
+    success = instance->callback(instance, ctx);
+    newlen = lwm2m_buf.len;
+
+    /* A resource that appears or disappears changes the separators of
+       the others */
+    if(success != LWM2M_STATUS_OK || current_opaque_callback != NULL ||
+       oldlen == 0 || newlen == 0 ||
+       t->len - oldlen + newlen > sizeof(t->data)) {
+      current_opaque_callback = NULL;
+      ctx->outbuf = outbuf;
+      ctx->level = 2;
+      return 0;
+    }
+
+    if(newlen != oldlen) {
+      memmove(&t->data[start + newlen], &t->data[start + oldlen],
+              t->len - start - oldlen);
+      for(i = pos + 1; i < t->count; i++) {
+        t->offset[i] += newlen - oldlen;
+      }
+      t->len += newlen - oldlen;
+      t->length[pos] = newlen;
+    }
+    memcpy(&t->data[start], lwm2m_buf.buffer, newlen);
+  }
+  lwm2m_buf.len = 0;
+  ctx->outbuf = outbuf;
+  ctx->level = 2;
+  ctx->writer_flags = 0;
+
+  if(t->len > outbuf->size) {
+    return 0;
+  }
+  memcpy(outbuf->buffer, t->data, t->len);
+  outbuf->len = t->len;
+  ctx->offset += t->len;
+  return 1;
+}
+#endif /* LWM2M_ENGINE_TEMPLATES */
+/*---------------------------------------------------------------------------*/
 static inline const char *
 get_method_as_string(coap_resource_flags_t method)
 {
@@ -656,6 +800,10 @@ perform_multi_resource_read_op(lwm2m_object_t *object,
   uint8_t initialized = 0; /* used for commas, etc */
   uint8_t num_read = 0;
   lwm2m_buffer_t *outbuf;
+#if LWM2M_ENGINE_TEMPLATES
+  lwm2m_template_t *tmpl = NULL;
+  uint16_t rsc_start = 0;
+#endif /* LWM2M_ENGINE_TEMPLATES */
 
   if(instance == NULL) {
     /* No existing instance */
@@ -688,6 +836,28 @@ perform_multi_resource_read_op(lwm2m_object_t *object,
           ctx->object_id, ctx->object_instance_id, ctx->resource_id,
           ctx->level, ctx->offset);
 
+#if LWM2M_ENGINE_TEMPLATES
+  if(ctx->operation == LWM2M_OP_READ && ctx->level == 2 && ctx->offset == 0) {
+    tmpl = get_template(instance->object_id, instance->instance_id);
+    if(tmpl != NULL) {
+      if(refresh_template(tmpl, instance, ctx)) {
+        LOG_DBG("MultiRead: %u bytes from template\n", tmpl->len);
+        lwm2m_buf_lock[0] = 0;
+        return LWM2M_STATUS_OK;
+      }
+      if(instance->resource_count > LWM2M_ENGINE_TEMPLATE_MAX_RESOURCES) {
+        tmpl = NULL;
+      } else {
+        /* Rebuilt from this read */
+        tmpl->writer = NULL;
+        tmpl->dirty = 0;
+        tmpl->head = 0;
+        tmpl->count = instance->resource_count;
+      }
+    }
+  }
+#endif /* LWM2M_ENGINE_TEMPLATES */
+
   /* Make use of the double buffer */
   ctx->outbuf = &lwm2m_buf;
 
@@ -789,7 +959,15 @@ perform_multi_resource_read_op(lwm2m_object_t *object,
                 ctx->outbuf->len += len;
                 LOG_DBG("INIT WRITE len:%d size:%"PRIu16"\n", len, ctx->outbuf->size);
                 initialized = 1;
+#if LWM2M_ENGINE_TEMPLATES
+                if(tmpl != NULL) {
+                  tmpl->head = ctx->outbuf->len;
+                }
+#endif /* LWM2M_ENGINE_TEMPLATES */
               }
+#if LWM2M_ENGINE_TEMPLATES
+              rsc_start = ctx->outbuf->len;
+#endif /* LWM2M_ENGINE_TEMPLATES */
 
               if(current_opaque_callback == NULL) {
                 LOG_DBG("Doing the callback to the resource %d\n", ctx->outbuf->len);
@@ -817,6 +995,10 @@ perform_multi_resource_read_op(lwm2m_object_t *object,
               }
               if(current_opaque_callback != NULL) {
                 uint32_t old_offset = ctx->offset;
+#if LWM2M_ENGINE_TEMPLATES
+                /* Streamed values are not kept in templates */
+                tmpl = NULL;
+#endif /* LWM2M_ENGINE_TEMPLATES */
                 int num_write = COAP_MAX_BLOCK_SIZE - ctx->outbuf->len;
                 /* Check if the callback did set a opaque callback function - then
                    we should produce data via that callback until the opaque has fully
@@ -846,9 +1028,21 @@ perform_multi_resource_read_op(lwm2m_object_t *object,
 
               /* we need to handle full buffer, etc here also! */
               ctx->level = lv;
+#if LWM2M_ENGINE_TEMPLATES
+              if(tmpl != NULL) {
+                tmpl->offset[last_rsc_pos] = rsc_start;
+                tmpl->length[last_rsc_pos] = ctx->outbuf->len - rsc_start;
+              }
+#endif /* LWM2M_ENGINE_TEMPLATES */
             } else {
               LOG_DBG("Resource %u not readable\n",
                       RSC_ID(instance->resource_ids[last_rsc_pos]));
+#if LWM2M_ENGINE_TEMPLATES
+              if(tmpl != NULL) {
+                tmpl->offset[last_rsc_pos] = ctx->outbuf->len;
+                tmpl->length[last_rsc_pos] = 0;
+              }
+#endif /* LWM2M_ENGINE_TEMPLATES */
             }
           }
         }
@@ -905,6 +1099,18 @@ perform_multi_resource_read_op(lwm2m_object_t *object,
     return LWM2M_STATUS_NOT_FOUND;
   }
 
+#if LWM2M_ENGINE_TEMPLATES
+  /* Keep the read as a template if it fits in a single block */
+  if(tmpl != NULL && ctx->offset == 0 &&
+     lwm2m_buf.len <= size && lwm2m_buf.len <= sizeof(tmpl->data)) {
+    memcpy(tmpl->data, lwm2m_buf.buffer, lwm2m_buf.len);
+    tmpl->len = lwm2m_buf.len;
+    tmpl->writer = ctx->writer;
+    LOG_DBG("MultiRead: template of %u bytes for %u/%u\n", tmpl->len,
+            tmpl->object_id, tmpl->instance_id);
+  }
+#endif /* LWM2M_ENGINE_TEMPLATES */
+
   /* seems like we are done! - flush buffer */
   len = double_buffer_flush(ctx->outbuf, outbuf, size);
   ctx->outbuf = outbuf;
@@ -1276,6 +1482,15 @@ void
 lwm2m_engine_remove_object(lwm2m_object_instance_t *object)
 {
   list_remove(object_list, object);
+#if LWM2M_ENGINE_TEMPLATES
+  {
+    lwm2m_template_t *t;
+    t = get_template(object->object_id, object->instance_id);
+    if(t != NULL) {
+      t->used = 0;
+    }
+  }
+#endif /* LWM2M_ENGINE_TEMPLATES */
 #if USE_RD_CLIENT
   lwm2m_rd_client_set_update_rd();
 #endif
@@ -1563,6 +1778,15 @@ lwm2m_queue_mode_request_received();
     context.offset = boffset;
   }
 
+#if LWM2M_ENGINE_TEMPLATES
+  if(context.operation != LWM2M_OP_READ &&
+     context.operation != LWM2M_OP_DISCOVER) {
+    invalidate_templates(context.object_id, context.level < 2 ?
+                         LWM2M_OBJECT_INSTANCE_NONE :
+                         context.object_instance_id);
+  }
+#endif /* LWM2M_ENGINE_TEMPLATES */
+
   /* This is a discovery operation */
   switch(context.operation) {
   case LWM2M_OP_DISCOVER:
@@ -1664,18 +1888,82 @@ lwm2m_send_notification(char* path)
   coap_notify_observers_sub(NULL, path);
 }
 /*---------------------------------------------------------------------------*/
+int
+lwm2m_engine_use_template(lwm2m_object_instance_t *instance)
+{
+#if LWM2M_ENGINE_TEMPLATES
+  lwm2m_template_t *t;
+  int i;
+
+  if(instance == NULL ||
+     instance->resource_count > LWM2M_ENGINE_TEMPLATE_MAX_RESOURCES) {
+    return 0;
+  }
+  t = get_template(instance->object_id, instance->instance_id);
+  for(i = 0; t == NULL && i < LWM2M_ENGINE_TEMPLATES; i++) {
+    if(!templates[i].used) {
+      t = &templates[i];
+    }
+  }
+  if(t == NULL) {
+    LOG_WARN("no free template for %u/%u\n",
+             instance->object_id, instance->instance_id);
+    return 0;
+  }
+  t->used = 1;
+  t->object_id = instance->object_id;
+  t->instance_id = instance->instance_id;
+  t->writer = NULL;
+  return 1;
+#else /* LWM2M_ENGINE_TEMPLATES */
+  return 0;
+#endif /* LWM2M_ENGINE_TEMPLATES */
+}
+/*---------------------------------------------------------------------------*/
+void
+lwm2m_engine_resource_changed(lwm2m_object_instance_t *instance,
+                              uint16_t resource)
+{
+#if LWM2M_ENGINE_TEMPLATES
+  lwm2m_template_t *t;
+  int i;
+
+  if(instance == NULL) {
+    return;
+  }
+  t = get_template(instance->object_id, instance->instance_id);
+  if(t == NULL || t->writer == NULL) {
+    return;
+  }
+  for(i = 0; i < t->count && i < instance->resource_count; i++) {
+    if(RSC_ID(instance->resource_ids[i]) == resource) {
+      t->dirty |= 1UL << i;
+      return;
+    }
+  }
+#endif /* LWM2M_ENGINE_TEMPLATES */
+}
+/*---------------------------------------------------------------------------*/
 void 
 lwm2m_notify_object_observers(lwm2m_object_instance_t *obj,
                                    uint16_t resource)
 {
   char path[20]; /* 60000/60000/60000 */
+#if LWM2M_QUEUE_MODE_ENABLED
+  char object_path[6];
+#endif
+
   if(obj != NULL) {
     snprintf(path, 20, "%d/%d/%d", obj->object_id, obj->instance_id, resource);
   }
 
+  lwm2m_engine_resource_changed(obj, resource);
+
 #if LWM2M_QUEUE_MODE_ENABLED
-  
-  if(coap_has_observers(path)) {
+  /* Observers of the instance or the object are notified from the
+     queue too */
+  snprintf(object_path, sizeof(object_path), "%u", obj->object_id);
+  if(coap_has_observers(object_path)) {
     /* Client is sleeping -> add the notification to the list */
     if(!lwm2m_rd_client_is_client_awake()) {
       lwm2m_notification_queue_add_notification_path(obj->object_id, obj->instance_id, resource);
@@ -114,6 +114,24 @@ void lwm2m_engine_remove_generic_object(lwm2m_object_t *object);
 void lwm2m_notify_object_observers(lwm2m_object_instance_t *obj,
                                    uint16_t resource);
 
+/*
+ * Serialization templates (LWM2M_ENGINE_CONF_TEMPLATES > 0).
+ *
+ * A read of a whole object instance is kept as a TLV/JSON template with
+ * the position of each resource in it. Later reads re-encode only the
+ * resources that changed since and copy the template into the CoAP
+ * payload. An instance with a template must report every value change,
+ * either with lwm2m_notify_object_observers() or with
+ * lwm2m_engine_resource_changed(). Writes, executes, creates and deletes
+ * on the instance rebuild the template.
+ *
+ * lwm2m_engine_use_template() returns non-zero if a template was bound
+ * to the instance.
+ */
+int  lwm2m_engine_use_template(lwm2m_object_instance_t *instance);
+void lwm2m_engine_resource_changed(lwm2m_object_instance_t *instance,
+                                   uint16_t resource);
+
 void lwm2m_engine_set_opaque_callback(lwm2m_context_t *ctx, lwm2m_write_opaque_callback cb);
 
 #endif /* LWM2M_ENGINE_H */
@@ -66,15 +66,38 @@
 #define LWM2M_NOTIFICATION_QUEUE_LENGTH COAP_MAX_OBSERVERS
 #endif
 
+/* Number of buckets for finding queued paths - a power of two */
+#ifdef LWM2M_NOTIFICATION_QUEUE_CONF_HASH_SIZE
+#define LWM2M_NOTIFICATION_QUEUE_HASH_SIZE LWM2M_NOTIFICATION_QUEUE_CONF_HASH_SIZE
+#else
+#define LWM2M_NOTIFICATION_QUEUE_HASH_SIZE 16
+#endif
+
+/* Number of objects that can have a priority set */
+#ifdef LWM2M_NOTIFICATION_QUEUE_CONF_PRIORITIES
+#define LWM2M_NOTIFICATION_QUEUE_PRIORITIES LWM2M_NOTIFICATION_QUEUE_CONF_PRIORITIES
+#else
+#define LWM2M_NOTIFICATION_QUEUE_PRIORITIES 4
+#endif
+
 /*---------------------------------------------------------------------------*/
 /* Queue to store the notifications in the period when the client has woken up, sent the update and it's waiting for the server response*/
 MEMB(notification_memb, notification_path_t, LWM2M_NOTIFICATION_QUEUE_LENGTH); /* Length + 1 to allocate the new path to add */
+/* Sorted by priority, highest first */
 LIST(notification_paths_queue);
+static notification_path_t *notification_paths_hash[LWM2M_NOTIFICATION_QUEUE_HASH_SIZE];
+
+static struct {
+  uint16_t object_id;
+  uint8_t priority;
+} priorities[LWM2M_NOTIFICATION_QUEUE_PRIORITIES];
+static uint8_t priorities_count;
 /*---------------------------------------------------------------------------*/
 void
 lwm2m_notification_queue_init(void)
 {
   list_init(notification_paths_queue);
+  memset(notification_paths_hash, 0, sizeof(notification_paths_hash));
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -93,16 +116,26 @@ extend_path(notification_path_t *path_object, char *path, int path_size)
   }
 }
 /*---------------------------------------------------------------------------*/
+static notification_path_t **
+get_bucket(uint16_t object_id, uint16_t instance_id, uint16_t resource_id)
+{
+  uint32_t h;
+  h = object_id * 31 + instance_id;
+  h = h * 31 + resource_id;
+  return &notification_paths_hash[(h ^ (h >> 7)) &
+                                  (LWM2M_NOTIFICATION_QUEUE_HASH_SIZE - 1)];
+}
+/*---------------------------------------------------------------------------*/
 static int
 is_notification_path_present(uint16_t object_id, uint16_t instance_id, uint16_t resource_id)
 {
-  notification_path_t *iteration_path = (notification_path_t *)list_head(notification_paths_queue);
+  notification_path_t *iteration_path = *get_bucket(object_id, instance_id, resource_id);
   while(iteration_path != NULL) {
     if(iteration_path->reduced_path[0] == object_id && iteration_path->reduced_path[1] == instance_id
        && iteration_path->reduced_path[2] == resource_id) {
       return 1;
     }
-    iteration_path = iteration_path->next;
+    iteration_path = iteration_path->hash_next;
   }
   return 0;
 }
@@ -110,44 +143,141 @@ is_notification_path_present(uint16_t object_id, uint16_t instance_id, uint16_t
 static void
 remove_notification_path(notification_path_t *path)
 {
+  notification_path_t **p;
+
+  p = get_bucket(path->reduced_path[0], path->reduced_path[1], path->reduced_path[2]);
+  while(*p != path) {
+    p = &(*p)->hash_next;
+  }
+  *p = path->hash_next;
   list_remove(notification_paths_queue, path);
   memb_free(&notification_memb, path);
 }
 /*---------------------------------------------------------------------------*/
+static uint8_t
+get_priority(uint16_t object_id)
+{
+  int i;
+  for(i = 0; i < priorities_count; i++) {
+    if(priorities[i].object_id == object_id) {
+      return priorities[i].priority;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+lwm2m_notification_queue_set_priority(uint16_t object_id, uint8_t priority)
+{
+  int i;
+  for(i = 0; i < priorities_count; i++) {
+    if(priorities[i].object_id == object_id) {
+      priorities[i].priority = priority;
+      return;
+    }
+  }
+  if(priorities_count == LWM2M_NOTIFICATION_QUEUE_PRIORITIES) {
+    LOG_WARN("No room for the priority of object %u\n", object_id);
+    return;
+  }
+  priorities[priorities_count].object_id = object_id;
+  priorities[priorities_count].priority = priority;
+  priorities_count++;
+}
+/*---------------------------------------------------------------------------*/
 void
 lwm2m_notification_queue_add_notification_path(uint16_t object_id, uint16_t instance_id, uint16_t resource_id)
 {
+  notification_path_t *path_object;
+  notification_path_t *previous;
+  notification_path_t **bucket;
+  uint8_t priority;
+
   if(is_notification_path_present(object_id, instance_id, resource_id)) {
     LOG_DBG("Notification path already present, not queueing it\n");
     return;
   }
-  notification_path_t *path_object = memb_alloc(&notification_memb);
+  priority = get_priority(object_id);
+  path_object = memb_alloc(&notification_memb);
   if(path_object == NULL) {
-    LOG_DBG("Queue is full, could not allocate new notification\n");
-    return;
+    /* The last path has the lowest priority */
+    previous = list_tail(notification_paths_queue);
+    if(previous == NULL || previous->priority >= priority) {
+      LOG_DBG("Queue is full, could not allocate new notification\n");
+      return;
+    }
+    LOG_DBG("Queue is full, dropping %u/%u/%u\n", previous->reduced_path[0],
+            previous->reduced_path[1], previous->reduced_path[2]);
+    remove_notification_path(previous);
+    path_object = memb_alloc(&notification_memb);
   }
   path_object->reduced_path[0] = object_id;
   path_object->reduced_path[1] = instance_id;
   path_object->reduced_path[2] = resource_id;
   path_object->level = 3;
-  list_add(notification_paths_queue, path_object);
+  path_object->priority = priority;
+
+  bucket = get_bucket(object_id, instance_id, resource_id);
+  path_object->hash_next = *bucket;
+  *bucket = path_object;
+
+  /* After the paths of the same or higher priority */
+  previous = NULL;
+  if(priority > 0) {
+    notification_path_t *p;
+    for(p = list_head(notification_paths_queue);
+        p != NULL && p->priority >= priority; p = p->next) {
+      previous = p;
+    }
+  } else {
+    previous = list_tail(notification_paths_queue);
+  }
+  list_insert(notification_paths_queue, previous, path_object);
   LOG_DBG("Notification path added to the list: %u/%u/%u\n", object_id, instance_id, resource_id);
 }
 /*---------------------------------------------------------------------------*/
 void
 lwm2m_notification_queue_send_notifications()
 {
+  /* The instances and objects that have already been notified */
+  uint32_t instances[LWM2M_NOTIFICATION_QUEUE_LENGTH];
+  uint16_t objects[LWM2M_NOTIFICATION_QUEUE_LENGTH];
+  int instances_count = 0;
+  int objects_count = 0;
+  uint32_t instance;
   char path[20];
   notification_path_t *iteration_path = (notification_path_t *)list_head(notification_paths_queue);
   notification_path_t *aux = iteration_path;
+  int i;
 
   while(iteration_path != NULL) {
-    extend_path(iteration_path, path, sizeof(path));
 #if LWM2M_QUEUE_MODE_INCLUDE_DYNAMIC_ADAPTATION
     if(lwm2m_queue_mode_get_dynamic_adaptation_flag()) {
       lwm2m_queue_mode_set_handler_from_notification();
     }
 #endif
+
+    /* One notification per observed object and instance, covering all
+       of their changed resources */
+    for(i = 0; i < objects_count &&
+          objects[i] != iteration_path->reduced_path[0]; i++);
+    if(i == objects_count) {
+      objects[objects_count++] = iteration_path->reduced_path[0];
+      snprintf(path, sizeof(path), "%u", iteration_path->reduced_path[0]);
+      coap_notify_observers_exact(path);
+    }
+    instance = ((uint32_t)iteration_path->reduced_path[0] << 16) |
+      iteration_path->reduced_path[1];
+    for(i = 0; i < instances_count && instances[i] != instance; i++);
+    if(i == instances_count) {
+      instances[instances_count++] = instance;
+      snprintf(path, sizeof(path), "%u/%u", iteration_path->reduced_path[0],
+               iteration_path->reduced_path[1]);
+      LOG_DBG("Sending stored notification with path: %s\n", path);
+      coap_notify_observers_exact(path);
+    }
+
+    extend_path(iteration_path, path, sizeof(path));
     LOG_DBG("Sending stored notification with path: %s\n", path);
     coap_notify_observers_sub(NULL, path);
     aux = iteration_path;
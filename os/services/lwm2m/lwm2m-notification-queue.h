@@ -51,14 +51,29 @@
 
 typedef struct notification_path {
   struct notification_path *next;
+  /* Next path in the same hash bucket */
+  struct notification_path *hash_next;
   uint16_t reduced_path[3];
   uint8_t level; /* The depth level of the path: 1. object, 2. object/instance, 3. object/instance/resource */
+  uint8_t priority;
 } notification_path_t;
 
 void lwm2m_notification_queue_init(void);
 
 void lwm2m_notification_queue_add_notification_path(uint16_t object_id, uint16_t instance_id, uint16_t resource_id);
 
+/*
+ * Stored notifications are sent in order of priority, highest first,
+ * and in the order they were queued within a priority. Objects have
+ * priority 0 unless set here. When the queue is full a new path
+ * replaces the last one if it has higher priority.
+ */
+void lwm2m_notification_queue_set_priority(uint16_t object_id, uint8_t priority);
+
+/*
+ * Sends the stored notifications. Observers of an object instance or
+ * of an object get a single notification for all its changed resources.
+ */
 void lwm2m_notification_queue_send_notifications();
 
 #endif /* LWM2M_NOTIFICATION_QUEUE_H */
@@ -119,7 +119,6 @@ lwm2m_queue_mode_set_dynamic_adaptation_flag(uint8_t flag)
 {
   queue_mode_dynamic_adaptation_flag = flag;
 }
-#endif
 /*---------------------------------------------------------------------------*/
 #if !UPDATE_WITH_MEAN
 static uint16_t
@@ -181,6 +180,7 @@ lwm2m_queue_mode_add_time_to_window(uint16_t time)
   times_window_index++;
   update_awake_time();
 }
+#endif /* LWM2M_QUEUE_MODE_INCLUDE_DYNAMIC_ADAPTATION */
 /*---------------------------------------------------------------------------*/
 uint8_t
 lwm2m_queue_mode_is_waked_up_by_notification()
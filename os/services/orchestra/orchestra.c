@@ -92,11 +92,17 @@ orchestra_callback_child_added(const linkaddr_t *addr)
 {
   /* Notify all Orchestra rules that a child was added */
   int i;
+  int batched;
+  /* Apply all schedule changes under a single TSCH lock */
+  batched = tsch_schedule_update_begin();
   for(i = 0; i < NUM_RULES; i++) {
     if(all_rules[i]->child_added != NULL) {
       all_rules[i]->child_added(addr);
     }
   }
+  if(batched) {
+    tsch_schedule_update_commit();
+  }
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -104,11 +110,17 @@ orchestra_callback_child_removed(const linkaddr_t *addr)
 {
   /* Notify all Orchestra rules that a child was removed */
   int i;
+  int batched;
+  /* Apply all schedule changes under a single TSCH lock */
+  batched = tsch_schedule_update_begin();
   for(i = 0; i < NUM_RULES; i++) {
     if(all_rules[i]->child_removed != NULL) {
       all_rules[i]->child_removed(addr);
     }
   }
+  if(batched) {
+    tsch_schedule_update_commit();
+  }
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -152,26 +164,38 @@ orchestra_callback_new_time_source(const struct tsch_neighbor *old, const struct
    * */
 
   int i;
+  int batched;
   if(new != old) {
     orchestra_parent_knows_us = 0;
   }
+  /* Apply all schedule changes under a single TSCH lock */
+  batched = tsch_schedule_update_begin();
   for(i = 0; i < NUM_RULES; i++) {
     if(all_rules[i]->new_time_source != NULL) {
       all_rules[i]->new_time_source(old, new);
     }
   }
+  if(batched) {
+    tsch_schedule_update_commit();
+  }
 }
 /*---------------------------------------------------------------------------*/
 void
 orchestra_callback_root_node_updated(const linkaddr_t *root, uint8_t is_added)
 {
   int i;
+  int batched;
 
+  /* Apply all schedule changes under a single TSCH lock */
+  batched = tsch_schedule_update_begin();
   for(i = 0; i < NUM_RULES; i++) {
     if(all_rules[i]->root_node_updated != NULL) {
       all_rules[i]->root_node_updated(root, is_added);
     }
   }
+  if(batched) {
+    tsch_schedule_update_commit();
+  }
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -72,9 +72,7 @@
 
 #if UIP_UDP
 #include <string.h>
-#if RESOLV_CONF_SUPPORTS_MDNS
 #include <ctype.h>
-#endif /* RESOLV_CONF_SUPPORTS_MDNS */
 
 #include "sys/log.h"
 #define LOG_MODULE "Resolv"
@@ -126,6 +124,12 @@ int strncasecmp(const char *s1, const char *s2, size_t n);
 #define RESOLV_SUPPORTS_RECORD_EXPIRATION 1
 #endif
 
+/** How many seconds a not-found answer is cached, unless the server
+    gives a shorter time in its SOA record */
+#ifndef RESOLV_CONF_NEGATIVE_TTL
+#define RESOLV_CONF_NEGATIVE_TTL 30
+#endif
+
 #if RESOLV_CONF_SUPPORTS_MDNS && !RESOLV_VERIFY_ANSWER_NAMES
 #error RESOLV_CONF_SUPPORTS_MDNS cannot be set without RESOLV_CONF_VERIFY_ANSWER_NAMES
 #endif
@@ -146,6 +150,7 @@ int strncasecmp(const char *s1, const char *s2, size_t n);
 
 #define DNS_TYPE_A      1
 #define DNS_TYPE_CNAME  5
+#define DNS_TYPE_SOA    6
 #define DNS_TYPE_PTR   12
 #define DNS_TYPE_MX    15
 #define DNS_TYPE_TXT   16
@@ -210,7 +215,10 @@ struct namemap {
 #define STATE_ASKING 3
 #define STATE_DONE   4
   uint8_t state;
-  uint8_t tmr;
+  /* Index + 1 of the next entry in the same hash bucket, or 0 */
+  uint8_t hash_next;
+  uint16_t hash;
+  struct timer tmr;
   uint16_t id;
   uint8_t retries;
   uint8_t seqno;
@@ -233,12 +241,27 @@ struct namemap {
 #define RESOLV_ENTRIES UIP_CONF_RESOLV_ENTRIES
 #endif /* UIP_CONF_RESOLV_ENTRIES */
 
+#ifdef RESOLV_CONF_HASH_SIZE
+#define RESOLV_HASH_SIZE RESOLV_CONF_HASH_SIZE
+#else /* RESOLV_CONF_HASH_SIZE */
+#define RESOLV_HASH_SIZE RESOLV_ENTRIES
+#endif /* RESOLV_CONF_HASH_SIZE */
+
 static struct namemap names[RESOLV_ENTRIES];
+/* Index + 1 of the first entry in each hash bucket, or 0 */
+static uint8_t buckets[RESOLV_HASH_SIZE];
 static uint8_t seqno;
 static struct uip_udp_conn *resolv_conn = NULL;
 static struct etimer retry;
 process_event_t resolv_event_found;
 
+#if RESOLV_STATS
+struct resolv_stats resolv_stats;
+#define RESOLV_STAT(code) (code)
+#else /* RESOLV_STATS */
+#define RESOLV_STAT(code)
+#endif /* RESOLV_STATS */
+
 PROCESS(resolv_process, "DNS resolver");
 
 static void resolv_found(char *name, uip_ipaddr_t *ipaddr);
@@ -553,6 +576,115 @@ mdns_prep_host_announce_packet(void)
 }
 #endif /* RESOLV_CONF_SUPPORTS_MDNS */
 /*---------------------------------------------------------------------------*/
+/** \internal
+ * Case-insensitive hash of a name, as names are compared with
+ * strcasecmp().
+ */
+static uint16_t
+name_hash(const char *name)
+{
+  uint16_t hash = 5381;
+
+  while(*name) {
+    hash = hash * 33 + tolower((unsigned char)*name++);
+  }
+  return hash;
+}
+/*---------------------------------------------------------------------------*/
+static void
+unlink_name(struct namemap *namemapptr)
+{
+  uint8_t *next;
+
+  if(namemapptr->name[0] == 0) {
+    return;
+  }
+  for(next = &buckets[namemapptr->hash % RESOLV_HASH_SIZE]; *next != 0;
+      next = &names[*next - 1].hash_next) {
+    if(&names[*next - 1] == namemapptr) {
+      *next = namemapptr->hash_next;
+      break;
+    }
+  }
+  namemapptr->hash_next = 0;
+}
+/*---------------------------------------------------------------------------*/
+/** \internal
+ * Gives an entry a new name. The rest of the entry is cleared.
+ */
+static void
+set_name(struct namemap *namemapptr, const char *name)
+{
+  uint8_t *bucket;
+
+  unlink_name(namemapptr);
+  memset(namemapptr, 0, sizeof(*namemapptr));
+  strncpy(namemapptr->name, name, sizeof(namemapptr->name) - 1);
+  namemapptr->hash = name_hash(namemapptr->name);
+  bucket = &buckets[namemapptr->hash % RESOLV_HASH_SIZE];
+  namemapptr->hash_next = *bucket;
+  *bucket = namemapptr - names + 1;
+}
+/*---------------------------------------------------------------------------*/
+static struct namemap *
+find_name(const char *name)
+{
+  struct namemap *namemapptr;
+  uint16_t hash;
+  uint8_t i;
+
+  hash = name_hash(name);
+  for(i = buckets[hash % RESOLV_HASH_SIZE]; i != 0;
+      i = namemapptr->hash_next) {
+    namemapptr = &names[i - 1];
+    if(namemapptr->hash == hash && strcasecmp(namemapptr->name, name) == 0) {
+      return namemapptr;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/** \internal
+ * Returns how long a not-found answer may be cached: the smaller of
+ * the TTL and the minimum field of an SOA record in the authority
+ * section, as in RFC 2308, or RESOLV_CONF_NEGATIVE_TTL without one.
+ */
+static uint32_t
+negative_ttl(unsigned char *queryptr, uint8_t nanswers, uint8_t nauthrr)
+{
+  const unsigned char *end = (unsigned char *)uip_appdata + uip_datalen();
+  uint32_t ttl, minimum;
+  uint16_t rdlen;
+
+  for(; nanswers > 0 && queryptr < end; --nanswers) {
+    queryptr = skip_name(queryptr);
+    if(queryptr + 10 > end) {
+      return RESOLV_CONF_NEGATIVE_TTL;
+    }
+    queryptr += 10 + ((queryptr[8] << 8) | queryptr[9]);
+  }
+  for(; nauthrr > 0 && queryptr < end; --nauthrr) {
+    queryptr = skip_name(queryptr);
+    if(queryptr + 10 > end) {
+      break;
+    }
+    rdlen = (queryptr[8] << 8) | queryptr[9];
+    if(((queryptr[0] << 8) | queryptr[1]) == DNS_TYPE_SOA &&
+       rdlen >= 22 && queryptr + 10 + rdlen <= end) {
+      ttl = ((uint32_t)queryptr[4] << 24) | ((uint32_t)queryptr[5] << 16) |
+        ((uint32_t)queryptr[6] << 8) | queryptr[7];
+      queryptr += 10 + rdlen - 4;
+      minimum = ((uint32_t)queryptr[0] << 24) |
+        ((uint32_t)queryptr[1] << 16) |
+        ((uint32_t)queryptr[2] << 8) | queryptr[3];
+      ttl = MIN(ttl, minimum);
+      return MIN(ttl, RESOLV_CONF_NEGATIVE_TTL);
+    }
+    queryptr += 10 + rdlen;
+  }
+  return RESOLV_CONF_NEGATIVE_TTL;
+}
+/*---------------------------------------------------------------------------*/
 static char
 try_next_server(struct namemap *namemapptr)
 {
@@ -570,132 +702,176 @@ try_next_server(struct namemap *namemapptr)
 }
 /*---------------------------------------------------------------------------*/
 /** \internal
- * Runs through the list of names to see if there are any that have
- * not yet been queried and, if so, sends out a query.
+ * Sends out a query for a name.
  */
 static void
-check_entries(void)
+send_query(struct namemap *namemapptr)
 {
-  uint8_t i;
+  struct dns_hdr *hdr = (struct dns_hdr *)uip_appdata;
+  memset(hdr, 0, sizeof(struct dns_hdr));
+  hdr->id = random_rand();
+  namemapptr->id = hdr->id;
 
-  for(i = 0; i < RESOLV_ENTRIES; ++i) {
-    struct namemap *namemapptr = &names[i];
-    if(namemapptr->state == STATE_NEW || namemapptr->state == STATE_ASKING) {
-      etimer_set(&retry, CLOCK_SECOND / 4);
-      if(namemapptr->state == STATE_ASKING) {
-        if(namemapptr->tmr == 0 || --namemapptr->tmr == 0) {
 #if RESOLV_CONF_SUPPORTS_MDNS
-          if(++namemapptr->retries ==
-             (namemapptr->is_mdns ? RESOLV_CONF_MAX_MDNS_RETRIES :
-              RESOLV_CONF_MAX_RETRIES))
+  if(!namemapptr->is_mdns || namemapptr->is_probe) {
+    hdr->flags1 = DNS_FLAG1_RD;
+  }
+  if(namemapptr->is_mdns) {
+    hdr->id = 0;
+  }
 #else /* RESOLV_CONF_SUPPORTS_MDNS */
-          if(++namemapptr->retries == RESOLV_CONF_MAX_RETRIES)
+  hdr->flags1 = DNS_FLAG1_RD;
 #endif /* RESOLV_CONF_SUPPORTS_MDNS */
-          {
-            /* Try the next server (if possible) before failing. Otherwise
-               simply mark the entry as failed. */
-            if(try_next_server(namemapptr) == 0) {
-              /* STATE_ERROR basically means "not found". */
-              namemapptr->state = STATE_ERROR;
 
-#if RESOLV_SUPPORTS_RECORD_EXPIRATION
-              /* Keep the "not found" error valid for 30 seconds */
-              namemapptr->expiration = clock_seconds() + 30;
-#endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
-
-              resolv_found(namemapptr->name, NULL);
-              continue;
-            }
-          }
-          namemapptr->tmr = namemapptr->retries * namemapptr->retries * 3;
+  hdr->numquestions = UIP_HTONS(1);
+  uint8_t *query = (unsigned char *)uip_appdata + sizeof(*hdr);
+  query = encode_name(query, namemapptr->name);
 
 #if RESOLV_CONF_SUPPORTS_MDNS
-          if(namemapptr->is_probe) {
-            /* Probing retries are much more aggressive, 250ms */
-            namemapptr->tmr = 2;
-          }
+  if(namemapptr->is_probe) {
+    *query++ = (uint8_t)((DNS_TYPE_ANY) >> 8);
+    *query++ = (uint8_t)((DNS_TYPE_ANY));
+  } else
 #endif /* RESOLV_CONF_SUPPORTS_MDNS */
-        } else {
-          /* Its timer has not run out, so we move on to next entry. */
-          continue;
-        }
-      } else {
-        namemapptr->state = STATE_ASKING;
-        namemapptr->tmr = 1;
-        namemapptr->retries = 0;
-      }
+  {
+    *query++ = (uint8_t)(NATIVE_DNS_TYPE >> 8);
+    *query++ = (uint8_t)NATIVE_DNS_TYPE;
+  }
+  *query++ = (uint8_t)(DNS_CLASS_IN >> 8);
+  *query++ = (uint8_t)DNS_CLASS_IN;
+#if RESOLV_CONF_SUPPORTS_MDNS
+  if(namemapptr->is_mdns) {
+    if(namemapptr->is_probe) {
+      /* This is our conflict detection request.
+       * In order to be in compliance with the MDNS
+       * spec, we need to add the records we are proposing
+       * to the rrauth section.
+       */
+      uint8_t count = 0;
 
-      struct dns_hdr *hdr = (struct dns_hdr *)uip_appdata;
-      memset(hdr, 0, sizeof(struct dns_hdr));
-      hdr->id = random_rand();
-      namemapptr->id = hdr->id;
+      query = mdns_write_announce_records(query, &count);
+      hdr->numauthrr = UIP_HTONS(count);
+    }
+    uip_udp_packet_sendto(resolv_conn, uip_appdata,
+                          (query - (uint8_t *)uip_appdata),
+                          &resolv_mdns_addr, UIP_HTONS(MDNS_PORT));
 
+    LOG_DBG("Sent MDNS %s for \"%s\"\n",
+            namemapptr->is_probe ? "probe" : "request", namemapptr->name);
+  } else {
+    uip_udp_packet_sendto(resolv_conn, uip_appdata,
+                          (query - (uint8_t *)uip_appdata),
+                          (const uip_ipaddr_t *)
+                          uip_nameserver_get(namemapptr->server),
+                          UIP_HTONS(DNS_PORT));
+
+    LOG_DBG("Sent DNS request for \"%s\"\n", namemapptr->name);
+  }
+#else /* RESOLV_CONF_SUPPORTS_MDNS */
+  uip_udp_packet_sendto(resolv_conn, uip_appdata,
+                        (query - (uint8_t *)uip_appdata),
+                        uip_nameserver_get(namemapptr->server),
+                        UIP_HTONS(DNS_PORT));
+  LOG_DBG("Sent DNS request for \"%s\"\n", namemapptr->name);
+#endif /* RESOLV_CONF_SUPPORTS_MDNS */
+  RESOLV_STAT(resolv_stats.queries++);
+}
+/*---------------------------------------------------------------------------*/
+/** \internal
+ * How long to wait for an answer before asking again.
+ */
+static clock_time_t
+retry_interval(struct namemap *namemapptr)
+{
 #if RESOLV_CONF_SUPPORTS_MDNS
-      if(!namemapptr->is_mdns || namemapptr->is_probe) {
-        hdr->flags1 = DNS_FLAG1_RD;
+  if(namemapptr->is_probe) {
+    /* Probing retries are much more aggressive */
+    return CLOCK_SECOND / 2;
+  }
+#endif /* RESOLV_CONF_SUPPORTS_MDNS */
+  if(namemapptr->retries == 0) {
+    return CLOCK_SECOND / 4;
+  }
+  return namemapptr->retries * namemapptr->retries * 3 * (CLOCK_SECOND / 4);
+}
+/*---------------------------------------------------------------------------*/
+/** \internal
+ * Runs through the list of names to see if there are any that have
+ * not yet been queried, or whose retry timer has expired, and if so,
+ * sends out a query. The retry timer is then set to the earliest
+ * retry time of the names still being resolved.
+ */
+static void
+check_entries(void)
+{
+  struct namemap *namemapptr, *next = NULL;
+  uint8_t i;
+  bool sent = false;
+
+  for(i = 0; i < RESOLV_ENTRIES; ++i) {
+    namemapptr = &names[i];
+    if(namemapptr->state != STATE_NEW && namemapptr->state != STATE_ASKING) {
+      continue;
+    }
+    if(namemapptr->state == STATE_ASKING) {
+      if(!timer_expired(&namemapptr->tmr)) {
+        /* Its timer has not run out, so we move on to next entry. */
+        if(next == NULL ||
+           timer_remaining(&namemapptr->tmr) < timer_remaining(&next->tmr)) {
+          next = namemapptr;
+        }
+        continue;
       }
-      if(namemapptr->is_mdns) {
-        hdr->id = 0;
+      if(sent) {
+        /* One query per poll, the next one goes out on the next poll */
+        tcpip_poll_udp(resolv_conn);
+        continue;
       }
+#if RESOLV_CONF_SUPPORTS_MDNS
+      if(++namemapptr->retries ==
+         (namemapptr->is_mdns ? RESOLV_CONF_MAX_MDNS_RETRIES :
+          RESOLV_CONF_MAX_RETRIES))
 #else /* RESOLV_CONF_SUPPORTS_MDNS */
-      hdr->flags1 = DNS_FLAG1_RD;
+      if(++namemapptr->retries == RESOLV_CONF_MAX_RETRIES)
 #endif /* RESOLV_CONF_SUPPORTS_MDNS */
+      {
+        /* Try the next server (if possible) before failing. Otherwise
+           simply mark the entry as failed. */
+        if(try_next_server(namemapptr) == 0) {
+          /* STATE_ERROR basically means "not found". */
+          namemapptr->state = STATE_ERROR;
 
-      hdr->numquestions = UIP_HTONS(1);
-      uint8_t *query = (unsigned char *)uip_appdata + sizeof(*hdr);
-      query = encode_name(query, namemapptr->name);
+#if RESOLV_SUPPORTS_RECORD_EXPIRATION
+          /* Keep the "not found" error valid for a while */
+          namemapptr->expiration = clock_seconds() + RESOLV_CONF_NEGATIVE_TTL;
+#endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
 
-#if RESOLV_CONF_SUPPORTS_MDNS
-      if(namemapptr->is_probe) {
-        *query++ = (uint8_t)((DNS_TYPE_ANY) >> 8);
-        *query++ = (uint8_t)((DNS_TYPE_ANY));
-      } else
-#endif /* RESOLV_CONF_SUPPORTS_MDNS */
-      {
-        *query++ = (uint8_t)(NATIVE_DNS_TYPE >> 8);
-        *query++ = (uint8_t)NATIVE_DNS_TYPE;
-      }
-      *query++ = (uint8_t)(DNS_CLASS_IN >> 8);
-      *query++ = (uint8_t)DNS_CLASS_IN;
-#if RESOLV_CONF_SUPPORTS_MDNS
-      if(namemapptr->is_mdns) {
-        if(namemapptr->is_probe) {
-          /* This is our conflict detection request.
-           * In order to be in compliance with the MDNS
-           * spec, we need to add the records we are proposing
-           * to the rrauth section.
-           */
-          uint8_t count = 0;
-
-          query = mdns_write_announce_records(query, &count);
-          hdr->numauthrr = UIP_HTONS(count);
+          resolv_found(namemapptr->name, NULL);
+          continue;
         }
-        uip_udp_packet_sendto(resolv_conn, uip_appdata,
-                              (query - (uint8_t *)uip_appdata),
-                              &resolv_mdns_addr, UIP_HTONS(MDNS_PORT));
-
-        LOG_DBG("(i=%d) Sent MDNS %s for \"%s\"\n", i,
-                namemapptr->is_probe ? "probe" : "request", namemapptr->name);
-      } else {
-        uip_udp_packet_sendto(resolv_conn, uip_appdata,
-                              (query - (uint8_t *)uip_appdata),
-                              (const uip_ipaddr_t *)
-                              uip_nameserver_get(namemapptr->server),
-                              UIP_HTONS(DNS_PORT));
-
-        LOG_DBG("(i=%d) Sent DNS request for \"%s\"\n", i,
-                namemapptr->name);
       }
-#else /* RESOLV_CONF_SUPPORTS_MDNS */
-      uip_udp_packet_sendto(resolv_conn, uip_appdata,
-                            (query - (uint8_t *)uip_appdata),
-                            uip_nameserver_get(namemapptr->server),
-                            UIP_HTONS(DNS_PORT));
-      LOG_DBG("(i=%d) Sent DNS request for \"%s\"\n", i,
-              namemapptr->name);
-#endif /* RESOLV_CONF_SUPPORTS_MDNS */
-      break;
+    } else {
+      if(sent) {
+        tcpip_poll_udp(resolv_conn);
+        continue;
+      }
+      namemapptr->state = STATE_ASKING;
+      namemapptr->retries = 0;
     }
+
+    timer_set(&namemapptr->tmr, retry_interval(namemapptr));
+    if(next == NULL ||
+       timer_remaining(&namemapptr->tmr) < timer_remaining(&next->tmr)) {
+      next = namemapptr;
+    }
+    send_query(namemapptr);
+    sent = true;
+  }
+
+  if(next != NULL) {
+    etimer_set(&retry, timer_remaining(&next->tmr));
+  } else {
+    etimer_stop(&retry);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -715,6 +891,7 @@ newdata(void)
    */
   uint8_t nquestions = (uint8_t)uip_ntohs(hdr->numquestions);
   uint8_t nanswers = (uint8_t)uip_ntohs(hdr->numanswers);
+  uint8_t nauthrr = (uint8_t)uip_ntohs(hdr->numauthrr);
 
   queryptr = (unsigned char *)hdr + sizeof(*hdr);
   i = 0;
@@ -811,11 +988,6 @@ newdata(void)
 
 /** ANSWER HANDLING SECTION **************************************************/
 
-  if(nanswers == 0) {
-    /* Skip responses with no answers. */
-    return;
-  }
-
   struct namemap *namemapptr = NULL;
 
 #if RESOLV_CONF_SUPPORTS_MDNS
@@ -823,12 +995,19 @@ newdata(void)
     /* OK, this was from MDNS. Things get a little weird here,
      * because we can't use the `id` field. We will look up the
      * appropriate request in a later step. */
+    if(nanswers == 0) {
+      /* Skip responses with no answers. */
+      return;
+    }
 
     i = -1;
     namemapptr = NULL;
   } else
 #endif /* RESOLV_CONF_SUPPORTS_MDNS */
   {
+    if(is_request) {
+      return;
+    }
     for(i = 0; i < RESOLV_ENTRIES; ++i) {
       namemapptr = &names[i];
       if(namemapptr->state == STATE_ASKING &&
@@ -850,8 +1029,10 @@ newdata(void)
     namemapptr->err = hdr->flags2 & DNS_FLAG2_ERR_MASK;
 
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-    /* If we remain in the error state, keep it cached for 30 seconds. */
-    namemapptr->expiration = clock_seconds() + 30;
+    /* If we remain in the error state, keep it cached as long as the
+       server allows. */
+    namemapptr->expiration = clock_seconds() +
+      negative_ttl(queryptr, nanswers, nauthrr);
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
 
     /* Check for error. If so, call callback to inform. */
@@ -921,15 +1102,18 @@ newdata(void)
           available_i = i;
         }
       }
-      if(i == RESOLV_ENTRIES) {
+      if(i == RESOLV_ENTRIES && available_i < RESOLV_ENTRIES) {
+        char name[RESOLV_CONF_MAX_DOMAIN_NAME_SIZE + 1];
+
         LOG_DBG("Unsolicited MDNS response\n");
         i = available_i;
         namemapptr = &names[i];
-        if(!decode_name(queryptr, namemapptr->name, uip_appdata)) {
+        if(!decode_name(queryptr, name, uip_appdata)) {
           LOG_DBG("MDNS name too big to cache\n");
           namemapptr = NULL;
           goto skip_to_next_answer;
         }
+        set_name(namemapptr, name);
       }
       if(i == RESOLV_ENTRIES) {
         LOG_DBG("Not enough room to keep track of unsolicited MDNS answer\n");
@@ -989,8 +1173,11 @@ skip_to_next_answer:
 #endif
   {
     if(try_next_server(namemapptr)) {
-      namemapptr->state = STATE_ASKING;
+      /* Ask the next server right away */
+      namemapptr->state = STATE_NEW;
       process_post(&resolv_process, PROCESS_EVENT_TIMER, NULL);
+    } else {
+      resolv_found(namemapptr->name, NULL);
     }
   }
 }
@@ -1077,6 +1264,7 @@ PROCESS_THREAD(resolv_process, ev, data)
   PROCESS_BEGIN();
 
   memset(names, 0, sizeof(names));
+  memset(buckets, 0, sizeof(buckets));
 
   resolv_event_found = process_alloc_event();
 
@@ -1171,13 +1359,17 @@ remove_trailing_dots(const char *name)
 /*---------------------------------------------------------------------------*/
 /**
  * Queues a name so that a question for the name will be sent out.
+ * A name that is already being resolved is not asked for again, and a
+ * name with a fresh cached address, or freshly known not to exist, is
+ * answered from the cache. Either way, resolv_event_found is broadcast
+ * once the name is resolved.
  *
  * \param name The hostname that is to be queried.
  */
 void
 resolv_query(const char *name)
 {
-  uint8_t lseqi = 0, lseq = 0, i = 0;
+  uint8_t lseqi = 0, lseq = 0, i;
   struct namemap *nameptr = 0;
 
   init();
@@ -1185,34 +1377,60 @@ resolv_query(const char *name)
   /* Remove trailing dots, if present. */
   name = remove_trailing_dots(name);
 
-  for(i = 0; i < RESOLV_ENTRIES; ++i) {
-    nameptr = &names[i];
-    if(0 == strcasecmp(nameptr->name, name)) {
-      break;
+  nameptr = find_name(name);
+  if(nameptr != NULL) {
+    if(nameptr->state == STATE_NEW || nameptr->state == STATE_ASKING) {
+      /* Already being resolved, the answer will be broadcast */
+      LOG_DBG("Query for \"%s\" already pending\n", name);
+      RESOLV_STAT(resolv_stats.coalesced++);
+      return;
+    }
+#if RESOLV_SUPPORTS_RECORD_EXPIRATION
+    if(nameptr->state == STATE_DONE &&
+       clock_seconds() <= nameptr->expiration
+#if RESOLV_CONF_SUPPORTS_MDNS
+       && strcasecmp(nameptr->name, resolv_hostname) != 0
+#endif /* RESOLV_CONF_SUPPORTS_MDNS */
+       ) {
+      /* Still fresh, answer from the cache */
+      LOG_DBG("Answering query for \"%s\" from cache\n", name);
+      RESOLV_STAT(resolv_stats.hits++);
+      process_post(PROCESS_BROADCAST, resolv_event_found, nameptr->name);
+      return;
+    }
+    if(nameptr->state == STATE_ERROR &&
+       clock_seconds() <= nameptr->expiration) {
+      /* Known not to exist, answer without an address */
+      LOG_DBG("Answering query for \"%s\" from negative cache\n", name);
+      RESOLV_STAT(resolv_stats.negative_hits++);
+      process_post(PROCESS_BROADCAST, resolv_event_found, nameptr->name);
+      return;
     }
-    if((nameptr->state == STATE_UNUSED)
+#endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
+  }
+
+  for(i = 0; nameptr == NULL && i < RESOLV_ENTRIES; ++i) {
+    if((names[i].state == STATE_UNUSED)
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-       || (nameptr->state == STATE_DONE && clock_seconds() > nameptr->expiration)
+       || (names[i].state == STATE_DONE &&
+           clock_seconds() > names[i].expiration)
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
        ) {
       lseqi = i;
       lseq = 255;
-    } else if(seqno - nameptr->seqno > lseq) {
-      lseq = seqno - nameptr->seqno;
+    } else if(seqno - names[i].seqno > lseq) {
+      lseq = seqno - names[i].seqno;
       lseqi = i;
     }
   }
 
-  if(i == RESOLV_ENTRIES) {
-    i = lseqi;
-    nameptr = &names[i];
+  if(nameptr == NULL) {
+    nameptr = &names[lseqi];
   }
 
   LOG_DBG("Starting query for \"%s\"\n", name);
 
-  memset(nameptr, 0, sizeof(*nameptr));
-
-  strncpy(nameptr->name, name, sizeof(nameptr->name) - 1);
+  set_name(nameptr, name);
   nameptr->state = STATE_NEW;
   nameptr->seqno = seqno;
   ++seqno;
@@ -1268,44 +1486,47 @@ resolv_lookup(const char *name, uip_ipaddr_t **ipaddr)
   }
 #endif /* UIP_CONF_LOOPBACK_INTERFACE */
 
-  /* Walk through the list to see if the name is in there. */
-  uint8_t i;
-  for(i = 0; i < RESOLV_ENTRIES; ++i) {
-    struct namemap *nameptr = &names[i];
-
-    if(strcasecmp(name, nameptr->name) == 0) {
-      switch(nameptr->state) {
-      case STATE_DONE:
-        ret = RESOLV_STATUS_CACHED;
+  /* Look the name up in the cache. */
+  struct namemap *nameptr = find_name(name);
+  if(nameptr != NULL) {
+    switch(nameptr->state) {
+    case STATE_DONE:
+      ret = RESOLV_STATUS_CACHED;
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-        if(clock_seconds() > nameptr->expiration) {
-          ret = RESOLV_STATUS_EXPIRED;
-        }
+      if(clock_seconds() > nameptr->expiration) {
+        ret = RESOLV_STATUS_EXPIRED;
+      }
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
-        break;
-      case STATE_NEW:
-      case STATE_ASKING:
-        ret = RESOLV_STATUS_RESOLVING;
-        break;
-      /* Almost certainly a not-found error from server */
-      case STATE_ERROR:
-        ret = RESOLV_STATUS_NOT_FOUND;
+      break;
+    case STATE_NEW:
+    case STATE_ASKING:
+      ret = RESOLV_STATUS_RESOLVING;
+      break;
+    /* Almost certainly a not-found error from server */
+    case STATE_ERROR:
+      ret = RESOLV_STATUS_NOT_FOUND;
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-        if(clock_seconds() > nameptr->expiration) {
-          ret = RESOLV_STATUS_UNCACHED;
-        }
-#endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
-        break;
+      if(clock_seconds() > nameptr->expiration) {
+        ret = RESOLV_STATUS_UNCACHED;
       }
-
-      if(ipaddr) {
-        *ipaddr = &nameptr->ipaddr;
-      }
-
-      /* Break out of for loop. */
+#endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
       break;
     }
+
+    if(ipaddr) {
+      *ipaddr = &nameptr->ipaddr;
+    }
+  }
+
+#if RESOLV_STATS
+  if(ret == RESOLV_STATUS_CACHED) {
+    resolv_stats.hits++;
+  } else if(ret == RESOLV_STATUS_NOT_FOUND) {
+    resolv_stats.negative_hits++;
+  } else if(ret != RESOLV_STATUS_RESOLVING) {
+    resolv_stats.misses++;
   }
+#endif /* RESOLV_STATS */
 
   if(LOG_DBG_ENABLED) {
     switch(ret) {
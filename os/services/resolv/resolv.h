@@ -52,6 +52,15 @@
 #define RESOLV_CONF_SUPPORTS_MDNS     (1)
 #endif
 
+/** If RESOLV_CONF_STATS is set, the resolver counts cache hits and
+ *  misses and the queries it sends in resolv_stats.
+ */
+#ifdef RESOLV_CONF_STATS
+#define RESOLV_STATS RESOLV_CONF_STATS
+#else
+#define RESOLV_STATS 0
+#endif
+
 /**
  * Event that is broadcasted when a DNS name has been resolved.
  */
@@ -90,6 +99,23 @@ enum {
 
 typedef uint8_t resolv_status_t;
 
+#if RESOLV_STATS
+struct resolv_stats {
+  /* Lookups and queries answered from fresh cached addresses */
+  uint32_t hits;
+  /* Lookups answered from cached not-found answers */
+  uint32_t negative_hits;
+  /* Lookups of names not cached, or expired */
+  uint32_t misses;
+  /* Queries for names that were already being resolved */
+  uint32_t coalesced;
+  /* Queries sent out, including retries */
+  uint32_t queries;
+};
+
+extern struct resolv_stats resolv_stats;
+#endif /* RESOLV_STATS */
+
 /* Functions. */
 resolv_status_t resolv_lookup(const char *name, uip_ipaddr_t **ipaddr);
 
@@ -41,3 +41,8 @@
 
 /* used by wpcap (see /cpu/native/net/wpcap-drv.c) */
 #define SELECT_CALLBACK 1
+
+/* Expose ND message counters through the nd6-stats shell command */
+#ifndef UIP_CONF_ND6_STATS
+#define UIP_CONF_ND6_STATS 1
+#endif
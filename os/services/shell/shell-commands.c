@@ -48,10 +48,12 @@
 #include "lib/list.h"
 #include "sys/log.h"
 #include "dev/watchdog.h"
+#include "sys/energest.h"
 #include "net/ipv6/uip.h"
 #include "net/ipv6/uiplib.h"
 #include "net/ipv6/uip-icmp6.h"
 #include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-nd6.h"
 #if BUILD_WITH_RESOLV
 #include "resolv.h"
 #endif /* BUILD_WITH_RESOLV */
@@ -531,6 +533,45 @@ PT_THREAD(cmd_ip_neighbors(struct pt *pt, shell_output_func output, char *args))
   PT_END(pt);
 
 }
+#if UIP_ND6_STATS
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(cmd_nd6_stats(struct pt *pt, shell_output_func output, char *args))
+{
+  static clock_time_t last_time;
+  static uint32_t last_total;
+  uint32_t total;
+  clock_time_t elapsed;
+
+  PT_BEGIN(pt);
+
+  total = uip_nd6_stats.ns_recv + uip_nd6_stats.ns_sent +
+    uip_nd6_stats.na_recv + uip_nd6_stats.na_sent +
+    uip_nd6_stats.rs_recv + uip_nd6_stats.rs_sent +
+    uip_nd6_stats.ra_recv + uip_nd6_stats.ra_sent;
+  elapsed = clock_time() - last_time;
+
+  SHELL_OUTPUT(output, "ND messages: NS %lu/%lu, NA %lu/%lu, RS %lu/%lu, RA %lu/%lu (rx/tx)\n",
+               (unsigned long)uip_nd6_stats.ns_recv, (unsigned long)uip_nd6_stats.ns_sent,
+               (unsigned long)uip_nd6_stats.na_recv, (unsigned long)uip_nd6_stats.na_sent,
+               (unsigned long)uip_nd6_stats.rs_recv, (unsigned long)uip_nd6_stats.rs_sent,
+               (unsigned long)uip_nd6_stats.ra_recv, (unsigned long)uip_nd6_stats.ra_sent);
+  SHELL_OUTPUT(output, "-- fast path %lu, NUD probes %lu, deferred %lu\n",
+               (unsigned long)uip_nd6_stats.fast_path,
+               (unsigned long)uip_nd6_stats.nud_probes,
+               (unsigned long)uip_nd6_stats.nud_deferred);
+  if(last_time != 0 && elapsed > 0) {
+    SHELL_OUTPUT(output, "-- %lu messages/s since last call\n",
+                 (unsigned long)((uint64_t)(total - last_total) * CLOCK_SECOND /
+                                 elapsed));
+  }
+
+  last_time = clock_time();
+  last_total = total;
+
+  PT_END(pt);
+}
+#endif /* UIP_ND6_STATS */
 #endif /* NETSTACK_CONF_WITH_IPV6 */
 #if MAC_CONF_WITH_TSCH
 /*---------------------------------------------------------------------------*/
@@ -614,6 +655,17 @@ PT_THREAD(cmd_tsch_status(struct pt *pt, shell_output_func output, char *args))
     SHELL_OUTPUT(output, "-- Network uptime: %lu seconds\n",
                  (unsigned long)(tsch_get_network_uptime_ticks() / CLOCK_SECOND));
   }
+#if TSCH_STATS_ON
+  SHELL_OUTPUT(output, "-- Input queue: max %u/%u, dropped %lu, deferred %lu\n",
+               tsch_stats.input_queue_max,
+               tsch_is_coordinator ? TSCH_MAX_INCOMING_PACKETS_ROOT : TSCH_MAX_INCOMING_PACKETS,
+               (unsigned long)tsch_stats.input_queue_drops,
+               (unsigned long)tsch_stats.input_queue_deferred);
+  SHELL_OUTPUT(output, "-- Lock: taken %lu times, held %lu ticks, max %lu ticks\n",
+               (unsigned long)tsch_stats.lock_count,
+               (unsigned long)tsch_stats.lock_held_ticks,
+               (unsigned long)tsch_stats.lock_held_max_ticks);
+#endif /* TSCH_STATS_ON */
 
   PT_END(pt);
 }
@@ -796,6 +848,78 @@ PT_THREAD(cmd_reboot(struct pt *pt, shell_output_func output, char *args))
   watchdog_reboot();
   PT_END(pt);
 }
+#if PROCESS_PROFILE_ENABLED
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(cmd_profile(struct pt *pt, shell_output_func output, char *args))
+{
+  struct process *p;
+  char *next_args;
+
+  PT_BEGIN(pt);
+
+  SHELL_ARGS_INIT(args, next_args);
+  SHELL_ARGS_NEXT(args, next_args);
+
+  if(args != NULL && !strcmp(args, "reset")) {
+    process_profile_reset();
+    SHELL_OUTPUT(output, "Process profile cleared\n");
+    PT_EXIT(pt);
+  }
+
+  SHELL_OUTPUT(output, "%-20s %7s %10s %8s %8s %8s\n",
+               "Process", "Calls", "Run us", "Max us", "Wait us", "Max us");
+  for(p = PROCESS_LIST(); p != NULL; p = p->next) {
+    if(p->profile.calls == 0) {
+      continue;
+    }
+    SHELL_OUTPUT(output, "%-20.20s %7lu %10lu %8lu %8lu %8lu\n",
+                 PROCESS_NAME_STRING(p),
+                 (unsigned long)p->profile.calls,
+                 (unsigned long)process_profile_to_us(p->profile.run_time),
+                 (unsigned long)process_profile_to_us(p->profile.max_run_time),
+                 (unsigned long)(p->profile.dispatches == 0 ? 0 :
+                                 process_profile_to_us(p->profile.wait_time) /
+                                 p->profile.dispatches),
+                 (unsigned long)process_profile_to_us(p->profile.max_wait_time));
+  }
+
+  PT_END(pt);
+}
+#endif /* PROCESS_PROFILE_ENABLED */
+#if ENERGEST_TAGS
+/*---------------------------------------------------------------------------*/
+static unsigned long
+energest_to_ms(uint64_t time)
+{
+  return (unsigned long)(time * 1000 / ENERGEST_SECOND);
+}
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(cmd_energest(struct pt *pt, shell_output_func output, char *args))
+{
+  int tag;
+
+  PT_BEGIN(pt);
+
+  energest_flush();
+
+  SHELL_OUTPUT(output, "Tag         CPU ms  Radio Tx ms  Radio Rx ms\n");
+  for(tag = 0; tag < ENERGEST_TAG_MAX; tag++) {
+    SHELL_OUTPUT(output, "%-8s %9lu %12lu %12lu\n",
+                 energest_tag_name(tag),
+                 energest_to_ms(energest_tag_time(tag, ENERGEST_TYPE_CPU)),
+                 energest_to_ms(energest_tag_time(tag, ENERGEST_TYPE_TRANSMIT)),
+                 energest_to_ms(energest_tag_time(tag, ENERGEST_TYPE_LISTEN)));
+  }
+  SHELL_OUTPUT(output, "%-8s %9lu %12lu %12lu\n", "total",
+               energest_to_ms(energest_type_time(ENERGEST_TYPE_CPU)),
+               energest_to_ms(energest_type_time(ENERGEST_TYPE_TRANSMIT)),
+               energest_to_ms(energest_type_time(ENERGEST_TYPE_LISTEN)));
+
+  PT_END(pt);
+}
+#endif /* ENERGEST_TAGS */
 #if MAC_CONF_WITH_TSCH
 /*---------------------------------------------------------------------------*/
 static
@@ -981,9 +1105,18 @@ const struct shell_command_t builtin_shell_commands[] = {
   { "reboot",               cmd_reboot,               "'> reboot': Reboot the board by watchdog_reboot()" },
   { "log",                  cmd_log,                  "'> log module level': Sets log level (0--4) for a given module (or \"all\"). For module \"mac\", level 4 also enables per-slot logging." },
   { "mac-addr",             cmd_macaddr,               "'> mac-addr': Shows the node's MAC address" },
+#if ENERGEST_TAGS
+  { "energest",             cmd_energest,             "'> energest': Shows the CPU and radio time attributed to each subsystem" },
+#endif /* ENERGEST_TAGS */
+#if PROCESS_PROFILE_ENABLED
+  { "profile",              cmd_profile,              "'> profile [reset]': Shows the CPU time used by each process, or clears it" },
+#endif /* PROCESS_PROFILE_ENABLED */
 #if NETSTACK_CONF_WITH_IPV6
   { "ip-addr",              cmd_ipaddr,               "'> ip-addr': Shows all IPv6 addresses" },
   { "ip-nbr",               cmd_ip_neighbors,         "'> ip-nbr': Shows all IPv6 neighbors" },
+#if UIP_ND6_STATS
+  { "nd6-stats",            cmd_nd6_stats,            "'> nd6-stats': Shows ND message counters and rate since the last call" },
+#endif /* UIP_ND6_STATS */
   { "ping",                 cmd_ping,                 "'> ping addr': Pings the IPv6 address 'addr'" },
   { "routes",               cmd_routes,               "'> routes': Shows the route entries" },
 #if BUILD_WITH_RESOLV
@@ -55,6 +55,11 @@
 static unsigned long last_tx, last_rx, last_time, last_cpu, last_lpm, last_deep_lpm;
 static unsigned long delta_tx, delta_rx, delta_time, delta_cpu, delta_lpm, delta_deep_lpm;
 static unsigned long curr_tx, curr_rx, curr_time, curr_cpu, curr_lpm, curr_deep_lpm;
+#if ENERGEST_TAGS
+static uint64_t last_tag_cpu[ENERGEST_TAG_MAX];
+static uint64_t last_tag_tx[ENERGEST_TAG_MAX];
+static uint64_t last_tag_rx[ENERGEST_TAG_MAX];
+#endif /* ENERGEST_TAGS */
 
 PROCESS(simple_energest_process, "Simple Energest");
 /*---------------------------------------------------------------------------*/
@@ -64,6 +69,34 @@ to_permil(unsigned long delta_metric, unsigned long delta_time)
   return (1000ul * (delta_metric)) / delta_time;
 }
 /*---------------------------------------------------------------------------*/
+#if ENERGEST_TAGS
+static void
+simple_energest_tag_step(void)
+{
+  unsigned long tag_cpu, tag_tx, tag_rx;
+  int tag;
+
+  LOG_INFO("Tag           CPU (permil)   Radio Tx (permil)   Radio Rx (permil)\n");
+  for(tag = 0; tag < ENERGEST_TAG_MAX; tag++) {
+    tag_cpu = energest_tag_time(tag, ENERGEST_TYPE_CPU) - last_tag_cpu[tag];
+    tag_tx = energest_tag_time(tag, ENERGEST_TYPE_TRANSMIT) - last_tag_tx[tag];
+    tag_rx = energest_tag_time(tag, ENERGEST_TYPE_LISTEN) - last_tag_rx[tag];
+    last_tag_cpu[tag] += tag_cpu;
+    last_tag_tx[tag] += tag_tx;
+    last_tag_rx[tag] += tag_rx;
+
+    if(tag_cpu + tag_tx + tag_rx == 0) {
+      continue;
+    }
+    LOG_INFO("%-8s %10lu (%4lu) %12lu (%4lu) %12lu (%4lu)\n",
+             energest_tag_name(tag),
+             tag_cpu, delta_cpu ? to_permil(tag_cpu, delta_cpu) : 0,
+             tag_tx, delta_tx ? to_permil(tag_tx, delta_tx) : 0,
+             tag_rx, delta_rx ? to_permil(tag_rx, delta_rx) : 0);
+  }
+}
+#endif /* ENERGEST_TAGS */
+/*---------------------------------------------------------------------------*/
 static void
 simple_energest_step(void)
 {
@@ -100,6 +133,9 @@ simple_energest_step(void)
   LOG_INFO("Radio Tx    : %10lu/%10lu (%lu permil)\n", delta_tx, delta_time, to_permil(delta_tx, delta_time));
   LOG_INFO("Radio Rx    : %10lu/%10lu (%lu permil)\n", delta_rx, delta_time, to_permil(delta_rx, delta_time));
   LOG_INFO("Radio total : %10lu/%10lu (%lu permil)\n", delta_tx+delta_rx, delta_time, to_permil(delta_tx+delta_rx, delta_time));
+#if ENERGEST_TAGS
+  simple_energest_tag_step();
+#endif /* ENERGEST_TAGS */
 }
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(simple_energest_process, ev, data)
@@ -119,6 +155,10 @@ PROCESS_THREAD(simple_energest_process, ev, data)
 void
 simple_energest_init(void)
 {
+#if ENERGEST_TAGS
+  int tag;
+#endif /* ENERGEST_TAGS */
+
   energest_flush();
   last_time = ENERGEST_GET_TOTAL_TIME();
   last_cpu = energest_type_time(ENERGEST_TYPE_CPU);
@@ -126,6 +166,13 @@ simple_energest_init(void)
   curr_tx = energest_type_time(ENERGEST_TYPE_TRANSMIT);
   last_deep_lpm = energest_type_time(ENERGEST_TYPE_DEEP_LPM);
   last_rx = energest_type_time(ENERGEST_TYPE_LISTEN);
+#if ENERGEST_TAGS
+  for(tag = 0; tag < ENERGEST_TAG_MAX; tag++) {
+    last_tag_cpu[tag] = energest_tag_time(tag, ENERGEST_TYPE_CPU);
+    last_tag_tx[tag] = energest_tag_time(tag, ENERGEST_TYPE_TRANSMIT);
+    last_tag_rx[tag] = energest_tag_time(tag, ENERGEST_TYPE_LISTEN);
+  }
+#endif /* ENERGEST_TAGS */
   process_start(&simple_energest_process, NULL);
 }
 
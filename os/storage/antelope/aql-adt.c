@@ -162,3 +162,29 @@ aql_add_value(aql_adt_t *adt, domain_t domain, void *value_ptr)
 
   return DB_OK;
 }
+
+db_result_t
+aql_set_group(aql_adt_t *adt, char *name)
+{
+  int i;
+
+  /* Group by a plain attribute in the projection if there is one,
+     or by an attribute that is used for processing only. */
+  for(i = 0; i < AQL_ATTRIBUTE_COUNT(adt); i++) {
+    if(adt->aggregators[i] == AQL_NONE &&
+       strcmp(adt->attributes[i].name, name) == 0) {
+      break;
+    }
+  }
+
+  if(i == AQL_ATTRIBUTE_COUNT(adt)) {
+    if(DB_ERROR(aql_add_attribute(adt, name, DOMAIN_UNSPECIFIED, 0, 0))) {
+      return DB_LIMIT_ERROR;
+    }
+    adt->attributes[i].flags = ATTRIBUTE_FLAG_NO_STORE;
+  }
+
+  adt->attributes[i].flags |= ATTRIBUTE_FLAG_GROUP;
+  AQL_SET_FLAG(adt, AQL_FLAG_AGGREGATE);
+  return DB_OK;
+}
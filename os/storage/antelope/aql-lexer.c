@@ -74,6 +74,7 @@ static const struct keyword keywords[] = {
   {"IS", IS},
   {"ON", ON},
   {"IN", IN},
+  {"BY", BY},
 
   {"AND", AND},
   {"NOT", NOT},
@@ -91,7 +92,9 @@ static const struct keyword keywords[] = {
 
   {"WHERE", WHERE},
   {"COUNT", COUNT},
+  {"GROUP", GROUP},
   {"INDEX", INDEX},
+  {"BTREE", BTREE},
 
   {"INSERT", INSERT},
   {"SELECT", SELECT},
@@ -112,7 +115,7 @@ static const struct keyword keywords[] = {
 };
 
 /* Provides a pointer to the first keyword of a specific length. */
-static const int8_t skip_hint[] = {0, 13, 21, 27, 33, 36, 44, 47, 48};
+static const int8_t skip_hint[] = {0, 13, 22, 28, 34, 39, 47, 50, 51};
 
 static char separators[] = "#.;,() \t\n";
 
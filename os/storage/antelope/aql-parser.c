@@ -489,6 +489,19 @@ PARSER(join)
   RETURN(OK);
 }
 
+PARSER(group)
+{
+  CONSUME(BY);
+  CONSUME(IDENTIFIER);
+
+  PRINTF("Group by attribute %s\n", VALUE);
+  if(DB_ERROR(AQL_SET_GROUP(adt, VALUE))) {
+    RETURN(SYNTAX_ERROR);
+  }
+
+  RETURN(OK);
+}
+
 PARSER(select)
 {
   AQL_SET_TYPE(adt, AQL_TYPE_SELECT);
@@ -512,6 +525,19 @@ PARSER(select)
     }
 
     AQL_SET_CONDITION(adt, &p);
+
+    NEXT;
+    if(TOKEN != GROUP) {
+      REWIND;
+      CONSUME(END);
+      return OK;
+    }
+  }
+
+  if(TOKEN == GROUP) {
+    if(!PARSE(group)) {
+      RETURN(SYNTAX_ERROR);
+    }
   } else {
     REWIND;
     RETURN(OK);
@@ -655,6 +681,9 @@ PARSER_TOKEN(index_type)
   case MEMHASH:
     type = INDEX_MEMHASH;
     break;
+  case BTREE:
+    type = INDEX_BTREE;
+    break;
   default:
     return NONE;
   };
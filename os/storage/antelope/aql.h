@@ -104,6 +104,9 @@ enum token {
   MEMHASH = 46,
   RELATION = 47,
   ATTRIBUTE = 48,
+  BTREE = 49,
+  GROUP = 50,
+  BY = 51,
 
   INTEGER_VALUE = 251,
   FLOAT_VALUE = 252,
@@ -204,6 +207,8 @@ typedef struct aql_adt aql_adt_t;
 #define AQL_SET_CONDITION(adt, cond)	((adt)->lvm_instance = (cond))
 #define AQL_ADD_VALUE(adt, domain, value)				\
     aql_add_value((adt), (domain), (value))
+#define AQL_SET_GROUP(adt, attr)					\
+    aql_set_group((adt), (attr))
 
 int lexer_start(lexer_t *, char *, token_t *, value_t *);
 int lexer_next(lexer_t *);
@@ -216,6 +221,7 @@ db_result_t aql_add_attribute(aql_adt_t *adt, char *name,
                                domain_t domain, unsigned element_size,
                                int processed_only);
 db_result_t aql_add_value(aql_adt_t *adt, domain_t domain, void *value);
+db_result_t aql_set_group(aql_adt_t *adt, char *name);
 db_result_t db_query(db_handle_t *handle, const char *format, ...);
 db_result_t db_process(db_handle_t *handle);
 
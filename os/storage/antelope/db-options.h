@@ -111,6 +111,17 @@
 #define DB_VM_BYTECODE_SIZE		256
 #endif /* DB_VM_BYTECODE_SIZE */
 
+/* The maximum number of groups in an aggregation with GROUP BY. */
+#ifndef DB_GROUP_LIMIT
+#define DB_GROUP_LIMIT			8
+#endif /* DB_GROUP_LIMIT */
+
+/* The number of rows from the smaller relation that a hash join keeps
+   in memory. Larger relations are joined in several passes. */
+#ifndef DB_HASH_JOIN_ROWS
+#define DB_HASH_JOIN_ROWS		32
+#endif /* DB_HASH_JOIN_ROWS */
+
 /*----------------------------------------------------------------------------*/
 
 /* Language options. */
@@ -161,6 +172,18 @@
 #define DB_MAX_CHAR_SIZE_PER_ROW	64
 #endif /* DB_MAX_CHAR_SIZE_PER_ROW */
 
+/* The size of each page buffer used for reading and appending rows.
+   Rows longer than this are accessed directly through the file system. */
+#ifndef DB_STORAGE_PAGE_SIZE
+#define DB_STORAGE_PAGE_SIZE		(2 * DB_MAX_CHAR_SIZE_PER_ROW)
+#endif /* DB_STORAGE_PAGE_SIZE */
+
+/* The number of row page buffers shared by all loaded relations. A join
+   uses three pages: one per input relation and one for the output. */
+#ifndef DB_STORAGE_PAGE_POOL_SIZE
+#define DB_STORAGE_PAGE_POOL_SIZE	3
+#endif /* DB_STORAGE_PAGE_POOL_SIZE */
+
 /* The maximum file name length to use for creating various database file. */
 #ifndef DB_MAX_FILENAME_LENGTH
 #define DB_MAX_FILENAME_LENGTH		16
@@ -215,6 +238,37 @@
 #define DB_HEAP_CACHE_LIMIT		1
 #endif /* DB_HEAP_CACHE_LIMIT */
 
+/* The maximum number of B+-tree indexes. */
+#ifndef DB_BTREE_INDEX_LIMIT
+#define DB_BTREE_INDEX_LIMIT		1
+#endif /* DB_BTREE_INDEX_LIMIT */
+
+/* The size of a B+-tree node in bytes. Each entry uses 8 bytes. */
+#ifndef DB_BTREE_NODE_SIZE
+#define DB_BTREE_NODE_SIZE		128
+#endif /* DB_BTREE_NODE_SIZE */
+
+/* The maximum number of nodes in a B+-tree index file. */
+#ifndef DB_BTREE_NODE_LIMIT
+#define DB_BTREE_NODE_LIMIT		255
+#endif /* DB_BTREE_NODE_LIMIT */
+
+/* The maximum height of a B+-tree. */
+#ifndef DB_BTREE_MAX_HEIGHT
+#define DB_BTREE_MAX_HEIGHT		6
+#endif /* DB_BTREE_MAX_HEIGHT */
+
+/* The maximum number of B+-tree nodes cached in memory. */
+#ifndef DB_BTREE_CACHE_LIMIT
+#define DB_BTREE_CACHE_LIMIT		4
+#endif /* DB_BTREE_CACHE_LIMIT */
+
+/* The number of insertions after which modified B+-tree nodes are
+   written to storage. */
+#ifndef DB_BTREE_WRITE_BATCH
+#define DB_BTREE_WRITE_BATCH		8
+#endif /* DB_BTREE_WRITE_BATCH */
+
 /*----------------------------------------------------------------------------*/
 
 /* LVM options. */
@@ -236,5 +290,12 @@
 #define LVM_USE_FLOATS			DB_FEATURE_FLOATS
 #endif /* LVM_USE_FLOATS */
 
+/* The maximum number of instructions in a predicate compiled for
+   row-by-row evaluation. Setting it to 0 leaves all predicates to
+   the bytecode interpreter. */
+#ifndef LVM_MAX_INSTRUCTIONS
+#define LVM_MAX_INSTRUCTIONS		16
+#endif /* LVM_MAX_INSTRUCTIONS */
+
 
 #endif /* !DB_OPTIONS_H */
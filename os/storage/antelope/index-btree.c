@@ -0,0 +1,678 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *     A B+-tree index for flash memory.
+ *
+ *     Keys are kept sorted in fixed-size nodes, and the leaves are
+ *     linked in key order, so that a range query descends the tree
+ *     once and then reads the leaves sequentially. Nodes are accessed
+ *     through a small cache shared by all B+-tree indexes. Modified
+ *     nodes are written back when they are evicted from the cache,
+ *     when a batch of insertions has been completed, or when the index
+ *     is released. Consecutive insertions into the same leaf therefore
+ *     cost a single node write.
+ *
+ *     Deletions do not merge nodes; emptied leaves remain linked in
+ *     the tree.
+ */
+
+#include <string.h>
+
+#include "cfs/cfs.h"
+#include "lib/memb.h"
+
+#include "db-options.h"
+#include "index.h"
+#include "result.h"
+#include "storage.h"
+
+#define DEBUG DEBUG_NONE
+#include "net/ipv6/uip-debug.h"
+
+typedef int32_t btree_key_t;
+typedef uint32_t btree_node_id_t;
+
+/* Node 0 holds the tree metadata; the root is never stored there. */
+#define NO_NODE         0
+
+struct btree_entry {
+  btree_key_t key;
+  /* The tuple ID in a leaf, or the child node ID in an inner node. */
+  uint32_t value;
+};
+
+#define NODE_HEADER_SIZE 8
+#define NODE_ENTRY_SIZE  8
+#define NODE_CAPACITY    ((DB_BTREE_NODE_SIZE - NODE_HEADER_SIZE) / \
+                          NODE_ENTRY_SIZE)
+
+#if NODE_CAPACITY < 4 || NODE_CAPACITY > 255
+#error "DB_BTREE_NODE_SIZE must fit between 4 and 255 entries."
+#endif
+
+struct btree_node {
+  uint8_t leaf;
+  uint8_t count;
+  uint16_t unused;
+  /* The next leaf in key order. */
+  btree_node_id_t next;
+  struct btree_entry entries[NODE_CAPACITY];
+};
+
+struct btree_meta {
+  btree_node_id_t root;
+  btree_node_id_t node_count;
+  uint8_t height;
+};
+
+struct btree {
+  db_storage_id_t storage;
+  struct btree_meta meta;
+  uint8_t meta_dirty;
+  uint8_t pending_inserts;
+};
+typedef struct btree btree_t;
+
+struct node_cache {
+  btree_t *tree;
+  btree_node_id_t id;
+  uint16_t last_use;
+  uint8_t dirty;
+  struct btree_node node;
+};
+
+static struct node_cache node_cache[DB_BTREE_CACHE_LIMIT];
+static uint16_t cache_clock;
+MEMB(btrees, btree_t, DB_BTREE_INDEX_LIMIT);
+
+static db_result_t create(index_t *);
+static db_result_t destroy(index_t *);
+static db_result_t load(index_t *);
+static db_result_t release(index_t *);
+static db_result_t insert(index_t *, attribute_value_t *, tuple_id_t);
+static db_result_t delete(index_t *, attribute_value_t *);
+static tuple_id_t get_next(index_iterator_t *);
+
+index_api_t index_btree = {
+  INDEX_BTREE,
+  INDEX_API_EXTERNAL | INDEX_API_RANGE_QUERIES,
+  create,
+  destroy,
+  load,
+  release,
+  insert,
+  delete,
+  get_next
+};
+
+static int
+cache_write_back(struct node_cache *cache)
+{
+  if(cache->dirty) {
+    if(DB_ERROR(storage_write(cache->tree->storage, &cache->node,
+                              (unsigned long)cache->id * DB_BTREE_NODE_SIZE,
+                              sizeof(cache->node)))) {
+      PRINTF("DB: Failed to write B+-tree node %lu\n",
+             (unsigned long)cache->id);
+      return 0;
+    }
+    cache->dirty = 0;
+  }
+  return 1;
+}
+
+static struct node_cache *
+cache_get(btree_t *tree, btree_node_id_t id, int read)
+{
+  struct node_cache *cache;
+  struct node_cache *victim;
+
+  /* Take a free slot, or evict the least recently used node. */
+  victim = NULL;
+  for(cache = node_cache; cache < &node_cache[DB_BTREE_CACHE_LIMIT]; cache++) {
+    if(cache->tree == tree && cache->id == id) {
+      cache->last_use = ++cache_clock;
+      return cache;
+    }
+    if(cache->tree == NULL) {
+      if(victim == NULL || victim->tree != NULL) {
+        victim = cache;
+      }
+    } else if(victim == NULL ||
+              (victim->tree != NULL &&
+               (uint16_t)(cache_clock - cache->last_use) >
+               (uint16_t)(cache_clock - victim->last_use))) {
+      victim = cache;
+    }
+  }
+
+  if(victim->tree != NULL && !cache_write_back(victim)) {
+    return NULL;
+  }
+  victim->tree = NULL;
+
+  if(read && DB_ERROR(storage_read(tree->storage, &victim->node,
+                                   (unsigned long)id * DB_BTREE_NODE_SIZE,
+                                   sizeof(victim->node)))) {
+    PRINTF("DB: Failed to read B+-tree node %lu\n", (unsigned long)id);
+    return NULL;
+  }
+
+  victim->tree = tree;
+  victim->id = id;
+  victim->dirty = 0;
+  victim->last_use = ++cache_clock;
+  return victim;
+}
+
+static int
+node_read(btree_t *tree, btree_node_id_t id, struct btree_node *node)
+{
+  struct node_cache *cache;
+
+  cache = cache_get(tree, id, 1);
+  if(cache == NULL) {
+    return 0;
+  }
+  memcpy(node, &cache->node, sizeof(*node));
+  return 1;
+}
+
+static int
+node_write(btree_t *tree, btree_node_id_t id, struct btree_node *node)
+{
+  struct node_cache *cache;
+
+  cache = cache_get(tree, id, 0);
+  if(cache == NULL) {
+    return 0;
+  }
+  memcpy(&cache->node, node, sizeof(*node));
+  cache->dirty = 1;
+  return 1;
+}
+
+static btree_node_id_t
+node_allocate(btree_t *tree)
+{
+  if(tree->meta.node_count >= DB_BTREE_NODE_LIMIT) {
+    PRINTF("DB: No more B+-tree nodes available\n");
+    return NO_NODE;
+  }
+  tree->meta_dirty = 1;
+  return ++tree->meta.node_count;
+}
+
+static int
+tree_flush(btree_t *tree)
+{
+  struct node_cache *cache;
+  int ok;
+
+  ok = 1;
+  for(cache = node_cache; cache < &node_cache[DB_BTREE_CACHE_LIMIT]; cache++) {
+    if(cache->tree == tree && !cache_write_back(cache)) {
+      ok = 0;
+    }
+  }
+
+  if(tree->meta_dirty) {
+    if(DB_ERROR(storage_write(tree->storage, &tree->meta, 0,
+                              sizeof(tree->meta)))) {
+      ok = 0;
+    } else {
+      tree->meta_dirty = 0;
+    }
+  }
+
+  tree->pending_inserts = 0;
+  return ok;
+}
+
+static void
+tree_forget(btree_t *tree)
+{
+  struct node_cache *cache;
+
+  for(cache = node_cache; cache < &node_cache[DB_BTREE_CACHE_LIMIT]; cache++) {
+    if(cache->tree == tree) {
+      cache->tree = NULL;
+    }
+  }
+}
+
+/* The child to insert a key into: the last one whose separator key is
+   not greater than the key. */
+static int
+insert_position(struct btree_node *node, btree_key_t key)
+{
+  int i;
+
+  for(i = node->count - 1; i > 0 && node->entries[i].key > key; i--);
+  return i;
+}
+
+/* The child that may hold the first occurrence of a key: the last one
+   whose separator key is smaller than the key. */
+static int
+search_position(struct btree_node *node, btree_key_t key)
+{
+  int i;
+
+  for(i = node->count - 1; i > 0 && node->entries[i].key >= key; i--);
+  return i;
+}
+
+static void
+node_insert_entry(struct btree_node *node, int pos, struct btree_entry *entry)
+{
+  memmove(&node->entries[pos + 1], &node->entries[pos],
+          (node->count - pos) * sizeof(node->entries[0]));
+  node->entries[pos] = *entry;
+  node->count++;
+}
+
+/* Insert an entry into a node, splitting it if it is full. The entry
+   referencing a new right sibling is returned through split_entry. */
+static int
+node_add(btree_t *tree, btree_node_id_t id, struct btree_node *node, int pos,
+         struct btree_entry *entry, struct btree_entry *split_entry)
+{
+  struct btree_node right;
+  btree_node_id_t right_id;
+  int half;
+
+  split_entry->value = NO_NODE;
+
+  if(node->count < NODE_CAPACITY) {
+    node_insert_entry(node, pos, entry);
+    return node_write(tree, id, node);
+  }
+
+  right_id = node_allocate(tree);
+  if(right_id == NO_NODE) {
+    return 0;
+  }
+
+  half = node->count / 2;
+  memset(&right, 0, sizeof(right));
+  right.leaf = node->leaf;
+  right.count = node->count - half;
+  memcpy(right.entries, &node->entries[half],
+         right.count * sizeof(right.entries[0]));
+  node->count = half;
+
+  if(node->leaf) {
+    right.next = node->next;
+    node->next = right_id;
+  }
+
+  if(pos <= half) {
+    node_insert_entry(node, pos, entry);
+  } else {
+    node_insert_entry(&right, pos - half, entry);
+  }
+
+  split_entry->key = right.entries[0].key;
+  split_entry->value = right_id;
+
+  PRINTF("DB: Split B+-tree node %lu into %lu at key %ld\n",
+         (unsigned long)id, (unsigned long)right_id, (long)split_entry->key);
+
+  return node_write(tree, id, node) && node_write(tree, right_id, &right);
+}
+
+static int
+tree_insert(btree_t *tree, btree_key_t key, tuple_id_t tuple_id)
+{
+  btree_node_id_t path[DB_BTREE_MAX_HEIGHT];
+  uint8_t path_pos[DB_BTREE_MAX_HEIGHT];
+  struct btree_node node;
+  struct btree_entry entry;
+  struct btree_entry split_entry;
+  btree_node_id_t id;
+  btree_node_id_t root_id;
+  int level;
+  int pos;
+
+  /* Descend to the leaf, remembering the path for splits. */
+  id = tree->meta.root;
+  for(level = 0;; level++) {
+    if(!node_read(tree, id, &node)) {
+      return 0;
+    }
+    if(node.leaf) {
+      break;
+    }
+    pos = insert_position(&node, key);
+    path[level] = id;
+    path_pos[level] = pos;
+    id = node.entries[pos].value;
+  }
+
+  /* Equal keys are kept in insertion order. */
+  for(pos = node.count; pos > 0 && node.entries[pos - 1].key > key; pos--);
+
+  entry.key = key;
+  entry.value = tuple_id;
+  if(!node_add(tree, id, &node, pos, &entry, &split_entry)) {
+    return 0;
+  }
+
+  while(split_entry.value != NO_NODE && level > 0) {
+    level--;
+    id = path[level];
+    entry = split_entry;
+    if(!node_read(tree, id, &node) ||
+       !node_add(tree, id, &node, path_pos[level] + 1, &entry, &split_entry)) {
+      return 0;
+    }
+  }
+
+  if(split_entry.value != NO_NODE) {
+    /* The root was split; grow the tree by one level. */
+    if(tree->meta.height >= DB_BTREE_MAX_HEIGHT) {
+      PRINTF("DB: The B+-tree is too high\n");
+      return 0;
+    }
+    root_id = node_allocate(tree);
+    if(root_id == NO_NODE) {
+      return 0;
+    }
+    memset(&node, 0, sizeof(node));
+    node.count = 2;
+    node.entries[0].key = key;
+    node.entries[0].value = tree->meta.root;
+    node.entries[1] = split_entry;
+    if(!node_write(tree, root_id, &node)) {
+      return 0;
+    }
+    tree->meta.root = root_id;
+    tree->meta.height++;
+    tree->meta_dirty = 1;
+  }
+
+  return 1;
+}
+
+/* Find the leftmost leaf that may hold a key, and the position of the
+   first entry in it that is not smaller than the key. */
+static btree_node_id_t
+tree_search(btree_t *tree, btree_key_t key, struct btree_node *node, int *pos)
+{
+  btree_node_id_t id;
+
+  for(id = tree->meta.root;; id = node->entries[search_position(node, key)].value) {
+    if(!node_read(tree, id, node)) {
+      return NO_NODE;
+    }
+    if(node->leaf) {
+      break;
+    }
+  }
+
+  for(*pos = 0; *pos < node->count && node->entries[*pos].key < key; (*pos)++);
+  return id;
+}
+
+static db_result_t
+create(index_t *index)
+{
+  char *filename;
+  btree_t *tree;
+  struct btree_node root;
+
+  filename = storage_generate_file("btree",
+                                   (unsigned long)(DB_BTREE_NODE_LIMIT + 1) *
+                                   DB_BTREE_NODE_SIZE);
+  if(filename == NULL) {
+    PRINTF("DB: Failed to generate a B+-tree file\n");
+    return DB_INDEX_ERROR;
+  }
+
+  memcpy(index->descriptor_file, filename, sizeof(index->descriptor_file));
+
+  index->opaque_data = tree = memb_alloc(&btrees);
+  if(tree == NULL) {
+    PRINTF("DB: Failed to allocate a B+-tree\n");
+    cfs_remove(index->descriptor_file);
+    index->descriptor_file[0] = '\0';
+    return DB_ALLOCATION_ERROR;
+  }
+
+  tree->storage = storage_open(index->descriptor_file);
+  if(tree->storage < 0) {
+    memb_free(&btrees, tree);
+    cfs_remove(index->descriptor_file);
+    index->descriptor_file[0] = '\0';
+    return DB_STORAGE_ERROR;
+  }
+
+  /* Start with a single, empty leaf as the root. */
+  memset(&tree->meta, 0, sizeof(tree->meta));
+  tree->meta.height = 1;
+  tree->meta.root = node_allocate(tree);
+  tree->pending_inserts = 0;
+
+  memset(&root, 0, sizeof(root));
+  root.leaf = 1;
+
+  if(!node_write(tree, tree->meta.root, &root) || !tree_flush(tree)) {
+    tree_forget(tree);
+    storage_close(tree->storage);
+    memb_free(&btrees, tree);
+    cfs_remove(index->descriptor_file);
+    index->descriptor_file[0] = '\0';
+    return DB_STORAGE_ERROR;
+  }
+
+  PRINTF("DB: Created a B+-tree index in %s\n", index->descriptor_file);
+
+  return DB_OK;
+}
+
+static db_result_t
+destroy(index_t *index)
+{
+  if(index->opaque_data != NULL) {
+    release(index);
+  }
+  cfs_remove(index->descriptor_file);
+  return DB_OK;
+}
+
+static db_result_t
+load(index_t *index)
+{
+  btree_t *tree;
+
+  index->opaque_data = tree = memb_alloc(&btrees);
+  if(tree == NULL) {
+    PRINTF("DB: Failed to allocate a B+-tree\n");
+    return DB_ALLOCATION_ERROR;
+  }
+
+  tree->storage = storage_open(index->descriptor_file);
+  if(tree->storage < 0 ||
+     DB_ERROR(storage_read(tree->storage, &tree->meta, 0,
+                           sizeof(tree->meta))) ||
+     tree->meta.root == NO_NODE) {
+    storage_close(tree->storage);
+    memb_free(&btrees, tree);
+    return DB_STORAGE_ERROR;
+  }
+
+  tree->meta_dirty = 0;
+  tree->pending_inserts = 0;
+
+  PRINTF("DB: Loaded a B+-tree index of height %u from %s\n",
+         tree->meta.height, index->descriptor_file);
+
+  return DB_OK;
+}
+
+static db_result_t
+release(index_t *index)
+{
+  btree_t *tree;
+  db_result_t result;
+
+  tree = index->opaque_data;
+
+  result = tree_flush(tree) ? DB_OK : DB_STORAGE_ERROR;
+  tree_forget(tree);
+  storage_close(tree->storage);
+  memb_free(&btrees, tree);
+  index->opaque_data = NULL;
+
+  return result;
+}
+
+static db_result_t
+insert(index_t *index, attribute_value_t *key, tuple_id_t value)
+{
+  btree_t *tree;
+  long long_key;
+
+  tree = (btree_t *)index->opaque_data;
+
+  long_key = db_value_to_long(key);
+
+  if(!tree_insert(tree, (btree_key_t)long_key, value)) {
+    PRINTF("DB: Failed to insert key %ld into a B+-tree index\n", long_key);
+    return DB_INDEX_ERROR;
+  }
+
+  if(++tree->pending_inserts >= DB_BTREE_WRITE_BATCH && !tree_flush(tree)) {
+    return DB_STORAGE_ERROR;
+  }
+
+  return DB_OK;
+}
+
+static db_result_t
+delete(index_t *index, attribute_value_t *value)
+{
+  btree_t *tree;
+  btree_key_t key;
+  struct btree_node node;
+  btree_node_id_t id;
+  int pos;
+  int i;
+
+  tree = (btree_t *)index->opaque_data;
+  key = (btree_key_t)db_value_to_long(value);
+
+  id = tree_search(tree, key, &node, &pos);
+  while(id != NO_NODE) {
+    for(i = pos; i < node.count && node.entries[i].key == key; i++);
+    if(i > pos) {
+      memmove(&node.entries[pos], &node.entries[i],
+              (node.count - i) * sizeof(node.entries[0]));
+      node.count -= i - pos;
+      if(!node_write(tree, id, &node)) {
+        return DB_STORAGE_ERROR;
+      }
+    }
+    if(pos < node.count || node.next == NO_NODE) {
+      break;
+    }
+    id = node.next;
+    pos = 0;
+    if(!node_read(tree, id, &node)) {
+      return DB_STORAGE_ERROR;
+    }
+  }
+
+  return tree_flush(tree) ? DB_OK : DB_STORAGE_ERROR;
+}
+
+/* Limits a search bound to the range of keys. */
+static btree_key_t
+bound_to_key(long bound)
+{
+  if(bound < INT32_MIN) {
+    return INT32_MIN;
+  } else if(bound > INT32_MAX) {
+    return INT32_MAX;
+  }
+  return (btree_key_t)bound;
+}
+
+static tuple_id_t
+get_next(index_iterator_t *iterator)
+{
+  static struct {
+    index_iterator_t *iterator;
+    btree_node_id_t leaf;
+    uint8_t pos;
+  } cursor;
+  btree_t *tree;
+  struct btree_node node;
+  btree_key_t min;
+  btree_key_t max;
+  int pos;
+
+  tree = (btree_t *)iterator->index->opaque_data;
+  max = bound_to_key(db_value_to_long(&iterator->max_value));
+
+  if(cursor.iterator != iterator || iterator->next_item_no == 0) {
+    /* Start a new range search at the first key within the range. */
+    cursor.iterator = iterator;
+    min = bound_to_key(db_value_to_long(&iterator->min_value));
+    cursor.leaf = tree_search(tree, min, &node, &pos);
+    cursor.pos = pos;
+  } else if(cursor.leaf != NO_NODE && !node_read(tree, cursor.leaf, &node)) {
+    cursor.leaf = NO_NODE;
+  }
+
+  while(cursor.leaf != NO_NODE) {
+    if(cursor.pos >= node.count) {
+      cursor.leaf = node.next;
+      cursor.pos = 0;
+      if(cursor.leaf != NO_NODE && !node_read(tree, cursor.leaf, &node)) {
+        cursor.leaf = NO_NODE;
+      }
+      continue;
+    }
+
+    if(node.entries[cursor.pos].key > max) {
+      break;
+    }
+
+    iterator->next_item_no++;
+    return (tuple_id_t)node.entries[cursor.pos++].value;
+  }
+
+  cursor.leaf = NO_NODE;
+  return INVALID_TUPLE;
+}
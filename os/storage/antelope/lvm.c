@@ -64,12 +64,19 @@
 #define LVM_USE_FLOATS			0
 #endif
 
+#ifndef LVM_MAX_INSTRUCTIONS
+#define LVM_MAX_INSTRUCTIONS		16
+#endif
+
 #define IS_CONNECTIVE(op) ((op) & LVM_CONNECTIVE)
 
 struct variable {
   operand_type_t type;
   operand_value_t value;
   char name[LVM_MAX_NAME_LENGTH + 1];
+  /* The location of the variable's value in a row, if it is bound. */
+  uint16_t offset;
+  uint8_t size;
 };
 typedef struct variable variable_t;
 
@@ -87,6 +94,61 @@ static variable_t variables[LVM_MAX_VARIABLE_ID];
 /* Range derivations of variables that are used for index searches. */
 static derivation_t derivations[LVM_MAX_VARIABLE_ID];
 
+#if LVM_MAX_INSTRUCTIONS > 0
+/*
+ * A compiled predicate is a flat array of instructions in postfix
+ * order. Variables are replaced by loads from their bound row offsets,
+ * constant subexpressions are folded, and a comparison between a
+ * variable and a constant becomes a single range test. The connectives
+ * AND and OR jump past their right operand when the left operand
+ * already decides the result.
+ */
+enum insn_opcode {
+  INSN_CONST,
+  INSN_LOAD16,
+  INSN_LOAD32,
+  INSN_RANGE16,
+  INSN_RANGE32,
+  INSN_ADD,
+  INSN_SUB,
+  INSN_MUL,
+  INSN_DIV,
+  INSN_EQ,
+  INSN_NEQ,
+  INSN_GE,
+  INSN_GEQ,
+  INSN_LE,
+  INSN_LEQ,
+  INSN_NOT,
+  INSN_AND,
+  INSN_OR
+};
+
+struct insn {
+  uint8_t opcode;
+  uint8_t invert;
+  uint16_t arg;
+  long min;
+  long max;
+};
+
+enum term_kind {
+  TERM_CONST,
+  TERM_VARIABLE,
+  TERM_EMITTED
+};
+
+struct term {
+  enum term_kind kind;
+  long value;
+  variable_id_t id;
+};
+
+static struct insn program[LVM_MAX_INSTRUCTIONS];
+static lvm_ip_t program_end;
+static long stack[LVM_MAX_INSTRUCTIONS];
+#endif /* LVM_MAX_INSTRUCTIONS > 0 */
+
 #if DEBUG
 static void
 print_derivations(derivation_t *d)
@@ -306,6 +368,7 @@ lvm_reset(lvm_instance_t *p, unsigned char *code, lvm_ip_t size)
   p->end = 0;
   p->ip = 0;
   p->error = 0;
+  p->program_size = 0;
 
   memset(variables, 0, sizeof(variables));
   memset(derivations, 0, sizeof(derivations));
@@ -539,6 +602,464 @@ lvm_clone(lvm_instance_t *dst, lvm_instance_t *src)
   memcpy(dst, src, sizeof(*dst));
 }
 
+lvm_status_t
+lvm_bind_variable(char *name, unsigned offset, unsigned size)
+{
+  variable_id_t id;
+
+  if(size != 2 && size != 4) {
+    return LVM_TYPE_ERROR;
+  }
+
+  id = lookup(name);
+  if(id == LVM_MAX_VARIABLE_ID || variables[id].name[0] == '\0') {
+    return LVM_INVALID_IDENTIFIER;
+  }
+
+  variables[id].offset = offset;
+  variables[id].size = size;
+  return LVM_TRUE;
+}
+
+#if LVM_MAX_INSTRUCTIONS > 0
+static lvm_status_t
+emit(uint8_t opcode, uint16_t arg, long min, long max)
+{
+  struct insn *insn;
+
+  if(program_end >= LVM_MAX_INSTRUCTIONS) {
+    return LVM_STACK_OVERFLOW;
+  }
+
+  insn = &program[program_end++];
+  insn->opcode = opcode;
+  insn->invert = 0;
+  insn->arg = arg;
+  insn->min = min;
+  insn->max = max;
+  return LVM_TRUE;
+}
+
+static lvm_status_t
+emit_term(struct term *term)
+{
+  variable_t *var;
+  lvm_status_t r;
+
+  switch(term->kind) {
+  case TERM_CONST:
+    r = emit(INSN_CONST, 0, term->value, 0);
+    break;
+  case TERM_VARIABLE:
+    var = &variables[term->id];
+    r = emit(var->size == 2 ? INSN_LOAD16 : INSN_LOAD32, var->offset, 0, 0);
+    break;
+  default:
+    return LVM_TRUE;
+  }
+
+  term->kind = TERM_EMITTED;
+  return r;
+}
+
+static long
+fold(operator_t op, long l1, long l2)
+{
+  switch(op) {
+  case LVM_ADD:
+    return l1 + l2;
+  case LVM_SUB:
+    return l1 - l2;
+  case LVM_MUL:
+    return l1 * l2;
+  case LVM_DIV:
+    return l1 / l2;
+  case LVM_EQ:
+    return l1 == l2;
+  case LVM_NEQ:
+    return l1 != l2;
+  case LVM_GE:
+    return l1 > l2;
+  case LVM_GEQ:
+    return l1 >= l2;
+  case LVM_LE:
+    return l1 < l2;
+  case LVM_LEQ:
+    return l1 <= l2;
+  default:
+    return 0;
+  }
+}
+
+static lvm_status_t compile_term(lvm_instance_t *p, struct term *term);
+
+/* Compiles both operands of an operator. A constant or variable on the
+   left must be emitted before a right operand that emits instructions,
+   but the emission is undone if the operands can be folded. */
+static lvm_status_t
+compile_operands(lvm_instance_t *p, struct term *left, struct term *right)
+{
+  lvm_ip_t mark;
+  int left_const;
+  lvm_status_t r;
+
+  r = compile_term(p, left);
+  if(LVM_ERROR(r)) {
+    return r;
+  }
+
+  mark = program_end;
+  left_const = left->kind == TERM_CONST;
+  if(*(node_type_t *)(p->code + p->ip) == LVM_ARITH_OP) {
+    r = emit_term(left);
+    if(LVM_ERROR(r)) {
+      return r;
+    }
+  }
+
+  r = compile_term(p, right);
+  if(LVM_ERROR(r)) {
+    return r;
+  }
+
+  if(left_const && right->kind == TERM_CONST) {
+    program_end = mark;
+    left->kind = TERM_CONST;
+  }
+  return LVM_TRUE;
+}
+
+static lvm_status_t
+compile_term(lvm_instance_t *p, struct term *term)
+{
+  node_type_t type;
+  operator_t op;
+  operand_t operand;
+  struct term left;
+  struct term right;
+  lvm_status_t r;
+
+  type = get_type(p);
+  if(type == LVM_OPERAND) {
+    get_operand(p, &operand);
+    switch(operand.type) {
+    case LVM_LONG:
+      term->kind = TERM_CONST;
+      term->value = operand.value.l;
+      return LVM_TRUE;
+    case LVM_VARIABLE:
+      if(operand.value.id >= LVM_MAX_VARIABLE_ID ||
+         variables[operand.value.id].size == 0) {
+        return LVM_INVALID_IDENTIFIER;
+      }
+      term->kind = TERM_VARIABLE;
+      term->id = operand.value.id;
+      return LVM_TRUE;
+    default:
+      return LVM_TYPE_ERROR;
+    }
+  } else if(type != LVM_ARITH_OP) {
+    return LVM_SEMANTIC_ERROR;
+  }
+
+  op = *get_operator(p);
+  r = compile_operands(p, &left, &right);
+  if(LVM_ERROR(r)) {
+    return r;
+  }
+
+  if(left.kind == TERM_CONST && right.kind == TERM_CONST &&
+     !(op == LVM_DIV && right.value == 0)) {
+    term->kind = TERM_CONST;
+    term->value = fold(op, left.value, right.value);
+    return LVM_TRUE;
+  }
+
+  term->kind = TERM_EMITTED;
+  if(LVM_ERROR(r = emit_term(&left)) || LVM_ERROR(r = emit_term(&right))) {
+    return r;
+  }
+  return emit(INSN_ADD + ((op & ~LVM_ARITH_OP) - 1), 0, 0, 0);
+}
+
+/* Turns "variable op constant" into a test of whether the variable is
+   within [min, max], possibly inverted. */
+static lvm_status_t
+emit_range(operator_t op, struct term *var, long value)
+{
+  long min;
+  long max;
+  lvm_status_t r;
+
+  min = LONG_MIN;
+  max = LONG_MAX;
+
+  switch(op) {
+  case LVM_EQ:
+  case LVM_NEQ:
+    min = max = value;
+    break;
+  case LVM_GE:
+    if(value == LONG_MAX) {
+      return LVM_FALSE;
+    }
+    min = value + 1;
+    break;
+  case LVM_GEQ:
+    min = value;
+    break;
+  case LVM_LE:
+    if(value == LONG_MIN) {
+      return LVM_FALSE;
+    }
+    max = value - 1;
+    break;
+  case LVM_LEQ:
+    max = value;
+    break;
+  default:
+    return LVM_FALSE;
+  }
+
+  r = emit(variables[var->id].size == 2 ? INSN_RANGE16 : INSN_RANGE32,
+           variables[var->id].offset, min, max);
+  if(!LVM_ERROR(r)) {
+    program[program_end - 1].invert = op == LVM_NEQ;
+  }
+  return r;
+}
+
+static operator_t
+mirror(operator_t op)
+{
+  switch(op) {
+  case LVM_GE:
+    return LVM_LE;
+  case LVM_GEQ:
+    return LVM_LEQ;
+  case LVM_LE:
+    return LVM_GE;
+  case LVM_LEQ:
+    return LVM_GEQ;
+  default:
+    return op;
+  }
+}
+
+static lvm_status_t
+compile_logic(lvm_instance_t *p)
+{
+  node_type_t type;
+  operator_t op;
+  struct term left;
+  struct term right;
+  lvm_ip_t start;
+  lvm_ip_t jump;
+  lvm_status_t r;
+
+  type = get_type(p);
+  if(type != LVM_CMP_OP) {
+    return LVM_SEMANTIC_ERROR;
+  }
+  op = *get_operator(p);
+
+  if(op == LVM_NOT) {
+    start = program_end;
+    r = compile_logic(p);
+    if(LVM_ERROR(r)) {
+      return r;
+    }
+    if(program_end == start + 1 &&
+       (program[start].opcode == INSN_RANGE16 ||
+        program[start].opcode == INSN_RANGE32)) {
+      program[start].invert = !program[start].invert;
+      return LVM_TRUE;
+    }
+    return emit(INSN_NOT, 0, 0, 0);
+  } else if(op == LVM_AND || op == LVM_OR) {
+    r = compile_logic(p);
+    if(LVM_ERROR(r)) {
+      return r;
+    }
+    jump = program_end;
+    r = emit(op == LVM_AND ? INSN_AND : INSN_OR, 0, 0, 0);
+    if(LVM_ERROR(r)) {
+      return r;
+    }
+    r = compile_logic(p);
+    if(LVM_ERROR(r)) {
+      return r;
+    }
+    program[jump].arg = program_end;
+    return LVM_TRUE;
+  } else if(op < LVM_EQ || op > LVM_LEQ) {
+    return LVM_EXECUTION_ERROR;
+  }
+
+  r = compile_operands(p, &left, &right);
+  if(LVM_ERROR(r)) {
+    return r;
+  }
+
+  if(left.kind == TERM_CONST && right.kind == TERM_CONST) {
+    return emit(INSN_CONST, 0, fold(op, left.value, right.value), 0);
+  } else if(left.kind == TERM_VARIABLE && right.kind == TERM_CONST) {
+    r = emit_range(op, &left, right.value);
+  } else if(left.kind == TERM_CONST && right.kind == TERM_VARIABLE) {
+    r = emit_range(mirror(op), &right, left.value);
+  } else {
+    r = LVM_FALSE;
+  }
+
+  if(r != LVM_FALSE) {
+    return r;
+  }
+
+  if(LVM_ERROR(r = emit_term(&left)) || LVM_ERROR(r = emit_term(&right))) {
+    return r;
+  }
+  return emit(INSN_EQ + ((op & ~LVM_CMP_OP) - 1), 0, 0, 0);
+}
+#endif /* LVM_MAX_INSTRUCTIONS > 0 */
+
+lvm_status_t
+lvm_compile(lvm_instance_t *p)
+{
+#if LVM_MAX_INSTRUCTIONS > 0
+  lvm_status_t r;
+
+  p->ip = 0;
+  p->program_size = 0;
+  program_end = 0;
+
+  r = compile_logic(p);
+  if(LVM_ERROR(r)) {
+    PRINTF("Unable to compile the predicate: %d\n", (int)r);
+    return r;
+  }
+
+  p->program_size = program_end;
+  PRINTF("Compiled the predicate into %d instructions\n", (int)program_end);
+  return LVM_TRUE;
+#else
+  return LVM_EXECUTION_ERROR;
+#endif /* LVM_MAX_INSTRUCTIONS > 0 */
+}
+
+static inline long
+load_value(const unsigned char *ptr, unsigned size)
+{
+  if(size == 2) {
+    return ptr[0] << 8 | ptr[1];
+  }
+  return (uint32_t)ptr[0] << 24 | (uint32_t)ptr[1] << 16 |
+         (uint32_t)ptr[2] << 8 | ptr[3];
+}
+
+lvm_status_t
+lvm_execute_row(lvm_instance_t *p, const unsigned char *row)
+{
+#if LVM_MAX_INSTRUCTIONS > 0
+  const struct insn *insn;
+  const struct insn *end;
+  long *top;
+  long value;
+
+  top = stack - 1;
+  insn = program;
+  end = program + p->program_size;
+
+  while(insn < end) {
+    switch(insn->opcode) {
+    case INSN_CONST:
+      *++top = insn->min;
+      break;
+    case INSN_LOAD16:
+      *++top = load_value(row + insn->arg, 2);
+      break;
+    case INSN_LOAD32:
+      *++top = load_value(row + insn->arg, 4);
+      break;
+    case INSN_RANGE16:
+      value = load_value(row + insn->arg, 2);
+      *++top = (value >= insn->min && value <= insn->max) != insn->invert;
+      break;
+    case INSN_RANGE32:
+      value = load_value(row + insn->arg, 4);
+      *++top = (value >= insn->min && value <= insn->max) != insn->invert;
+      break;
+    case INSN_ADD:
+      top--;
+      top[0] += top[1];
+      break;
+    case INSN_SUB:
+      top--;
+      top[0] -= top[1];
+      break;
+    case INSN_MUL:
+      top--;
+      top[0] *= top[1];
+      break;
+    case INSN_DIV:
+      top--;
+      if(top[1] == 0) {
+        return LVM_MATH_ERROR;
+      }
+      top[0] /= top[1];
+      break;
+    case INSN_EQ:
+      top--;
+      top[0] = top[0] == top[1];
+      break;
+    case INSN_NEQ:
+      top--;
+      top[0] = top[0] != top[1];
+      break;
+    case INSN_GE:
+      top--;
+      top[0] = top[0] > top[1];
+      break;
+    case INSN_GEQ:
+      top--;
+      top[0] = top[0] >= top[1];
+      break;
+    case INSN_LE:
+      top--;
+      top[0] = top[0] < top[1];
+      break;
+    case INSN_LEQ:
+      top--;
+      top[0] = top[0] <= top[1];
+      break;
+    case INSN_NOT:
+      top[0] = !top[0];
+      break;
+    case INSN_AND:
+      if(!top[0]) {
+        insn = program + insn->arg;
+        continue;
+      }
+      top--;
+      break;
+    case INSN_OR:
+      if(top[0]) {
+        insn = program + insn->arg;
+        continue;
+      }
+      top--;
+      break;
+    default:
+      return LVM_EXECUTION_ERROR;
+    }
+    insn++;
+  }
+
+  return stack[0] ? LVM_TRUE : LVM_FALSE;
+#else
+  return LVM_EXECUTION_ERROR;
+#endif /* LVM_MAX_INSTRUCTIONS > 0 */
+}
+
 static void
 create_intersection(derivation_t *result, derivation_t *d1, derivation_t *d2)
 {
@@ -588,14 +1109,9 @@ create_union(derivation_t *result, derivation_t *d1, derivation_t *d2)
   int i;
 
   for(i = 0; i < LVM_MAX_VARIABLE_ID; i++) {
-    if(!d1[i].derived && !d2[i].derived) {
+    if(!d1[i].derived || !d2[i].derived) {
+      /* The variable is unconstrained on one side of the union. */
       continue;
-    } else if(d1[i].derived && !d2[i].derived) {
-      result[i].min.l = d1[i].min.l;
-      result[i].max.l = d1[i].max.l;
-    } else if(!d1[i].derived && d2[i].derived) {
-      result[i].min.l = d2[i].min.l;
-      result[i].max.l = d2[i].max.l;
     } else {
       /* Both derivations have been made; create a
          union of the ranges. */
@@ -625,6 +1141,36 @@ create_union(derivation_t *result, derivation_t *d1, derivation_t *d2)
 #endif /* DEBUG */
 }
 
+/* Skips an arithmetic expression or an operand, from which no range
+   can be derived. */
+static lvm_status_t
+skip_expr(lvm_instance_t *p, node_type_t type)
+{
+  operand_t operand;
+  lvm_status_t r;
+
+  switch(type) {
+  case LVM_OPERAND:
+    get_operand(p, &operand);
+    return LVM_TRUE;
+  case LVM_ARITH_OP:
+    get_operator(p);
+    r = skip_expr(p, get_type(p));
+    if(LVM_ERROR(r)) {
+      return r;
+    }
+    return skip_expr(p, get_type(p));
+  default:
+    return LVM_DERIVATION_ERROR;
+  }
+}
+
+/*
+ * Derives the ranges of the variables that the expression constrains.
+ * Parts of the expression that do not compare a variable with a
+ * constant leave the variables unconstrained, so that the ranges
+ * derived for the other operand of an AND can still be used.
+ */
 static int
 derive_relation(lvm_instance_t *p, derivation_t *local_derivations)
 {
@@ -632,28 +1178,37 @@ derive_relation(lvm_instance_t *p, derivation_t *local_derivations)
   node_type_t type;
   operand_t operand[2];
   int i;
+  int derivable;
   int variable_id;
   operand_value_t *value;
   derivation_t *derivation;
+  operator_t op;
 
   type = get_type(p);
+  if(type != LVM_CMP_OP) {
+    return LVM_DERIVATION_ERROR;
+  }
   operator = get_operator(p);
 
   if(IS_CONNECTIVE(*operator)) {
     derivation_t d1[LVM_MAX_VARIABLE_ID];
     derivation_t d2[LVM_MAX_VARIABLE_ID];
 
-    if(*operator != LVM_AND && *operator != LVM_OR) {
-      return LVM_DERIVATION_ERROR;
-    }
-
     PRINTF("Attempting to infer ranges from a logical connective\n");
 
     memset(d1, 0, sizeof(d1));
     memset(d2, 0, sizeof(d2));
 
-    if(LVM_ERROR(derive_relation(p, d1)) ||
-       LVM_ERROR(derive_relation(p, d2))) {
+    if(LVM_ERROR(derive_relation(p, d1))) {
+      return LVM_DERIVATION_ERROR;
+    }
+
+    if(*operator == LVM_NOT) {
+      /* The complement of a range is not a range. */
+      return LVM_TRUE;
+    }
+
+    if(LVM_ERROR(derive_relation(p, d2))) {
       return LVM_DERIVATION_ERROR;
     }
 
@@ -665,6 +1220,7 @@ derive_relation(lvm_instance_t *p, derivation_t *local_derivations)
     return LVM_TRUE;
   }
 
+  derivable = 1;
   for(i = 0; i < 2; i++) {
     type = get_type(p);
     switch(type) {
@@ -672,38 +1228,57 @@ derive_relation(lvm_instance_t *p, derivation_t *local_derivations)
       get_operand(p, &operand[i]);
       break;
     default:
-      return LVM_DERIVATION_ERROR;
+      if(LVM_ERROR(skip_expr(p, type))) {
+        return LVM_DERIVATION_ERROR;
+      }
+      derivable = 0;
     }
   }
 
-  if(operand[0].type == LVM_VARIABLE && operand[1].type == LVM_VARIABLE) {
-    return LVM_DERIVATION_ERROR;
+  if(!derivable ||
+     (operand[0].type == LVM_VARIABLE) == (operand[1].type == LVM_VARIABLE)) {
+    return LVM_TRUE;
   }
 
-  /* Determine which of the operands that is the variable. */
+  /* Determine which of the operands that is the variable, and mirror
+     the operator if the variable is on the right-hand side. */
+  op = *operator;
   if(operand[0].type == LVM_VARIABLE) {
-    if(operand[1].type == LVM_VARIABLE) {
-      return LVM_DERIVATION_ERROR;
-    }
     variable_id = operand[0].value.id;
     value = &operand[1].value;
   } else {
     variable_id = operand[1].value.id;
     value = &operand[0].value;
+    switch(op) {
+    case LVM_GE:
+      op = LVM_LE;
+      break;
+    case LVM_GEQ:
+      op = LVM_LEQ;
+      break;
+    case LVM_LE:
+      op = LVM_GE;
+      break;
+    case LVM_LEQ:
+      op = LVM_GEQ;
+      break;
+    default:
+      break;
+    }
   }
 
   if(variable_id >= LVM_MAX_VARIABLE_ID) {
      return LVM_DERIVATION_ERROR;
   }
 
-  PRINTF("variable id %d, value %ld\n", variable_id, *(long *)value);
+  PRINTF("variable id %d, value %ld\n", variable_id, value->l);
 
   derivation = local_derivations + variable_id;
   /* Default values. */
   derivation->max.l = LONG_MAX;
   derivation->min.l = LONG_MIN;
 
-  switch(*operator) {
+  switch(op) {
   case LVM_EQ:
     derivation->max = *value;
     derivation->min = *value;
@@ -721,7 +1296,8 @@ derive_relation(lvm_instance_t *p, derivation_t *local_derivations)
     derivation->max.l = value->l;
     break;
   default:
-    return LVM_DERIVATION_ERROR;
+    /* Inequality does not constrain the variable to a range. */
+    return LVM_TRUE;
   }
 
   derivation->derived = 1;
@@ -732,6 +1308,8 @@ derive_relation(lvm_instance_t *p, derivation_t *local_derivations)
 lvm_status_t
 lvm_derive(lvm_instance_t *p)
 {
+  p->ip = 0;
+  memset(derivations, 0, sizeof(derivations));
   return derive_relation(p, derivations);
 }
 
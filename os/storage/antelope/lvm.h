@@ -61,6 +61,8 @@ typedef enum lvm_status lvm_status_t;
 
 #define LVM_ERROR(x)	(x >= 2)
 
+#define LVM_IS_COMPILED(p)	((p)->program_size > 0)
+
 typedef int lvm_ip_t;
 
 struct lvm_instance {
@@ -69,6 +71,7 @@ struct lvm_instance {
   lvm_ip_t end;
   lvm_ip_t ip;
   unsigned error;
+  lvm_ip_t program_size;
 };
 typedef struct lvm_instance lvm_instance_t;
 
@@ -128,6 +131,9 @@ lvm_status_t lvm_get_derived_range(lvm_instance_t *p, char *name,
                                    operand_value_t *max);
 void lvm_print_derivations(lvm_instance_t *p);
 lvm_status_t lvm_execute(lvm_instance_t *p);
+lvm_status_t lvm_bind_variable(char *name, unsigned offset, unsigned size);
+lvm_status_t lvm_compile(lvm_instance_t *p);
+lvm_status_t lvm_execute_row(lvm_instance_t *p, const unsigned char *row);
 lvm_status_t lvm_register_variable(char *name, operand_type_t type);
 lvm_status_t lvm_set_variable_value(char *name, operand_value_t value);
 void lvm_print_code(lvm_instance_t *p);
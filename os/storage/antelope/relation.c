@@ -177,6 +177,7 @@ relation_clear(relation_t *rel)
   memset(rel, 0, sizeof(*rel));
   rel->tuple_storage = -1;
   rel->cardinality = INVALID_TUPLE;
+  rel->row_count = INVALID_TUPLE;
   rel->dir = DB_STORAGE;
   LIST_STRUCT_INIT(rel, attributes);
 }
@@ -547,8 +548,76 @@ relation_insert(relation_t *rel, attribute_value_t *values)
   return storage_put_row(rel, record);
 }
 
+/*
+ * Aggregated values are kept per group in a small hash table, which is
+ * filled while the rows are streamed through the selection. A query
+ * without GROUP BY aggregates all of its rows in a single group.
+ */
+struct group {
+  long key;
+  long values[AQL_ATTRIBUTE_LIMIT];
+  tuple_id_t rows;
+  uint8_t next;
+};
+
+#define NO_GROUP	0xff
+
+#if DB_GROUP_LIMIT >= NO_GROUP
+#error "DB_GROUP_LIMIT must be smaller than 255"
+#endif
+
+static struct group groups[DB_GROUP_LIMIT];
+static uint8_t group_heads[DB_GROUP_LIMIT];
+static uint8_t group_count;
+static uint8_t groups_emitted;
+static uint8_t aggregation_done;
+static struct source_dest_map *group_map;
+
+static void
+clear_groups(void)
+{
+  memset(group_heads, NO_GROUP, sizeof(group_heads));
+  group_count = 0;
+  groups_emitted = 0;
+  aggregation_done = 0;
+}
+
+static struct group *
+find_group(long key, unsigned attribute_count)
+{
+  uint8_t *head;
+  uint8_t id;
+  struct group *group;
+  unsigned i;
+
+  head = &group_heads[(unsigned long)key % DB_GROUP_LIMIT];
+  for(id = *head; id != NO_GROUP; id = groups[id].next) {
+    if(groups[id].key == key) {
+      return &groups[id];
+    }
+  }
+
+  if(group_count == DB_GROUP_LIMIT) {
+    PRINTF("DB: The number of groups exceeds %d\n", DB_GROUP_LIMIT);
+    return NULL;
+  }
+
+  group = &groups[group_count];
+  group->key = key;
+  group->rows = 0;
+  group->next = *head;
+  *head = group_count++;
+
+  for(i = 0; i < attribute_count; i++) {
+    group->values[i] = attr_map[i].to_attr->aggregation_value;
+  }
+
+  return group;
+}
+
 static void
-aggregate(attribute_t *attr, attribute_value_t *value)
+aggregate(aql_aggregator_t aggregator, long *aggregation_value,
+          attribute_value_t *value)
 {
   long long_value;
 
@@ -563,25 +632,26 @@ aggregate(attribute_t *attr, attribute_value_t *value)
     return;
   }
 
-  switch(attr->aggregator) {
+  switch(aggregator) {
   case AQL_COUNT:
-    attr->aggregation_value++;
+    (*aggregation_value)++;
     break;
   case AQL_SUM:
-    attr->aggregation_value += long_value;
-    break;
   case AQL_MEAN:
+    /* The mean is divided by the number of rows in the group
+       when the result is generated. */
+    *aggregation_value += long_value;
     break;
   case AQL_MEDIAN:
     break;
   case AQL_MAX:
-    if(long_value > attr->aggregation_value) {
-      attr->aggregation_value = long_value;
+    if(long_value > *aggregation_value) {
+      *aggregation_value = long_value;
     }
     break;
   case AQL_MIN:
-    if(long_value < attr->aggregation_value) {
-      attr->aggregation_value = long_value;
+    if(long_value < *aggregation_value) {
+      *aggregation_value = long_value;
     }
     break;
   default:
@@ -636,7 +706,7 @@ select_index(db_handle_t *handle, lvm_instance_t *lvm_instance)
   operand_value_t max;
   attribute_value_t av_min;
   attribute_value_t av_max;
-  long range;
+  unsigned long range;
   unsigned long min_range;
 
   index = NULL;
@@ -650,12 +720,13 @@ select_index(db_handle_t *handle, lvm_instance_t *lvm_instance)
     if(attr->index != NULL &&
        !LVM_ERROR(lvm_get_derived_range(lvm_instance, attr->name, &min, &max))) {
       range = (unsigned long)max.l - (unsigned long)min.l;
-      PRINTF("DB: The search range for attribute \"%s\" comprises %ld values\n",
+      PRINTF("DB: The search range for attribute \"%s\" comprises %lu values\n",
              attr->name, range + 1);
 
       if(range <= min_range) {
+        min_range = range;
         index = attr->index;
-        av_min.domain = av_max.domain = DOMAIN_INT;
+        av_min.domain = av_max.domain = DOMAIN_LONG;
         VALUE_LONG(&av_min) = min.l;
         VALUE_LONG(&av_max) = max.l;
       }
@@ -677,6 +748,7 @@ generate_selection_result(db_handle_t *handle, relation_t *rel, aql_adt_t *adt)
   relation_t *result_rel;
   unsigned attribute_count;
   attribute_t *attr;
+  unsigned i;
 
   result_rel = handle->result_rel;
 
@@ -696,9 +768,42 @@ generate_selection_result(db_handle_t *handle, relation_t *rel, aql_adt_t *adt)
     return DB_IMPLEMENTATION_ERROR;
   }
 
+  if(AQL_GET_FLAGS(adt) & AQL_FLAG_AGGREGATE) {
+    clear_groups();
+    group_map = NULL;
+    for(i = 0; i < attribute_count; i++) {
+      if(attr_map[i].to_attr->flags & ATTRIBUTE_FLAG_GROUP) {
+        group_map = &attr_map[i];
+      }
+    }
+
+    if(group_map == NULL) {
+      /* All rows are aggregated into one result row, even if no row
+         fulfills the condition. */
+      find_group(0, attribute_count);
+    } else if(group_map->from_attr->domain != DOMAIN_INT &&
+              group_map->from_attr->domain != DOMAIN_LONG) {
+      PRINTF("DB: Rows can only be grouped by integer attributes\n");
+      return DB_TYPE_ERROR;
+    }
+  }
+
   if(adt->lvm_instance != NULL) {
-    /* Try to establish acceptable ranges for the attribute values. */
-    if(!LVM_ERROR(lvm_derive(adt->lvm_instance))) {
+    /* Resolve the predicate's variables to their offsets in the row,
+       so that it can be evaluated without the bytecode interpreter. */
+    for(i = 0; i < attribute_count; i++) {
+      attr = attr_map[i].from_attr;
+      if(attr->domain == DOMAIN_INT || attr->domain == DOMAIN_LONG) {
+        lvm_bind_variable(attr->name, attr_map[i].from_offset,
+                          attr->domain == DOMAIN_INT ? 2 : 4);
+      }
+    }
+    lvm_compile(adt->lvm_instance);
+
+    /* Try to establish acceptable ranges for the attribute values.
+       An index search would skip the rows that a removal must keep. */
+    if(!(AQL_GET_FLAGS(adt) & AQL_FLAG_INVERSE_LOGIC) &&
+       !LVM_ERROR(lvm_derive(adt->lvm_instance))) {
       select_index(handle, adt->lvm_instance);
     }
   }
@@ -743,24 +848,28 @@ relation_process_select(void *handle_ptr)
   unsigned char *from_ptr;
   unsigned char *to_ptr;
   operand_value_t operand_value;
-  uint8_t intbuf[2];
   attribute_value_t value;
   lvm_status_t wanted_result;
+  lvm_instance_t *lvm_instance;
+  struct group *group;
+  long key;
 
   handle = (db_handle_t *)handle_ptr;
   adt = (aql_adt_t *)handle->adt;
+  lvm_instance = adt->lvm_instance;
 
   attribute_count = handle->result_rel->attribute_count;
   attr_map_end = attr_map + attribute_count;
 
+  if((AQL_GET_FLAGS(adt) & AQL_FLAG_AGGREGATE) && aggregation_done) {
+    goto end_aggregation;
+  }
+
   if(handle->flags & DB_HANDLE_FLAG_SEARCH_INDEX) {
     handle->tuple_id = index_get_next(&handle->index_iterator);
     if(handle->tuple_id == INVALID_TUPLE) {
-      PRINTF("DB: An attribute value could not be found in the index\n");
-      if(handle->index_iterator.next_item_no == 0) {
-        return DB_INDEX_ERROR;
-      }
-
+      /* No more rows are in the searched range. This includes an
+         empty range, which is an empty result rather than an error. */
       if(adt->flags & AQL_FLAG_AGGREGATE) {
         goto end_aggregation;
       }
@@ -789,10 +898,12 @@ relation_process_select(void *handle_ptr)
     result_attr = attr_map_ptr->to_attr;
 
     /* Update the internal state of the PLE. */
-    if(result_attr->domain == DOMAIN_INT) {
+    if(lvm_instance == NULL || LVM_IS_COMPILED(lvm_instance)) {
+      /* The values are read directly from the row. */
+    } else if(attr_map_ptr->from_attr->domain == DOMAIN_INT) {
       operand_value.l = from_ptr[0] << 8 | from_ptr[1];
       lvm_set_variable_value(result_attr->name, operand_value);
-    } else if(result_attr->domain == DOMAIN_LONG) {
+    } else if(attr_map_ptr->from_attr->domain == DOMAIN_LONG) {
       operand_value.l = (uint32_t)from_ptr[0] << 24 |
                         (uint32_t)from_ptr[1] << 16 |
                         (uint32_t)from_ptr[2] << 8 |
@@ -819,16 +930,38 @@ relation_process_select(void *handle_ptr)
   }
 
   /* Check whether the given predicate is true for this tuple. */
-  if(adt->lvm_instance == NULL ||
-     lvm_execute(adt->lvm_instance) == wanted_result) {
+  if(lvm_instance == NULL ||
+     (LVM_IS_COMPILED(lvm_instance) ?
+      lvm_execute_row(lvm_instance, row) :
+      lvm_execute(lvm_instance)) == wanted_result) {
     if(AQL_GET_FLAGS(adt) & AQL_FLAG_AGGREGATE) {
+      key = 0;
+      if(group_map != NULL) {
+        result = db_phy_to_value(&value, group_map->from_attr,
+                                 row + group_map->from_offset);
+        if(DB_ERROR(result)) {
+          return result;
+        }
+        key = db_value_to_long(&value);
+      }
+
+      group = find_group(key, attribute_count);
+      if(group == NULL) {
+        return DB_LIMIT_ERROR;
+      }
+      group->rows++;
+
       for(attr_map_ptr = attr_map; attr_map_ptr < attr_map_end; attr_map_ptr++) {
+        if(attr_map_ptr->to_attr->aggregator == AQL_NONE) {
+          continue;
+        }
         from_ptr = row + attr_map_ptr->from_offset;
-        result = db_phy_to_value(&value, attr_map_ptr->to_attr, from_ptr);
+        result = db_phy_to_value(&value, attr_map_ptr->from_attr, from_ptr);
         if(DB_ERROR(result)) {
 	  return result;
         }
-        aggregate(attr_map_ptr->to_attr, &value);
+        aggregate(attr_map_ptr->to_attr->aggregator,
+                  &group->values[attr_map_ptr - attr_map], &value);
       }
     } else {
       if(AQL_GET_FLAGS(adt) & AQL_FLAG_ASSIGN) {
@@ -845,15 +978,36 @@ relation_process_select(void *handle_ptr)
   return DB_OK;
 
 end_aggregation:
-  /* Generate aggregated result if requested. */
+  /* Generate one aggregated result row per group. */
+  aggregation_done = 1;
+  if(groups_emitted == group_count) {
+    return DB_FINISHED;
+  }
+  group = &groups[groups_emitted++];
+
   for(attr_map_ptr = attr_map; attr_map_ptr < attr_map_end; attr_map_ptr++) {
     result_attr = attr_map_ptr->to_attr;
-    to_ptr = result_row + attr_map_ptr->to_offset;
+    if(result_attr->flags & ATTRIBUTE_FLAG_NO_STORE) {
+      continue;
+    }
 
-    intbuf[0] = result_attr->aggregation_value >> 8;
-    intbuf[1] = result_attr->aggregation_value & 0xff;
-    from_ptr = intbuf;
-    memcpy(to_ptr, from_ptr, result_attr->element_size);
+    value.domain = result_attr->domain;
+    if(result_attr->aggregator == AQL_NONE) {
+      /* The attribute that the rows are grouped by. */
+      if(value.domain == DOMAIN_INT) {
+        VALUE_INT(&value) = group->key;
+      } else {
+        VALUE_LONG(&value) = group->key;
+      }
+    } else {
+      VALUE_LONG(&value) = group->values[attr_map_ptr - attr_map];
+      if(result_attr->aggregator == AQL_MEAN && group->rows > 0) {
+        VALUE_LONG(&value) /= (long)group->rows;
+      }
+    }
+
+    to_ptr = result_row + attr_map_ptr->to_offset;
+    db_value_to_phy(to_ptr, result_attr, &value);
   }
 
   if(AQL_GET_FLAGS(adt) & AQL_FLAG_ASSIGN) {
@@ -863,8 +1017,7 @@ end_aggregation:
     }
   }
 
-  handle->current_row = 1;
-  AQL_GET_FLAGS(adt) &= ~AQL_FLAG_AGGREGATE; /* Stop the aggregation. */
+  handle->current_row = groups_emitted;
 
   return DB_GOT_ROW;
 }
@@ -918,8 +1071,8 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
 
     attr = relation_attribute_add(handle->result_rel, dir,
 				  attribute_name, 
-				  adt->aggregators[i] ? DOMAIN_INT : attr->domain,
-				  attr->element_size);
+				  adt->aggregators[i] ? DOMAIN_LONG : attr->domain,
+				  adt->aggregators[i] ? 4 : attr->element_size);
     if(attr == NULL) {
       PRINTF("DB: Failed to add a result attribute\n");
       relation_release(handle->result_rel);
@@ -929,8 +1082,10 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
     attr->aggregator = adt->aggregators[i];
     switch(attr->aggregator) {
     case AQL_NONE:
-      if(!(adt->attributes[i].flags & ATTRIBUTE_FLAG_NO_STORE)) {
-        /* Only count attributes projected into the result set. */
+      if(!(adt->attributes[i].flags &
+           (ATTRIBUTE_FLAG_NO_STORE | ATTRIBUTE_FLAG_GROUP))) {
+        /* Only count attributes projected into the result set,
+           apart from the one that the rows are grouped by. */
         normal_attributes++;
       }
       break;
@@ -949,9 +1104,9 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
   }
 
   /* Preclude mixes of normal attributes and aggregated ones in 
-     selection results. */
-  if(normal_attributes > 0 &&
-     handle->result_rel->attribute_count > normal_attributes) {
+     selection results. Attributes used only in the predicate are
+     neither. */
+  if(normal_attributes > 0 && (AQL_GET_FLAGS(adt) & AQL_FLAG_AGGREGATE)) {
      return DB_RELATIONAL_ERROR;
   }
 
@@ -959,6 +1114,235 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
 }
 
 #if DB_FEATURE_JOIN
+/*
+ * A hash join is used when the attribute to join on is not indexed in
+ * the right relation. The join keys and tuple IDs of a batch of rows
+ * from the smaller relation are kept in a hash table, against which
+ * each row of the larger relation is probed. If the smaller relation
+ * does not fit in one batch, the larger relation is scanned once per
+ * batch, so that the memory use is bounded by DB_HASH_JOIN_ROWS.
+ */
+struct hash_entry {
+  long key;
+  tuple_id_t tuple_id;
+  uint8_t next;
+};
+
+#define NO_HASH_ENTRY	0xff
+
+#if DB_HASH_JOIN_ROWS >= NO_HASH_ENTRY
+#error "DB_HASH_JOIN_ROWS must be smaller than 255"
+#endif
+
+#define HASH_BUCKET(key)	((unsigned long)(key) % DB_HASH_JOIN_ROWS)
+
+struct hash_join {
+  struct hash_entry entries[DB_HASH_JOIN_ROWS];
+  uint8_t heads[DB_HASH_JOIN_ROWS];
+  relation_t *build_rel;
+  relation_t *probe_rel;
+  attribute_t *build_attr;
+  attribute_t *probe_attr;
+  unsigned char *build_row;
+  unsigned char *probe_row;
+  int build_offset;
+  int probe_offset;
+  tuple_id_t next_build_row;
+  long probe_key;
+  uint8_t entry_count;
+  uint8_t next_entry;
+  uint8_t build_finished;
+};
+
+static struct hash_join hash_join;
+
+static db_result_t
+join_key(attribute_t *attr, unsigned char *ptr, long *key)
+{
+  attribute_value_t value;
+
+  if(DB_ERROR(db_phy_to_value(&value, attr, ptr))) {
+    return DB_TYPE_ERROR;
+  }
+  *key = db_value_to_long(&value);
+  return DB_OK;
+}
+
+static db_result_t
+build_hash_table(void)
+{
+  struct hash_entry *entry;
+  tuple_id_t tuple_id;
+  db_result_t result;
+  unsigned bucket;
+
+  memset(hash_join.heads, NO_HASH_ENTRY, sizeof(hash_join.heads));
+  hash_join.entry_count = 0;
+  hash_join.next_entry = NO_HASH_ENTRY;
+
+  while(hash_join.entry_count < DB_HASH_JOIN_ROWS) {
+    tuple_id = hash_join.next_build_row;
+    result = storage_get_row(hash_join.build_rel, &tuple_id,
+                             hash_join.build_row);
+    if(DB_ERROR(result)) {
+      return result;
+    } else if(result == DB_FINISHED) {
+      hash_join.build_finished = 1;
+      break;
+    }
+    hash_join.next_build_row++;
+
+    entry = &hash_join.entries[hash_join.entry_count];
+    if(DB_ERROR(join_key(hash_join.build_attr,
+                         hash_join.build_row + hash_join.build_offset,
+                         &entry->key))) {
+      return DB_TYPE_ERROR;
+    }
+    entry->tuple_id = tuple_id;
+
+    bucket = HASH_BUCKET(entry->key);
+    entry->next = hash_join.heads[bucket];
+    hash_join.heads[bucket] = hash_join.entry_count++;
+  }
+
+  PRINTF("DB: Hashed %d rows of relation %s\n",
+         hash_join.entry_count, hash_join.build_rel->name);
+
+  return DB_OK;
+}
+
+static db_result_t
+start_hash_join(db_handle_t *handle)
+{
+  tuple_id_t left_cardinality;
+  tuple_id_t right_cardinality;
+
+  left_cardinality = relation_cardinality(handle->left_rel);
+  right_cardinality = relation_cardinality(handle->right_rel);
+  if(left_cardinality == INVALID_TUPLE || right_cardinality == INVALID_TUPLE) {
+    return DB_STORAGE_ERROR;
+  }
+
+  /* Build the hash table from the smaller relation. */
+  if(right_cardinality <= left_cardinality) {
+    hash_join.build_rel = handle->right_rel;
+    hash_join.build_attr = handle->right_join_attr;
+    hash_join.build_row = right_row;
+    hash_join.probe_rel = handle->left_rel;
+    hash_join.probe_attr = handle->left_join_attr;
+    hash_join.probe_row = left_row;
+  } else {
+    hash_join.build_rel = handle->left_rel;
+    hash_join.build_attr = handle->left_join_attr;
+    hash_join.build_row = left_row;
+    hash_join.probe_rel = handle->right_rel;
+    hash_join.probe_attr = handle->right_join_attr;
+    hash_join.probe_row = right_row;
+  }
+
+  hash_join.build_offset = get_attribute_value_offset(hash_join.build_rel,
+                                                      hash_join.build_attr);
+  hash_join.probe_offset = get_attribute_value_offset(hash_join.probe_rel,
+                                                      hash_join.probe_attr);
+  if(hash_join.build_offset < 0 || hash_join.probe_offset < 0) {
+    return DB_IMPLEMENTATION_ERROR;
+  }
+
+  hash_join.next_build_row = 0;
+  hash_join.build_finished = 0;
+  handle->tuple_id = 0;
+
+  return build_hash_table();
+}
+
+static db_result_t
+generate_join_row(db_handle_t *handle)
+{
+  unsigned char *join_next_attribute_ptr;
+  size_t element_size;
+  int i;
+
+  /* Use the source attribute map to fill in the physical representation
+     of the resulting tuple. */
+  join_next_attribute_ptr = join_row;
+
+  for(i = 0; i < handle->join_rel->attribute_count; i++) {
+    element_size = source_map[i].attr->element_size;
+
+    memcpy(join_next_attribute_ptr, source_map[i].from_ptr, element_size);
+    join_next_attribute_ptr += element_size;
+  }
+
+  if(((aql_adt_t *)handle->adt)->flags & AQL_FLAG_ASSIGN) {
+    if(DB_ERROR(storage_put_row(handle->join_rel, join_row))) {
+      return DB_STORAGE_ERROR;
+    }
+  }
+
+  handle->current_row++;
+  return DB_GOT_ROW;
+}
+
+static db_result_t
+process_hash_join(db_handle_t *handle)
+{
+  struct hash_entry *entry;
+  tuple_id_t tuple_id;
+  db_result_t result;
+
+  if(hash_join.next_entry == NO_HASH_ENTRY) {
+    /* Probe the hash table with the next row of the larger relation. */
+    result = storage_get_row(hash_join.probe_rel, &handle->tuple_id,
+                             hash_join.probe_row);
+    if(DB_ERROR(result)) {
+      return result;
+    } else if(result == DB_FINISHED) {
+      if(hash_join.build_finished) {
+        return DB_FINISHED;
+      }
+
+      /* Start over with the next batch of rows of the smaller relation. */
+      result = build_hash_table();
+      if(DB_ERROR(result)) {
+        return result;
+      } else if(hash_join.entry_count == 0) {
+        return DB_FINISHED;
+      }
+      handle->tuple_id = 0;
+      return DB_OK;
+    }
+    handle->tuple_id++;
+
+    if(DB_ERROR(join_key(hash_join.probe_attr,
+                         hash_join.probe_row + hash_join.probe_offset,
+                         &hash_join.probe_key))) {
+      return DB_TYPE_ERROR;
+    }
+    hash_join.next_entry = hash_join.heads[HASH_BUCKET(hash_join.probe_key)];
+  }
+
+  while(hash_join.next_entry != NO_HASH_ENTRY) {
+    entry = &hash_join.entries[hash_join.next_entry];
+    hash_join.next_entry = entry->next;
+    if(entry->key != hash_join.probe_key) {
+      continue;
+    }
+
+    tuple_id = entry->tuple_id;
+    result = storage_get_row(hash_join.build_rel, &tuple_id,
+                             hash_join.build_row);
+    if(DB_ERROR(result)) {
+      return result;
+    } else if(result == DB_FINISHED) {
+      return DB_IMPLEMENTATION_ERROR;
+    }
+
+    return generate_join_row(handle);
+  }
+
+  return DB_OK;
+}
+
 db_result_t
 relation_process_join(void *handle_ptr)
 {
@@ -966,17 +1350,16 @@ relation_process_join(void *handle_ptr)
   db_result_t result;
   relation_t *left_rel;
   relation_t *right_rel;
-  relation_t *join_rel;
-  unsigned char *join_next_attribute_ptr;
-  size_t element_size;
   tuple_id_t right_tuple_id;
   attribute_value_t value;
-  int i;
 
   handle = (db_handle_t *)handle_ptr;
   left_rel = handle->left_rel;
   right_rel = handle->right_rel;
-  join_rel = handle->join_rel;
+
+  if(handle->flags & DB_HANDLE_FLAG_HASH_JOIN) {
+    return process_hash_join(handle);
+  }
 
   if(!(handle->flags & DB_HANDLE_FLAG_INDEX_STEP)) {
     goto inner_loop;
@@ -1030,25 +1413,7 @@ inner_loop:
         return DB_IMPLEMENTATION_ERROR;
       }
 
-      /* Use the source attribute map to fill in the physical representation
-	 of the resulting tuple. */
-      join_next_attribute_ptr = join_row;
-
-      for(i = 0; i < join_rel->attribute_count; i++) {
-	element_size = source_map[i].attr->element_size;
-
-	memcpy(join_next_attribute_ptr, source_map[i].from_ptr, element_size);
-	join_next_attribute_ptr += element_size;
-      }
-
-      if(((aql_adt_t *)handle->adt)->flags & AQL_FLAG_ASSIGN) {
-        if(DB_ERROR(storage_put_row(join_rel, join_row))) {
-          return DB_STORAGE_ERROR;
-        }
-      }
-
-      handle->current_row++;
-      return DB_GOT_ROW;
+      return generate_join_row(handle);
     }
   }
 
@@ -1159,8 +1524,15 @@ relation_join(void *query_result, void *adt_ptr)
   }
 
   if(!index_exists(handle->right_join_attr)) {
-    PRINTF("DB: The attribute to join on is not indexed\n");
-    return DB_INDEX_ERROR;
+    if((handle->left_join_attr->domain != DOMAIN_INT &&
+        handle->left_join_attr->domain != DOMAIN_LONG) ||
+       (handle->right_join_attr->domain != DOMAIN_INT &&
+        handle->right_join_attr->domain != DOMAIN_LONG)) {
+      PRINTF("DB: The attribute to join on is not indexed\n");
+      return DB_INDEX_ERROR;
+    }
+    PRINTF("DB: The attribute to join on is not indexed; using a hash join\n");
+    handle->flags = DB_HANDLE_FLAG_HASH_JOIN;
   }
 
   /*
@@ -1189,6 +1561,13 @@ relation_join(void *query_result, void *adt_ptr)
     handle->ncolumns++;
   }
 
+  if(handle->flags & DB_HANDLE_FLAG_HASH_JOIN) {
+    if(DB_ERROR(generate_join_result(handle))) {
+      return DB_IMPLEMENTATION_ERROR;
+    }
+    return start_hash_join(handle);
+  }
+
   return generate_join_result(handle);
 }
 #endif /* DB_FEATURE_JOIN */
@@ -68,6 +68,7 @@ struct relation {
   attribute_id_t attribute_count;
   tuple_id_t cardinality;
   tuple_id_t next_row;
+  tuple_id_t row_count; /* Cached by the storage layer. */
   db_storage_id_t tuple_storage;
   db_direction_t dir;
   uint8_t references;
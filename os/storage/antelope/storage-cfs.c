@@ -68,6 +68,28 @@ struct index_record {
 
 #define ROW_XOR 0xf6U
 
+/*
+ * Rows are read and appended through a small pool of page buffers, so
+ * that a sequential scan or a series of insertions costs one file system
+ * access per page instead of one per row. The rows in a page are kept
+ * decoded. Rows from index "written" onwards have been appended to the
+ * relation, but are not yet stored in its tuple file.
+ */
+struct row_page {
+  relation_t *rel;
+  tuple_id_t first_row;
+  uint16_t rows;
+  uint16_t written;
+  uint16_t last_use;
+  unsigned char data[DB_STORAGE_PAGE_SIZE];
+};
+
+#define PAGE_CAPACITY(rel)     (DB_STORAGE_PAGE_SIZE / (rel)->row_length)
+#define ROW_FITS_IN_PAGE(rel)  ((rel)->row_length <= DB_STORAGE_PAGE_SIZE)
+
+static struct row_page pages[DB_STORAGE_PAGE_POOL_SIZE];
+static uint16_t page_clock;
+
 static void
 merge_strings(char *dest, char *prefix, char *suffix)
 {
@@ -75,6 +97,215 @@ merge_strings(char *dest, char *prefix, char *suffix)
   strcat(dest, suffix);
 }
 
+static void
+xor_rows(relation_t *rel, unsigned char *data, unsigned rows)
+{
+  unsigned char *last_byte;
+
+  /* Ensure that last written byte is separated from 0, to make file
+     lengths correct in Coffee. */
+  for(last_byte = data + rel->row_length - 1; rows > 0; rows--) {
+    *last_byte ^= ROW_XOR;
+    last_byte += rel->row_length;
+  }
+}
+
+static int
+read_rows(relation_t *rel, tuple_id_t tuple_id, unsigned char *data,
+          unsigned rows)
+{
+  int r;
+
+  if(cfs_seek(rel->tuple_storage, tuple_id * rel->row_length, CFS_SEEK_SET) ==
+              (cfs_offset_t)-1) {
+    return -1;
+  }
+
+  r = cfs_read(rel->tuple_storage, data, rows * rel->row_length);
+  if(r < 0) {
+    PRINTF("DB: Reading failed on fd %d\n", rel->tuple_storage);
+    return -1;
+  } else if(r > 0 && r < rel->row_length) {
+    PRINTF("DB: Incomplete record: %d < %d\n", r, rel->row_length);
+    return -1;
+  }
+
+  rows = r / rel->row_length;
+  xor_rows(rel, data, rows);
+
+  PRINTF("DB: Read %u rows from relation %s\n", rows, rel->name);
+
+  return rows;
+}
+
+/* Append rows to the tuple file. Returns the tuple ID of the first
+   row, or INVALID_TUPLE on failure. */
+static tuple_id_t
+append_rows(relation_t *rel, unsigned char *data, unsigned rows)
+{
+  cfs_offset_t end;
+  unsigned remaining;
+  unsigned char *ptr;
+  int r;
+#if DB_FEATURE_INTEGRITY
+  int missing_bytes;
+  char buf[rel->row_length];
+#endif
+
+  end = cfs_seek(rel->tuple_storage, 0, CFS_SEEK_END);
+  if(end == (cfs_offset_t)-1) {
+    return INVALID_TUPLE;
+  }
+
+#if DB_FEATURE_INTEGRITY
+  missing_bytes = end % rel->row_length;
+  if(missing_bytes > 0) {
+    memset(buf, 0xff, sizeof(buf));
+    r = cfs_write(rel->tuple_storage, buf, sizeof(buf));
+    if(r != missing_bytes) {
+      return INVALID_TUPLE;
+    }
+    end += missing_bytes;
+  }
+#endif
+
+  xor_rows(rel, data, rows);
+
+  ptr = data;
+  remaining = rows * rel->row_length;
+  do {
+    r = cfs_write(rel->tuple_storage, ptr, remaining);
+    if(r < 0) {
+      PRINTF("DB: Failed to store %u bytes\n", remaining);
+      xor_rows(rel, data, rows);
+      return INVALID_TUPLE;
+    }
+    ptr += r;
+    remaining -= r;
+  } while(remaining > 0);
+
+  PRINTF("DB: Stored %u rows of %d bytes\n", rows, rel->row_length);
+
+  xor_rows(rel, data, rows);
+
+  return (tuple_id_t)(end / rel->row_length);
+}
+
+static db_result_t
+flush_page(struct row_page *page)
+{
+  relation_t *rel;
+  tuple_id_t first;
+  tuple_id_t expected;
+
+  if(page->written == page->rows) {
+    return DB_OK;
+  }
+
+  rel = page->rel;
+  expected = page->first_row + page->written;
+  first = append_rows(rel, page->data + page->written * rel->row_length,
+                      page->rows - page->written);
+  if(first == INVALID_TUPLE) {
+    PRINTF("DB: Lost %u rows of relation %s\n",
+           page->rows - page->written, rel->name);
+    rel->row_count = INVALID_TUPLE;
+    page->rel = NULL;
+    return DB_STORAGE_ERROR;
+  }
+
+  if(first != expected) {
+    /* An incomplete row at the end of the file has been padded. */
+    page->first_row += first - expected;
+    rel->row_count += first - expected;
+  }
+
+  page->written = page->rows;
+  return DB_OK;
+}
+
+static struct row_page *
+find_page(relation_t *rel, tuple_id_t tuple_id)
+{
+  struct row_page *page;
+
+  for(page = pages; page < &pages[DB_STORAGE_PAGE_POOL_SIZE]; page++) {
+    if(page->rel == rel && tuple_id >= page->first_row &&
+       tuple_id - page->first_row < page->rows) {
+      page->last_use = ++page_clock;
+      return page;
+    }
+  }
+
+  return NULL;
+}
+
+static struct row_page *
+find_tail_page(relation_t *rel)
+{
+  struct row_page *page;
+
+  for(page = pages; page < &pages[DB_STORAGE_PAGE_POOL_SIZE]; page++) {
+    if(page->rel == rel && page->first_row + page->rows == rel->row_count) {
+      page->last_use = ++page_clock;
+      return page;
+    }
+  }
+
+  return NULL;
+}
+
+static struct row_page *
+allocate_page(relation_t *rel)
+{
+  struct row_page *page;
+  struct row_page *victim;
+
+  /* Take a free page, or evict the least recently used one. */
+  victim = NULL;
+  for(page = pages; page < &pages[DB_STORAGE_PAGE_POOL_SIZE]; page++) {
+    if(page->rel == NULL) {
+      victim = page;
+      break;
+    }
+    if(victim == NULL ||
+       (uint16_t)(page_clock - page->last_use) >
+       (uint16_t)(page_clock - victim->last_use)) {
+      victim = page;
+    }
+  }
+
+  if(victim->rel != NULL && DB_ERROR(flush_page(victim))) {
+    return NULL;
+  }
+
+  victim->rel = rel;
+  victim->first_row = 0;
+  victim->rows = victim->written = 0;
+  victim->last_use = ++page_clock;
+
+  return victim;
+}
+
+static db_result_t
+release_pages(relation_t *rel, int flush)
+{
+  struct row_page *page;
+  db_result_t result;
+
+  result = DB_OK;
+  for(page = pages; page < &pages[DB_STORAGE_PAGE_POOL_SIZE]; page++) {
+    if(page->rel == rel) {
+      if(flush && DB_ERROR(flush_page(page))) {
+        result = DB_STORAGE_ERROR;
+      }
+      page->rel = NULL;
+    }
+  }
+
+  return result;
+}
+
 char *
 storage_generate_file(char *prefix, unsigned long size)
 {
@@ -103,6 +334,11 @@ storage_generate_file(char *prefix, unsigned long size)
 db_result_t
 storage_load(relation_t *rel)
 {
+  if(RELATION_HAS_TUPLES(rel) && DB_ERROR(release_pages(rel, 1))) {
+    return DB_STORAGE_ERROR;
+  }
+  rel->row_count = INVALID_TUPLE;
+
   PRINTF("DB: Opening the tuple file %s\n", rel->tuple_filename);
   rel->tuple_storage = cfs_open(rel->tuple_filename,
                                 CFS_READ | CFS_WRITE | CFS_APPEND);
@@ -120,8 +356,13 @@ storage_unload(relation_t *rel)
   if(RELATION_HAS_TUPLES(rel)) {
     PRINTF("DB: Unload tuple file %s\n", rel->tuple_filename);
 
+    if(DB_ERROR(release_pages(rel, 1))) {
+      PRINTF("DB: Failed to flush the rows of %s\n", rel->name);
+    }
+
     cfs_close(rel->tuple_storage);
     rel->tuple_storage = -1;
+    rel->row_count = INVALID_TUPLE;
   }
 }
 
@@ -279,8 +520,12 @@ storage_put_attribute(relation_t *rel, attribute_t *attr)
 db_result_t
 storage_drop_relation(relation_t *rel, int remove_tuples)
 {
-  if(remove_tuples && RELATION_HAS_TUPLES(rel)) {
-    cfs_remove(rel->tuple_filename);
+  if(RELATION_HAS_TUPLES(rel)) {
+    release_pages(rel, !remove_tuples);
+    if(remove_tuples) {
+      cfs_remove(rel->tuple_filename);
+      rel->row_count = INVALID_TUPLE;
+    }
   }
   return cfs_remove(rel->name) < 0 ? DB_STORAGE_ERROR : DB_OK;
 }
@@ -294,6 +539,16 @@ storage_rename_relation(char *old_name, char *new_name)
   int new_fd;
   int r;
   char buf[64];
+  struct row_page *page;
+
+  /* Rows buffered for the relation must reach its tuple file before
+     the relation can be loaded under the new name. */
+  for(page = pages; page < &pages[DB_STORAGE_PAGE_POOL_SIZE]; page++) {
+    if(page->rel != NULL && strcmp(page->rel->name, old_name) == 0 &&
+       DB_ERROR(flush_page(page))) {
+      return DB_STORAGE_ERROR;
+    }
+  }
 
   result = DB_STORAGE_ERROR;
   old_fd = new_fd = -1;
@@ -405,6 +660,7 @@ storage_get_row(relation_t *rel, tuple_id_t *tuple_id, storage_row_t row)
 {
   int r;
   tuple_id_t nrows;
+  struct row_page *page;
 
   if(DB_ERROR(storage_get_row_amount(rel, &nrows))) {
     return DB_STORAGE_ERROR;
@@ -414,25 +670,31 @@ storage_get_row(relation_t *rel, tuple_id_t *tuple_id, storage_row_t row)
     return DB_FINISHED;
   }
 
-  if(cfs_seek(rel->tuple_storage, *tuple_id * rel->row_length, CFS_SEEK_SET) ==
-              (cfs_offset_t)-1) {
-    return DB_STORAGE_ERROR;
+  if(!ROW_FITS_IN_PAGE(rel)) {
+    r = read_rows(rel, *tuple_id, row, 1);
+    return r < 0 ? DB_STORAGE_ERROR : r == 0 ? DB_FINISHED : DB_OK;
   }
 
-  r = cfs_read(rel->tuple_storage, row, rel->row_length);
-  if(r < 0) {
-    PRINTF("DB: Reading failed on fd %d\n", rel->tuple_storage);
-    return DB_STORAGE_ERROR;
-  } else if(r == 0) {
-    return DB_FINISHED;
-  } else if(r < rel->row_length) {
-    PRINTF("DB: Incomplete record: %d < %d\n", r, rel->row_length);
-    return DB_STORAGE_ERROR;
-  }
+  page = find_page(rel, *tuple_id);
+  if(page == NULL) {
+    /* Read ahead as many rows as the page can hold. */
+    page = allocate_page(rel);
+    if(page == NULL) {
+      return DB_STORAGE_ERROR;
+    }
 
-  row[rel->row_length - 1] ^= ROW_XOR;
+    r = read_rows(rel, *tuple_id, page->data, PAGE_CAPACITY(rel));
+    if(r <= 0) {
+      page->rel = NULL;
+      return r < 0 ? DB_STORAGE_ERROR : DB_FINISHED;
+    }
+
+    page->first_row = *tuple_id;
+    page->rows = page->written = r;
+  }
 
-  PRINTF("DB: Read %d bytes from relation %s\n", rel->row_length, rel->name);
+  memcpy(row, page->data + (*tuple_id - page->first_row) * rel->row_length,
+         rel->row_length);
 
   return DB_OK;
 }
@@ -440,51 +702,45 @@ storage_get_row(relation_t *rel, tuple_id_t *tuple_id, storage_row_t row)
 db_result_t
 storage_put_row(relation_t *rel, storage_row_t row)
 {
-  cfs_offset_t end;
-  unsigned remaining;
-  int r;
-  unsigned char *last_byte;
-#if DB_FEATURE_INTEGRITY
-  int missing_bytes;
-  char buf[rel->row_length];
-#endif
+  tuple_id_t nrows;
+  tuple_id_t tuple_id;
+  struct row_page *page;
 
-  end = cfs_seek(rel->tuple_storage, 0, CFS_SEEK_END);
-  if(end == (cfs_offset_t)-1) {
+  if(DB_ERROR(storage_get_row_amount(rel, &nrows))) {
     return DB_STORAGE_ERROR;
   }
 
-#if DB_FEATURE_INTEGRITY
-  missing_bytes = end % rel->row_length;
-  if(missing_bytes > 0) {
-    memset(buf, 0xff, sizeof(buf));
-    r = cfs_write(rel->tuple_storage, buf, sizeof(buf));
-    if(r != missing_bytes) {
+  if(!ROW_FITS_IN_PAGE(rel)) {
+    tuple_id = append_rows(rel, row, 1);
+    if(tuple_id == INVALID_TUPLE) {
       return DB_STORAGE_ERROR;
     }
+    rel->row_count = tuple_id + 1;
+    return DB_OK;
   }
-#endif
-
-  /* Ensure that last written byte is separated from 0, to make file
-     lengths correct in Coffee. */
-  last_byte = row + rel->row_length - 1;
-  *last_byte ^= ROW_XOR;
 
-  remaining = rel->row_length;
-  do {
-    r = cfs_write(rel->tuple_storage, row, remaining);
-    if(r < 0) {
-      PRINTF("DB: Failed to store %u bytes\n", remaining);
-      *last_byte ^= ROW_XOR;
+  /* Buffer the row in the page at the end of the relation. The page
+     is written out when it is full, evicted, or the relation is
+     unloaded. */
+  page = find_tail_page(rel);
+  if(page != NULL && page->rows == PAGE_CAPACITY(rel)) {
+    if(DB_ERROR(flush_page(page))) {
       return DB_STORAGE_ERROR;
     }
-    row += r;
-    remaining -= r;
-  } while(remaining > 0);
+    page = NULL;
+  }
 
-  PRINTF("DB: Stored a of %d bytes\n", rel->row_length);
+  if(page == NULL) {
+    page = allocate_page(rel);
+    if(page == NULL) {
+      return DB_STORAGE_ERROR;
+    }
+    page->first_row = rel->row_count;
+  }
 
-  *last_byte ^= ROW_XOR;
+  memcpy(page->data + page->rows * rel->row_length, row, rel->row_length);
+  page->rows++;
+  rel->row_count++;
 
   return DB_OK;
 }
@@ -496,15 +752,19 @@ storage_get_row_amount(relation_t *rel, tuple_id_t *amount)
 
   if(rel->row_length == 0) {
     *amount = 0;
-  } else {
+    return DB_OK;
+  }
+
+  if(rel->row_count == INVALID_TUPLE) {
     offset = cfs_seek(rel->tuple_storage, 0, CFS_SEEK_END);
     if(offset == (cfs_offset_t)-1) {
       return DB_STORAGE_ERROR;
     }
 
-    *amount = (tuple_id_t)(offset / rel->row_length);
+    rel->row_count = (tuple_id_t)(offset / rel->row_length);
   }
 
+  *amount = rel->row_count;
   return DB_OK;
 }
 
@@ -548,8 +808,12 @@ storage_read(db_storage_id_t fd,
   ptr = buffer;
   while(length > 0) {
     r = cfs_read(fd, ptr, length);
-    if(r <= 0) {
+    if(r < 0) {
       return DB_STORAGE_ERROR;
+    } else if(r == 0) {
+      /* File systems that do not extend files on seeks end here. */
+      memset(ptr, 0, length);
+      break;
     }
     ptr += r;
     length -= r;
@@ -39,6 +39,8 @@
 
 #include "contiki.h"
 #include "sys/energest.h"
+#include <stdio.h>
+#include <string.h>
 
 #if ENERGEST_CONF_ON
 
@@ -46,6 +48,18 @@ uint64_t energest_total_time[ENERGEST_TYPE_MAX];
 ENERGEST_TIME_T energest_current_time[ENERGEST_TYPE_MAX];
 unsigned char energest_current_mode[ENERGEST_TYPE_MAX];
 
+#if ENERGEST_TAGS
+uint64_t energest_tag_total_time[ENERGEST_TAG_MAX][ENERGEST_TYPE_MAX];
+unsigned char energest_current_tag[ENERGEST_TYPE_MAX];
+
+static const char *tag_names[] = {
+  "other", "mac", "routing", "nd", "coap", "app",
+#ifdef ENERGEST_CONF_TAG_ADDITIONS_NAMES
+  ENERGEST_CONF_TAG_ADDITIONS_NAMES
+#endif /* ENERGEST_CONF_TAG_ADDITIONS_NAMES */
+};
+#endif /* ENERGEST_TAGS */
+
 /*---------------------------------------------------------------------------*/
 void
 energest_init(void)
@@ -55,6 +69,11 @@ energest_init(void)
     energest_total_time[i] = energest_current_time[i] = 0;
     energest_current_mode[i] = 0;
   }
+#if ENERGEST_TAGS
+  memset(energest_tag_total_time, 0, sizeof(energest_tag_total_time));
+  memset(energest_current_tag, ENERGEST_TAG_OTHER,
+         sizeof(energest_current_tag));
+#endif /* ENERGEST_TAGS */
   ENERGEST_ON(ENERGEST_TYPE_CPU);
 }
 /*---------------------------------------------------------------------------*/
@@ -66,8 +85,7 @@ energest_flush(void)
   for(i = 0; i < ENERGEST_TYPE_MAX; i++) {
     if(energest_current_mode[i]) {
       now = ENERGEST_CURRENT_TIME();
-      energest_total_time[i] +=
-        (ENERGEST_TIME_T)(now - energest_current_time[i]);
+      energest_add(i, (ENERGEST_TIME_T)(now - energest_current_time[i]));
       energest_current_time[i] = now;
     }
   }
@@ -81,6 +99,40 @@ energest_get_total_time(void)
     energest_type_time(ENERGEST_TYPE_DEEP_LPM);
 }
 /*---------------------------------------------------------------------------*/
+#if ENERGEST_TAGS
+energest_tag_t
+energest_tag_set(energest_type_t type, energest_tag_t tag)
+{
+  energest_tag_t previous;
+  ENERGEST_TIME_T now;
+
+  previous = energest_current_tag[type];
+  if(previous != tag) {
+    /* Attribute the time so far to the previous tag. */
+    if(energest_current_mode[type]) {
+      now = ENERGEST_CURRENT_TIME();
+      energest_add(type, (ENERGEST_TIME_T)(now - energest_current_time[type]));
+      energest_current_time[type] = now;
+    }
+    energest_current_tag[type] = tag;
+  }
+  return previous;
+}
+/*---------------------------------------------------------------------------*/
+const char *
+energest_tag_name(energest_tag_t tag)
+{
+  static char number[4];
+
+  if(tag < sizeof(tag_names) / sizeof(tag_names[0])) {
+    return tag_names[tag];
+  }
+  /* An added tag without a name */
+  snprintf(number, sizeof(number), "%u", (uint8_t)tag);
+  return number;
+}
+#endif /* ENERGEST_TAGS */
+/*---------------------------------------------------------------------------*/
 #else /* ENERGEST_CONF_ON */
 
 void
@@ -47,6 +47,18 @@
 #define ENERGEST_CONF_ON 0
 #endif /* ENERGEST_CONF_ON */
 
+/*
+ * Optional attribution of the time of each type to tags, which stand
+ * for the subsystem that caused it. The radio time is attributed to
+ * the tag of the packet being sent, and the CPU time to the tag of
+ * the running process.
+ */
+#if ENERGEST_CONF_ON && defined(ENERGEST_CONF_TAGS)
+#define ENERGEST_TAGS ENERGEST_CONF_TAGS
+#else
+#define ENERGEST_TAGS 0
+#endif /* ENERGEST_CONF_TAGS */
+
 #ifndef ENERGEST_CURRENT_TIME
 #ifdef ENERGEST_CONF_CURRENT_TIME
 #define ENERGEST_CURRENT_TIME ENERGEST_CONF_CURRENT_TIME
@@ -106,6 +118,33 @@ typedef enum energest_type {
   ENERGEST_TYPE_MAX
 } energest_type_t;
 
+/*
+ * The tags to which time is attributed. Time that is not attributed
+ * to any subsystem, such as idle listening, has the tag
+ * ENERGEST_TAG_OTHER.
+ *
+ * #define ENERGEST_CONF_TAG_ADDITIONS TAG_NAME1, TAG_NAME2
+ *
+ * Their names, in the same order, for energest_tag_name(). A tag
+ * without a name is printed as its number.
+ *
+ * #define ENERGEST_CONF_TAG_ADDITIONS_NAMES "name1", "name2"
+ */
+typedef enum energest_tag {
+  ENERGEST_TAG_OTHER,
+  ENERGEST_TAG_MAC,
+  ENERGEST_TAG_ROUTING,
+  ENERGEST_TAG_ND,
+  ENERGEST_TAG_COAP,
+  ENERGEST_TAG_APP,
+
+#ifdef ENERGEST_CONF_TAG_ADDITIONS
+  ENERGEST_CONF_TAG_ADDITIONS,
+#endif /* ENERGEST_CONF_TAG_ADDITIONS */
+
+  ENERGEST_TAG_MAX
+} energest_tag_t;
+
 void energest_init(void);
 void energest_flush(void);
 
@@ -117,6 +156,20 @@ extern uint64_t energest_total_time[ENERGEST_TYPE_MAX];
 extern ENERGEST_TIME_T energest_current_time[ENERGEST_TYPE_MAX];
 extern unsigned char energest_current_mode[ENERGEST_TYPE_MAX];
 
+#if ENERGEST_TAGS
+extern uint64_t energest_tag_total_time[ENERGEST_TAG_MAX][ENERGEST_TYPE_MAX];
+extern unsigned char energest_current_tag[ENERGEST_TYPE_MAX];
+#endif /* ENERGEST_TAGS */
+
+static inline void
+energest_add(energest_type_t type, ENERGEST_TIME_T time)
+{
+  energest_total_time[type] += time;
+#if ENERGEST_TAGS
+  energest_tag_total_time[energest_current_tag[type]][type] += time;
+#endif /* ENERGEST_TAGS */
+}
+
 static inline uint64_t
 energest_type_time(energest_type_t type)
 {
@@ -143,8 +196,8 @@ static inline void
 energest_off(energest_type_t type)
 {
  if(energest_current_mode[type] != 0) {
-   energest_total_time[type] +=
-     (ENERGEST_TIME_T)(ENERGEST_CURRENT_TIME() - energest_current_time[type]);
+   energest_add(type, (ENERGEST_TIME_T)
+                (ENERGEST_CURRENT_TIME() - energest_current_time[type]));
    energest_current_mode[type] = 0;
  }
 }
@@ -155,8 +208,8 @@ energest_switch(energest_type_t type_off, energest_type_t type_on)
 {
   ENERGEST_TIME_T energest_local_variable_now = ENERGEST_CURRENT_TIME();
   if(energest_current_mode[type_off] != 0) {
-    energest_total_time[type_off] += (ENERGEST_TIME_T)
-      (energest_local_variable_now - energest_current_time[type_off]);
+    energest_add(type_off, (ENERGEST_TIME_T)
+                 (energest_local_variable_now - energest_current_time[type_off]));
     energest_current_mode[type_off] = 0;
   }
   if(energest_current_mode[type_on] == 0) {
@@ -166,6 +219,43 @@ energest_switch(energest_type_t type_off, energest_type_t type_on)
 }
 #define ENERGEST_SWITCH(type_off, type_on) energest_switch(type_off, type_on)
 
+#if ENERGEST_TAGS
+
+static inline uint64_t
+energest_tag_time(energest_tag_t tag, energest_type_t type)
+{
+  return energest_tag_total_time[tag][type];
+}
+
+/*
+ * Attribute the time of a type from now on to a tag, and return the
+ * tag to which it was attributed before.
+ */
+energest_tag_t energest_tag_set(energest_type_t type, energest_tag_t tag);
+
+/* Attribute the radio time from now on to a tag */
+static inline void
+energest_tag_radio(energest_tag_t tag)
+{
+  energest_tag_set(ENERGEST_TYPE_TRANSMIT, tag);
+  energest_tag_set(ENERGEST_TYPE_LISTEN, tag);
+}
+
+const char *energest_tag_name(energest_tag_t tag);
+
+#define ENERGEST_TAG_RADIO(tag) energest_tag_radio(tag)
+#define ENERGEST_TAG_PROCESS(p, tag) ((p)->energest_tag = (tag))
+
+#else /* ENERGEST_TAGS */
+
+static inline uint64_t
+energest_tag_time(energest_tag_t tag, energest_type_t type) { return 0; }
+
+#define ENERGEST_TAG_RADIO(tag) do { } while(0)
+#define ENERGEST_TAG_PROCESS(p, tag) do { } while(0)
+
+#endif /* ENERGEST_TAGS */
+
 #else /* ENERGEST_CONF_ON */
 
 static inline uint64_t energest_type_time(energest_type_t type) { return 0; }
@@ -185,6 +275,12 @@ static inline void energest_switch(energest_type_t type_off,
 #define ENERGEST_OFF(type) do { } while(0)
 #define ENERGEST_SWITCH(type_off, type_on) do { } while(0)
 
+static inline uint64_t
+energest_tag_time(energest_tag_t tag, energest_type_t type) { return 0; }
+
+#define ENERGEST_TAG_RADIO(tag) do { } while(0)
+#define ENERGEST_TAG_PROCESS(p, tag) do { } while(0)
+
 #endif /* ENERGEST_CONF_ON */
 
 #endif /* ENERGEST_H_ */
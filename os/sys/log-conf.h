@@ -77,11 +77,24 @@
 
 /* Custom output function -- default is printf */
 #ifdef LOG_CONF_OUTPUT
-#define LOG_OUTPUT(...) LOG_CONF_OUTPUT(__VA_ARGS__)
+#define LOG_OUTPUT_NOW(...) LOG_CONF_OUTPUT(__VA_ARGS__)
 #else /* LOG_CONF_OUTPUT */
-#define LOG_OUTPUT(...) printf(__VA_ARGS__)
+#define LOG_OUTPUT_NOW(...) printf(__VA_ARGS__)
 #endif /* LOG_CONF_OUTPUT */
 
+/* Queue the logs and format them later, see sys/log-deferred.h */
+#ifdef LOG_CONF_DEFERRED
+#define LOG_DEFERRED LOG_CONF_DEFERRED
+#else /* LOG_CONF_DEFERRED */
+#define LOG_DEFERRED 0
+#endif /* LOG_CONF_DEFERRED */
+
+#if LOG_DEFERRED
+#define LOG_OUTPUT(...) log_deferred_output(__VA_ARGS__)
+#else /* LOG_DEFERRED */
+#define LOG_OUTPUT(...) LOG_OUTPUT_NOW(__VA_ARGS__)
+#endif /* LOG_DEFERRED */
+
 /* Color the prefix based on the log level. Disabled by default */
 #ifdef LOG_CONF_WITH_COLOR
 #define LOG_WITH_COLOR LOG_CONF_WITH_COLOR
@@ -0,0 +1,666 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \addtogroup log-deferred
+ * @{ */
+
+/**
+ * \file
+ *         Deferred logging: records are queued at the call site and
+ *         formatted later
+ */
+
+#include "contiki.h"
+#include "sys/log.h"
+#include "sys/critical.h"
+#include "lib/ringbufindex.h"
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <string.h>
+
+#if LOG_DEFERRED
+
+#if (LOG_DEFERRED_QUEUE_LEN & (LOG_DEFERRED_QUEUE_LEN - 1)) != 0 || \
+  LOG_DEFERRED_QUEUE_LEN > 128
+#error LOG_DEFERRED_QUEUE_LEN must be a power of two up to 128
+#endif
+
+/* Some of the arguments did not fit in the record */
+#define FLAG_TRUNCATED           0x20
+/* The tail of the previous line was dropped */
+#define FLAG_AFTER_DROP          0x40
+
+struct log_record {
+  const char *module;
+  const char *fmt;
+  uint8_t level;
+  uint8_t flags;
+  uint8_t len;
+  volatile uint8_t ready;
+  uint8_t args[LOG_DEFERRED_ARGS_LEN];
+};
+
+struct drop_counter {
+  const char *module;
+  unsigned long dropped;
+  unsigned long reported;
+};
+
+/* The types that the arguments are passed as */
+enum arg_type {
+  ARG_NONE,
+  ARG_INT,
+  ARG_LONG,
+  ARG_LLONG,
+  ARG_INTMAX,
+  ARG_SIZE,
+  ARG_PTR,
+  ARG_DOUBLE,
+  ARG_STRING,
+  ARG_UNSUPPORTED
+};
+
+/* A conversion specification of a format string */
+struct conversion {
+  const char *start;
+  const char *end;
+  uint8_t stars;
+  enum arg_type type;
+};
+
+static struct ringbufindex queue = { LOG_DEFERRED_QUEUE_LEN - 1, 0, 0 };
+static struct log_record records[LOG_DEFERRED_QUEUE_LEN];
+
+static struct drop_counter drops[LOG_DEFERRED_MODULES];
+static struct drop_counter other_drops = { "other modules", 0, 0 };
+static const char *line_module;
+static uint8_t dropping;
+static uint8_t line_dropped;
+static uint8_t formatting;
+
+static const char *const level_names[] = { "PRI", "ERR", "WARN", "INFO", "DBG" };
+static const char *const level_colors[] = {
+  LOG_COLOR_PRI, LOG_COLOR_ERR, LOG_COLOR_WARN, LOG_COLOR_INFO, LOG_COLOR_DBG
+};
+
+PROCESS(log_deferred_process, "Deferred log");
+/*---------------------------------------------------------------------------*/
+/* Parses the conversion specification that starts with the '%' at p */
+static const char *
+parse_conversion(const char *p, struct conversion *c)
+{
+  char length = 0;
+
+  c->start = p++;
+  c->stars = 0;
+  p += strspn(p, "-+ #0");
+  if(*p == '*') {
+    c->stars++;
+    p++;
+  }
+  while(isdigit((unsigned char)*p)) {
+    p++;
+  }
+  if(*p == '.') {
+    p++;
+    if(*p == '*') {
+      c->stars++;
+      p++;
+    }
+    while(isdigit((unsigned char)*p)) {
+      p++;
+    }
+  }
+
+  if(*p == 'h' || *p == 'l') {
+    length = *p++;
+    if(*p == length) {
+      length = length == 'l' ? 'q' : 'h';
+      p++;
+    }
+  } else if(strchr("jztL", *p) != NULL && *p != '\0') {
+    length = *p++;
+  }
+
+  switch(*p) {
+  case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+    switch(length) {
+    case 'l': c->type = ARG_LONG; break;
+    case 'q': c->type = ARG_LLONG; break;
+    case 'j': c->type = ARG_INTMAX; break;
+    case 'z': case 't': c->type = ARG_SIZE; break;
+    case 'L': c->type = ARG_UNSUPPORTED; break;
+    default: c->type = ARG_INT; break;
+    }
+    break;
+  case 'c':
+    c->type = ARG_INT;
+    break;
+  case 'p':
+    c->type = ARG_PTR;
+    break;
+  case 's':
+    c->type = ARG_STRING;
+    break;
+  case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+    c->type = length == 'L' ? ARG_UNSUPPORTED : ARG_DOUBLE;
+    break;
+  case '%':
+    c->type = ARG_NONE;
+    break;
+  default:
+    c->type = ARG_UNSUPPORTED;
+    break;
+  }
+  if(*p != '\0') {
+    p++;
+  }
+  c->end = p;
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+static int
+pack(struct log_record *r, const void *value, size_t size)
+{
+  if(r->len + size > LOG_DEFERRED_ARGS_LEN) {
+    r->flags |= FLAG_TRUNCATED;
+    return 0;
+  }
+  memcpy(&r->args[r->len], value, size);
+  r->len += size;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+#define PACK_ARG(r, type, ap) do { \
+    type value = va_arg(ap, type); \
+    if(!pack(r, &value, sizeof(value))) { \
+      return; \
+    } \
+  } while(0)
+
+/* Copies the arguments of a format string to a record */
+static void
+pack_args(struct log_record *r, const char *fmt, va_list ap)
+{
+  struct conversion c;
+  const char *s;
+  size_t len;
+  int i;
+
+  while((fmt = strchr(fmt, '%')) != NULL) {
+    fmt = parse_conversion(fmt, &c);
+    for(i = 0; i < c.stars; i++) {
+      PACK_ARG(r, int, ap);
+    }
+    switch(c.type) {
+    case ARG_NONE: break;
+    case ARG_INT: PACK_ARG(r, int, ap); break;
+    case ARG_LONG: PACK_ARG(r, long, ap); break;
+    case ARG_LLONG: PACK_ARG(r, long long, ap); break;
+    case ARG_INTMAX: PACK_ARG(r, intmax_t, ap); break;
+    case ARG_SIZE: PACK_ARG(r, size_t, ap); break;
+    case ARG_PTR: PACK_ARG(r, void *, ap); break;
+    case ARG_DOUBLE: PACK_ARG(r, double, ap); break;
+    case ARG_STRING:
+      /* The string may not live until the record is printed */
+      s = va_arg(ap, const char *);
+      if(s == NULL) {
+        s = "(null)";
+      }
+      if(r->len + 1 > LOG_DEFERRED_ARGS_LEN) {
+        /* Not even room for the terminating null */
+        r->flags |= FLAG_TRUNCATED;
+        return;
+      }
+      len = strlen(s);
+      if(r->len + len + 1 > LOG_DEFERRED_ARGS_LEN) {
+        r->flags |= FLAG_TRUNCATED;
+        len = LOG_DEFERRED_ARGS_LEN - r->len - 1;
+      }
+      memcpy(&r->args[r->len], s, len);
+      r->args[r->len + len] = '\0';
+      r->len += len + 1;
+      if(r->flags & FLAG_TRUNCATED) {
+        return;
+      }
+      break;
+    default:
+      r->flags |= FLAG_TRUNCATED;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+count_drop(const char *module)
+{
+  struct drop_counter *d;
+  int i;
+
+  d = &other_drops;
+  for(i = 0; i < LOG_DEFERRED_MODULES; i++) {
+    if(drops[i].module == NULL) {
+      drops[i].module = module;
+    }
+    if(drops[i].module == module || strcmp(drops[i].module, module) == 0) {
+      d = &drops[i];
+      break;
+    }
+  }
+  d->dropped++;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Reserves the next free record, or returns NULL if the message is
+ * dropped. A message that continues a line is dropped with the rest of
+ * its line. Records are reserved with interrupts disabled, so that
+ * interrupts may log while the main loop fills a record. The record is
+ * printed once it is committed.
+ */
+static struct log_record *
+prepare(const char *module, uint8_t level, uint8_t flags)
+{
+  int_master_status_t status;
+  struct log_record *r;
+  int index;
+
+  status = critical_enter();
+
+  if(flags & LOG_DEFERRED_NEWLINE) {
+    line_module = module;
+    dropping = 0;
+  } else if(module == NULL) {
+    module = line_module != NULL ? line_module : "(none)";
+  }
+
+  index = dropping ? -1 : ringbufindex_peek_put(&queue);
+  if(index == -1) {
+    if(!dropping && !(flags & LOG_DEFERRED_NEWLINE)) {
+      line_dropped = 1;
+    }
+    dropping = 1;
+    count_drop(module);
+    critical_exit(status);
+    return NULL;
+  }
+  ringbufindex_put(&queue);
+
+  r = &records[index];
+  r->ready = 0;
+  r->module = module;
+  r->level = level;
+  r->flags = flags;
+  if(line_dropped && (flags & LOG_DEFERRED_NEWLINE)) {
+    r->flags |= FLAG_AFTER_DROP;
+    line_dropped = 0;
+  }
+  r->len = 0;
+  critical_exit(status);
+  return r;
+}
+/*---------------------------------------------------------------------------*/
+static void
+commit(struct log_record *r)
+{
+  r->ready = 1;
+  process_poll(&log_deferred_process);
+}
+/*---------------------------------------------------------------------------*/
+static void
+defer_format(const char *module, uint8_t level, uint8_t flags,
+             const char *fmt, va_list ap)
+{
+  struct log_record *r;
+
+  r = prepare(module, level, flags);
+  if(r != NULL) {
+    r->fmt = fmt;
+    pack_args(r, fmt, ap);
+    commit(r);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+log_deferred_format(const char *module, uint8_t level, uint8_t flags,
+                    const char *fmt, ...)
+{
+  va_list ap;
+
+  va_start(ap, fmt);
+  defer_format(module, level, flags, fmt, ap);
+  va_end(ap);
+}
+/*---------------------------------------------------------------------------*/
+void
+log_deferred_output(const char *fmt, ...)
+{
+  char buf[64];
+  va_list ap;
+
+  va_start(ap, fmt);
+  if(formatting) {
+    /* Output of the log functions that print the records */
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    LOG_OUTPUT_NOW("%s", buf);
+  } else {
+    defer_format(NULL, 0, 0, fmt, ap);
+  }
+  va_end(ap);
+}
+/*---------------------------------------------------------------------------*/
+void
+log_deferred_data(const char *module, uint8_t kind,
+                  const void *data, size_t len)
+{
+  struct log_record *r;
+
+  r = prepare(module, 0, kind);
+  if(r != NULL) {
+    r->fmt = NULL;
+    if(data != NULL) {
+      if(len > LOG_DEFERRED_ARGS_LEN) {
+        r->flags |= FLAG_TRUNCATED;
+        len = LOG_DEFERRED_ARGS_LEN;
+      }
+      memcpy(r->args, data, len);
+      r->len = len;
+    }
+    commit(r);
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if LOG_DEFERRED_BINARY
+static void
+print_record(const struct log_record *r)
+{
+  int i;
+
+  LOG_OUTPUT_NOW("#L %lx %lx %u %02x ", (unsigned long)(uintptr_t)r->module,
+                 (unsigned long)(uintptr_t)r->fmt, r->level, r->flags);
+  for(i = 0; i < r->len; i++) {
+    LOG_OUTPUT_NOW("%02x", r->args[i]);
+  }
+  LOG_OUTPUT_NOW("\n");
+}
+#else /* LOG_DEFERRED_BINARY */
+/*---------------------------------------------------------------------------*/
+static int
+unpack(const struct log_record *r, uint8_t *pos, void *value, size_t size)
+{
+  if(*pos + size > r->len) {
+    return 0;
+  }
+  memcpy(value, &r->args[*pos], size);
+  *pos += size;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+#define PRINT_ARG(type) do { \
+    type value; \
+    if(!unpack(r, &pos, &value, sizeof(value))) { \
+      goto truncated; \
+    } \
+    if(c.stars == 0) { \
+      LOG_OUTPUT_NOW(spec, value); \
+    } else if(c.stars == 1) { \
+      LOG_OUTPUT_NOW(spec, stars[0], value); \
+    } else { \
+      LOG_OUTPUT_NOW(spec, stars[0], stars[1], value); \
+    } \
+  } while(0)
+
+/* Formats a format string with the arguments of a record */
+static void
+print_format(const struct log_record *r)
+{
+  struct conversion c;
+  const char *fmt;
+  const char *next;
+  const char *s;
+  char spec[16];
+  int stars[2];
+  uint8_t pos;
+  int i;
+
+  pos = 0;
+  fmt = r->fmt;
+  while((next = strchr(fmt, '%')) != NULL) {
+    if(next > fmt) {
+      LOG_OUTPUT_NOW("%.*s", (int)(next - fmt), fmt);
+    }
+    fmt = parse_conversion(next, &c);
+    if(c.type == ARG_NONE) {
+      LOG_OUTPUT_NOW("%%");
+      continue;
+    }
+    if(c.end - c.start >= (int)sizeof(spec) || c.type == ARG_UNSUPPORTED) {
+      goto truncated;
+    }
+    memcpy(spec, c.start, c.end - c.start);
+    spec[c.end - c.start] = '\0';
+    for(i = 0; i < c.stars; i++) {
+      if(!unpack(r, &pos, &stars[i], sizeof(int))) {
+        goto truncated;
+      }
+    }
+    switch(c.type) {
+    case ARG_INT: PRINT_ARG(int); break;
+    case ARG_LONG: PRINT_ARG(long); break;
+    case ARG_LLONG: PRINT_ARG(long long); break;
+    case ARG_INTMAX: PRINT_ARG(intmax_t); break;
+    case ARG_SIZE: PRINT_ARG(size_t); break;
+    case ARG_PTR: PRINT_ARG(void *); break;
+    case ARG_DOUBLE: PRINT_ARG(double); break;
+    case ARG_STRING:
+      if(pos >= r->len) {
+        goto truncated;
+      }
+      s = (const char *)&r->args[pos];
+      pos += strlen(s) + 1;
+      if(c.stars == 0) {
+        LOG_OUTPUT_NOW(spec, s);
+      } else if(c.stars == 1) {
+        LOG_OUTPUT_NOW(spec, stars[0], s);
+      } else {
+        LOG_OUTPUT_NOW(spec, stars[0], stars[1], s);
+      }
+      if((r->flags & FLAG_TRUNCATED) && pos >= r->len) {
+        goto truncated;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  LOG_OUTPUT_NOW("%s", fmt);
+  return;
+
+truncated:
+  /* The rest of the format string is lost, except for its newline */
+  LOG_OUTPUT_NOW(" ...%s", strchr(r->fmt, '\0')[-1] == '\n' ? "\n" : "");
+}
+/*---------------------------------------------------------------------------*/
+static void
+print_record(const struct log_record *r)
+{
+  const void *data;
+
+  if(r->flags & FLAG_AFTER_DROP) {
+    LOG_OUTPUT_NOW(" ...\n");
+  }
+  if(r->flags & LOG_DEFERRED_NEWLINE) {
+    if(LOG_WITH_COLOR) {
+      LOG_OUTPUT_NOW("%s", level_colors[r->level]);
+    }
+    if(LOG_WITH_MODULE_PREFIX) {
+      LOG_OUTPUT_PREFIX(r->level, level_names[r->level], r->module);
+    }
+    if(LOG_WITH_COLOR) {
+      LOG_OUTPUT_NOW(LOG_COLOR_RESET);
+    }
+  }
+
+  data = r->len > 0 ? r->args : NULL;
+  switch(r->flags & LOG_DEFERRED_KIND_MASK) {
+  case LOG_DEFERRED_FORMAT:
+    print_format(r);
+    return;
+#if NETSTACK_CONF_WITH_IPV6
+  case LOG_DEFERRED_6ADDR:
+    if(LOG_WITH_COMPACT_ADDR) {
+      log_6addr_compact(data);
+    } else if(data != NULL) {
+      log_6addr(data);
+    } else {
+      LOG_OUTPUT_NOW("(NULL IP addr)");
+    }
+    break;
+#endif /* NETSTACK_CONF_WITH_IPV6 */
+  case LOG_DEFERRED_LLADDR:
+    if(LOG_WITH_COMPACT_ADDR) {
+      log_lladdr_compact(data);
+    } else {
+      log_lladdr(data);
+    }
+    break;
+  case LOG_DEFERRED_BYTES:
+    log_bytes(r->args, r->len);
+    break;
+  }
+  if(r->flags & FLAG_TRUNCATED) {
+    LOG_OUTPUT_NOW("...");
+  }
+}
+#endif /* LOG_DEFERRED_BINARY */
+/*---------------------------------------------------------------------------*/
+static void
+report_drops(struct drop_counter *d)
+{
+  if(d->module != NULL && d->dropped != d->reported) {
+    LOG_OUTPUT_NOW("[WARN: LogDefer  ] %lu logs dropped from %s\n",
+                   d->dropped - d->reported, d->module);
+    d->reported = d->dropped;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Prints up to count records, and returns the number of records left */
+static int
+print_records(int count)
+{
+  int_master_status_t status;
+  uint8_t dropped;
+  int index;
+  int i;
+
+  formatting = 1;
+  while(count-- > 0 && (index = ringbufindex_peek_get(&queue)) != -1 &&
+        records[index].ready) {
+    print_record(&records[index]);
+    ringbufindex_get(&queue);
+  }
+  if(ringbufindex_empty(&queue)) {
+    status = critical_enter();
+    dropped = line_dropped;
+    line_dropped = 0;
+    critical_exit(status);
+    if(dropped) {
+      LOG_OUTPUT_NOW(" ...\n");
+    }
+    for(i = 0; i < LOG_DEFERRED_MODULES; i++) {
+      report_drops(&drops[i]);
+    }
+    report_drops(&other_drops);
+  }
+  formatting = 0;
+  return ringbufindex_elements(&queue);
+}
+/*---------------------------------------------------------------------------*/
+void
+log_deferred_flush(void)
+{
+  print_records(LOG_DEFERRED_QUEUE_LEN);
+}
+/*---------------------------------------------------------------------------*/
+unsigned long
+log_deferred_dropped(const char *module)
+{
+  unsigned long dropped;
+  int i;
+
+  dropped = module == NULL ? other_drops.dropped : 0;
+  for(i = 0; i < LOG_DEFERRED_MODULES && drops[i].module != NULL; i++) {
+    if(module == NULL || strcmp(drops[i].module, module) == 0) {
+      dropped += drops[i].dropped;
+    }
+  }
+  return dropped;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(log_deferred_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+#if LOG_DEFERRED_BINARY
+  /* Tells tools/log-decoder how to read the records */
+  LOG_OUTPUT_NOW("#LOG-DEFERRED int %u long %u llong %u intmax %u size %u "
+                 "ptr %u double %u %s anchor %lx\n",
+                 (unsigned)sizeof(int), (unsigned)sizeof(long),
+                 (unsigned)sizeof(long long), (unsigned)sizeof(intmax_t),
+                 (unsigned)sizeof(size_t), (unsigned)sizeof(void *),
+                 (unsigned)sizeof(double),
+                 *(const uint8_t *)&(const uint16_t){ 1 } ? "le" : "be",
+                 (unsigned long)(uintptr_t)&log_deferred_process);
+#endif /* LOG_DEFERRED_BINARY */
+
+  while(1) {
+    /*
+     * Records are only printed when no other event is pending. While
+     * the system is busy, one record is printed per event, so that
+     * logging cannot fall behind forever.
+     */
+    if(print_records(process_nevents() > 0 ? 1 : LOG_DEFERRED_QUEUE_LEN) > 0) {
+      process_poll(&log_deferred_process);
+    }
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+void
+log_deferred_init(void)
+{
+  process_start(&log_deferred_process, NULL);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* LOG_DEFERRED */
+
+/** @} */
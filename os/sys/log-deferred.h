@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \addtogroup log
+ * @{ */
+
+/**
+ * \defgroup log-deferred Deferred logging
+ *
+ * With LOG_CONF_DEFERRED, the LOG_* macros do not format their
+ * message at the call site. Instead, they store the address of the
+ * format string and the raw values of its arguments in a ring buffer.
+ * Strings are copied, as are the addresses and bytes of the
+ * LOG_*_6ADDR, LOG_*_LLADDR and LOG_*_BYTES macros, so that their
+ * buffers can be reused right away.
+ *
+ * The messages are formatted by a process that gives way to all
+ * other events, or, with LOG_CONF_DEFERRED_BINARY, printed as hex
+ * records that tools/log-decoder formats on the host with the
+ * firmware ELF file.
+ *
+ * When the ring buffer is full, messages are dropped and counted per
+ * module. A message that lost its tail is ended with " ..." and the
+ * number of dropped messages of each module is reported with the
+ * next messages.
+ *
+ * Records are reserved with interrupts disabled, so messages may be
+ * logged from interrupts. A message that an interrupt logs while the
+ * main loop is in the middle of a line is printed inside that line.
+ *
+ * Only the address of the format string is stored: it must be a string
+ * literal or otherwise live until the message is printed.
+ * LOG_CONF_WITH_LOC is ignored.
+ *
+ * @{
+ */
+
+/**
+ * \file
+ *         Header file for deferred logging
+ */
+
+#ifndef LOG_DEFERRED_H_
+#define LOG_DEFERRED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* The size of the queue, a power of two up to 128. It holds one record less */
+#ifdef LOG_DEFERRED_CONF_QUEUE_LEN
+#define LOG_DEFERRED_QUEUE_LEN LOG_DEFERRED_CONF_QUEUE_LEN
+#else
+#define LOG_DEFERRED_QUEUE_LEN 32
+#endif
+
+/* The space for the arguments of a record, in bytes */
+#ifdef LOG_DEFERRED_CONF_ARGS_LEN
+#define LOG_DEFERRED_ARGS_LEN LOG_DEFERRED_CONF_ARGS_LEN
+#else
+#define LOG_DEFERRED_ARGS_LEN 24
+#endif
+
+/* The number of modules whose dropped messages are counted apart */
+#ifdef LOG_DEFERRED_CONF_MODULES
+#define LOG_DEFERRED_MODULES LOG_DEFERRED_CONF_MODULES
+#else
+#define LOG_DEFERRED_MODULES 8
+#endif
+
+/* Print hex records for tools/log-decoder instead of formatted text */
+#ifdef LOG_DEFERRED_CONF_BINARY
+#define LOG_DEFERRED_BINARY LOG_DEFERRED_CONF_BINARY
+#else
+#define LOG_DEFERRED_BINARY 0
+#endif
+
+/* The kinds of records */
+#define LOG_DEFERRED_FORMAT      0 /* A format string and its arguments */
+#define LOG_DEFERRED_6ADDR       1 /* An IPv6 address */
+#define LOG_DEFERRED_LLADDR      2 /* A link-layer address */
+#define LOG_DEFERRED_BYTES       3 /* A byte array, printed as hex */
+#define LOG_DEFERRED_KIND_MASK   0x0f
+
+/* The record starts a line, and is printed after the log prefix */
+#define LOG_DEFERRED_NEWLINE     0x10
+
+/**
+ * Starts the process that prints the queued records. Records that
+ * are logged before are kept until then.
+ */
+void log_deferred_init(void);
+
+/**
+ * Queues a message.
+ * \param module The module string descriptor, or NULL
+ * \param level The log level
+ * \param flags LOG_DEFERRED_NEWLINE if the message starts a line
+ * \param fmt The format string, which must be a constant
+ */
+void log_deferred_format(const char *module, uint8_t level, uint8_t flags,
+                         const char *fmt, ...);
+
+/**
+ * Queues a message without log prefix. This replaces LOG_OUTPUT.
+ * \param fmt The format string, which must be a constant
+ */
+void log_deferred_output(const char *fmt, ...);
+
+/**
+ * Queues an address or byte array.
+ * \param module The module string descriptor, or NULL
+ * \param kind LOG_DEFERRED_6ADDR, LOG_DEFERRED_LLADDR or LOG_DEFERRED_BYTES
+ * \param data The data to copy, or NULL for a NULL address
+ * \param len The length of the data
+ */
+void log_deferred_data(const char *module, uint8_t kind,
+                       const void *data, size_t len);
+
+/**
+ * Prints all queued records now.
+ */
+void log_deferred_flush(void);
+
+/**
+ * Returns the number of messages that were dropped because the
+ * queue was full.
+ * \param module The module string descriptor, or NULL for all modules
+ * \return The number of dropped messages
+ */
+unsigned long log_deferred_dropped(const char *module);
+
+#endif /* LOG_DEFERRED_H_ */
+
+/** @} */
+/** @} */
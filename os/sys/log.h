@@ -54,6 +54,7 @@
 #include <stdio.h>
 #include "net/linkaddr.h"
 #include "sys/log-conf.h"
+#include "sys/log-deferred.h"
 #if NETSTACK_CONF_WITH_IPV6
 #include "net/ipv6/uip.h"
 #endif /* NETSTACK_CONF_WITH_IPV6 */
@@ -136,6 +137,19 @@ extern struct log_module all_modules[];
 
 /* Main log function */
 
+#if LOG_DEFERRED
+
+/* The format string is printed later: it must be a string literal */
+#define LOG(newline, level, levelstr, levelcolor, ...) do {  \
+                            if(level <= (LOG_LEVEL)) { \
+                              log_deferred_format(LOG_MODULE, level, \
+                                                  (newline) ? LOG_DEFERRED_NEWLINE : 0, \
+                                                  __VA_ARGS__); \
+                            } \
+                          } while (0)
+
+#else /* LOG_DEFERRED */
+
 #define LOG(newline, level, levelstr, levelcolor, ...) do {  \
                             if(level <= (LOG_LEVEL)) { \
                               if(newline) { \
@@ -156,6 +170,8 @@ extern struct log_module all_modules[];
                             } \
                           } while (0)
 
+#endif /* LOG_DEFERRED */
+
 /* For Cooja annotations */
 #define LOG_ANNOTATE(...) do {  \
                             if(LOG_WITH_ANNOTATE) { \
@@ -163,6 +179,32 @@ extern struct log_module all_modules[];
                             } \
                         } while (0)
 
+#if LOG_DEFERRED
+
+/* Addresses and bytes are copied, and printed later */
+#define LOG_LLADDR(level, lladdr) do {  \
+                            if(level <= (LOG_LEVEL)) { \
+                              log_deferred_data(LOG_MODULE, LOG_DEFERRED_LLADDR, \
+                                                lladdr, LINKADDR_SIZE); \
+                            } \
+                        } while (0)
+
+#define LOG_6ADDR(level, ipaddr) do {  \
+                           if(level <= (LOG_LEVEL)) { \
+                             log_deferred_data(LOG_MODULE, LOG_DEFERRED_6ADDR, \
+                                               ipaddr, sizeof(uip_ipaddr_t)); \
+                           } \
+                         } while (0)
+
+#define LOG_BYTES(level, data, length) do {  \
+                           if(level <= (LOG_LEVEL)) { \
+                             log_deferred_data(LOG_MODULE, LOG_DEFERRED_BYTES, \
+                                               data, length); \
+                           } \
+                         } while (0)
+
+#else /* LOG_DEFERRED */
+
 /* Link-layer address */
 #define LOG_LLADDR(level, lladdr) do {  \
                             if(level <= (LOG_LEVEL)) { \
@@ -191,6 +233,8 @@ extern struct log_module all_modules[];
                            } \
                          } while (0)
 
+#endif /* LOG_DEFERRED */
+
 /* More compact versions of LOG macros */
 #define LOG_PRINT(...)         LOG(1, 0, "PRI", LOG_COLOR_PRI, __VA_ARGS__)
 #define LOG_ERR(...)           LOG(1, LOG_LEVEL_ERR, "ERR", LOG_COLOR_ERR, __VA_ARGS__)
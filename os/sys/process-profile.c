@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup process-profile
+ * @{
+ */
+
+/**
+ * \file
+ *         Implementation of the process profiler
+ */
+
+#include "contiki.h"
+#include "sys/process-profile.h"
+#include <string.h>
+
+#include "sys/log.h"
+#define LOG_MODULE "Profile"
+#define LOG_LEVEL LOG_LEVEL_MAIN
+
+#if PROCESS_PROFILE_ENABLED
+/*---------------------------------------------------------------------------*/
+/* The number of events of each type delivered to processes */
+static uint32_t event_counts[PROCESS_PROFILE_EVENT_TYPES];
+
+/*
+ * The total run time accounted to processes so far. The time that a
+ * call has accounted to nested calls is the difference of this
+ * counter from the start to the end of the call.
+ */
+static uint32_t charged;
+
+#if PROCESS_PROFILE_PERIOD
+PROCESS(process_profile_process, "Process profile");
+#endif /* PROCESS_PROFILE_PERIOD */
+/*---------------------------------------------------------------------------*/
+static uint32_t
+elapsed_since(uint32_t time)
+{
+  /* Wrap around at the width of the time source */
+  return (PROCESS_PROFILE_TIME_T)(process_profile_now() - time);
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+process_profile_now(void)
+{
+  return PROCESS_PROFILE_CURRENT_TIME();
+}
+/*---------------------------------------------------------------------------*/
+void
+process_profile_dispatch(struct process *p, uint32_t queued)
+{
+  uint32_t wait;
+
+  wait = elapsed_since(queued);
+  p->profile.dispatches++;
+  p->profile.wait_time += wait;
+  if(wait > p->profile.max_wait_time) {
+    p->profile.max_wait_time = wait;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+process_profile_begin(struct process_profile_call *call)
+{
+  call->charged = charged;
+  call->start = process_profile_now();
+}
+/*---------------------------------------------------------------------------*/
+void
+process_profile_end(struct process *p, unsigned char ev,
+                    const struct process_profile_call *call)
+{
+  uint32_t run;
+
+  /* Exclude the time of the processes that this process called. */
+  run = elapsed_since(call->start) - (charged - call->charged);
+  charged += run;
+
+  p->profile.calls++;
+  p->profile.run_time += run;
+  if(run > p->profile.max_run_time) {
+    p->profile.max_run_time = run;
+  }
+
+  if(ev >= PROCESS_EVENT_NONE && ev < PROCESS_EVENT_MAX) {
+    event_counts[ev - PROCESS_EVENT_NONE]++;
+  } else {
+    event_counts[PROCESS_PROFILE_EVENT_TYPES - 1]++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+process_profile_event_count(unsigned type)
+{
+  if(type >= PROCESS_PROFILE_EVENT_TYPES) {
+    return 0;
+  }
+  return event_counts[type];
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+process_profile_to_us(uint64_t time)
+{
+  return (uint32_t)(time * 1000000 / PROCESS_PROFILE_SECOND);
+}
+/*---------------------------------------------------------------------------*/
+void
+process_profile_reset(void)
+{
+  struct process *p;
+  uint32_t poll_time;
+
+  for(p = PROCESS_LIST(); p != NULL; p = p->next) {
+    poll_time = p->profile.poll_time;
+    memset(&p->profile, 0, sizeof(p->profile));
+    p->profile.poll_time = poll_time;
+  }
+  memset(event_counts, 0, sizeof(event_counts));
+}
+/*---------------------------------------------------------------------------*/
+void
+process_profile_log(void)
+{
+  static const char *event_names[PROCESS_PROFILE_EVENT_TYPES] = {
+    "none", "init", "poll", "exit", "service removed", "continue",
+    "msg", "exited", "timer", "com", "other"
+  };
+  struct process *p;
+  uint64_t total;
+  unsigned i;
+
+  for(total = 0, p = PROCESS_LIST(); p != NULL; p = p->next) {
+    total += p->profile.run_time;
+  }
+
+  LOG_INFO("--- Process profile (total run time %lu us)\n",
+           (unsigned long)process_profile_to_us(total));
+  LOG_INFO("%-20s %7s %10s %8s %8s %8s\n",
+           "Process", "Calls", "Run us", "Max us", "Wait us", "Max us");
+  for(p = PROCESS_LIST(); p != NULL; p = p->next) {
+    if(p->profile.calls == 0) {
+      continue;
+    }
+    LOG_INFO("%-20.20s %7lu %10lu %8lu %8lu %8lu\n",
+             PROCESS_NAME_STRING(p),
+             (unsigned long)p->profile.calls,
+             (unsigned long)process_profile_to_us(p->profile.run_time),
+             (unsigned long)process_profile_to_us(p->profile.max_run_time),
+             (unsigned long)(p->profile.dispatches == 0 ? 0 :
+                             process_profile_to_us(p->profile.wait_time) /
+                             p->profile.dispatches),
+             (unsigned long)process_profile_to_us(p->profile.max_wait_time));
+  }
+
+  for(i = 0; i < PROCESS_PROFILE_EVENT_TYPES; i++) {
+    if(event_counts[i] > 0) {
+      LOG_INFO("Events %-16s %7lu\n", event_names[i],
+               (unsigned long)event_counts[i]);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if PROCESS_PROFILE_PERIOD
+PROCESS_THREAD(process_profile_process, ev, data)
+{
+  static struct etimer et;
+
+  PROCESS_BEGIN();
+
+  etimer_set(&et, PROCESS_PROFILE_PERIOD);
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+
+    process_profile_log();
+    process_profile_reset();
+  }
+
+  PROCESS_END();
+}
+#endif /* PROCESS_PROFILE_PERIOD */
+/*---------------------------------------------------------------------------*/
+void
+process_profile_init(void)
+{
+#if PROCESS_PROFILE_PERIOD
+  process_start(&process_profile_process, NULL);
+#endif /* PROCESS_PROFILE_PERIOD */
+}
+/*---------------------------------------------------------------------------*/
+#endif /* PROCESS_PROFILE_ENABLED */
+/** @} */
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \addtogroup sys
+ * @{ */
+
+/**
+ * \defgroup process-profile Process profiler
+ *
+ * Optional accounting of the CPU time used by each process. When
+ * enabled, the kernel records for every process how often it was
+ * called, how long it ran, and how long its events and polls waited
+ * in the queue before they were delivered. The time that a process
+ * spends in a process that it calls synchronously is accounted to the
+ * called process only.
+ *
+ * The profile can be printed periodically to the log, and with the
+ * "profile" shell command.
+ *
+ * @{
+ */
+
+/**
+ * \file
+ *         Header file for the process profiler
+ */
+
+#ifndef PROCESS_PROFILE_H_
+#define PROCESS_PROFILE_H_
+
+#include <stdint.h>
+
+/* If this is disabled, the kernel does no accounting */
+#ifdef PROCESS_PROFILE_CONF_ENABLED
+#define PROCESS_PROFILE_ENABLED PROCESS_PROFILE_CONF_ENABLED
+#else
+#define PROCESS_PROFILE_ENABLED 0 /* Disable by default */
+#endif
+
+/* How often to log and reset the profile, or 0 to never do it */
+#ifdef PROCESS_PROFILE_CONF_PERIOD
+#define PROCESS_PROFILE_PERIOD PROCESS_PROFILE_CONF_PERIOD
+#else
+#define PROCESS_PROFILE_PERIOD (60 * CLOCK_SECOND)
+#endif
+
+/* The time source of the profiler, and the width of its time values */
+#ifdef PROCESS_PROFILE_CONF_CURRENT_TIME
+#define PROCESS_PROFILE_CURRENT_TIME PROCESS_PROFILE_CONF_CURRENT_TIME
+#define PROCESS_PROFILE_SECOND PROCESS_PROFILE_CONF_SECOND
+#else
+#define PROCESS_PROFILE_CURRENT_TIME RTIMER_NOW
+#define PROCESS_PROFILE_SECOND RTIMER_SECOND
+#endif
+
+#ifdef PROCESS_PROFILE_CONF_TIME_T
+#define PROCESS_PROFILE_TIME_T PROCESS_PROFILE_CONF_TIME_T
+#else
+#define PROCESS_PROFILE_TIME_T rtimer_clock_t
+#endif
+
+/**
+ * Event types counted separately: the kernel events from
+ * PROCESS_EVENT_NONE up to PROCESS_EVENT_MAX, followed by all other
+ * events.
+ */
+#define PROCESS_PROFILE_EVENT_TYPES (0x8a - 0x80 + 1)
+
+struct process;
+
+/**
+ * \brief The profile of a process. Times are in units of
+ *        PROCESS_PROFILE_SECOND.
+ */
+struct process_profile {
+  /** The number of times the process was called */
+  uint32_t calls;
+  /** The number of queued events and polls delivered to the process */
+  uint32_t dispatches;
+  /** The total time that the process ran */
+  uint64_t run_time;
+  /** The total time that events and polls waited for the process */
+  uint64_t wait_time;
+  uint32_t max_run_time;
+  uint32_t max_wait_time;
+  /** When the pending poll of the process was requested */
+  uint32_t poll_time;
+};
+
+/**
+ * \brief      Start the periodic logging of the profile
+ *
+ *             This function is called by the system during boot-up.
+ */
+void process_profile_init(void);
+
+/**
+ * \brief      Get the current time of the profiler
+ */
+uint32_t process_profile_now(void);
+
+/**
+ * \brief      Account for the time that a queued event or poll
+ *             waited before it is delivered to a process
+ * \param p    The process to which the event is delivered
+ * \param queued The time at which the event was queued
+ */
+void process_profile_dispatch(struct process *p, uint32_t queued);
+
+/** \brief The state of a call of a process that is being accounted for */
+struct process_profile_call {
+  uint32_t start;
+  uint32_t charged;
+};
+
+/**
+ * \brief      Start accounting for a call of a process
+ * \param call The state of the call, for process_profile_end()
+ *
+ *             Calls may be nested, when a process calls another
+ *             process synchronously.
+ */
+void process_profile_begin(struct process_profile_call *call);
+
+/**
+ * \brief      Account for the time that a process has run
+ * \param p    The process that was called
+ * \param ev   The event that the process handled
+ * \param call The state of the call set by process_profile_begin()
+ */
+void process_profile_end(struct process *p, unsigned char ev,
+                         const struct process_profile_call *call);
+
+/**
+ * \brief      Get the number of events of a type delivered to processes
+ * \param type An index lower than PROCESS_PROFILE_EVENT_TYPES
+ */
+uint32_t process_profile_event_count(unsigned type);
+
+/**
+ * \brief      Convert a time of the profiler to microseconds
+ */
+uint32_t process_profile_to_us(uint64_t time);
+
+/**
+ * \brief      Clear the profile of all processes
+ */
+void process_profile_reset(void);
+
+/**
+ * \brief      Print the profile of all processes to the log
+ */
+void process_profile_log(void);
+
+#endif /* PROCESS_PROFILE_H_ */
+/** @} */
+/** @} */
@@ -47,6 +47,7 @@
 
 #include "contiki.h"
 #include "sys/process.h"
+#include "sys/energest.h"
 
 /*
  * Pointer to the currently running process structure.
@@ -63,6 +64,9 @@ struct event_data {
   process_event_t ev;
   process_data_t data;
   struct process *p;
+#if PROCESS_PROFILE_ENABLED
+  uint32_t queued;
+#endif /* PROCESS_PROFILE_ENABLED */
 };
 
 static process_num_events_t nevents, fevent;
@@ -175,6 +179,12 @@ static void
 call_process(struct process *p, process_event_t ev, process_data_t data)
 {
   int ret;
+#if PROCESS_PROFILE_ENABLED
+  struct process_profile_call call;
+#endif /* PROCESS_PROFILE_ENABLED */
+#if ENERGEST_TAGS
+  energest_tag_t caller_tag;
+#endif /* ENERGEST_TAGS */
 
 #if DEBUG
   if(p->state == PROCESS_STATE_CALLED) {
@@ -187,7 +197,23 @@ call_process(struct process *p, process_event_t ev, process_data_t data)
     PRINTF("process: calling process '%s' with event %d\n", PROCESS_NAME_STRING(p), ev);
     process_current = p;
     p->state = PROCESS_STATE_CALLED;
+#if ENERGEST_TAGS
+    /* Processes without a tag work on behalf of their caller. */
+    caller_tag = energest_current_tag[ENERGEST_TYPE_CPU];
+    if(p->energest_tag != ENERGEST_TAG_OTHER) {
+      energest_tag_set(ENERGEST_TYPE_CPU, p->energest_tag);
+    }
+#endif /* ENERGEST_TAGS */
+#if PROCESS_PROFILE_ENABLED
+    process_profile_begin(&call);
+#endif /* PROCESS_PROFILE_ENABLED */
     ret = p->thread(&p->pt, ev, data);
+#if PROCESS_PROFILE_ENABLED
+    process_profile_end(p, ev, &call);
+#endif /* PROCESS_PROFILE_ENABLED */
+#if ENERGEST_TAGS
+    energest_tag_set(ENERGEST_TYPE_CPU, caller_tag);
+#endif /* ENERGEST_TAGS */
     if(ret == PT_EXITED ||
        ret == PT_ENDED ||
        ev == PROCESS_EVENT_EXIT) {
@@ -232,6 +258,9 @@ do_poll(void)
     if(p->needspoll) {
       p->state = PROCESS_STATE_RUNNING;
       p->needspoll = 0;
+#if PROCESS_PROFILE_ENABLED
+      process_profile_dispatch(p, p->profile.poll_time);
+#endif /* PROCESS_PROFILE_ENABLED */
       call_process(p, PROCESS_EVENT_POLL, NULL);
     }
   }
@@ -249,6 +278,9 @@ do_event(void)
   process_data_t data;
   struct process *receiver;
   struct process *p;
+#if PROCESS_PROFILE_ENABLED
+  uint32_t queued;
+#endif /* PROCESS_PROFILE_ENABLED */
 
   /*
    * If there are any events in the queue, take the first one and walk
@@ -265,6 +297,9 @@ do_event(void)
 
     data = events[fevent].data;
     receiver = events[fevent].p;
+#if PROCESS_PROFILE_ENABLED
+    queued = events[fevent].queued;
+#endif /* PROCESS_PROFILE_ENABLED */
 
     /* Since we have seen the new event, we move pointer upwards
        and decrease the number of events. */
@@ -281,6 +316,9 @@ do_event(void)
         if(poll_requested) {
           do_poll();
         }
+#if PROCESS_PROFILE_ENABLED
+        process_profile_dispatch(p, queued);
+#endif /* PROCESS_PROFILE_ENABLED */
         call_process(p, ev, data);
       }
     } else {
@@ -292,6 +330,10 @@ do_event(void)
         receiver->state = PROCESS_STATE_RUNNING;
       }
 
+#if PROCESS_PROFILE_ENABLED
+      process_profile_dispatch(receiver, queued);
+#endif /* PROCESS_PROFILE_ENABLED */
+
       /* Make sure that the process actually is running. */
       call_process(receiver, ev, data);
     }
@@ -347,6 +389,9 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
   events[snum].ev = ev;
   events[snum].data = data;
   events[snum].p = p;
+#if PROCESS_PROFILE_ENABLED
+  events[snum].queued = process_profile_now();
+#endif /* PROCESS_PROFILE_ENABLED */
   ++nevents;
 
 #if PROCESS_CONF_STATS
@@ -373,6 +418,11 @@ process_poll(struct process *p)
   if(p != NULL) {
     if(p->state == PROCESS_STATE_RUNNING ||
        p->state == PROCESS_STATE_CALLED) {
+#if PROCESS_PROFILE_ENABLED
+      if(!p->needspoll) {
+        p->profile.poll_time = process_profile_now();
+      }
+#endif /* PROCESS_PROFILE_ENABLED */
       p->needspoll = 1;
       poll_requested = 1;
     }
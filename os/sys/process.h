@@ -55,6 +55,7 @@
 
 #include "sys/pt.h"
 #include "sys/cc.h"
+#include "sys/process-profile.h"
 
 typedef unsigned char process_event_t;
 typedef void *        process_data_t;
@@ -323,6 +324,13 @@ struct process {
   PT_THREAD((* thread)(struct pt *, process_event_t, process_data_t));
   struct pt pt;
   unsigned char state, needspoll;
+#if PROCESS_PROFILE_ENABLED
+  struct process_profile profile;
+#endif /* PROCESS_PROFILE_ENABLED */
+#if ENERGEST_CONF_ON && ENERGEST_CONF_TAGS
+  /* The energest tag of the CPU time of the process, see ENERGEST_TAGS */
+  unsigned char energest_tag;
+#endif /* ENERGEST_CONF_ON && ENERGEST_CONF_TAGS */
 };
 
 /**
@@ -0,0 +1,324 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Checks for the CoAP observe notification path and a measurement of
+ *   the notification cost as a function of the number of observers.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "coap-engine.h"
+#include "coap-observe.h"
+#include "unit-test.h"
+#include "capture-driver.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define RESOURCE_PATH   "test/obs"
+#define BENCH_NOTIFIES  2000
+
+static unsigned handler_calls;
+static unsigned packets;
+static uint8_t last_packet[UIP_BUFSIZE];
+static uint16_t last_len;
+/*---------------------------------------------------------------------------*/
+/* Records the UDP payload of every outgoing packet */
+static void
+capture_packet(void)
+{
+  /* Other traffic, such as RPL DIS messages, is ignored */
+  if(UIP_IP_BUF->proto != UIP_PROTO_UDP || uip_len < UIP_IPUDPH_LEN) {
+    return;
+  }
+  packets++;
+  last_len = uip_len - UIP_IPUDPH_LEN;
+  memcpy(last_packet, uip_buf + UIP_IPUDPH_LEN, last_len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+res_get_handler(coap_message_t *request, coap_message_t *response,
+                uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  handler_calls++;
+  coap_set_header_content_format(response, TEXT_PLAIN);
+  coap_set_header_max_age(response, 30);
+  coap_set_payload(response, buffer,
+                   snprintf((char *)buffer, preferred_size,
+                            "value %u", handler_calls));
+}
+RESOURCE(res_obs, "title=\"Observable\";obs", res_get_handler,
+         NULL, NULL, NULL);
+RESOURCE(res_a, "title=\"A\";obs", res_get_handler, NULL, NULL, NULL);
+RESOURCE(res_b, "title=\"B\";obs", res_get_handler, NULL, NULL, NULL);
+RESOURCE(res_c, "title=\"C\";obs", res_get_handler, NULL, NULL, NULL);
+/*---------------------------------------------------------------------------*/
+static coap_endpoint_t endpoints[COAP_MAX_OBSERVERS];
+static coap_message_t parsed[1];
+
+static void
+add_observer(coap_resource_t *resource, int i)
+{
+  coap_message_t request[1];
+  coap_message_t response[1];
+  uint8_t token[2];
+
+  uip_ip6addr(&endpoints[i].ipaddr, 0xff02, 0, 0, 0, 0, 0, 0, 1);
+  endpoints[i].port = UIP_HTONS(5000 + i);
+
+  token[0] = 0xA0;
+  token[1] = i;
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_set_header_uri_path(request, resource->url);
+  coap_set_header_observe(request, 0);
+  coap_set_token(request, token, sizeof(token));
+  coap_set_src_endpoint(request, &endpoints[i]);
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, 0);
+  coap_observe_handler(resource, request, response);
+}
+static void
+add_observers(int count)
+{
+  int i;
+
+  coap_remove_observer_by_uri(NULL, RESOURCE_PATH);
+  for(i = 0; i < count; i++) {
+    add_observer(&res_obs, i);
+  }
+}
+static int
+parse_last(void)
+{
+  return coap_parse_message(parsed, last_packet, last_len) == NO_ERROR;
+}
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(observe_render_once, "Render once, send to all");
+UNIT_TEST(observe_render_once)
+{
+  UNIT_TEST_BEGIN();
+
+  add_observers(4);
+  handler_calls = 0;
+  packets = 0;
+
+  /* Observe sequence 1: non-confirmable */
+  coap_notify_observers(&res_obs);
+  UNIT_TEST_ASSERT(handler_calls == 1);
+  UNIT_TEST_ASSERT(packets == 4);
+
+  /* The last packet went to the last observer */
+  UNIT_TEST_ASSERT(parse_last());
+  UNIT_TEST_ASSERT(parsed->type == COAP_TYPE_NON);
+  UNIT_TEST_ASSERT(parsed->code == CONTENT_2_05);
+  UNIT_TEST_ASSERT(parsed->token_len == 2);
+  UNIT_TEST_ASSERT(parsed->token[0] == 0xA0 && parsed->token[1] == 3);
+  UNIT_TEST_ASSERT(coap_is_option(parsed, COAP_OPTION_OBSERVE));
+  UNIT_TEST_ASSERT(parsed->observe == 1);
+  UNIT_TEST_ASSERT(parsed->content_format == TEXT_PLAIN);
+  UNIT_TEST_ASSERT(parsed->max_age == 30);
+  UNIT_TEST_ASSERT(parsed->payload_len == 7);
+  UNIT_TEST_ASSERT(memcmp(parsed->payload, "value 1", 7) == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(observe_confirmable, "Shared confirmable notifications");
+UNIT_TEST(observe_confirmable)
+{
+  uint16_t mid;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  add_observers(1);
+
+  /* Observe sequence 1 is non-confirmable, 2 is confirmable */
+  coap_notify_observers(&res_obs);
+  coap_notify_observers(&res_obs);
+  UNIT_TEST_ASSERT(parse_last());
+  UNIT_TEST_ASSERT(parsed->type == COAP_TYPE_CON);
+  UNIT_TEST_ASSERT(parsed->observe == 2);
+  mid = parsed->mid;
+
+  /* Only the matching MID from the matching endpoint acknowledges */
+  UNIT_TEST_ASSERT(!coap_observe_ack(&endpoints[1], mid));
+  UNIT_TEST_ASSERT(!coap_observe_ack(&endpoints[0], mid + 1));
+  UNIT_TEST_ASSERT(coap_observe_ack(&endpoints[0], mid));
+  UNIT_TEST_ASSERT(!coap_observe_ack(&endpoints[0], mid));
+
+  /* Sequence 5 would be non-confirmable, but while a confirmable one is
+     outstanding it replaces it and stays confirmable */
+  coap_notify_observers(&res_obs);
+  UNIT_TEST_ASSERT(parse_last() && parsed->type == COAP_TYPE_NON);
+  coap_notify_observers(&res_obs);
+  UNIT_TEST_ASSERT(parse_last() && parsed->type == COAP_TYPE_CON);
+  mid = parsed->mid;
+  coap_notify_observers(&res_obs);
+  UNIT_TEST_ASSERT(parse_last() && parsed->type == COAP_TYPE_CON);
+  UNIT_TEST_ASSERT(parsed->observe == 5);
+  UNIT_TEST_ASSERT(!coap_observe_ack(&endpoints[0], mid));
+  UNIT_TEST_ASSERT(coap_observe_ack(&endpoints[0], parsed->mid));
+
+  /* Replaced notifications are released: no buffer may leak */
+  add_observers(8);
+  packets = 0;
+  for(i = 0; i < 100; i++) {
+    coap_notify_observers(&res_obs);
+  }
+  UNIT_TEST_ASSERT(packets == 800);
+
+  /* The sequence number advances once per notification */
+  UNIT_TEST_ASSERT(parse_last());
+  UNIT_TEST_ASSERT(parsed->observe == 100);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(observe_pool_full, "Pending CONs do not hold back NONs");
+UNIT_TEST(observe_pool_full)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  coap_remove_observer_by_uri(NULL, RESOURCE_PATH);
+  add_observer(&res_a, 0);
+  add_observer(&res_b, 1);
+  add_observer(&res_c, 2);
+
+  /* The second notifications of A and B are confirmable and stay
+     unacknowledged, which takes up every buffer of the pool */
+  UNIT_TEST_ASSERT(COAP_MAX_SHARED_NOTIFICATIONS == 2);
+  for(i = 0; i < 2; i++) {
+    coap_notify_observers(&res_a);
+    coap_notify_observers(&res_b);
+  }
+  UNIT_TEST_ASSERT(parse_last() && parsed->type == COAP_TYPE_CON);
+
+  /* The observer of C still gets its non-confirmable notification */
+  packets = 0;
+  coap_notify_observers(&res_c);
+  UNIT_TEST_ASSERT(packets == 1);
+  UNIT_TEST_ASSERT(parse_last());
+  UNIT_TEST_ASSERT(parsed->type == COAP_TYPE_NON);
+  UNIT_TEST_ASSERT(parsed->token[1] == 2);
+  UNIT_TEST_ASSERT(parsed->observe == 1);
+
+  /* Its next one is confirmable and finds no buffer: only it is lost */
+  packets = 0;
+  coap_notify_observers(&res_c);
+  UNIT_TEST_ASSERT(packets == 0);
+
+  /* Once the observer of A is gone, C gets its confirmable notification */
+  coap_remove_observer_by_uri(NULL, "test/a");
+  coap_notify_observers(&res_c);
+  UNIT_TEST_ASSERT(packets == 1);
+  UNIT_TEST_ASSERT(parse_last() && parsed->type == COAP_TYPE_CON);
+
+  coap_remove_observer_by_uri(NULL, "test/b");
+  coap_remove_observer_by_uri(NULL, "test/c");
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(observe_benchmark, "Notification cost");
+UNIT_TEST(observe_benchmark)
+{
+  static const int counts[] = { 1, 2, 4, 8, 16, 32 };
+  uint64_t start, elapsed;
+  int i, j;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+    add_observers(counts[i]);
+    handler_calls = 0;
+    packets = 0;
+
+    start = now_ns();
+    for(j = 0; j < BENCH_NOTIFIES; j++) {
+      coap_notify_observers(&res_obs);
+    }
+    elapsed = now_ns() - start;
+
+    printf("observers %2d: %6lu ns/notify, %4lu ns/observer, "
+           "%u handler calls, %u packets\n",
+           counts[i],
+           (unsigned long)(elapsed / BENCH_NOTIFIES),
+           (unsigned long)(elapsed / BENCH_NOTIFIES / counts[i]),
+           handler_calls, packets);
+
+    UNIT_TEST_ASSERT(handler_calls == BENCH_NOTIFIES);
+    UNIT_TEST_ASSERT(packets == BENCH_NOTIFIES * counts[i]);
+  }
+
+  coap_remove_observer_by_uri(NULL, RESOURCE_PATH);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  capture_set_callback(capture_packet);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  coap_engine_init();
+  coap_activate_resource(&res_obs, RESOURCE_PATH);
+  coap_activate_resource(&res_a, "test/a");
+  coap_activate_resource(&res_b, "test/b");
+  coap_activate_resource(&res_c, "test/c");
+
+  UNIT_TEST_RUN(observe_render_once);
+  UNIT_TEST_RUN(observe_confirmable);
+  UNIT_TEST_RUN(observe_pool_full);
+  UNIT_TEST_RUN(observe_benchmark);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Throughput of the MQTT client outbound queue against an in-node broker
+ *   stand-in, with a single request in flight and with a full window.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/tcp-socket.h"
+#include "mqtt.h"
+#include "unit-test.h"
+#include "capture-driver.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define BROKER_ADDR    "fd00::1"
+#define BROKER_PORT    1883
+#define TOPIC          "test/queue"
+#define BENCH_MESSAGES 500
+#define RUN_TIMEOUT    (10 * CLOCK_SECOND)
+/*---------------------------------------------------------------------------*/
+/* Nothing leaves the node: client and broker use the node's own address */
+static unsigned link_packets;
+
+static void
+count_packet(void)
+{
+  link_packets++;
+}
+/*---------------------------------------------------------------------------*/
+struct run_stats {
+  unsigned window;
+  unsigned segments;
+  unsigned publishes;
+  unsigned max_per_segment;
+  unsigned pubacks;
+  unsigned max_inflight;
+  uint8_t in_order;
+  uint8_t completed;
+  uint64_t elapsed_ns;
+};
+
+static struct run_stats runs[2];
+static struct run_stats *run;
+/*---------------------------------------------------------------------------*/
+/*
+ * Broker stand-in: answers CONNECT, QoS 1 PUBLISH, SUBSCRIBE and PINGREQ.
+ * All acknowledgements for one segment are sent back in one segment.
+ */
+static struct tcp_socket broker_socket;
+static uint8_t broker_in[MQTT_TCP_OUTPUT_BUFF_SIZE];
+static uint8_t broker_out[MQTT_TCP_INPUT_BUFF_SIZE];
+static uint8_t broker_rx[2 * MQTT_TCP_OUTPUT_BUFF_SIZE];
+static int broker_rx_len;
+static uint16_t broker_next_mid;
+
+static int
+broker_input(struct tcp_socket *s, void *ptr,
+             const uint8_t *input_data_ptr, int input_data_len)
+{
+  uint8_t reply[MQTT_TCP_INPUT_BUFF_SIZE];
+  int reply_len = 0;
+  unsigned per_segment = 0;
+  uint32_t remaining;
+  int pos, len_bytes, total;
+  uint16_t topic_len, mid;
+
+  if(input_data_len > sizeof(broker_rx) - broker_rx_len) {
+    return input_data_len;
+  }
+  memcpy(&broker_rx[broker_rx_len], input_data_ptr, input_data_len);
+  broker_rx_len += input_data_len;
+  if(run != NULL) {
+    run->segments++;
+  }
+
+  for(;;) {
+    /* Fixed header and Remaining Length */
+    remaining = 0;
+    len_bytes = 0;
+    do {
+      if(1 + len_bytes >= broker_rx_len) {
+        goto done;
+      }
+      remaining |= (broker_rx[1 + len_bytes] & 0x7F) << (7 * len_bytes);
+    } while(broker_rx[1 + len_bytes++] & 0x80);
+    pos = 1 + len_bytes;
+    total = pos + remaining;
+    if(total > broker_rx_len || reply_len + 4 > sizeof(reply)) {
+      break;
+    }
+
+    switch(broker_rx[0] & 0xF0) {
+    case MQTT_FHDR_MSG_TYPE_CONNECT:
+      reply[reply_len++] = MQTT_FHDR_MSG_TYPE_CONNACK;
+      reply[reply_len++] = 2;
+      reply[reply_len++] = 0;
+      reply[reply_len++] = 0;
+      break;
+    case MQTT_FHDR_MSG_TYPE_PUBLISH:
+      topic_len = (broker_rx[pos] << 8) | broker_rx[pos + 1];
+      mid = (broker_rx[pos + 2 + topic_len] << 8) |
+        broker_rx[pos + 3 + topic_len];
+      if(run != NULL) {
+        run->publishes++;
+        if(mid != broker_next_mid) {
+          run->in_order = 0;
+        }
+      }
+      /* The client steps MIDs by two */
+      broker_next_mid = mid + 2;
+      per_segment++;
+      if((broker_rx[0] >> 1) & 0x03) {
+        reply[reply_len++] = MQTT_FHDR_MSG_TYPE_PUBACK;
+        reply[reply_len++] = 2;
+        reply[reply_len++] = mid >> 8;
+        reply[reply_len++] = mid & 0xFF;
+      }
+      break;
+    case MQTT_FHDR_MSG_TYPE_SUBSCRIBE:
+      reply[reply_len++] = MQTT_FHDR_MSG_TYPE_SUBACK;
+      reply[reply_len++] = 3;
+      reply[reply_len++] = broker_rx[pos];
+      reply[reply_len++] = broker_rx[pos + 1];
+      reply[reply_len++] = 0;
+      break;
+    case MQTT_FHDR_MSG_TYPE_PINGREQ:
+      reply[reply_len++] = MQTT_FHDR_MSG_TYPE_PINGRESP;
+      reply[reply_len++] = 0;
+      break;
+    }
+
+    memmove(broker_rx, &broker_rx[total], broker_rx_len - total);
+    broker_rx_len -= total;
+  }
+
+done:
+  if(run != NULL && per_segment > run->max_per_segment) {
+    run->max_per_segment = per_segment;
+  }
+  if(reply_len > 0) {
+    tcp_socket_send(s, reply, reply_len);
+  }
+  return 0;
+}
+static void
+broker_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
+{
+  if(event == TCP_SOCKET_CLOSED || event == TCP_SOCKET_ABORTED) {
+    broker_rx_len = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct mqtt_connection conn;
+static uint8_t payload[32];
+
+static void
+mqtt_event(struct mqtt_connection *m, mqtt_event_t event, void *data)
+{
+  if(event == MQTT_EVENT_PUBACK && run != NULL) {
+    run->pubacks++;
+  }
+  process_poll(&test_process);
+}
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(queue_window, "In-flight window limits");
+UNIT_TEST(queue_window)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < 2; i++) {
+    UNIT_TEST_ASSERT(runs[i].completed);
+    UNIT_TEST_ASSERT(runs[i].publishes == BENCH_MESSAGES);
+    UNIT_TEST_ASSERT(runs[i].pubacks == BENCH_MESSAGES);
+    UNIT_TEST_ASSERT(runs[i].in_order);
+    UNIT_TEST_ASSERT(runs[i].max_inflight <= runs[i].window);
+    UNIT_TEST_ASSERT(runs[i].max_per_segment <= runs[i].window);
+  }
+  UNIT_TEST_ASSERT(link_packets == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(queue_coalescing, "Several requests per TCP segment");
+UNIT_TEST(queue_coalescing)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < 2; i++) {
+    printf("window %u: %u messages, %lu us, %lu msgs/s, "
+           "%u segments, up to %u messages per segment\n",
+           runs[i].window, runs[i].publishes,
+           (unsigned long)(runs[i].elapsed_ns / 1000),
+           (unsigned long)(runs[i].publishes * 1000000000ULL /
+                           (runs[i].elapsed_ns ? runs[i].elapsed_ns : 1)),
+           runs[i].segments, runs[i].max_per_segment);
+  }
+
+  /* One request at a time costs a segment per message */
+  UNIT_TEST_ASSERT(runs[0].segments >= BENCH_MESSAGES);
+  UNIT_TEST_ASSERT(runs[0].max_per_segment == 1);
+
+  /* A full window packs several messages, and their PUBACKs, together */
+  UNIT_TEST_ASSERT(runs[1].max_per_segment > 1);
+  UNIT_TEST_ASSERT(runs[1].segments < runs[0].segments / 2);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static unsigned sent;
+  static int i;
+  uip_ipaddr_t addr;
+  uint16_t mid;
+
+  PROCESS_BEGIN();
+
+  capture_set_callback(count_packet);
+
+  uiplib_ip6addrconv(BROKER_ADDR, &addr);
+  uip_ds6_addr_add(&addr, 0, ADDR_MANUAL);
+
+  tcp_socket_register(&broker_socket, NULL,
+                      broker_in, sizeof(broker_in),
+                      broker_out, sizeof(broker_out),
+                      broker_input, broker_event);
+  tcp_socket_listen(&broker_socket, BROKER_PORT);
+
+  mqtt_register(&conn, &test_process, "queue-test", mqtt_event,
+                MQTT_TCP_OUTPUT_BUFF_SIZE);
+  mqtt_connect(&conn, BROKER_ADDR, BROKER_PORT, 60 * 60, 1);
+
+  etimer_set(&et, RUN_TIMEOUT);
+  PROCESS_WAIT_UNTIL(mqtt_connected(&conn) || etimer_expired(&et));
+
+  memset(payload, 'x', sizeof(payload));
+
+  for(i = 0; i < 2 && mqtt_connected(&conn); i++) {
+    run = &runs[i];
+    run->window = i == 0 ? 1 : MQTT_MAX_INFLIGHT;
+    run->in_order = 1;
+    conn.inflight_max = run->window;
+    broker_next_mid = conn.mid_counter + 2;
+
+    sent = 0;
+    etimer_set(&et, RUN_TIMEOUT);
+    run->elapsed_ns = now_ns();
+    while(run->pubacks < BENCH_MESSAGES && !etimer_expired(&et)) {
+      while(sent < BENCH_MESSAGES &&
+            mqtt_publish(&conn, &mid, TOPIC, payload, sizeof(payload),
+                         MQTT_QOS_LEVEL_1, MQTT_RETAIN_OFF) == MQTT_STATUS_OK) {
+        sent++;
+      }
+      if(conn.inflight > run->max_inflight) {
+        run->max_inflight = conn.inflight;
+      }
+      PROCESS_WAIT_EVENT();
+    }
+    run->elapsed_ns = now_ns() - run->elapsed_ns;
+    run->completed = run->pubacks == BENCH_MESSAGES;
+  }
+  run = NULL;
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(queue_window);
+  UNIT_TEST_RUN(queue_coalescing);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
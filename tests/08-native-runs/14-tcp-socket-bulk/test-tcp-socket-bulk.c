@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Bulk transfer through tcp-socket with copied, referenced and mixed
+ *   output data, counting the bytes copied into the output buffer per
+ *   byte sent.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uiplib.h"
+#include "net/ipv6/tcp-socket.h"
+#include "unit-test.h"
+#include "capture-driver.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NODE_ADDR      "fd00::1"
+#define PORT           5000
+#define SOURCE_SIZE    8192
+#define PHASE_BYTES    (16 * SOURCE_SIZE)
+#define COPY_CHUNK     300
+#define REF_CHUNK      4096
+#define HEADER_LEN     17
+#define PAYLOAD_LEN    512
+#define MIXED_BLOCKS   (PHASE_BYTES / PAYLOAD_LEN)
+#define PHASE_TIMEOUT  (10 * CLOCK_SECOND)
+/*---------------------------------------------------------------------------*/
+/* Nothing leaves the node: both sockets use the node's own address */
+static unsigned link_packets;
+
+static void
+count_packet(void)
+{
+  link_packets++;
+}
+/*---------------------------------------------------------------------------*/
+enum { PHASE_COPY, PHASE_REF, PHASE_MIXED, PHASES };
+
+static const char *phase_names[PHASES] = { "copy", "ref", "mixed" };
+
+struct phase_stats {
+  uint32_t bytes;
+  uint32_t copied;
+  uint32_t sent;
+  uint64_t elapsed_ns;
+};
+
+static struct phase_stats phases[PHASES];
+static uint8_t source[SOURCE_SIZE];
+static uint8_t headers[HEADER_LEN];
+
+static uint32_t
+phase_bytes(int phase)
+{
+  return phase == PHASE_MIXED ?
+    MIXED_BLOCKS * (HEADER_LEN + PAYLOAD_LEN) : PHASE_BYTES;
+}
+/*---------------------------------------------------------------------------*/
+static struct tcp_socket receiver;
+static uint8_t receiver_in[1280];
+static uint8_t receiver_out[64];
+static uint32_t received;
+static uint32_t mismatches;
+static uint8_t mixed_stream;
+
+/* Byte k of a phase's stream */
+static uint8_t
+expected(uint32_t k)
+{
+  uint32_t block;
+
+  if(!mixed_stream) {
+    return source[k % SOURCE_SIZE];
+  }
+  block = k % (HEADER_LEN + PAYLOAD_LEN);
+  if(block < HEADER_LEN) {
+    return headers[block];
+  }
+  return source[(k / (HEADER_LEN + PAYLOAD_LEN) * PAYLOAD_LEN +
+                 block - HEADER_LEN) % SOURCE_SIZE];
+}
+static int
+receiver_input(struct tcp_socket *s, void *ptr,
+               const uint8_t *input_data_ptr, int input_data_len)
+{
+  int i;
+
+  for(i = 0; i < input_data_len; i++) {
+    if(input_data_ptr[i] != expected(received + i)) {
+      mismatches++;
+    }
+  }
+  received += input_data_len;
+  process_poll(&test_process);
+  return 0;
+}
+static void
+receiver_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
+{
+}
+/*---------------------------------------------------------------------------*/
+static struct tcp_socket sender;
+static uint8_t sender_in[64];
+/* Deliberately not a multiple of any chunk size, to wrap the ring around */
+static uint8_t sender_out[1000];
+static uint8_t connected;
+
+static void
+sender_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
+{
+  if(event == TCP_SOCKET_CONNECTED) {
+    connected = 1;
+  }
+  process_poll(&test_process);
+}
+/* Queues more of the phase's stream, returns 0 when nothing was accepted */
+static uint32_t queued;
+
+static int
+queue_more(int phase)
+{
+  uint32_t off;
+  int len, n;
+
+  if(queued >= phase_bytes(phase)) {
+    return 0;
+  }
+
+  if(phase == PHASE_COPY) {
+    off = queued % SOURCE_SIZE;
+    len = MIN(COPY_CHUNK, SOURCE_SIZE - off);
+    n = tcp_socket_send(&sender, &source[off], len);
+  } else if(phase == PHASE_REF) {
+    off = queued % SOURCE_SIZE;
+    len = MIN(REF_CHUNK, SOURCE_SIZE - off);
+    n = tcp_socket_send_ref(&sender, &source[off], len);
+  } else {
+    /* A small copied header followed by a referenced payload */
+    if(tcp_socket_max_sendlen(&sender) < HEADER_LEN ||
+       sender.output_slices_len + 2 > TCP_SOCKET_MAX_SLICES) {
+      return 0;
+    }
+    off = (queued / (HEADER_LEN + PAYLOAD_LEN) * PAYLOAD_LEN) % SOURCE_SIZE;
+    n = tcp_socket_send(&sender, headers, HEADER_LEN);
+    n += tcp_socket_send_ref(&sender, &source[off], PAYLOAD_LEN);
+  }
+  if(n <= 0) {
+    return 0;
+  }
+  queued += n;
+  return n;
+}
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(bulk_integrity, "Stream integrity");
+UNIT_TEST(bulk_integrity)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < PHASES; i++) {
+    UNIT_TEST_ASSERT(phases[i].bytes == phase_bytes(i));
+    UNIT_TEST_ASSERT(phases[i].sent == phase_bytes(i));
+  }
+  UNIT_TEST_ASSERT(mismatches == 0);
+  UNIT_TEST_ASSERT(link_packets == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(bulk_copies, "Bytes copied per byte sent");
+UNIT_TEST(bulk_copies)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < PHASES; i++) {
+    printf("%-5s: %lu bytes, %lu us, %lu kB/s, "
+           "%lu.%03lu bytes copied per byte sent\n",
+           phase_names[i], (unsigned long)phases[i].bytes,
+           (unsigned long)(phases[i].elapsed_ns / 1000),
+           (unsigned long)(phases[i].bytes * 1000000ULL /
+                           (phases[i].elapsed_ns ? phases[i].elapsed_ns : 1)),
+           (unsigned long)(phases[i].copied / phases[i].sent),
+           (unsigned long)(phases[i].copied * 1000ULL / phases[i].sent % 1000));
+  }
+
+  /* Copied bytes go into the ring once and are never moved again */
+  UNIT_TEST_ASSERT(phases[PHASE_COPY].copied == PHASE_BYTES);
+  /* Referenced bytes are only copied into the outgoing packets */
+  UNIT_TEST_ASSERT(phases[PHASE_REF].copied == 0);
+  UNIT_TEST_ASSERT(phases[PHASE_MIXED].copied == MIXED_BLOCKS * HEADER_LEN);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static struct tcp_socket_stats start_stats;
+  static int phase;
+  uip_ipaddr_t addr;
+  uint32_t i;
+
+  PROCESS_BEGIN();
+
+  capture_set_callback(count_packet);
+
+  for(i = 0; i < SOURCE_SIZE; i++) {
+    source[i] = i ^ (i >> 8) * 31;
+  }
+  for(i = 0; i < HEADER_LEN; i++) {
+    headers[i] = 0xA0 + i;
+  }
+
+  uiplib_ip6addrconv(NODE_ADDR, &addr);
+  uip_ds6_addr_add(&addr, 0, ADDR_MANUAL);
+
+  tcp_socket_register(&receiver, NULL,
+                      receiver_in, sizeof(receiver_in),
+                      receiver_out, sizeof(receiver_out),
+                      receiver_input, receiver_event);
+  tcp_socket_listen(&receiver, PORT);
+
+  tcp_socket_register(&sender, NULL,
+                      sender_in, sizeof(sender_in),
+                      sender_out, sizeof(sender_out),
+                      NULL, sender_event);
+  tcp_socket_connect(&sender, &addr, PORT);
+
+  etimer_set(&et, PHASE_TIMEOUT);
+  PROCESS_WAIT_UNTIL(connected || etimer_expired(&et));
+
+  for(phase = 0; phase < PHASES && connected; phase++) {
+    /* Keep the phases apart: the receiver matches a stream per phase */
+    received = 0;
+    queued = 0;
+    mixed_stream = phase == PHASE_MIXED;
+    start_stats = tcp_socket_stats;
+    phases[phase].elapsed_ns = now_ns();
+
+    etimer_set(&et, PHASE_TIMEOUT);
+    while(received < phase_bytes(phase) && !etimer_expired(&et)) {
+      while(queue_more(phase) > 0);
+      PROCESS_WAIT_EVENT();
+    }
+
+    phases[phase].elapsed_ns = now_ns() - phases[phase].elapsed_ns;
+    phases[phase].bytes = received;
+    phases[phase].copied =
+      tcp_socket_stats.bytes_copied - start_stats.bytes_copied;
+    phases[phase].sent = tcp_socket_stats.bytes_sent - start_stats.bytes_sent;
+
+    /* The last ACK may still be on its way */
+    while(tcp_socket_queuelen(&sender) > 0 && !etimer_expired(&et)) {
+      PROCESS_WAIT_EVENT();
+      phases[phase].sent =
+        tcp_socket_stats.bytes_sent - start_stats.bytes_sent;
+    }
+  }
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(bulk_integrity);
+  UNIT_TEST_RUN(bulk_copies);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+./run-one.sh 15-tcp-window
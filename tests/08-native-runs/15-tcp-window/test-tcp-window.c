@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Bulk transfer over an emulated link with different round-trip
+ *   times, comparing the throughput with the one segment per round
+ *   trip that uIP reaches without UIP_TCP_SLIDING_WINDOW.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uiplib.h"
+#include "net/ipv6/tcp-socket.h"
+#include "unit-test.h"
+#include "link-emulator.h"
+#include <stdio.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+/* The peer is the node itself, reached over the emulated link */
+#define PEER_ADDR      "fe80::2"
+#define PORT           5000
+#define BULK_BYTES     32768
+#define RUN_TIMEOUT    (10 * CLOCK_SECOND)
+
+static const clock_time_t rtts[] = { 0, 20, 100 };
+#define RUNS           (sizeof(rtts) / sizeof(rtts[0]))
+/*---------------------------------------------------------------------------*/
+struct run_stats {
+  uint32_t bytes;
+  clock_time_t elapsed;
+  /* Time for the transfer at one segment per round trip */
+  clock_time_t stop_and_wait;
+};
+
+static struct run_stats runs[RUNS];
+static struct link_emulator_stats link_stats;
+/*---------------------------------------------------------------------------*/
+static struct tcp_socket receiver;
+static uint8_t receiver_in[UIP_TCP_MSS];
+static uint8_t receiver_out[64];
+static uint32_t received;
+static uint32_t mismatches;
+static uint8_t receiver_closed;
+
+static uint8_t
+pattern(uint32_t k)
+{
+  return k * 7 + (k >> 8);
+}
+static int
+receiver_input(struct tcp_socket *s, void *ptr,
+               const uint8_t *input_data_ptr, int input_data_len)
+{
+  int i;
+
+  for(i = 0; i < input_data_len; i++) {
+    if(input_data_ptr[i] != pattern(received + i)) {
+      mismatches++;
+    }
+  }
+  received += input_data_len;
+  process_poll(&test_process);
+  return 0;
+}
+static void
+receiver_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
+{
+  if(event == TCP_SOCKET_CLOSED || event == TCP_SOCKET_ABORTED ||
+     event == TCP_SOCKET_TIMEDOUT) {
+    receiver_closed = 1;
+    process_poll(&test_process);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct tcp_socket sender;
+static uint8_t sender_in[64];
+static uint8_t sender_out[4096];
+static uint8_t connected;
+static uint32_t queued;
+
+static void
+sender_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
+{
+  if(event == TCP_SOCKET_CONNECTED) {
+    connected = 1;
+  }
+  process_poll(&test_process);
+}
+static void
+queue_more(void)
+{
+  static uint8_t chunk[256];
+  int len, i;
+
+  while(queued < BULK_BYTES) {
+    len = MIN(sizeof(chunk), BULK_BYTES - queued);
+    len = MIN(len, tcp_socket_max_sendlen(&sender));
+    if(len <= 0) {
+      break;
+    }
+    for(i = 0; i < len; i++) {
+      chunk[i] = pattern(queued + i);
+    }
+    queued += tcp_socket_send(&sender, chunk, len);
+  }
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(window_integrity, "Stream integrity");
+UNIT_TEST(window_integrity)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < RUNS; i++) {
+    UNIT_TEST_ASSERT(runs[i].bytes == BULK_BYTES);
+  }
+  UNIT_TEST_ASSERT(mismatches == 0);
+  UNIT_TEST_ASSERT(link_stats.drops == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(window_throughput, "More than one segment per round trip");
+UNIT_TEST(window_throughput)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < RUNS; i++) {
+    printf("rtt %3lu ms: %lu bytes in %lu ms, %lu B/s, "
+           "one segment per round trip takes %lu ms\n",
+           (unsigned long)rtts[i], (unsigned long)runs[i].bytes,
+           (unsigned long)runs[i].elapsed,
+           (unsigned long)(runs[i].bytes * CLOCK_SECOND /
+                           (runs[i].elapsed ? runs[i].elapsed : 1)),
+           (unsigned long)runs[i].stop_and_wait);
+    if(rtts[i] > 0) {
+      UNIT_TEST_ASSERT(runs[i].elapsed < runs[i].stop_and_wait);
+    }
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static clock_time_t start;
+  static int run;
+  uip_ipaddr_t addr;
+  uip_lladdr_t lladdr = { { 0x02 } };
+
+  PROCESS_BEGIN();
+
+  uiplib_ip6addrconv(PEER_ADDR, &addr);
+  uip_ds6_nbr_add(&addr, &lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_UNDEFINED, NULL);
+
+  link_emulator_set_stats(&link_stats);
+
+  tcp_socket_register(&receiver, NULL,
+                      receiver_in, sizeof(receiver_in),
+                      receiver_out, sizeof(receiver_out),
+                      receiver_input, receiver_event);
+  tcp_socket_listen(&receiver, PORT);
+
+  tcp_socket_register(&sender, NULL,
+                      sender_in, sizeof(sender_in),
+                      sender_out, sizeof(sender_out),
+                      NULL, sender_event);
+
+  for(run = 0; run < RUNS; run++) {
+    link_emulator_set_delay(rtts[run] / 2);
+    connected = 0;
+    receiver_closed = 0;
+    received = 0;
+    queued = 0;
+
+    tcp_socket_connect(&sender, &addr, PORT);
+    etimer_set(&et, RUN_TIMEOUT);
+    PROCESS_WAIT_UNTIL(connected || etimer_expired(&et));
+
+    start = clock_time();
+    while(received < BULK_BYTES && !etimer_expired(&et)) {
+      queue_more();
+      PROCESS_WAIT_EVENT();
+    }
+    runs[run].elapsed = clock_time() - start;
+    runs[run].bytes = received;
+    runs[run].stop_and_wait = (BULK_BYTES + UIP_TCP_MSS - 1) / UIP_TCP_MSS *
+      rtts[run];
+
+    tcp_socket_close(&sender);
+    tcpip_poll_tcp(sender.c);
+    PROCESS_WAIT_UNTIL(receiver_closed || etimer_expired(&et));
+  }
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(window_integrity);
+  UNIT_TEST_RUN(window_throughput);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
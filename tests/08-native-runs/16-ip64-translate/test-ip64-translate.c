@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Translation throughput of ip64_6to4() and ip64_4to6() with a full
+ *   address map, and expiry of address mappings.
+ */
+
+#include "contiki.h"
+#include "ip64/ip64.h"
+#include "ip64/ip64-addrmap.h"
+#include "net/ipv6/uiplib.h"
+#include "unit-test.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+/* As many flows as the address map holds by default */
+#define FLOWS          32
+#define ROUNDS         20000
+#define PAYLOAD_LEN    32
+#define IPV6_HDRLEN    40
+#define IPV4_HDRLEN    20
+#define UDP_HDRLEN     8
+#define FIRST_SRCPORT  40000
+#define DESTPORT       5683
+#define PROTO_UDP      17
+/*---------------------------------------------------------------------------*/
+static uint8_t packets[FLOWS][IPV6_HDRLEN + UDP_HDRLEN + PAYLOAD_LEN];
+static uint8_t v4packet[UIP_BUFSIZE];
+static uint8_t v6packet[UIP_BUFSIZE];
+static uint16_t mapped_ports[FLOWS];
+static uint32_t failures;
+static uint64_t elapsed_6to4_ns, elapsed_4to6_ns;
+
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_packet(int flow)
+{
+  uint8_t *p = packets[flow];
+  uip_ip6addr_t addr;
+  uint16_t port;
+
+  memset(p, 0, sizeof(packets[flow]));
+  p[0] = 0x60;
+  p[5] = UDP_HDRLEN + PAYLOAD_LEN;
+  p[6] = PROTO_UDP;
+  p[7] = 64;
+  uip_ip6addr(&addr, 0xfd00, 0, 0, 0, 0, 0, 0, flow + 1);
+  memcpy(&p[8], &addr, 16);
+  /* 192.0.2.1 behind the well-known NAT64 prefix */
+  uip_ip6addr(&addr, 0x64, 0xff9b, 0, 0, 0, 0, 0xc000, 0x0201);
+  memcpy(&p[24], &addr, 16);
+  port = FIRST_SRCPORT + flow;
+  p[40] = port >> 8;
+  p[41] = port & 0xff;
+  p[42] = DESTPORT >> 8;
+  p[43] = DESTPORT & 0xff;
+  p[45] = UDP_HDRLEN + PAYLOAD_LEN;
+  memset(&p[48], flow, PAYLOAD_LEN);
+}
+/*---------------------------------------------------------------------------*/
+/* Translates a packet of a flow out, and its reply back in */
+static void
+round_trip(int flow)
+{
+  uint64_t t;
+  uint8_t addr[4], port[2];
+  int len;
+
+  t = now_ns();
+  len = ip64_6to4(packets[flow], sizeof(packets[flow]), v4packet);
+  elapsed_6to4_ns += now_ns() - t;
+  if(len <= 0) {
+    failures++;
+    return;
+  }
+
+  if(mapped_ports[flow] == 0) {
+    mapped_ports[flow] = (v4packet[20] << 8) | v4packet[21];
+  } else if(mapped_ports[flow] != ((v4packet[20] << 8) | v4packet[21])) {
+    failures++;
+  }
+
+  /* The reply swaps addresses and ports */
+  memcpy(addr, &v4packet[12], 4);
+  memcpy(&v4packet[12], &v4packet[16], 4);
+  memcpy(&v4packet[16], addr, 4);
+  memcpy(port, &v4packet[20], 2);
+  memcpy(&v4packet[20], &v4packet[22], 2);
+  memcpy(&v4packet[22], port, 2);
+
+  t = now_ns();
+  len = ip64_4to6(v4packet, len, v6packet);
+  elapsed_4to6_ns += now_ns() - t;
+  if(len <= 0 ||
+     memcmp(&v6packet[24], &packets[flow][8], 16) != 0 ||
+     memcmp(&v6packet[42], &packets[flow][40], 2) != 0) {
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(translate_round_trip, "Translation round trip");
+UNIT_TEST(translate_round_trip)
+{
+  int i, j;
+
+  UNIT_TEST_BEGIN();
+
+  printf("6to4: %lu ns per packet, 4to6: %lu ns per packet, %d flows\n",
+         (unsigned long)(elapsed_6to4_ns / ((uint64_t)ROUNDS * FLOWS)),
+         (unsigned long)(elapsed_4to6_ns / ((uint64_t)ROUNDS * FLOWS)),
+         FLOWS);
+
+  UNIT_TEST_ASSERT(failures == 0);
+  for(i = 0; i < FLOWS; i++) {
+    UNIT_TEST_ASSERT(mapped_ports[i] >= 10000 && mapped_ports[i] < 20000);
+    for(j = 0; j < i; j++) {
+      UNIT_TEST_ASSERT(mapped_ports[i] != mapped_ports[j]);
+    }
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+static struct ip64_addrmap_entry *expiring;
+static uint16_t expiring_port;
+
+UNIT_TEST_REGISTER(addrmap_expiry, "Expired mappings are removed");
+UNIT_TEST(addrmap_expiry)
+{
+  struct ip64_addrmap_entry *m;
+  uip_ip4addr_t ip4addr;
+  int n;
+
+  UNIT_TEST_BEGIN();
+
+  uip_ipaddr(&ip4addr, 192, 0, 2, 1);
+  UNIT_TEST_ASSERT(ip64_addrmap_lookup_port(expiring_port, PROTO_UDP) == NULL);
+  UNIT_TEST_ASSERT(ip64_addrmap_lookup((uip_ip6addr_t *)&packets[0][8],
+                                       FIRST_SRCPORT, &ip4addr, DESTPORT,
+                                       PROTO_UDP) == NULL);
+
+  /* Aging has emptied the map */
+  for(n = 0, m = ip64_addrmap_list(); m != NULL; m = m->next) {
+    n++;
+  }
+  UNIT_TEST_ASSERT(n == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  struct ip64_addrmap_entry *m;
+  uip_ip4addr_t ip4addr, netmask;
+  int i, r;
+
+  PROCESS_BEGIN();
+
+  ip64_addrmap_init();
+  uip_ipaddr(&ip4addr, 10, 0, 0, 1);
+  uip_ipaddr(&netmask, 255, 255, 255, 0);
+  ip64_set_ipv4_address(&ip4addr, &netmask);
+
+  for(i = 0; i < FLOWS; i++) {
+    make_packet(i);
+  }
+  for(r = 0; r < ROUNDS; r++) {
+    for(i = 0; i < FLOWS; i++) {
+      round_trip(i);
+    }
+  }
+
+  /* Let all mappings expire */
+  for(m = ip64_addrmap_list(); m != NULL; m = m->next) {
+    ip64_addrmap_set_lifetime(m, CLOCK_SECOND / 10);
+  }
+  expiring = ip64_addrmap_list();
+  expiring_port = expiring->mapped_port;
+  etimer_set(&et, CLOCK_SECOND / 2);
+  PROCESS_WAIT_UNTIL(etimer_expired(&et));
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(translate_round_trip);
+  UNIT_TEST_RUN(addrmap_expiry);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Resolver cache: TTL expiry, negative caching, coalesced queries
+ *   and retries, against a DNS server stand-in on the node itself.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uiplib.h"
+#include "net/ipv6/uip-nameserver.h"
+#include "net/ipv6/simple-udp.h"
+#include "resolv.h"
+#include "unit-test.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+PROCESS(server_process, "DNS server");
+AUTOSTART_PROCESSES(&test_process, &server_process);
+
+#define NODE_ADDR      "fd00::1"
+#define BROKER_ADDR    "fd00::100"
+#define DNS_PORT       53
+#define TTL            1
+#define EVENT_TIMEOUT  (3 * CLOCK_SECOND)
+/*---------------------------------------------------------------------------*/
+/*
+ * The server knows "broker.example", answers "missing.example" with a
+ * not-found error and an SOA record, and never answers
+ * "silent.example". Replies go out from the server process, since the
+ * resolver is still busy sending when the query arrives.
+ */
+enum { NAME_BROKER, NAME_MISSING, NAME_SILENT, NAMES };
+
+static const char *names[NAMES] = {
+  "broker.example", "missing.example", "silent.example"
+};
+static unsigned server_queries[NAMES];
+static struct simple_udp_connection server;
+static uip_ipaddr_t broker_addr;
+static uint8_t reply[256];
+static uint16_t reply_len;
+static uip_ipaddr_t reply_addr;
+static uint16_t reply_port;
+
+static int
+question_is(const uint8_t *q, const char *name)
+{
+  char decoded[64];
+  int len = 0;
+
+  while(*q != 0 && len + *q + 1 < sizeof(decoded)) {
+    if(len > 0) {
+      decoded[len++] = '.';
+    }
+    memcpy(&decoded[len], q + 1, *q);
+    len += *q;
+    q += *q + 1;
+  }
+  decoded[len] = 0;
+  return strcmp(decoded, name) == 0;
+}
+static uint8_t *
+put_rr_header(uint8_t *p, uint16_t type, uint32_t ttl, uint16_t rdlen)
+{
+  /* The name points to the question */
+  *p++ = 0xc0;
+  *p++ = 12;
+  *p++ = type >> 8;
+  *p++ = type & 0xff;
+  *p++ = 0;
+  *p++ = 1;
+  *p++ = ttl >> 24;
+  *p++ = ttl >> 16;
+  *p++ = ttl >> 8;
+  *p++ = ttl;
+  *p++ = rdlen >> 8;
+  *p++ = rdlen & 0xff;
+  return p;
+}
+static void
+server_callback(struct simple_udp_connection *c,
+                const uip_ipaddr_t *sender_addr, uint16_t sender_port,
+                const uip_ipaddr_t *receiver_addr, uint16_t receiver_port,
+                const uint8_t *data, uint16_t datalen)
+{
+  uint8_t *p;
+  int i;
+
+  if(datalen < 12 || datalen > 128 || reply_len > 0) {
+    return;
+  }
+  for(i = 0; i < NAMES && !question_is(&data[12], names[i]); i++);
+  if(i == NAMES) {
+    return;
+  }
+  server_queries[i]++;
+  if(i == NAME_SILENT) {
+    return;
+  }
+
+  memcpy(reply, data, datalen);
+  reply[2] = 0x81;
+  reply[3] = 0x80;
+  p = &reply[datalen];
+  if(i == NAME_BROKER) {
+    reply[7] = 1;
+    p = put_rr_header(p, 28, TTL, 16);
+    memcpy(p, &broker_addr, 16);
+    p += 16;
+  } else {
+    /* Not found, cache it for TTL seconds */
+    reply[3] |= 3;
+    reply[9] = 1;
+    p = put_rr_header(p, 6, 3600, 22);
+    *p++ = 0;
+    *p++ = 0;
+    memset(p, 0, 16);
+    p += 16;
+    *p++ = 0;
+    *p++ = 0;
+    *p++ = 0;
+    *p++ = TTL;
+  }
+  reply_len = p - reply;
+  uip_ipaddr_copy(&reply_addr, sender_addr);
+  reply_port = sender_port;
+  process_poll(&server_process);
+}
+PROCESS_THREAD(server_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  simple_udp_register(&server, DNS_PORT, NULL, 0, server_callback);
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    simple_udp_sendto_port(&server, reply, reply_len,
+                           &reply_addr, reply_port);
+    reply_len = 0;
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+static resolv_status_t broker_fresh, broker_cached, broker_expired;
+static resolv_status_t missing_fresh, missing_expired, silent_status;
+static unsigned broker_queries_coalesced, broker_queries_cached;
+static unsigned broker_queries_expired;
+static unsigned missing_queries_cached;
+static resolv_status_t missing_cached;
+static int broker_addr_ok;
+static struct resolv_stats stats_coalesced;
+static uint32_t silent_sent;
+static uint8_t timed_out;
+
+UNIT_TEST_REGISTER(resolv_ttl, "Answers are cached for their TTL");
+UNIT_TEST(resolv_ttl)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(!timed_out);
+  UNIT_TEST_ASSERT(broker_fresh == RESOLV_STATUS_CACHED);
+  UNIT_TEST_ASSERT(broker_addr_ok);
+  UNIT_TEST_ASSERT(broker_cached == RESOLV_STATUS_CACHED);
+  UNIT_TEST_ASSERT(broker_queries_cached == 1);
+  UNIT_TEST_ASSERT(broker_expired == RESOLV_STATUS_EXPIRED);
+  UNIT_TEST_ASSERT(broker_queries_expired == 2);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(resolv_negative, "Not-found answers are cached");
+UNIT_TEST(resolv_negative)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(missing_fresh == RESOLV_STATUS_NOT_FOUND);
+  UNIT_TEST_ASSERT(missing_cached == RESOLV_STATUS_NOT_FOUND);
+  UNIT_TEST_ASSERT(missing_queries_cached == 1);
+  UNIT_TEST_ASSERT(missing_expired == RESOLV_STATUS_UNCACHED);
+  UNIT_TEST_ASSERT(server_queries[NAME_MISSING] == 1);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(resolv_coalesce, "Concurrent queries are coalesced");
+UNIT_TEST(resolv_coalesce)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(broker_queries_coalesced == 1);
+  UNIT_TEST_ASSERT(stats_coalesced.coalesced == 2);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(resolv_retries, "Unanswered queries are retried");
+UNIT_TEST(resolv_retries)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("hits %lu, negative hits %lu, misses %lu, coalesced %lu, "
+         "queries %lu\n",
+         (unsigned long)resolv_stats.hits,
+         (unsigned long)resolv_stats.negative_hits,
+         (unsigned long)resolv_stats.misses,
+         (unsigned long)resolv_stats.coalesced,
+         (unsigned long)resolv_stats.queries);
+
+  UNIT_TEST_ASSERT(silent_status == RESOLV_STATUS_NOT_FOUND);
+  /* The first query and one retry */
+  UNIT_TEST_ASSERT(server_queries[NAME_SILENT] == 2);
+  UNIT_TEST_ASSERT(silent_sent == 2);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static uint32_t queries_before;
+  uip_ipaddr_t addr, *found;
+
+  PROCESS_BEGIN();
+
+  uiplib_ip6addrconv(NODE_ADDR, &addr);
+  uip_ds6_addr_add(&addr, 0, ADDR_MANUAL);
+  uip_nameserver_update(&addr, UIP_NAMESERVER_INFINITE_LIFETIME);
+  uiplib_ip6addrconv(BROKER_ADDR, &broker_addr);
+
+/* Waits for the answer for a name, or the timeout */
+#define WAIT_FOUND(name)                                                \
+  do {                                                                  \
+    etimer_set(&et, EVENT_TIMEOUT);                                     \
+    PROCESS_WAIT_EVENT_UNTIL((ev == resolv_event_found &&               \
+                              strcmp(data, (name)) == 0) ||             \
+                             etimer_expired(&et));                      \
+    timed_out |= etimer_expired(&et);                                   \
+  } while(0)
+
+  /* Three queries in a row go out as one */
+  resolv_query(names[NAME_BROKER]);
+  resolv_query(names[NAME_BROKER]);
+  resolv_query(names[NAME_BROKER]);
+  stats_coalesced = resolv_stats;
+  WAIT_FOUND(names[NAME_BROKER]);
+  broker_queries_coalesced = server_queries[NAME_BROKER];
+  broker_fresh = resolv_lookup(names[NAME_BROKER], &found);
+  broker_addr_ok = uip_ipaddr_cmp(found, &broker_addr);
+
+  /* A query for a fresh name is answered from the cache */
+  resolv_query(names[NAME_BROKER]);
+  WAIT_FOUND(names[NAME_BROKER]);
+  broker_cached = resolv_lookup(names[NAME_BROKER], NULL);
+  broker_queries_cached = server_queries[NAME_BROKER];
+
+  /* Not-found answers are cached for the SOA minimum */
+  resolv_query(names[NAME_MISSING]);
+  WAIT_FOUND(names[NAME_MISSING]);
+  missing_fresh = resolv_lookup(names[NAME_MISSING], NULL);
+
+  /* A query for a name known not to exist is answered from the cache */
+  resolv_query(names[NAME_MISSING]);
+  WAIT_FOUND(names[NAME_MISSING]);
+  missing_cached = resolv_lookup(names[NAME_MISSING], NULL);
+  missing_queries_cached = server_queries[NAME_MISSING];
+
+  etimer_set(&et, (TTL + 1) * CLOCK_SECOND + CLOCK_SECOND / 2);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  broker_expired = resolv_lookup(names[NAME_BROKER], NULL);
+  missing_expired = resolv_lookup(names[NAME_MISSING], NULL);
+  resolv_query(names[NAME_BROKER]);
+  WAIT_FOUND(names[NAME_BROKER]);
+  broker_queries_expired = server_queries[NAME_BROKER];
+
+  /* An unanswered name fails after the retries */
+  queries_before = resolv_stats.queries;
+  resolv_query(names[NAME_SILENT]);
+  WAIT_FOUND(names[NAME_SILENT]);
+  silent_status = resolv_lookup(names[NAME_SILENT], NULL);
+  silent_sent = resolv_stats.queries - queries_before;
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(resolv_ttl);
+  UNIT_TEST_RUN(resolv_negative);
+  UNIT_TEST_RUN(resolv_coalesce);
+  UNIT_TEST_RUN(resolv_retries);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
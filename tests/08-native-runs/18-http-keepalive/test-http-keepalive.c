@@ -0,0 +1,413 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   HTTP requests to a server stand-in over an emulated link: one
+ *   connection per request, kept-alive connections, pipelined requests,
+ *   chunked responses and a connection closed with requests pending.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uiplib.h"
+#include "http-socket.h"
+#include "unit-test.h"
+#include "link-emulator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+/* The server is the node itself, reached over the emulated link */
+#define SERVER_ADDR    "fe80::2"
+#define SERVER_URL     "http://[" SERVER_ADDR "]:8080"
+#define PORT           8080
+#define LINK_DELAY     (10 * CLOCK_SECOND / 1000)
+#define REQUESTS       10
+#define PIPELINED      4
+#define CHUNKED        PIPELINED
+#define CLOSING        (CHUNKED + 2)
+#define CLOSING_QUEUED 3
+#define RUN_TIMEOUT    (10 * CLOCK_SECOND)
+/*---------------------------------------------------------------------------*/
+/*
+ * The server answers "/chunked" with a chunked body, "/close" by closing
+ * the connection and anything else with a numbered reply. Its headers
+ * have mixed case and a line longer than the client keeps.
+ */
+#define CHUNKED_BODY   "hello, chunked world"
+
+static struct tcp_socket server;
+static uint8_t server_in[128];
+static uint8_t server_out[1024];
+static char server_line[64];
+static int server_line_len;
+static char server_path[32];
+static int server_content_length;
+static int server_body_left;
+static unsigned server_requests;
+static unsigned server_connections;
+static uint8_t server_closing;
+
+static void
+server_respond(void)
+{
+  char str[128];
+
+  server_requests++;
+  if(strcmp(server_path, "/close") == 0) {
+    server_closing = 1;
+    tcp_socket_close(&server);
+  } else if(strcmp(server_path, "/chunked") == 0) {
+    tcp_socket_send_str(&server,
+                        "HTTP/1.1 200 OK\r\n"
+                        "transfer-ENCODING: chunked\r\n"
+                        "X-Padding: ................................."
+                        "..........................................\r\n"
+                        "\r\n"
+                        "5;name=value\r\nhello\r\n"
+                        "7\r\n, chunk\r\n"
+                        "8\r\ned world\r\n"
+                        "0\r\nX-Trailer: 1\r\n\r\n");
+  } else {
+    snprintf(str, sizeof(str), "reply %u", server_requests);
+    tcp_socket_send_str(&server,
+                        "HTTP/1.1 200 OK\r\n"
+                        "X-Padding: ................................."
+                        "..........................................\r\n"
+                        "content-LENGTH: ");
+    tcp_socket_send_str(&server, strlen(str) == 7 ? "7" : "8");
+    tcp_socket_send_str(&server, "\r\n\r\n");
+    tcp_socket_send_str(&server, str);
+  }
+}
+static int
+server_input(struct tcp_socket *s, void *ptr,
+             const uint8_t *input_data_ptr, int input_data_len)
+{
+  char c;
+  int i;
+
+  for(i = 0; i < input_data_len && !server_closing; i++) {
+    c = input_data_ptr[i];
+    if(server_body_left > 0) {
+      if(--server_body_left == 0) {
+        server_respond();
+      }
+    } else if(c == '\n') {
+      server_line[server_line_len] = '\0';
+      if(server_line_len == 0) {
+        server_body_left = server_content_length;
+        if(server_body_left == 0) {
+          server_respond();
+        }
+      } else if(sscanf(server_line, "GET %31s", server_path) == 1 ||
+                sscanf(server_line, "POST %31s", server_path) == 1) {
+        server_content_length = 0;
+      } else if(strncmp(server_line, "Content-Length: ", 16) == 0) {
+        server_content_length = atoi(server_line + 16);
+      }
+      server_line_len = 0;
+    } else if(c != '\r' && server_line_len < sizeof(server_line) - 1) {
+      server_line[server_line_len++] = c;
+    }
+  }
+  return 0;
+}
+static void
+server_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
+{
+  if(event == TCP_SOCKET_CONNECTED) {
+    server_connections++;
+    server_closing = 0;
+    server_line_len = 0;
+    server_body_left = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+struct run_stats {
+  unsigned completed;
+  unsigned connections;
+  clock_time_t elapsed;
+  uint32_t air_bytes;
+  uint32_t air_packets;
+};
+
+static struct run_stats single_run, keepalive_run;
+static struct link_emulator_stats link_stats;
+static struct http_socket client;
+static unsigned completed;
+static unsigned out_of_order;
+static unsigned errors;
+static char body[64];
+static int body_len;
+static char replies[PIPELINED][16];
+static char chunked_body[64];
+static int chunked_len;
+static uint8_t closed_mask;
+
+static void
+callback(struct http_socket *s, void *ptr,
+         http_socket_event_t e,
+         const uint8_t *data, uint16_t datalen)
+{
+  int index = (int)(intptr_t)ptr;
+
+  if(e == HTTP_SOCKET_DATA) {
+    datalen = MIN(datalen, sizeof(body) - 1 - body_len);
+    memcpy(&body[body_len], data, datalen);
+    body_len += datalen;
+    body[body_len] = '\0';
+  } else if(e == HTTP_SOCKET_COMPLETE) {
+    if(index < PIPELINED) {
+      if(index != completed) {
+        out_of_order++;
+      }
+      strncpy(replies[index], body, sizeof(replies[index]) - 1);
+    } else if(index == CHUNKED) {
+      strcpy(chunked_body, body);
+      chunked_len = body_len;
+    }
+    body_len = 0;
+    completed++;
+    process_poll(&test_process);
+  } else if(e == HTTP_SOCKET_CLOSED) {
+    if(index >= CLOSING && index < CLOSING + CLOSING_QUEUED) {
+      closed_mask |= 1 << (index - CLOSING);
+      process_poll(&test_process);
+    }
+  } else if(e != HTTP_SOCKET_HEADER) {
+    errors++;
+    process_poll(&test_process);
+  }
+}
+static void
+start_run(void)
+{
+  completed = 0;
+  body_len = 0;
+  server_connections = 0;
+  link_stats.bytes = 0;
+  link_stats.packets = 0;
+}
+static void
+end_run(struct run_stats *stats, clock_time_t start)
+{
+  stats->elapsed = clock_time() - start;
+  stats->completed = completed;
+  stats->connections = server_connections;
+  stats->air_bytes = link_stats.bytes;
+  stats->air_packets = link_stats.packets;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(http_keepalive, "Kept-alive connections are reused");
+UNIT_TEST(http_keepalive)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("one connection per request: %u requests, %lu ms, %lu requests/s, "
+         "%lu bytes in %lu packets\n", single_run.completed,
+         (unsigned long)single_run.elapsed,
+         (unsigned long)(single_run.completed * CLOCK_SECOND /
+                         (single_run.elapsed ? single_run.elapsed : 1)),
+         (unsigned long)single_run.air_bytes,
+         (unsigned long)single_run.air_packets);
+  printf("kept-alive connection: %u requests, %lu ms, %lu requests/s, "
+         "%lu bytes in %lu packets\n", keepalive_run.completed,
+         (unsigned long)keepalive_run.elapsed,
+         (unsigned long)(keepalive_run.completed * CLOCK_SECOND /
+                         (keepalive_run.elapsed ? keepalive_run.elapsed : 1)),
+         (unsigned long)keepalive_run.air_bytes,
+         (unsigned long)keepalive_run.air_packets);
+
+  UNIT_TEST_ASSERT(single_run.completed == REQUESTS);
+  UNIT_TEST_ASSERT(single_run.connections == REQUESTS);
+  UNIT_TEST_ASSERT(keepalive_run.completed == REQUESTS);
+  UNIT_TEST_ASSERT(keepalive_run.connections == 1);
+  UNIT_TEST_ASSERT(keepalive_run.elapsed < single_run.elapsed);
+  UNIT_TEST_ASSERT(keepalive_run.air_bytes < single_run.air_bytes);
+  UNIT_TEST_ASSERT(keepalive_run.air_packets < single_run.air_packets);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(http_pipeline, "Pipelined responses arrive in order");
+UNIT_TEST(http_pipeline)
+{
+  int i;
+  char expected[16];
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(out_of_order == 0);
+  for(i = 0; i < PIPELINED; i++) {
+    snprintf(expected, sizeof(expected), "reply %u",
+             2 * REQUESTS + i + 1);
+    UNIT_TEST_ASSERT(strcmp(replies[i], expected) == 0);
+  }
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(http_chunked, "Chunked responses are decoded");
+UNIT_TEST(http_chunked)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(chunked_len == strlen(CHUNKED_BODY));
+  UNIT_TEST_ASSERT(strcmp(chunked_body, CHUNKED_BODY) == 0);
+  UNIT_TEST_ASSERT(errors == 0);
+  UNIT_TEST_ASSERT(link_stats.drops == 0);
+  UNIT_TEST_ASSERT(server_connections == 1);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(http_closed, "Pending requests see the connection close");
+UNIT_TEST(http_closed)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(closed_mask == (1 << CLOSING_QUEUED) - 1);
+  UNIT_TEST_ASSERT(errors == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static clock_time_t start;
+  static int i;
+  static const char reading[] = "{\"temp\":21.5}";
+  uip_ipaddr_t addr;
+  uip_lladdr_t lladdr = { { 0x02 } };
+
+  PROCESS_BEGIN();
+
+  uiplib_ip6addrconv(SERVER_ADDR, &addr);
+  uip_ds6_nbr_add(&addr, &lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_UNDEFINED, NULL);
+
+  link_emulator_set_delay(LINK_DELAY);
+  link_emulator_set_stats(&link_stats);
+
+  tcp_socket_register(&server, NULL,
+                      server_in, sizeof(server_in),
+                      server_out, sizeof(server_out),
+                      server_input, server_event);
+  tcp_socket_listen(&server, PORT);
+  http_socket_init(&client);
+
+  /* A new connection for each request */
+  start_run();
+  start = clock_time();
+  etimer_set(&et, RUN_TIMEOUT);
+  for(i = 0; i < REQUESTS && !etimer_expired(&et); i++) {
+    http_socket_post(&client, SERVER_URL "/reading",
+                     reading, sizeof(reading) - 1, "application/json",
+                     callback, (void *)(intptr_t)i);
+    PROCESS_WAIT_UNTIL(completed > i || errors > 0 || etimer_expired(&et));
+  }
+  end_run(&single_run, start);
+
+  /* Let the last connection close before the next run */
+  etimer_set(&et, CLOCK_SECOND / 2);
+  PROCESS_WAIT_UNTIL(etimer_expired(&et));
+
+  /* The same requests on one kept-alive connection */
+  http_socket_set_keep_alive(&client, 1);
+  start_run();
+  start = clock_time();
+  etimer_set(&et, RUN_TIMEOUT);
+  for(i = 0; i < REQUESTS && !etimer_expired(&et); i++) {
+    http_socket_post(&client, SERVER_URL "/reading",
+                     reading, sizeof(reading) - 1, "application/json",
+                     callback, (void *)(intptr_t)i);
+    PROCESS_WAIT_UNTIL(completed > i || errors > 0 || etimer_expired(&et));
+  }
+  end_run(&keepalive_run, start);
+
+  /* Pipelined requests, still on the same connection */
+  completed = 0;
+  for(i = 0; i < PIPELINED; i++) {
+    if(http_socket_get(&client, SERVER_URL "/reading", 0, 0,
+                       callback, (void *)(intptr_t)i) != HTTP_SOCKET_OK) {
+      errors++;
+    }
+  }
+  etimer_set(&et, RUN_TIMEOUT);
+  PROCESS_WAIT_UNTIL(completed == PIPELINED || errors > 0 ||
+                     etimer_expired(&et));
+
+  /* A chunked response, then the connection is still usable */
+  completed = 0;
+  http_socket_get(&client, SERVER_URL "/chunked", 0, 0,
+                  callback, (void *)(intptr_t)CHUNKED);
+  PROCESS_WAIT_UNTIL(completed == 1 || errors > 0 || etimer_expired(&et));
+  http_socket_get(&client, SERVER_URL "/reading", 0, 0,
+                  callback, (void *)(intptr_t)(CHUNKED + 1));
+  PROCESS_WAIT_UNTIL(completed == 2 || errors > 0 || etimer_expired(&et));
+
+  /* The server closes the connection with pipelined requests pending */
+  closed_mask = 0;
+  for(i = 0; i < CLOSING_QUEUED; i++) {
+    if(http_socket_get(&client,
+                       i == 0 ? SERVER_URL "/close" : SERVER_URL "/reading",
+                       0, 0, callback,
+                       (void *)(intptr_t)(CLOSING + i)) != HTTP_SOCKET_OK) {
+      errors++;
+    }
+  }
+  etimer_set(&et, RUN_TIMEOUT);
+  PROCESS_WAIT_UNTIL(closed_mask == (1 << CLOSING_QUEUED) - 1 ||
+                     errors > 0 || etimer_expired(&et));
+
+  http_socket_close(&client);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(http_keepalive);
+  UNIT_TEST_RUN(http_pipeline);
+  UNIT_TEST_RUN(http_chunked);
+  UNIT_TEST_RUN(http_closed);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Websocket messages to an echo server stand-in over an emulated
+ *   link: batched small messages, fragmented large ones, masked and
+ *   interleaved frames from the server.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uiplib.h"
+#include "websocket.h"
+#include "unit-test.h"
+#include "link-emulator.h"
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+/* The server is the node itself, reached over the emulated link */
+#define SERVER_ADDR    "fe80::2"
+#define SERVER_URL     "ws://[" SERVER_ADDR "]:8080/echo"
+#define PORT           8080
+#define LINK_DELAY     (10 * CLOCK_SECOND / 1000)
+#define BATCHES        10
+#define BATCH_SIZE     10
+#define LARGE_LEN      1500
+#define LONG_FRAME_LEN 300
+#define RUN_TIMEOUT    (10 * CLOCK_SECOND)
+/*---------------------------------------------------------------------------*/
+/* Counts the packets the client puts on the emulated link */
+static struct link_emulator_stats link_stats;
+static uint32_t client_packets;
+
+static void
+count_client_packet(void)
+{
+  if(UIP_TCP_BUF->srcport != UIP_HTONS(PORT)) {
+    client_packets++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * The server answers the upgrade request and echoes each frame it
+ * gets as it is, only unmasked. Text messages starting with "cmd:"
+ * make it send frames that the client does not send itself.
+ */
+static struct tcp_socket server;
+static uint8_t server_in[256];
+static uint8_t server_out[4096];
+static uint8_t server_upgraded;
+static uint8_t server_endmatch;
+static uint8_t server_hdr[14];
+static uint8_t server_hdrlen;
+static uint8_t server_payload[LARGE_LEN];
+static uint16_t server_len;
+static uint16_t server_got;
+static char server_pong[8];
+
+static int
+frame_header_len(const uint8_t *hdr)
+{
+  int len = 2;
+
+  if((hdr[1] & 0x7f) == 126) {
+    len += 2;
+  } else if((hdr[1] & 0x7f) == 127) {
+    len += 8;
+  }
+  return len + ((hdr[1] & 0x80) ? 4 : 0);
+}
+static void
+server_send_frame(uint8_t opcode, const uint8_t *mask,
+                  const uint8_t *data, uint16_t len)
+{
+  uint8_t hdr[14];
+  uint8_t masked[32];
+  int hdrlen, i;
+
+  hdr[0] = opcode;
+  if(len > 125) {
+    hdr[1] = 126;
+    hdr[2] = len >> 8;
+    hdr[3] = len & 0xff;
+    hdrlen = 4;
+  } else {
+    hdr[1] = len;
+    hdrlen = 2;
+  }
+  if(mask != NULL) {
+    hdr[1] |= 0x80;
+    memcpy(&hdr[hdrlen], mask, 4);
+    hdrlen += 4;
+    for(i = 0; i < len; i++) {
+      masked[i] = data[i] ^ mask[i & 3];
+    }
+    data = masked;
+  }
+  tcp_socket_send(&server, hdr, hdrlen);
+  tcp_socket_send(&server, data, len);
+}
+static void
+server_command(const char *cmd)
+{
+  static const uint8_t mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+  uint8_t hdr[10] = { 0x82, 127, 0, 0, 0, 0, 0, 0, 0, 0 };
+  int i;
+
+  if(strcmp(cmd, "masked") == 0) {
+    server_send_frame(0x81, mask, (const uint8_t *)"masked hello", 12);
+  } else if(strcmp(cmd, "ping-fragments") == 0) {
+    server_send_frame(0x01, NULL, (const uint8_t *)"part1-", 6);
+    server_send_frame(0x89, NULL, (const uint8_t *)"pp", 2);
+    server_send_frame(0x80, NULL, (const uint8_t *)"part2", 5);
+  } else if(strcmp(cmd, "long-length") == 0) {
+    /* A short frame with its length in eight bytes */
+    hdr[8] = LONG_FRAME_LEN >> 8;
+    hdr[9] = LONG_FRAME_LEN & 0xff;
+    tcp_socket_send(&server, hdr, sizeof(hdr));
+    for(i = 0; i < LONG_FRAME_LEN; i++) {
+      server_payload[i] = i;
+    }
+    tcp_socket_send(&server, server_payload, LONG_FRAME_LEN);
+  }
+}
+static void
+server_frame(void)
+{
+  uint8_t opcode = server_hdr[0] & 0x0f;
+
+  if(opcode == 0x0a) {
+    server_len = MIN(server_len, sizeof(server_pong) - 1);
+    memcpy(server_pong, server_payload, server_len);
+    server_pong[server_len] = '\0';
+  } else if(opcode == 0x01 && server_len > 4 &&
+            memcmp(server_payload, "cmd:", 4) == 0) {
+    server_payload[server_len] = '\0';
+    server_command((char *)&server_payload[4]);
+  } else if(opcode <= 0x02) {
+    server_send_frame(server_hdr[0], NULL, server_payload, server_len);
+  }
+}
+static int
+server_input(struct tcp_socket *s, void *ptr,
+             const uint8_t *input_data_ptr, int input_data_len)
+{
+  static const char endmarker[] = "\r\n\r\n";
+  const uint8_t *mask;
+  uint8_t c;
+  int i;
+
+  for(i = 0; i < input_data_len; i++) {
+    c = input_data_ptr[i];
+    if(!server_upgraded) {
+      server_endmatch = c == endmarker[server_endmatch] ?
+        server_endmatch + 1 : (c == '\r');
+      if(server_endmatch == 4) {
+        server_upgraded = 1;
+        tcp_socket_send_str(&server,
+                            "HTTP/1.1 101 Switching Protocols\r\n"
+                            "Upgrade: websocket\r\n"
+                            "Connection: Upgrade\r\n\r\n");
+      }
+    } else if(server_hdrlen < 2 ||
+              server_hdrlen < frame_header_len(server_hdr)) {
+      server_hdr[server_hdrlen++] = c;
+      if(server_hdrlen >= 2 && server_hdrlen == frame_header_len(server_hdr)) {
+        server_len = server_hdr[1] & 0x7f;
+        if(server_len == 126) {
+          server_len = (server_hdr[2] << 8) | server_hdr[3];
+        }
+        server_got = 0;
+        if(server_len == 0) {
+          server_frame();
+          server_hdrlen = 0;
+        }
+      }
+    } else {
+      mask = &server_hdr[server_hdrlen - 4];
+      server_payload[server_got] = c ^ mask[server_got & 3];
+      if(++server_got == server_len) {
+        server_frame();
+        server_hdrlen = 0;
+      }
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static struct websocket client;
+static uint8_t connected;
+static uint8_t message[LARGE_LEN];
+static uint16_t message_len;
+static uint16_t received_len;
+static uint8_t received[LARGE_LEN];
+static unsigned messages;
+static unsigned mismatches;
+static unsigned pings;
+static unsigned errors;
+static int expected_small;
+
+static void
+callback(struct websocket *s, websocket_result_t r,
+         const uint8_t *data, uint16_t datalen)
+{
+  char expected[16];
+
+  if(r == WEBSOCKET_CONNECTED) {
+    connected = 1;
+  } else if(r == WEBSOCKET_DATA) {
+    datalen = MIN(datalen, sizeof(message) - message_len);
+    memcpy(&message[message_len], data, datalen);
+    message_len += datalen;
+  } else if(r == WEBSOCKET_DATA_RECEIVED) {
+    if(datalen != message_len) {
+      mismatches++;
+    }
+    if(expected_small >= 0) {
+      snprintf(expected, sizeof(expected), "msg %03d", expected_small++);
+      if(message_len != strlen(expected) ||
+         memcmp(message, expected, message_len) != 0) {
+        mismatches++;
+      }
+    }
+    memcpy(received, message, message_len);
+    received_len = message_len;
+    message_len = 0;
+    messages++;
+  } else if(r == WEBSOCKET_PINGED) {
+    pings++;
+  } else if(r != WEBSOCKET_PONG_RECEIVED) {
+    errors++;
+  }
+  process_poll(&test_process);
+}
+/*---------------------------------------------------------------------------*/
+static clock_time_t small_elapsed, large_elapsed;
+static uint32_t small_packets, small_bytes;
+static unsigned small_messages;
+static int large_ok, fragments_ok, masked_ok, interleaved_ok, long_frame_ok;
+
+UNIT_TEST_REGISTER(ws_batched, "Small messages are echoed in order");
+UNIT_TEST(ws_batched)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("%u small messages: %lu ms, %lu messages/s, "
+         "%lu packets from the client, %lu bytes on air\n",
+         small_messages, (unsigned long)small_elapsed,
+         (unsigned long)(small_messages * CLOCK_SECOND /
+                         (small_elapsed ? small_elapsed : 1)),
+         (unsigned long)small_packets, (unsigned long)small_bytes);
+
+  UNIT_TEST_ASSERT(connected);
+  UNIT_TEST_ASSERT(small_messages == BATCHES * BATCH_SIZE);
+  UNIT_TEST_ASSERT(mismatches == 0);
+  /* Each batch leaves in a single segment */
+  UNIT_TEST_ASSERT(small_packets < small_messages / 2);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(ws_fragments, "Fragmented messages");
+UNIT_TEST(ws_fragments)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("%d byte message in %d byte fragments: %lu ms\n",
+         LARGE_LEN, WEBSOCKET_MAX_MSGLEN, (unsigned long)large_elapsed);
+
+  UNIT_TEST_ASSERT(large_ok);
+  UNIT_TEST_ASSERT(fragments_ok);
+  UNIT_TEST_ASSERT(interleaved_ok);
+  UNIT_TEST_ASSERT(pings == 1);
+  UNIT_TEST_ASSERT(strcmp(server_pong, "pp") == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(ws_frames, "Masked and long-length frames");
+UNIT_TEST(ws_frames)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(masked_ok);
+  UNIT_TEST_ASSERT(long_frame_ok);
+  UNIT_TEST_ASSERT(errors == 0);
+  UNIT_TEST_ASSERT(link_stats.drops == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static clock_time_t start;
+  static uint8_t large[LARGE_LEN];
+  static int i, j;
+  char str[16];
+  uip_ipaddr_t addr;
+  uip_lladdr_t lladdr = { { 0x02 } };
+
+  PROCESS_BEGIN();
+
+  uiplib_ip6addrconv(SERVER_ADDR, &addr);
+  uip_ds6_nbr_add(&addr, &lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_UNDEFINED, NULL);
+
+  link_emulator_set_delay(LINK_DELAY);
+  link_emulator_set_stats(&link_stats);
+  link_emulator_set_callback(count_client_packet);
+
+  tcp_socket_register(&server, NULL,
+                      server_in, sizeof(server_in),
+                      server_out, sizeof(server_out),
+                      server_input, NULL);
+  tcp_socket_listen(&server, PORT);
+
+  websocket_init(&client);
+  websocket_open(&client, SERVER_URL, "echo", NULL, callback);
+  etimer_set(&et, RUN_TIMEOUT);
+  PROCESS_WAIT_UNTIL(connected || etimer_expired(&et));
+
+  /* Small messages, a batch at a time */
+  expected_small = 0;
+  link_stats.bytes = 0;
+  client_packets = 0;
+  start = clock_time();
+  for(i = 0; i < BATCHES && !etimer_expired(&et); i++) {
+    for(j = 0; j < BATCH_SIZE; j++) {
+      snprintf(str, sizeof(str), "msg %03d", i * BATCH_SIZE + j);
+      websocket_send_str(&client, str);
+    }
+    PROCESS_WAIT_UNTIL(messages == (i + 1) * BATCH_SIZE ||
+                       etimer_expired(&et));
+  }
+  small_elapsed = clock_time() - start;
+  small_messages = messages;
+  small_packets = client_packets;
+  small_bytes = link_stats.bytes;
+  expected_small = -1;
+
+  /* A message larger than a frame */
+  for(i = 0; i < LARGE_LEN; i++) {
+    large[i] = i * 7;
+  }
+  messages = 0;
+  start = clock_time();
+  websocket_send(&client, large, LARGE_LEN);
+  PROCESS_WAIT_UNTIL(messages == 1 || etimer_expired(&et));
+  large_elapsed = clock_time() - start;
+  large_ok = received_len == LARGE_LEN &&
+    memcmp(received, large, LARGE_LEN) == 0;
+
+  /* A message sent in parts */
+  messages = 0;
+  websocket_send_fragment(&client, (const uint8_t *)"alpha ", 6, 1, 0);
+  websocket_send_fragment(&client, (const uint8_t *)"beta ", 5, 1, 0);
+  websocket_send_fragment(&client, (const uint8_t *)"gamma", 5, 1, 1);
+  PROCESS_WAIT_UNTIL(messages == 1 || etimer_expired(&et));
+  fragments_ok = received_len == 16 &&
+    memcmp(received, "alpha beta gamma", 16) == 0;
+
+  /* A ping between the fragments of a message */
+  messages = 0;
+  websocket_send_str(&client, "cmd:ping-fragments");
+  PROCESS_WAIT_UNTIL(messages == 1 || etimer_expired(&et));
+  interleaved_ok = received_len == 11 &&
+    memcmp(received, "part1-part2", 11) == 0;
+
+  /* A masked frame */
+  messages = 0;
+  websocket_send_str(&client, "cmd:masked");
+  PROCESS_WAIT_UNTIL(messages == 1 || etimer_expired(&et));
+  masked_ok = received_len == 12 &&
+    memcmp(received, "masked hello", 12) == 0;
+
+  /* A frame with a 64-bit length */
+  messages = 0;
+  websocket_send_str(&client, "cmd:long-length");
+  PROCESS_WAIT_UNTIL(messages == 1 || etimer_expired(&et));
+  long_frame_ok = received_len == LONG_FRAME_LEN;
+  for(i = 0; i < received_len; i++) {
+    long_frame_ok &= received[i] == (uint8_t)i;
+  }
+
+  /* Let the pong reach the server */
+  etimer_set(&et, CLOCK_SECOND / 10);
+  PROCESS_WAIT_UNTIL(etimer_expired(&et));
+
+  websocket_close(&client);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(ws_batched);
+  UNIT_TEST_RUN(ws_fragments);
+  UNIT_TEST_RUN(ws_frames);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Checks that LwM2M reads served from serialization templates match
+ *   fully encoded reads, and a measurement of the encode time per
+ *   notification with and without a template.
+ */
+
+#include "contiki.h"
+#include "coap-engine.h"
+#include "lwm2m-engine.h"
+#include "lwm2m-object.h"
+#include "unit-test.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define OBJECT_ID      3303
+#define BENCH_NOTIFIES 2000
+#define CHECK_ROUNDS   200
+/*---------------------------------------------------------------------------*/
+/* A temperature sensor with the resources of the IPSO object */
+typedef struct {
+  lwm2m_object_instance_t reg;
+  int32_t value;
+  int32_t min;
+  int32_t max;
+  int32_t samples;
+  int high;
+  char units[8];
+} sensor_t;
+
+static const lwm2m_resource_id_t resources[] = {
+  RO(5700), RO(5601), RO(5602), RO(5603), RO(5604), RO(5701),
+  RO(5750), RO(5800), RO(5850), EX(5605)
+};
+
+static unsigned callbacks;
+
+static lwm2m_status_t
+sensor_callback(lwm2m_object_instance_t *object, lwm2m_context_t *ctx)
+{
+  sensor_t *s = (sensor_t *)object;
+
+  callbacks++;
+  if(ctx->operation != LWM2M_OP_READ) {
+    return LWM2M_STATUS_OPERATION_NOT_ALLOWED;
+  }
+  switch(ctx->resource_id) {
+  case 5700:
+    lwm2m_object_write_float32fix(ctx, s->value, 10);
+    break;
+  case 5601:
+    lwm2m_object_write_float32fix(ctx, s->min, 10);
+    break;
+  case 5602:
+    lwm2m_object_write_float32fix(ctx, s->max, 10);
+    break;
+  case 5603:
+    lwm2m_object_write_float32fix(ctx, -40 << 10, 10);
+    break;
+  case 5604:
+    lwm2m_object_write_float32fix(ctx, 125 << 10, 10);
+    break;
+  case 5701:
+    lwm2m_object_write_string(ctx, s->units, strlen(s->units));
+    break;
+  case 5750:
+    lwm2m_object_write_string(ctx, "room \"A\"", 8);
+    break;
+  case 5800:
+    lwm2m_object_write_int(ctx, s->samples);
+    break;
+  case 5850:
+    lwm2m_object_write_boolean(ctx, s->high);
+    break;
+  default:
+    return LWM2M_STATUS_NOT_FOUND;
+  }
+  return LWM2M_STATUS_OK;
+}
+
+static sensor_t sensors[2];
+
+static void
+sensor_init(sensor_t *s, uint16_t instance_id)
+{
+  memset(s, 0, sizeof(*s));
+  s->reg.object_id = OBJECT_ID;
+  s->reg.instance_id = instance_id;
+  s->reg.resource_ids = resources;
+  s->reg.resource_count = sizeof(resources) / sizeof(resources[0]);
+  s->reg.callback = sensor_callback;
+  s->value = 21 << 10;
+  s->min = s->max = s->value;
+  strcpy(s->units, "Cel");
+  lwm2m_engine_add_object(&s->reg);
+}
+/* A new sample - only the value, its counter and perhaps min/max change */
+static void
+sensor_sample(sensor_t *s, int32_t value)
+{
+  s->value = value;
+  s->samples++;
+  lwm2m_notify_object_observers(&s->reg, 5700);
+  lwm2m_notify_object_observers(&s->reg, 5800);
+  if(value < s->min) {
+    s->min = value;
+    lwm2m_notify_object_observers(&s->reg, 5601);
+  }
+  if(value > s->max) {
+    s->max = value;
+    lwm2m_notify_object_observers(&s->reg, 5602);
+  }
+  if(s->high != (value > (30 << 10))) {
+    s->high = !s->high;
+    lwm2m_notify_object_observers(&s->reg, 5850);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t payload[COAP_MAX_BLOCK_SIZE];
+static uint16_t payload_len;
+
+static int
+read_instance(uint16_t instance_id, unsigned int accept)
+{
+  coap_message_t request[1];
+  coap_message_t response[1];
+  char path[16];
+  int32_t offset = 0;
+  const uint8_t *data;
+
+  snprintf(path, sizeof(path), "%u/%u", OBJECT_ID, instance_id);
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_set_header_uri_path(request, path);
+  coap_set_header_accept(request, accept);
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, 0);
+  if(coap_call_handlers(request, response, payload, sizeof(payload),
+                        &offset) != COAP_HANDLER_STATUS_PROCESSED ||
+     response->code != CONTENT_2_05 || offset != -1) {
+    return 0;
+  }
+  payload_len = coap_get_payload(response, &data);
+  return data == payload;
+}
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/* Some changes in value length on the way */
+static int32_t
+sample_value(int i)
+{
+  return ((i * 37) % 900 - 300) << 6;
+}
+/*---------------------------------------------------------------------------*/
+static int
+check_format(unsigned int accept)
+{
+  static uint8_t expected[COAP_MAX_BLOCK_SIZE];
+  uint16_t expected_len;
+  int i;
+
+  for(i = 0; i < CHECK_ROUNDS; i++) {
+    sensor_sample(&sensors[0], sample_value(i));
+    if(i % 50 == 7) {
+      strcpy(sensors[0].units, i % 100 == 7 ? "degrees" : "K");
+      lwm2m_engine_resource_changed(&sensors[0].reg, 5701);
+    }
+
+    callbacks = 0;
+    if(!read_instance(0, accept)) {
+      return 0;
+    }
+    /* The first read builds the template, the rest re-encode the
+       changed resources only */
+    if(i > 0 && callbacks > 5) {
+      printf("read %d: %u callbacks\n", i, callbacks);
+      return 0;
+    }
+    memcpy(expected, payload, payload_len);
+    expected_len = payload_len;
+
+    /* Binding again makes the next read encode everything */
+    lwm2m_engine_use_template(&sensors[0].reg);
+    if(!read_instance(0, accept) || payload_len != expected_len ||
+       memcmp(payload, expected, expected_len) != 0) {
+      printf("read %d: template differs\n", i);
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static uint64_t
+bench_format(uint16_t instance_id, unsigned int accept)
+{
+  uint64_t start;
+  int i;
+
+  read_instance(instance_id, accept);
+  start = now_ns();
+  for(i = 0; i < BENCH_NOTIFIES; i++) {
+    sensor_sample(&sensors[instance_id], sample_value(i));
+    if(!read_instance(instance_id, accept)) {
+      return 0;
+    }
+  }
+  return (now_ns() - start) / BENCH_NOTIFIES;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(template_tlv, "TLV from template");
+UNIT_TEST(template_tlv)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(lwm2m_engine_use_template(&sensors[0].reg));
+  UNIT_TEST_ASSERT(check_format(LWM2M_TLV));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(template_json, "JSON from template");
+UNIT_TEST(template_json)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The template follows the requested format */
+  UNIT_TEST_ASSERT(check_format(LWM2M_JSON));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(template_invalidate, "Template rebuilt after changes");
+UNIT_TEST(template_invalidate)
+{
+  coap_message_t request[1];
+  coap_message_t response[1];
+  uint8_t buffer[16];
+  int32_t offset = 0;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(read_instance(0, LWM2M_TLV));
+
+  /* An execute on the instance rebuilds the template from the nine
+     readable resources */
+  coap_init_message(request, COAP_TYPE_CON, COAP_POST, 0);
+  coap_set_header_uri_path(request, "3303/0/5605");
+  coap_init_message(response, COAP_TYPE_ACK, CHANGED_2_04, 0);
+  coap_call_handlers(request, response, buffer, sizeof(buffer), &offset);
+  callbacks = 0;
+  UNIT_TEST_ASSERT(read_instance(0, LWM2M_TLV));
+  UNIT_TEST_ASSERT(callbacks == 9);
+
+  /* Nothing changed - no callbacks at all */
+  callbacks = 0;
+  UNIT_TEST_ASSERT(read_instance(0, LWM2M_TLV));
+  UNIT_TEST_ASSERT(callbacks == 0);
+
+  /* A change that is not reported is not seen until the next rebuild */
+  sensors[0].samples = 1000;
+  callbacks = 0;
+  UNIT_TEST_ASSERT(read_instance(0, LWM2M_TLV));
+  UNIT_TEST_ASSERT(callbacks == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(template_bench, "Encode time per notification");
+UNIT_TEST(template_bench)
+{
+  uint64_t full_tlv, full_json, tmpl_tlv, tmpl_json;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(lwm2m_engine_use_template(&sensors[0].reg));
+  full_tlv = bench_format(1, LWM2M_TLV);
+  tmpl_tlv = bench_format(0, LWM2M_TLV);
+  full_json = bench_format(1, LWM2M_JSON);
+  tmpl_json = bench_format(0, LWM2M_JSON);
+
+  printf("TLV:  %6lu ns/notification encoded, %6lu ns from template\n",
+         (unsigned long)full_tlv, (unsigned long)tmpl_tlv);
+  printf("JSON: %6lu ns/notification encoded, %6lu ns from template\n",
+         (unsigned long)full_json, (unsigned long)tmpl_json);
+
+  UNIT_TEST_ASSERT(full_tlv > 0 && tmpl_tlv > 0);
+  UNIT_TEST_ASSERT(full_json > 0 && tmpl_json > 0);
+  UNIT_TEST_ASSERT(tmpl_tlv < full_tlv);
+  UNIT_TEST_ASSERT(tmpl_json < full_json);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  lwm2m_engine_init();
+  sensor_init(&sensors[0], 0);
+  sensor_init(&sensors[1], 1);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(template_tlv);
+  UNIT_TEST_RUN(template_json);
+  UNIT_TEST_RUN(template_invalidate);
+  UNIT_TEST_RUN(template_bench);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
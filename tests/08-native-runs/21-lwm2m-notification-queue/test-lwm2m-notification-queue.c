@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Checks for the LwM2M queue mode notification queue: coalescing per
+ *   observed instance, duplicate paths and priorities, and a measurement
+ *   of what a wake-up sends.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "coap-engine.h"
+#include "coap-observe.h"
+#include "lwm2m-engine.h"
+#include "lwm2m-object.h"
+#include "lwm2m-notification-queue.h"
+#include "unit-test.h"
+#include "capture-driver.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define SENSOR_ID     3303
+#define ALARM_ID      3338
+#define SENSORS       4
+#define MAX_PACKETS   32
+#define WAKEUPS       50
+/*---------------------------------------------------------------------------*/
+/* Records the token of every outgoing notification */
+static unsigned packets;
+static unsigned bytes;
+static uint8_t tokens[MAX_PACKETS];
+static uint8_t last_packet[UIP_BUFSIZE];
+static uint16_t last_len;
+
+static void
+capture_packet(void)
+{
+  coap_message_t message[1];
+
+  if(UIP_IP_BUF->proto != UIP_PROTO_UDP) {
+    return;
+  }
+  last_len = uip_len - UIP_IPUDPH_LEN;
+  memcpy(last_packet, uip_buf + UIP_IPUDPH_LEN, last_len);
+  if(packets < MAX_PACKETS &&
+     coap_parse_message(message, last_packet, last_len) == NO_ERROR) {
+    tokens[packets] = message->token[0];
+  }
+  packets++;
+  bytes += uip_len;
+}
+/*---------------------------------------------------------------------------*/
+static const uint16_t sensor_ids[] = { 5700, 5601, 5602, 5800 };
+static const lwm2m_resource_id_t sensor_resources[] = {
+  RO(5700), RO(5601), RO(5602), RO(5800)
+};
+static const lwm2m_resource_id_t alarm_resources[] = { RO(5500) };
+
+static lwm2m_status_t
+object_callback(lwm2m_object_instance_t *object, lwm2m_context_t *ctx)
+{
+  if(ctx->operation != LWM2M_OP_READ) {
+    return LWM2M_STATUS_OPERATION_NOT_ALLOWED;
+  }
+  if(ctx->resource_id == 5500) {
+    lwm2m_object_write_boolean(ctx, 1);
+  } else {
+    lwm2m_object_write_int(ctx, ctx->resource_id + object->instance_id);
+  }
+  return LWM2M_STATUS_OK;
+}
+
+static lwm2m_object_instance_t sensors[SENSORS];
+static lwm2m_object_instance_t alarm;
+
+static void
+object_init(lwm2m_object_instance_t *o, uint16_t object_id,
+            uint16_t instance_id, const lwm2m_resource_id_t *resources,
+            uint16_t count)
+{
+  o->object_id = object_id;
+  o->instance_id = instance_id;
+  o->resource_ids = resources;
+  o->resource_count = count;
+  o->callback = object_callback;
+  lwm2m_engine_add_object(o);
+}
+/*---------------------------------------------------------------------------*/
+static coap_endpoint_t server;
+
+/* The token is the observer's number in the checks */
+static void
+observe(const char *path, uint8_t token)
+{
+  coap_message_t request[1];
+  coap_message_t response[1];
+
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_set_header_uri_path(request, path);
+  coap_set_header_observe(request, 0);
+  coap_set_token(request, &token, 1);
+  coap_set_src_endpoint(request, &server);
+  coap_init_message(response, COAP_TYPE_ACK, CONTENT_2_05, 0);
+  coap_observe_handler(NULL, request, response);
+}
+static void
+remove_observers(void)
+{
+  coap_remove_observer_by_client(&server);
+}
+/* The resources of a sample - queued again and again while asleep */
+static void
+queue_samples(int instances, int rounds)
+{
+  int i, j, r;
+
+  for(r = 0; r < rounds; r++) {
+    for(i = 0; i < instances; i++) {
+      for(j = 0; j < 4; j++) {
+        lwm2m_notification_queue_add_notification_path(SENSOR_ID, i,
+                                                        sensor_ids[j]);
+      }
+    }
+  }
+}
+static int
+contains(const uint8_t *data, int len, const char *str)
+{
+  int i, n = strlen(str);
+  for(i = 0; i + n <= len; i++) {
+    if(memcmp(&data[i], str, n) == 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+static void
+reset_capture(void)
+{
+  packets = 0;
+  bytes = 0;
+  memset(tokens, 0xff, sizeof(tokens));
+}
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(queue_coalesce, "One notification per observed instance");
+UNIT_TEST(queue_coalesce)
+{
+  coap_message_t message[1];
+  const uint8_t *payload;
+  int len;
+
+  UNIT_TEST_BEGIN();
+
+  remove_observers();
+  observe("3303/0", 0);
+  observe("3303/1", 1);
+  observe("3303/2", 2);
+
+  reset_capture();
+  queue_samples(3, 5);
+  lwm2m_notification_queue_send_notifications();
+
+  UNIT_TEST_ASSERT(packets == 3);
+  UNIT_TEST_ASSERT(tokens[0] == 0 && tokens[1] == 1 && tokens[2] == 2);
+
+  /* The last one holds all the resources of instance 2 */
+  UNIT_TEST_ASSERT(coap_parse_message(message, last_packet, last_len) == NO_ERROR);
+  len = coap_get_payload(message, &payload);
+  UNIT_TEST_ASSERT(len > 0);
+  UNIT_TEST_ASSERT(contains(payload, len, "\"n\":\"5700\",\"v\":5702"));
+  UNIT_TEST_ASSERT(contains(payload, len, "\"n\":\"5800\",\"v\":5802"));
+
+  /* The queue is empty afterwards */
+  reset_capture();
+  lwm2m_notification_queue_send_notifications();
+  UNIT_TEST_ASSERT(packets == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(queue_resources, "Resource observers are notified per resource");
+UNIT_TEST(queue_resources)
+{
+  UNIT_TEST_BEGIN();
+
+  remove_observers();
+  observe("3303/0/5700", 0);
+  observe("3303/0/5800", 1);
+  observe("3303/1", 2);
+
+  reset_capture();
+  queue_samples(2, 3);
+  lwm2m_notification_queue_send_notifications();
+
+  /* The instance observer does not get the resource notifications of
+     instance 0, and the resource observers not the instance one */
+  UNIT_TEST_ASSERT(packets == 3);
+  UNIT_TEST_ASSERT(tokens[0] == 0 && tokens[1] == 1 && tokens[2] == 2);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(queue_priority, "Higher priorities are sent first");
+UNIT_TEST(queue_priority)
+{
+  UNIT_TEST_BEGIN();
+
+  remove_observers();
+  observe("3303/0", 0);
+  observe("3303/1", 1);
+  observe("3303/3/5800", 3);
+  observe("3338/0/5500", 9);
+
+  /* The queue is full with low priority paths; the alarm replaces the
+     last one */
+  reset_capture();
+  queue_samples(SENSORS, 1);
+  lwm2m_notification_queue_add_notification_path(ALARM_ID, 0, 5500);
+  lwm2m_notification_queue_send_notifications();
+
+  UNIT_TEST_ASSERT(packets == 3);
+  UNIT_TEST_ASSERT(tokens[0] == 9);
+  UNIT_TEST_ASSERT(tokens[1] == 0 && tokens[2] == 1);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(queue_observed, "Observed paths match whole segments");
+UNIT_TEST(queue_observed)
+{
+  UNIT_TEST_BEGIN();
+
+  remove_observers();
+  observe("3303/0", 0);
+
+  UNIT_TEST_ASSERT(coap_has_observers("3303"));
+  UNIT_TEST_ASSERT(coap_has_observers("3303/0"));
+  UNIT_TEST_ASSERT(!coap_has_observers("3"));
+  UNIT_TEST_ASSERT(!coap_has_observers("330"));
+  UNIT_TEST_ASSERT(!coap_has_observers("3303/1"));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(queue_bench, "What a wake-up sends");
+UNIT_TEST(queue_bench)
+{
+  unsigned resource_packets, resource_bytes;
+  unsigned instance_packets, instance_bytes;
+  uint64_t start, resource_ns, instance_ns, add_ns;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* The server observes every resource of three sensors */
+  remove_observers();
+  for(i = 0; i < 12; i++) {
+    char path[16];
+    snprintf(path, sizeof(path), "3303/%d/%u", i / 4,
+             sensor_ids[i % 4]);
+    observe(path, i);
+  }
+  reset_capture();
+  start = now_ns();
+  for(i = 0; i < WAKEUPS; i++) {
+    queue_samples(3, 4);
+    lwm2m_notification_queue_send_notifications();
+  }
+  resource_ns = (now_ns() - start) / WAKEUPS;
+  resource_packets = packets / WAKEUPS;
+  resource_bytes = bytes / WAKEUPS;
+
+  /* The server observes the three sensor instances */
+  remove_observers();
+  observe("3303/0", 0);
+  observe("3303/1", 1);
+  observe("3303/2", 2);
+  reset_capture();
+  start = now_ns();
+  for(i = 0; i < WAKEUPS; i++) {
+    queue_samples(3, 4);
+    lwm2m_notification_queue_send_notifications();
+  }
+  instance_ns = (now_ns() - start) / WAKEUPS;
+  instance_packets = packets / WAKEUPS;
+  instance_bytes = bytes / WAKEUPS;
+
+  /* Queueing a path that is already pending */
+  queue_samples(3, 1);
+  start = now_ns();
+  queue_samples(3, 100);
+  add_ns = (now_ns() - start) / 1200;
+  lwm2m_notification_queue_send_notifications();
+
+  printf("resource observers: %2u notifications, %4u bytes, %6lu ns per wake-up\n",
+         resource_packets, resource_bytes, (unsigned long)(resource_ns));
+  printf("instance observers: %2u notifications, %4u bytes, %6lu ns per wake-up\n",
+         instance_packets, instance_bytes, (unsigned long)(instance_ns));
+  printf("queueing a pending path: %lu ns\n", (unsigned long)add_ns);
+
+  UNIT_TEST_ASSERT(resource_packets == 12);
+  UNIT_TEST_ASSERT(instance_packets == 3);
+  UNIT_TEST_ASSERT(instance_bytes < resource_bytes);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  capture_set_callback(capture_packet);
+
+  uip_ip6addr(&server.ipaddr, 0xff02, 0, 0, 0, 0, 0, 0, 1);
+  server.port = UIP_HTONS(5683);
+
+  lwm2m_engine_init();
+  for(i = 0; i < SENSORS; i++) {
+    object_init(&sensors[i], SENSOR_ID, i, sensor_resources,
+                sizeof(sensor_resources) / sizeof(sensor_resources[0]));
+  }
+  object_init(&alarm, ALARM_ID, 0, alarm_resources, 1);
+  lwm2m_notification_queue_init();
+  lwm2m_notification_queue_set_priority(ALARM_ID, 1);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(queue_coalesce);
+  UNIT_TEST_RUN(queue_resources);
+  UNIT_TEST_RUN(queue_priority);
+  UNIT_TEST_RUN(queue_observed);
+  UNIT_TEST_RUN(queue_bench);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Checks that Antelope relations read and written through the page
+ *   buffers of the storage layer keep their contents, and measures
+ *   the insertion and scan rates on the cfs-posix backend.
+ */
+
+#include "contiki.h"
+#include "antelope.h"
+#include "unit-test.h"
+#include <stdio.h>
+#include <time.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define BULK_ROWS    4000
+#define QUERY_ROWS   200
+#define TOTAL_ROWS   (BULK_ROWS + QUERY_ROWS)
+#define COPY_ROWS    100
+#define REMOVED_ROWS 1000
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+rows_per_second(unsigned long rows, uint64_t ns)
+{
+  return ns == 0 ? 0 : (unsigned long)(rows * 1000000000ULL / ns);
+}
+/*---------------------------------------------------------------------------*/
+static long
+sample_value(long id)
+{
+  return id * 3 + 100000;
+}
+/*---------------------------------------------------------------------------*/
+static db_result_t
+run_query(const char *query)
+{
+  db_handle_t handle;
+  db_result_t result;
+
+  result = db_query(&handle, query);
+  if(!DB_ERROR(result) && db_processing(&handle)) {
+    do {
+      result = db_process(&handle);
+    } while(!DB_ERROR(result) && result != DB_FINISHED);
+    db_free(&handle);
+  }
+  return DB_ERROR(result) ? result : DB_OK;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Select all rows of a relation in order, checking that each holds the
+ * sample for its ID. Returns the number of rows, or -1 on mismatch.
+ */
+static long
+scan_samples(const char *relation, long first_id)
+{
+  db_handle_t handle;
+  db_result_t result;
+  attribute_value_t id;
+  attribute_value_t value;
+  long rows;
+
+  if(DB_ERROR(db_query(&handle, "SELECT id, value FROM %s;", relation))) {
+    return -1;
+  }
+
+  for(rows = 0;; rows++) {
+    result = db_process(&handle);
+    if(result == DB_FINISHED) {
+      break;
+    }
+    if(result != DB_GOT_ROW ||
+       DB_ERROR(db_get_value(&id, &handle, 0)) ||
+       DB_ERROR(db_get_value(&value, &handle, 1)) ||
+       db_value_to_long(&id) != first_id + rows ||
+       db_value_to_long(&value) != sample_value(first_id + rows)) {
+      rows = -1;
+      break;
+    }
+  }
+
+  db_free(&handle);
+  return rows;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(antelope_insert, "Insert rows");
+UNIT_TEST(antelope_insert)
+{
+  relation_t *rel;
+  attribute_value_t values[2];
+  uint64_t start;
+  uint64_t bulk_ns;
+  uint64_t query_ns;
+  long i;
+  int ok;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(!DB_ERROR(run_query("CREATE RELATION samples;")));
+  UNIT_TEST_ASSERT(!DB_ERROR(run_query(
+    "CREATE ATTRIBUTE id DOMAIN INT IN samples;")));
+  UNIT_TEST_ASSERT(!DB_ERROR(run_query(
+    "CREATE ATTRIBUTE value DOMAIN LONG IN samples;")));
+
+  /* Rows inserted into a loaded relation are appended a page at a time. */
+  rel = relation_load("samples");
+  UNIT_TEST_ASSERT(rel != NULL);
+
+  values[0].domain = DOMAIN_INT;
+  values[1].domain = DOMAIN_LONG;
+
+  ok = 1;
+  start = now_ns();
+  for(i = 0; i < BULK_ROWS; i++) {
+    VALUE_INT(&values[0]) = i;
+    VALUE_LONG(&values[1]) = sample_value(i);
+    if(DB_ERROR(relation_insert(rel, values))) {
+      ok = 0;
+      break;
+    }
+  }
+  relation_release(rel);
+  bulk_ns = now_ns() - start;
+  UNIT_TEST_ASSERT(ok);
+
+  /* Each INSERT query loads and releases the relation. */
+  start = now_ns();
+  for(i = BULK_ROWS; i < TOTAL_ROWS; i++) {
+    if(DB_ERROR(db_query(NULL, "INSERT (%ld, %ld) INTO samples;",
+                         i, sample_value(i)))) {
+      ok = 0;
+      break;
+    }
+  }
+  query_ns = now_ns() - start;
+  UNIT_TEST_ASSERT(ok);
+
+  printf("insert: %7lu rows/s loaded, %7lu rows/s by INSERT query\n",
+         rows_per_second(BULK_ROWS, bulk_ns),
+         rows_per_second(QUERY_ROWS, query_ns));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(antelope_scan, "Scan rows");
+UNIT_TEST(antelope_scan)
+{
+  uint64_t start;
+  uint64_t scan_ns;
+  long rows;
+
+  UNIT_TEST_BEGIN();
+
+  start = now_ns();
+  rows = scan_samples("samples", 0);
+  scan_ns = now_ns() - start;
+  UNIT_TEST_ASSERT(rows == TOTAL_ROWS);
+
+  printf("scan:   %7lu rows/s\n", rows_per_second(rows, scan_ns));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(antelope_assign, "Rows of an assigned result");
+UNIT_TEST(antelope_assign)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The result relation is written while the source is scanned. */
+  UNIT_TEST_ASSERT(!DB_ERROR(run_query(
+    "copy <- SELECT id, value FROM samples WHERE id < 100;")));
+  UNIT_TEST_ASSERT(scan_samples("copy", 0) == COPY_ROWS);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(antelope_remove, "Rows left after a removal");
+UNIT_TEST(antelope_remove)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(!DB_ERROR(run_query(
+    "REMOVE FROM samples WHERE id < 1000;")));
+  UNIT_TEST_ASSERT(scan_samples("samples", REMOVED_ROWS) ==
+                   TOTAL_ROWS - REMOVED_ROWS);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  db_init();
+  run_query("REMOVE RELATION samples;");
+  run_query("REMOVE RELATION copy;");
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(antelope_insert);
+  UNIT_TEST_RUN(antelope_scan);
+  UNIT_TEST_RUN(antelope_assign);
+  UNIT_TEST_RUN(antelope_remove);
+
+  run_query("REMOVE RELATION samples;");
+  run_query("REMOVE RELATION copy;");
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,378 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Checks range queries on a B+-tree index over unsorted keys, and
+ *   compares the range query time with that of the other index types.
+ */
+
+#include "contiki.h"
+#include "antelope.h"
+#include "cfs/cfs.h"
+#include "unit-test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define ROWS          2000
+#define KEY_STEP      7
+#define KEY_SPREAD    1009
+#define KEY_LIMIT     (KEY_SPREAD * KEY_STEP)
+#define QUERIES       50
+#define NARROW_RANGE  20
+#define WIDE_RANGE    (KEY_LIMIT / 20)
+/*---------------------------------------------------------------------------*/
+struct sample {
+  long key;
+  long id;
+};
+
+static struct sample sorted_samples[ROWS];
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+/* Unsorted keys, each of which occurs about twice. */
+static long
+key_of(long id)
+{
+  return (id * 7919 % KEY_SPREAD) * KEY_STEP;
+}
+/*---------------------------------------------------------------------------*/
+static long
+expected_rows(long min, long max)
+{
+  long i;
+  long count;
+
+  for(i = count = 0; i < ROWS; i++) {
+    if(key_of(i) >= min && key_of(i) <= max) {
+      count++;
+    }
+  }
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+static int
+compare_samples(const void *a, const void *b)
+{
+  const struct sample *sa = a;
+  const struct sample *sb = b;
+
+  if(sa->key != sb->key) {
+    return sa->key < sb->key ? -1 : 1;
+  }
+  return sa->id < sb->id ? -1 : sa->id > sb->id;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_samples(const char *relation)
+{
+  char filename[INDEX_NAME_LENGTH];
+
+  /* The index catalog of a relation is not removed with it. Remove it
+     first, so that the indexes of an old relation are not loaded. */
+  snprintf(filename, sizeof(filename), "%s%s", relation, INDEX_NAME_SUFFIX);
+  cfs_remove(filename);
+
+  db_query(NULL, "REMOVE RELATION %s;", relation);
+}
+/*---------------------------------------------------------------------------*/
+static int
+create_samples(const char *relation, const char *index_type, int sorted)
+{
+  relation_t *rel;
+  attribute_value_t values[2];
+  long i;
+  int ok;
+
+  if(DB_ERROR(db_query(NULL, "CREATE RELATION %s;", relation)) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE id DOMAIN LONG IN %s;",
+                       relation)) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE key DOMAIN LONG IN %s;",
+                       relation))) {
+    return 0;
+  }
+
+  if(index_type != NULL &&
+     DB_ERROR(db_query(NULL, "CREATE INDEX %s.key TYPE %s;",
+                       relation, index_type))) {
+    return 0;
+  }
+
+  rel = relation_load((char *)relation);
+  if(rel == NULL) {
+    return 0;
+  }
+
+  values[0].domain = values[1].domain = DOMAIN_LONG;
+  for(i = 0, ok = 1; ok && i < ROWS; i++) {
+    if(sorted) {
+      VALUE_LONG(&values[0]) = sorted_samples[i].id;
+      VALUE_LONG(&values[1]) = sorted_samples[i].key;
+    } else {
+      VALUE_LONG(&values[0]) = i;
+      VALUE_LONG(&values[1]) = key_of(i);
+    }
+    ok = !DB_ERROR(relation_insert(rel, values));
+  }
+
+  relation_release(rel);
+  return ok;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the number of rows in the key range, or -1 on error. */
+static long
+select_range(const char *relation, long min, long max)
+{
+  db_handle_t handle;
+  db_result_t result;
+  attribute_value_t key;
+  long rows;
+
+  if(DB_ERROR(db_query(&handle,
+                       "SELECT key FROM %s WHERE key >= %ld AND key <= %ld;",
+                       relation, min, max))) {
+    return -1;
+  }
+
+  for(rows = 0;;) {
+    result = db_process(&handle);
+    if(result == DB_FINISHED) {
+      break;
+    } else if(result == DB_GOT_ROW) {
+      if(DB_ERROR(db_get_value(&key, &handle, 0)) ||
+         db_value_to_long(&key) < min || db_value_to_long(&key) > max) {
+        rows = -1;
+        break;
+      }
+      rows++;
+    } else if(result != DB_OK) {
+      rows = -1;
+      break;
+    }
+  }
+
+  db_free(&handle);
+  return rows;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Microseconds per range query of the given width. The number of rows
+ * found in all queries, and the number expected, are added to the
+ * counters.
+ */
+static unsigned long
+bench_range(const char *relation, long width, long *found, long *expected)
+{
+  uint64_t start;
+  long min;
+  long rows;
+  int i;
+
+  start = now_ns();
+  for(i = 0; i < QUERIES; i++) {
+    min = (long)i * (KEY_LIMIT - width) / QUERIES;
+    rows = select_range(relation, min, min + width - 1);
+    if(rows > 0) {
+      *found += rows;
+    }
+    *expected += expected_rows(min, min + width - 1);
+  }
+  return (unsigned long)((now_ns() - start) / QUERIES / 1000);
+}
+/*---------------------------------------------------------------------------*/
+/* Checks the entries found by the index iterator for a key range. */
+static int
+check_index_range(index_t *index, relation_t *rel, long min, long max)
+{
+  index_iterator_t iterator;
+  attribute_value_t min_value;
+  attribute_value_t max_value;
+  tuple_id_t tuple_id;
+  long previous_key;
+  long count;
+
+  min_value.domain = max_value.domain = DOMAIN_LONG;
+  VALUE_LONG(&min_value) = min;
+  VALUE_LONG(&max_value) = max;
+
+  if(DB_ERROR(index_get_iterator(&iterator, index, &min_value, &max_value))) {
+    return 0;
+  }
+
+  previous_key = min;
+  for(count = 0;
+      (tuple_id = index_get_next(&iterator)) != INVALID_TUPLE;
+      count++) {
+    /* The iterator returns the tuples in key order. */
+    if(tuple_id >= ROWS || key_of(tuple_id) < previous_key ||
+       key_of(tuple_id) > max) {
+      return 0;
+    }
+    previous_key = key_of(tuple_id);
+  }
+
+  return count == expected_rows(min, max);
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(btree_ranges, "B+-tree range iteration");
+UNIT_TEST(btree_ranges)
+{
+  relation_t *rel;
+  attribute_t *attr;
+  long min;
+  int ok;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(create_samples("bt", "BTREE", 0));
+
+  rel = relation_load("bt");
+  UNIT_TEST_ASSERT(rel != NULL);
+  attr = relation_attribute_get(rel, "key");
+  UNIT_TEST_ASSERT(attr != NULL && attr->index != NULL);
+  UNIT_TEST_ASSERT(((index_t *)attr->index)->type == INDEX_BTREE);
+
+  for(min = 0, ok = 1; ok && min < KEY_LIMIT; min += WIDE_RANGE / 3) {
+    ok = check_index_range(attr->index, rel, min, min + WIDE_RANGE);
+  }
+  UNIT_TEST_ASSERT(ok);
+
+  /* Equal keys, and ranges outside the key space. */
+  UNIT_TEST_ASSERT(check_index_range(attr->index, rel, 700, 700));
+  UNIT_TEST_ASSERT(check_index_range(attr->index, rel, 701, 701));
+  UNIT_TEST_ASSERT(check_index_range(attr->index, rel, KEY_LIMIT, 2 * KEY_LIMIT));
+  UNIT_TEST_ASSERT(check_index_range(attr->index, rel, 0, KEY_LIMIT));
+
+  /* The tree is found in storage again after it has been released. */
+  UNIT_TEST_ASSERT(!DB_ERROR(index_release(attr->index)));
+  UNIT_TEST_ASSERT(!DB_ERROR(index_load(rel, attr)));
+  UNIT_TEST_ASSERT(check_index_range(attr->index, rel, 1000, 3000));
+
+  relation_release(rel);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(btree_select, "Range SELECT through the B+-tree");
+UNIT_TEST(btree_select)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(select_range("bt", 350, 1400) == expected_rows(350, 1400));
+  UNIT_TEST_ASSERT(select_range("bt", 0, KEY_LIMIT) == ROWS);
+
+  /* Rows inserted by a query are indexed too. */
+  UNIT_TEST_ASSERT(!DB_ERROR(db_query(NULL, "INSERT (%ld, %ld) INTO bt;",
+                                      (long)ROWS, (long)KEY_LIMIT + 5)));
+  UNIT_TEST_ASSERT(select_range("bt", KEY_LIMIT, KEY_LIMIT + 10) == 1);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(btree_bench, "Range query time per index type");
+UNIT_TEST(btree_bench)
+{
+  static const char *relations[] = { "plain", "sorted", "heap", "bt" };
+  static const char *names[] = {
+    "no index", "inline (sorted rows)", "maxheap", "B+-tree"
+  };
+  unsigned long narrow;
+  unsigned long wide;
+  long found;
+  long expected;
+  long i;
+  int r;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < ROWS; i++) {
+    sorted_samples[i].key = key_of(i);
+    sorted_samples[i].id = i;
+  }
+  qsort(sorted_samples, ROWS, sizeof(sorted_samples[0]), compare_samples);
+
+  /* The row inserted into the B+-tree relation by a query is outside
+     of the benchmarked ranges. */
+  UNIT_TEST_ASSERT(create_samples("plain", NULL, 0));
+  UNIT_TEST_ASSERT(create_samples("sorted", "INLINE", 1));
+  UNIT_TEST_ASSERT(create_samples("heap", "MAXHEAP", 0));
+
+  printf("%d rows, %d queries per range width\n", ROWS, QUERIES);
+  for(r = 0; r < sizeof(relations) / sizeof(relations[0]); r++) {
+    found = expected = 0;
+    narrow = bench_range(relations[r], NARROW_RANGE, &found, &expected);
+    wide = bench_range(relations[r], WIDE_RANGE, &found, &expected);
+    printf("%-22s %6lu us/query (%d keys), %6lu us/query (%d keys), "
+           "%ld/%ld rows\n", names[r], narrow, NARROW_RANGE, wide, WIDE_RANGE,
+           found, expected);
+    if(r == 0 || r == 3) {
+      /* Full scans and the B+-tree return exact results. */
+      UNIT_TEST_ASSERT(found == expected);
+    }
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  db_init();
+  remove_samples("bt");
+  remove_samples("plain");
+  remove_samples("sorted");
+  remove_samples("heap");
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(btree_ranges);
+  UNIT_TEST_RUN(btree_select);
+  UNIT_TEST_RUN(btree_bench);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Checks that compiled predicates select the same rows as the LVM
+ *   bytecode interpreter, that derived ranges are pushed into index
+ *   searches, and compares the evaluation time of both.
+ */
+
+#include "contiki.h"
+#include "antelope.h"
+#include "cfs/cfs.h"
+#include "lvm.h"
+#include "unit-test.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define ROWS          4000
+#define BENCH_ROUNDS  5
+/*---------------------------------------------------------------------------*/
+struct predicate {
+  const char *condition;
+  int (*match)(long a, long b, long c, long d);
+  int indexed;
+};
+
+static int
+match_ranges(long a, long b, long c, long d)
+{
+  return a > 100 && (b < 250 && c != 3);
+}
+
+static int
+match_disjunction(long a, long b, long c, long d)
+{
+  return b == 7 || (a >= 200 && a < 300);
+}
+
+static int
+match_inequality(long a, long b, long c, long d)
+{
+  return c != 2 && d > 5000;
+}
+
+static int
+match_arithmetic(long a, long b, long c, long d)
+{
+  return a + b > 900 && c <= 4;
+}
+
+static int
+match_mirrored(long a, long b, long c, long d)
+{
+  return 500 > a && (10 <= b - c && 3 != c);
+}
+
+static int
+match_division(long a, long b, long c, long d)
+{
+  /* Rows for which the division fails are not selected. */
+  return c != 0 && a / c > 100;
+}
+
+static int
+match_constant(long a, long b, long c, long d)
+{
+  return a < 50 && 2 * 3 == 6;
+}
+
+/* AQL groups a chain of connectives from the right, without precedence. */
+static const struct predicate predicates[] = {
+  { "a > 100 AND b < 250 AND c <> 3", match_ranges, 1 },
+  { "b = 7 OR a >= 200 AND a < 300", match_disjunction, 0 },
+  { "c <> 2 AND d > 5000", match_inequality, 0 },
+  { "a + b > 900 AND c <= 4", match_arithmetic, 0 },
+  { "500 > a AND 10 <= b - c AND 3 <> c", match_mirrored, 1 },
+  { "a / c > 100", match_division, 0 },
+  { "a < 50 AND 2 * 3 = 6", match_constant, 1 },
+};
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static long
+value_a(long id)
+{
+  return id * 37 % 1000;
+}
+
+static long
+value_b(long id)
+{
+  return id * 13 % 500;
+}
+
+static long
+value_c(long id)
+{
+  return id % 7;
+}
+
+static long
+value_d(long id)
+{
+  return id * 101 % 100000;
+}
+/*---------------------------------------------------------------------------*/
+static int
+matches(const struct predicate *predicate, long id)
+{
+  return predicate->match(value_a(id), value_b(id), value_c(id), value_d(id));
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_samples(const char *relation)
+{
+  char filename[INDEX_NAME_LENGTH];
+
+  /* The index catalog of a relation is not removed with it. */
+  snprintf(filename, sizeof(filename), "%s%s", relation, INDEX_NAME_SUFFIX);
+  cfs_remove(filename);
+
+  db_query(NULL, "REMOVE RELATION %s;", relation);
+}
+/*---------------------------------------------------------------------------*/
+static int
+create_samples(const char *relation, int indexed)
+{
+  relation_t *rel;
+  attribute_value_t values[5];
+  long i;
+  int ok;
+
+  if(DB_ERROR(db_query(NULL, "CREATE RELATION %s;", relation)) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE id DOMAIN LONG IN %s;",
+                       relation)) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE a DOMAIN INT IN %s;",
+                       relation)) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE b DOMAIN INT IN %s;",
+                       relation)) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE c DOMAIN INT IN %s;",
+                       relation)) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE d DOMAIN LONG IN %s;",
+                       relation))) {
+    return 0;
+  }
+
+  if(indexed &&
+     DB_ERROR(db_query(NULL, "CREATE INDEX %s.a TYPE BTREE;", relation))) {
+    return 0;
+  }
+
+  rel = relation_load((char *)relation);
+  if(rel == NULL) {
+    return 0;
+  }
+
+  values[0].domain = values[4].domain = DOMAIN_LONG;
+  values[1].domain = values[2].domain = values[3].domain = DOMAIN_INT;
+  for(i = 0, ok = 1; ok && i < ROWS; i++) {
+    VALUE_LONG(&values[0]) = i;
+    VALUE_INT(&values[1]) = value_a(i);
+    VALUE_INT(&values[2]) = value_b(i);
+    VALUE_INT(&values[3]) = value_c(i);
+    VALUE_LONG(&values[4]) = value_d(i);
+    ok = !DB_ERROR(relation_insert(rel, values));
+  }
+
+  relation_release(rel);
+  return ok;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Selects the rows matching the predicate, and returns their number if
+ * every row matches and none is missing, or -1 otherwise. The bytecode
+ * interpreter is used if the compiled predicate is discarded.
+ */
+static long
+select_rows(const char *relation, const struct predicate *predicate,
+            int interpret, int *indexed)
+{
+  static uint8_t selected[ROWS];
+  db_handle_t handle;
+  db_result_t result;
+  attribute_value_t id;
+  lvm_instance_t *lvm_instance;
+  long rows;
+  long i;
+
+  if(DB_ERROR(db_query(&handle, "SELECT id FROM %s WHERE %s;",
+                       relation, predicate->condition))) {
+    return -1;
+  }
+
+  lvm_instance = ((aql_adt_t *)handle.adt)->lvm_instance;
+  if(interpret) {
+    lvm_instance->program_size = 0;
+  } else if(!LVM_IS_COMPILED(lvm_instance)) {
+    db_free(&handle);
+    return -1;
+  }
+  if(indexed != NULL) {
+    *indexed = (handle.flags & DB_HANDLE_FLAG_SEARCH_INDEX) != 0;
+  }
+
+  memset(selected, 0, sizeof(selected));
+  for(rows = 0;;) {
+    result = db_process(&handle);
+    if(result == DB_FINISHED) {
+      break;
+    } else if(result == DB_GOT_ROW) {
+      if(DB_ERROR(db_get_value(&id, &handle, 0))) {
+        rows = -1;
+        break;
+      }
+      i = db_value_to_long(&id);
+      if(i < 0 || i >= ROWS || selected[i] || !matches(predicate, i)) {
+        rows = -1;
+        break;
+      }
+      selected[i] = 1;
+      rows++;
+    } else if(result != DB_OK) {
+      rows = -1;
+      break;
+    }
+  }
+  db_free(&handle);
+
+  for(i = 0; rows >= 0 && i < ROWS; i++) {
+    if(!selected[i] && matches(predicate, i)) {
+      rows = -1;
+    }
+  }
+  return rows;
+}
+/*---------------------------------------------------------------------------*/
+/* Nanoseconds per row for selecting with the predicate. */
+static unsigned long
+bench_select(const char *relation, const struct predicate *predicate,
+             int interpret)
+{
+  uint64_t start;
+  int i;
+
+  start = now_ns();
+  for(i = 0; i < BENCH_ROUNDS; i++) {
+    if(select_rows(relation, predicate, interpret, NULL) < 0) {
+      return 0;
+    }
+  }
+  return (unsigned long)((now_ns() - start) / BENCH_ROUNDS / ROWS);
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(compiled_rows, "Compiled predicates select the same rows");
+UNIT_TEST(compiled_rows)
+{
+  long compiled;
+  long interpreted;
+  int i;
+  int ok;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(create_samples("plain", 0));
+
+  for(i = 0, ok = 1; i < sizeof(predicates) / sizeof(predicates[0]); i++) {
+    compiled = select_rows("plain", &predicates[i], 0, NULL);
+    interpreted = select_rows("plain", &predicates[i], 1, NULL);
+    if(compiled < 0 || compiled != interpreted) {
+      printf("\"%s\": %ld rows compiled, %ld rows interpreted\n",
+             predicates[i].condition, compiled, interpreted);
+      ok = 0;
+    }
+  }
+  UNIT_TEST_ASSERT(ok);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(index_pushdown, "Derived ranges are searched in indexes");
+UNIT_TEST(index_pushdown)
+{
+  int indexed;
+  int i;
+  int ok;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(create_samples("keyed", 1));
+
+  for(i = 0, ok = 1; i < sizeof(predicates) / sizeof(predicates[0]); i++) {
+    if(select_rows("keyed", &predicates[i], 0, &indexed) < 0 ||
+       indexed != predicates[i].indexed) {
+      printf("\"%s\": index search %s\n", predicates[i].condition,
+             indexed ? "used" : "not used");
+      ok = 0;
+    }
+  }
+  UNIT_TEST_ASSERT(ok);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(predicate_bench, "Predicate evaluation time");
+UNIT_TEST(predicate_bench)
+{
+  unsigned long compiled;
+  unsigned long interpreted;
+  unsigned long indexed;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  printf("%d rows, ns/row: interpreted, compiled, compiled with index\n",
+         ROWS);
+  for(i = 0; i < sizeof(predicates) / sizeof(predicates[0]); i++) {
+    interpreted = bench_select("plain", &predicates[i], 1);
+    compiled = bench_select("plain", &predicates[i], 0);
+    indexed = bench_select("keyed", &predicates[i], 0);
+    printf("%-36s %5lu %5lu %5lu\n", predicates[i].condition,
+           interpreted, compiled, indexed);
+    UNIT_TEST_ASSERT(interpreted > 0 && compiled > 0 && indexed > 0);
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  db_init();
+  remove_samples("plain");
+  remove_samples("keyed");
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(compiled_rows);
+  UNIT_TEST_RUN(index_pushdown);
+  UNIT_TEST_RUN(predicate_bench);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,482 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Checks that joins on attributes without an index are computed by a
+ *   hash join with the same result as an index join, that aggregates
+ *   are computed per group with GROUP BY, and compares their speed.
+ */
+
+#include "contiki.h"
+#include "antelope.h"
+#include "cfs/cfs.h"
+#include "unit-test.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+/* Readings of devices that are not in the device relations are not joined. */
+#define READINGS      4000
+#define DEVICES       60
+#define UNKNOWN       10
+#define PHASES        12
+#define BENCH_ROUNDS  5
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static long
+reading_device(long time)
+{
+  return time * 13 % (DEVICES + UNKNOWN);
+}
+
+static long
+reading_value(long time)
+{
+  return time * 37 % 1000;
+}
+
+static long
+reading_phase(long time)
+{
+  return time % PHASES;
+}
+
+static long
+device_kind(long device)
+{
+  return device * 11 % 5;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_relation(const char *relation)
+{
+  char filename[INDEX_NAME_LENGTH];
+
+  /* The index catalog of a relation is not removed with it. */
+  snprintf(filename, sizeof(filename), "%s%s", relation, INDEX_NAME_SUFFIX);
+  cfs_remove(filename);
+
+  db_query(NULL, "REMOVE RELATION %s;", relation);
+}
+/*---------------------------------------------------------------------------*/
+static int
+create_readings(void)
+{
+  relation_t *rel;
+  attribute_value_t values[4];
+  long i;
+  int ok;
+
+  if(DB_ERROR(db_query(NULL, "CREATE RELATION readings;")) ||
+     DB_ERROR(db_query(NULL,
+                       "CREATE ATTRIBUTE time DOMAIN LONG IN readings;")) ||
+     DB_ERROR(db_query(NULL,
+                       "CREATE ATTRIBUTE device DOMAIN INT IN readings;")) ||
+     DB_ERROR(db_query(NULL,
+                       "CREATE ATTRIBUTE value DOMAIN INT IN readings;")) ||
+     DB_ERROR(db_query(NULL,
+                       "CREATE ATTRIBUTE phase DOMAIN INT IN readings;"))) {
+    return 0;
+  }
+
+  rel = relation_load("readings");
+  if(rel == NULL) {
+    return 0;
+  }
+
+  values[0].domain = DOMAIN_LONG;
+  values[1].domain = values[2].domain = values[3].domain = DOMAIN_INT;
+  for(i = 0, ok = 1; ok && i < READINGS; i++) {
+    VALUE_LONG(&values[0]) = i;
+    VALUE_INT(&values[1]) = reading_device(i);
+    VALUE_INT(&values[2]) = reading_value(i);
+    VALUE_INT(&values[3]) = reading_phase(i);
+    ok = !DB_ERROR(relation_insert(rel, values));
+  }
+
+  relation_release(rel);
+  return ok;
+}
+/*---------------------------------------------------------------------------*/
+static int
+create_devices(const char *relation, int indexed)
+{
+  relation_t *rel;
+  attribute_value_t values[2];
+  long i;
+  int ok;
+
+  if(DB_ERROR(db_query(NULL, "CREATE RELATION %s;", relation)) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE device DOMAIN INT IN %s;",
+                       relation)) ||
+     DB_ERROR(db_query(NULL, "CREATE ATTRIBUTE kind DOMAIN INT IN %s;",
+                       relation))) {
+    return 0;
+  }
+
+  if(indexed &&
+     DB_ERROR(db_query(NULL, "CREATE INDEX %s.device TYPE BTREE;",
+                       relation))) {
+    return 0;
+  }
+
+  rel = relation_load((char *)relation);
+  if(rel == NULL) {
+    return 0;
+  }
+
+  /* Insert in descending order so that the join order differs from
+     the order of the device relation. */
+  values[0].domain = values[1].domain = DOMAIN_INT;
+  for(i = DEVICES - 1, ok = 1; ok && i >= 0; i--) {
+    VALUE_INT(&values[0]) = i;
+    VALUE_INT(&values[1]) = device_kind(i);
+    ok = !DB_ERROR(relation_insert(rel, values));
+  }
+
+  relation_release(rel);
+  return ok;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Joins the readings with a device relation, and returns the number of
+ * joined rows if every reading of a known device is joined once with
+ * the kind of its device, or -1 otherwise.
+ */
+static long
+join_rows(const char *left, const char *right, int *hashed)
+{
+  static uint8_t joined[READINGS];
+  db_handle_t handle;
+  db_result_t result;
+  attribute_value_t time;
+  attribute_value_t kind;
+  long rows;
+  long i;
+
+  if(DB_ERROR(db_query(&handle, "JOIN %s, %s ON device PROJECT time, kind;",
+                       left, right))) {
+    return -1;
+  }
+  if(hashed != NULL) {
+    *hashed = (handle.flags & DB_HANDLE_FLAG_HASH_JOIN) != 0;
+  }
+
+  memset(joined, 0, sizeof(joined));
+  for(rows = 0;;) {
+    result = db_process(&handle);
+    if(result == DB_FINISHED) {
+      break;
+    } else if(result == DB_GOT_ROW) {
+      if(DB_ERROR(db_get_value(&time, &handle, 0)) ||
+         DB_ERROR(db_get_value(&kind, &handle, 1))) {
+        rows = -1;
+        break;
+      }
+      i = db_value_to_long(&time);
+      if(i < 0 || i >= READINGS || joined[i] ||
+         reading_device(i) >= DEVICES ||
+         db_value_to_long(&kind) != device_kind(reading_device(i))) {
+        rows = -1;
+        break;
+      }
+      joined[i] = 1;
+      rows++;
+    } else if(result != DB_OK) {
+      rows = -1;
+      break;
+    }
+  }
+  db_free(&handle);
+
+  for(i = 0; rows >= 0 && i < READINGS; i++) {
+    if(!joined[i] && reading_device(i) < DEVICES) {
+      rows = -1;
+    }
+  }
+  return rows;
+}
+/*---------------------------------------------------------------------------*/
+/* Nanoseconds per joined row. */
+static unsigned long
+bench_join(const char *left, const char *right)
+{
+  uint64_t start;
+  long rows;
+  int i;
+
+  start = now_ns();
+  for(i = 0, rows = 0; i < BENCH_ROUNDS; i++) {
+    rows = join_rows(left, right, NULL);
+    if(rows <= 0) {
+      return 0;
+    }
+  }
+  return (unsigned long)((now_ns() - start) / BENCH_ROUNDS / rows);
+}
+/*---------------------------------------------------------------------------*/
+struct phase {
+  long count;
+  long max;
+  long sum;
+};
+
+static struct phase phases[PHASES];
+
+static void
+compute_phases(void)
+{
+  long i;
+  struct phase *phase;
+
+  memset(phases, 0, sizeof(phases));
+  for(i = 0; i < READINGS; i++) {
+    phase = &phases[reading_phase(i)];
+    phase->count++;
+    phase->sum += reading_value(i);
+    if(reading_value(i) > phase->max) {
+      phase->max = reading_value(i);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Returns the number of groups if the aggregates of each phase match
+ * the values computed from the samples, or -1 otherwise.
+ */
+static long
+select_phases(void)
+{
+  static uint8_t seen[PHASES];
+  db_handle_t handle;
+  db_result_t result;
+  attribute_value_t values[5];
+  struct phase *phase;
+  long rows;
+  long key;
+  int i;
+
+  if(DB_ERROR(db_query(&handle,
+                       "SELECT phase, COUNT(value), MAX(value), SUM(value), "
+                       "MEAN(value) FROM readings GROUP BY phase;"))) {
+    return -1;
+  }
+
+  memset(seen, 0, sizeof(seen));
+  for(rows = 0;;) {
+    result = db_process(&handle);
+    if(result == DB_FINISHED) {
+      break;
+    } else if(result == DB_GOT_ROW) {
+      for(i = 0; i < 5; i++) {
+        if(DB_ERROR(db_get_value(&values[i], &handle, i))) {
+          rows = -1;
+          break;
+        }
+      }
+      if(rows < 0) {
+        break;
+      }
+      key = db_value_to_long(&values[0]);
+      if(key < 0 || key >= PHASES || seen[key]) {
+        rows = -1;
+        break;
+      }
+      seen[key] = 1;
+      phase = &phases[key];
+      if(db_value_to_long(&values[1]) != phase->count ||
+         db_value_to_long(&values[2]) != phase->max ||
+         db_value_to_long(&values[3]) != phase->sum ||
+         db_value_to_long(&values[4]) != phase->sum / phase->count) {
+        rows = -1;
+        break;
+      }
+      rows++;
+    } else if(result != DB_OK) {
+      rows = -1;
+      break;
+    }
+  }
+  db_free(&handle);
+
+  return rows;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the result of processing the query until it fails or finishes. */
+static db_result_t
+process_query(const char *query, long *rows, long *first_value)
+{
+  db_handle_t handle;
+  db_result_t result;
+  attribute_value_t value;
+
+  *rows = 0;
+  result = db_query(&handle, query);
+  while(!DB_ERROR(result) && result != DB_FINISHED) {
+    result = db_process(&handle);
+    if(result == DB_GOT_ROW) {
+      if(*rows == 0 && !DB_ERROR(db_get_value(&value, &handle, 0))) {
+        *first_value = db_value_to_long(&value);
+      }
+      (*rows)++;
+    }
+  }
+  db_free(&handle);
+
+  return result;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(hash_join, "Joins without an index use a hash join");
+UNIT_TEST(hash_join)
+{
+  long expected;
+  long i;
+  int hashed;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(create_readings());
+  UNIT_TEST_ASSERT(create_devices("devices", 0));
+  UNIT_TEST_ASSERT(create_devices("keyed", 1));
+
+  for(i = expected = 0; i < READINGS; i++) {
+    expected += reading_device(i) < DEVICES;
+  }
+
+  /* The devices do not fit in one hash table, so that the readings
+     are scanned several times. */
+  UNIT_TEST_ASSERT(DEVICES > DB_HASH_JOIN_ROWS);
+  UNIT_TEST_ASSERT(join_rows("readings", "devices", &hashed) == expected);
+  UNIT_TEST_ASSERT(hashed);
+  UNIT_TEST_ASSERT(join_rows("devices", "readings", &hashed) == expected);
+  UNIT_TEST_ASSERT(hashed);
+  UNIT_TEST_ASSERT(join_rows("readings", "keyed", &hashed) == expected);
+  UNIT_TEST_ASSERT(!hashed);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(group_by, "Aggregates are computed per group");
+UNIT_TEST(group_by)
+{
+  long rows;
+  long value;
+
+  UNIT_TEST_BEGIN();
+
+  compute_phases();
+  UNIT_TEST_ASSERT(select_phases() == PHASES);
+
+  /* The attribute to group by does not have to be selected. */
+  UNIT_TEST_ASSERT(process_query("SELECT COUNT(value) FROM readings "
+                                 "GROUP BY phase;",
+                                 &rows, &value) == DB_FINISHED);
+  UNIT_TEST_ASSERT(rows == PHASES && value == phases[0].count);
+
+  /* Without GROUP BY, there is one result even if no row is selected. */
+  UNIT_TEST_ASSERT(process_query("SELECT COUNT(value) FROM readings "
+                                 "WHERE value > 5000;",
+                                 &rows, &value) == DB_FINISHED);
+  UNIT_TEST_ASSERT(rows == 1 && value == 0);
+
+  /* There are more devices than groups. */
+  UNIT_TEST_ASSERT(DEVICES + UNKNOWN > DB_GROUP_LIMIT);
+  UNIT_TEST_ASSERT(process_query("SELECT device, COUNT(value) FROM readings "
+                                 "GROUP BY device;",
+                                 &rows, &value) == DB_LIMIT_ERROR);
+
+  /* The attribute to group by must be in the relation. */
+  UNIT_TEST_ASSERT(DB_ERROR(process_query("SELECT COUNT(value) FROM readings "
+                                          "GROUP BY kind;",
+                                          &rows, &value)));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(join_bench, "Join and aggregation time");
+UNIT_TEST(join_bench)
+{
+  unsigned long hashed;
+  unsigned long indexed;
+  uint64_t start;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  hashed = bench_join("readings", "devices");
+  indexed = bench_join("readings", "keyed");
+  printf("%d readings, %d devices, ns/joined row: hash join %lu, "
+         "index join %lu\n", READINGS, DEVICES, hashed, indexed);
+  UNIT_TEST_ASSERT(hashed > 0 && indexed > 0);
+
+  start = now_ns();
+  for(i = 0; i < BENCH_ROUNDS; i++) {
+    UNIT_TEST_ASSERT(select_phases() == PHASES);
+  }
+  printf("%d readings, %d groups, ns/row: %lu\n", READINGS, PHASES,
+         (unsigned long)((now_ns() - start) / BENCH_ROUNDS / READINGS));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  db_init();
+  remove_relation("readings");
+  remove_relation("devices");
+  remove_relation("keyed");
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(hash_join);
+  UNIT_TEST_RUN(group_by);
+  UNIT_TEST_RUN(join_bench);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Checks the run time, queue wait time and call counts recorded by
+ *   the process profiler, and measures its overhead per call.
+ */
+
+#include "contiki.h"
+#include "unit-test.h"
+#include <stdio.h>
+#include <time.h>
+
+#include "sys/log.h"
+#define LOG_MODULE "Test"
+#define LOG_LEVEL LOG_LEVEL_INFO
+
+PROCESS(test_process, "test");
+PROCESS(busy_process, "busy");
+PROCESS(caller_process, "caller");
+AUTOSTART_PROCESSES(&test_process);
+
+/* The number of calls of each kind */
+#define CALLS        20
+/* The time that the busy process runs for each event, in microseconds */
+#define BUSY_US      200
+#define BENCH_CALLS  100000
+
+static process_event_t busy_event;
+static process_event_t done_event;
+static unsigned busy_events;
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+busy_wait(void)
+{
+  uint64_t end;
+
+  end = now_ns() + BUSY_US * 1000ULL;
+  while(now_ns() < end);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(busy_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD();
+    if(ev == busy_event || ev == PROCESS_EVENT_POLL) {
+      busy_wait();
+      if(++busy_events % CALLS == 0) {
+        process_post(&test_process, done_event, NULL);
+      }
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(caller_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD();
+    if(ev == busy_event) {
+      /* The time of the busy process is not accounted to the caller. */
+      process_post_synch(&busy_process, busy_event, NULL);
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+to_us(uint64_t time)
+{
+  return process_profile_to_us(time);
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(run_time, "Run time is accounted per process");
+UNIT_TEST(run_time)
+{
+  struct process_profile *busy;
+  struct process_profile *caller;
+
+  UNIT_TEST_BEGIN();
+
+  busy = &busy_process.profile;
+  caller = &caller_process.profile;
+
+  /* Each kind of call is made CALLS times, once all events were
+     delivered to the busy process either directly, through the caller
+     or as polls. */
+  UNIT_TEST_ASSERT(busy->calls == 3 * CALLS);
+  UNIT_TEST_ASSERT(busy->dispatches == 2 * CALLS);
+  UNIT_TEST_ASSERT(caller->calls == CALLS);
+  UNIT_TEST_ASSERT(caller->dispatches == CALLS);
+
+  UNIT_TEST_ASSERT(to_us(busy->run_time) >= 3 * CALLS * BUSY_US);
+  UNIT_TEST_ASSERT(to_us(busy->max_run_time) >= BUSY_US);
+  UNIT_TEST_ASSERT(to_us(caller->run_time) < CALLS * BUSY_US / 4);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(wait_time, "Queue wait time is accounted per process");
+UNIT_TEST(wait_time)
+{
+  struct process_profile *busy;
+
+  UNIT_TEST_BEGIN();
+
+  busy = &busy_process.profile;
+
+  /* The events were queued at once, so that the last one waited for
+     the busy process to handle all others. */
+  UNIT_TEST_ASSERT(to_us(busy->max_wait_time) >= (CALLS - 1) * BUSY_US);
+  UNIT_TEST_ASSERT(to_us(busy->wait_time) >=
+                   (CALLS - 1) * CALLS / 2 * BUSY_US);
+  UNIT_TEST_ASSERT(busy->max_wait_time <= busy->wait_time);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(event_types, "Events are counted per type");
+UNIT_TEST(event_types)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(process_profile_event_count(PROCESS_EVENT_POLL -
+                                               PROCESS_EVENT_NONE) >= CALLS);
+  /* The allocated events */
+  UNIT_TEST_ASSERT(process_profile_event_count(PROCESS_PROFILE_EVENT_TYPES - 1)
+                   >= 3 * CALLS);
+  UNIT_TEST_ASSERT(process_profile_event_count(PROCESS_PROFILE_EVENT_TYPES)
+                   == 0);
+
+  process_profile_log();
+  process_profile_reset();
+  UNIT_TEST_ASSERT(busy_process.profile.calls == 0);
+  UNIT_TEST_ASSERT(process_profile_event_count(PROCESS_EVENT_POLL -
+                                               PROCESS_EVENT_NONE) == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(overhead, "Profiler overhead per call");
+UNIT_TEST(overhead)
+{
+  struct process_profile_call call;
+  uint64_t start;
+  unsigned long ns;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  start = now_ns();
+  for(i = 0; i < BENCH_CALLS; i++) {
+    process_profile_begin(&call);
+    process_profile_end(&busy_process, PROCESS_EVENT_CONTINUE, &call);
+  }
+  ns = (unsigned long)((now_ns() - start) / BENCH_CALLS);
+  printf("Profiler overhead: %lu ns per call\n", ns);
+
+  UNIT_TEST_ASSERT(busy_process.profile.calls == BENCH_CALLS);
+  process_profile_reset();
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static int i;
+
+  PROCESS_BEGIN();
+
+  busy_event = process_alloc_event();
+  done_event = process_alloc_event();
+  process_start(&busy_process, NULL);
+  process_start(&caller_process, NULL);
+  process_profile_reset();
+
+  for(i = 0; i < CALLS; i++) {
+    process_post(&busy_process, busy_event, NULL);
+  }
+  PROCESS_WAIT_EVENT_UNTIL(ev == done_event);
+
+  for(i = 0; i < CALLS; i++) {
+    process_post(&caller_process, busy_event, NULL);
+  }
+  PROCESS_WAIT_EVENT_UNTIL(ev == done_event);
+
+  for(i = 0; i < CALLS; i++) {
+    process_poll(&busy_process);
+    PROCESS_PAUSE();
+  }
+  PROCESS_WAIT_EVENT_UNTIL(ev == done_event);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(run_time);
+  UNIT_TEST_RUN(wait_time);
+  UNIT_TEST_RUN(event_types);
+  UNIT_TEST_RUN(overhead);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Checks that energest attributes radio time to the tag of the frame
+ *   being sent and CPU time to the tag of the running process, and that
+ *   IPv6 packets are tagged by the subsystem that sends them.
+ */
+
+#include "contiki.h"
+#include "sys/energest.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uipbuf.h"
+#include "net/ipv6/uip-icmp6.h"
+#include "unit-test.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+PROCESS(test_process, "test");
+PROCESS(app_process, "app");
+PROCESS(helper_process, "helper");
+AUTOSTART_PROCESSES(&test_process);
+
+/* Busy times in milliseconds, a multiple of the energest resolution */
+#define SHORT_MS      20
+#define LONG_MS       40
+/* Tolerance of the time comparisons in energest ticks */
+#define SLACK         (ENERGEST_SECOND / 200)
+#define BENCH_CALLS   100000
+
+static process_event_t work_event;
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+busy_wait(unsigned ms)
+{
+  uint64_t end;
+
+  end = now_ns() + ms * 1000000ULL;
+  while(now_ns() < end);
+}
+/*---------------------------------------------------------------------------*/
+static uint64_t
+ms_to_energest(unsigned ms)
+{
+  return (uint64_t)ms * ENERGEST_SECOND / 1000;
+}
+/*---------------------------------------------------------------------------*/
+static int
+about(uint64_t time, unsigned ms)
+{
+  return time + SLACK >= ms_to_energest(ms) &&
+    time <= ms_to_energest(ms) + SLACK;
+}
+/*---------------------------------------------------------------------------*/
+/* Whether the time of a type is the sum of the time of its tags */
+static int
+tags_add_up(energest_type_t type)
+{
+  uint64_t sum;
+  int tag;
+
+  energest_flush();
+  for(sum = 0, tag = 0; tag < ENERGEST_TAG_MAX; tag++) {
+    sum += energest_tag_time(tag, type);
+  }
+  return sum == energest_type_time(type);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(helper_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD();
+    if(ev == work_event) {
+      busy_wait(SHORT_MS);
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(app_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD();
+    if(ev == work_event) {
+      busy_wait(LONG_MS);
+      /* The helper has no tag, and works on behalf of the application. */
+      process_post_synch(&helper_process, work_event, NULL);
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_packet(uint8_t proto, uint8_t icmp_type, uint16_t srcport,
+            uint16_t destport)
+{
+  uint16_t payload_len;
+
+  uipbuf_clear();
+  memset(uip_buf, 0, UIP_IPUDPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = proto;
+  UIP_IP_BUF->ttl = 64;
+
+  if(proto == UIP_PROTO_ICMP6) {
+    UIP_ICMP_BUF->type = icmp_type;
+    payload_len = UIP_ICMPH_LEN;
+  } else {
+    UIP_UDP_BUF->srcport = UIP_HTONS(srcport);
+    UIP_UDP_BUF->destport = UIP_HTONS(destport);
+    payload_len = UIP_UDPH_LEN;
+  }
+  uipbuf_set_len_field(UIP_IP_BUF, payload_len);
+  uip_len = UIP_IPH_LEN + payload_len;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(radio_tags, "Radio time is attributed to frame tags");
+UNIT_TEST(radio_tags)
+{
+  uint64_t routing;
+  uint64_t coap;
+  uint64_t other;
+
+  UNIT_TEST_BEGIN();
+
+  energest_flush();
+  routing = energest_tag_time(ENERGEST_TAG_ROUTING, ENERGEST_TYPE_TRANSMIT);
+  coap = energest_tag_time(ENERGEST_TAG_COAP, ENERGEST_TYPE_TRANSMIT);
+  other = energest_tag_time(ENERGEST_TAG_OTHER, ENERGEST_TYPE_LISTEN);
+
+  /* A tag that changes during a transmission splits its time. */
+  ENERGEST_TAG_RADIO(ENERGEST_TAG_ROUTING);
+  ENERGEST_ON(ENERGEST_TYPE_TRANSMIT);
+  busy_wait(SHORT_MS);
+  ENERGEST_TAG_RADIO(ENERGEST_TAG_COAP);
+  busy_wait(LONG_MS);
+  ENERGEST_SWITCH(ENERGEST_TYPE_TRANSMIT, ENERGEST_TYPE_LISTEN);
+  ENERGEST_TAG_RADIO(ENERGEST_TAG_OTHER);
+  busy_wait(SHORT_MS);
+  ENERGEST_OFF(ENERGEST_TYPE_LISTEN);
+
+  UNIT_TEST_ASSERT(about(energest_tag_time(ENERGEST_TAG_ROUTING,
+                                           ENERGEST_TYPE_TRANSMIT) - routing,
+                         SHORT_MS));
+  UNIT_TEST_ASSERT(about(energest_tag_time(ENERGEST_TAG_COAP,
+                                           ENERGEST_TYPE_TRANSMIT) - coap,
+                         LONG_MS));
+  UNIT_TEST_ASSERT(about(energest_tag_time(ENERGEST_TAG_OTHER,
+                                           ENERGEST_TYPE_LISTEN) - other,
+                         SHORT_MS));
+  UNIT_TEST_ASSERT(tags_add_up(ENERGEST_TYPE_TRANSMIT));
+  UNIT_TEST_ASSERT(tags_add_up(ENERGEST_TYPE_LISTEN));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(cpu_tags, "CPU time is attributed to process tags");
+UNIT_TEST(cpu_tags)
+{
+  uint64_t app;
+
+  UNIT_TEST_BEGIN();
+
+  energest_flush();
+  app = energest_tag_time(ENERGEST_TAG_APP, ENERGEST_TYPE_CPU);
+
+  process_post_synch(&app_process, work_event, NULL);
+  energest_flush();
+
+  UNIT_TEST_ASSERT(about(energest_tag_time(ENERGEST_TAG_APP,
+                                           ENERGEST_TYPE_CPU) - app,
+                         LONG_MS + SHORT_MS));
+  /* The tag of the caller is restored. */
+  UNIT_TEST_ASSERT(energest_current_tag[ENERGEST_TYPE_CPU] ==
+                   ENERGEST_TAG_OTHER);
+  UNIT_TEST_ASSERT(tags_add_up(ENERGEST_TYPE_CPU));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(packet_tags, "IPv6 packets are tagged by subsystem");
+UNIT_TEST(packet_tags)
+{
+  energest_tag_t caller;
+
+  UNIT_TEST_BEGIN();
+
+  make_packet(UIP_PROTO_ICMP6, ICMP6_RPL, 0, 0);
+  UNIT_TEST_ASSERT(uipbuf_energest_tag() == ENERGEST_TAG_ROUTING);
+  make_packet(UIP_PROTO_ICMP6, ICMP6_NS, 0, 0);
+  UNIT_TEST_ASSERT(uipbuf_energest_tag() == ENERGEST_TAG_ND);
+  make_packet(UIP_PROTO_ICMP6, ICMP6_RA, 0, 0);
+  UNIT_TEST_ASSERT(uipbuf_energest_tag() == ENERGEST_TAG_ND);
+  make_packet(UIP_PROTO_UDP, 0, 40000, 5683);
+  UNIT_TEST_ASSERT(uipbuf_energest_tag() == ENERGEST_TAG_COAP);
+  make_packet(UIP_PROTO_UDP, 0, 5684, 40000);
+  UNIT_TEST_ASSERT(uipbuf_energest_tag() == ENERGEST_TAG_COAP);
+
+  /* Other packets have the tag of the running process, if any. */
+  make_packet(UIP_PROTO_ICMP6, ICMP6_ECHO_REQUEST, 0, 0);
+  UNIT_TEST_ASSERT(uipbuf_energest_tag() == ENERGEST_TAG_APP);
+  make_packet(UIP_PROTO_UDP, 0, 40000, 40001);
+  UNIT_TEST_ASSERT(uipbuf_energest_tag() == ENERGEST_TAG_APP);
+  caller = energest_tag_set(ENERGEST_TYPE_CPU, ENERGEST_TAG_MAC);
+  UNIT_TEST_ASSERT(uipbuf_energest_tag() == ENERGEST_TAG_MAC);
+  energest_tag_set(ENERGEST_TYPE_CPU, caller);
+
+  uipbuf_clear();
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(tag_names, "Tags have printable names");
+UNIT_TEST(tag_names)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(strcmp(energest_tag_name(ENERGEST_TAG_OTHER),
+                          "other") == 0);
+  UNIT_TEST_ASSERT(strcmp(energest_tag_name(ENERGEST_TAG_APP), "app") == 0);
+  UNIT_TEST_ASSERT(strcmp(energest_tag_name(ENERGEST_TAG_NAMED),
+                          "named") == 0);
+  UNIT_TEST_ASSERT(strcmp(energest_tag_name(ENERGEST_TAG_UNNAMED),
+                          "7") == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(tag_overhead, "Tag switching overhead");
+UNIT_TEST(tag_overhead)
+{
+  uint64_t start;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  start = now_ns();
+  for(i = 0; i < BENCH_CALLS; i++) {
+    energest_tag_set(ENERGEST_TYPE_CPU, ENERGEST_TAG_APP);
+    energest_tag_set(ENERGEST_TYPE_CPU, ENERGEST_TAG_OTHER);
+  }
+  printf("Tag switch: %lu ns\n",
+         (unsigned long)((now_ns() - start) / BENCH_CALLS / 2));
+  UNIT_TEST_ASSERT(tags_add_up(ENERGEST_TYPE_CPU));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  work_event = process_alloc_event();
+  ENERGEST_TAG_PROCESS(&app_process, ENERGEST_TAG_APP);
+  process_start(&app_process, NULL);
+  process_start(&helper_process, NULL);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(radio_tags);
+  UNIT_TEST_RUN(cpu_tags);
+  UNIT_TEST_RUN(packet_tags);
+  UNIT_TEST_RUN(tag_names);
+  UNIT_TEST_RUN(tag_overhead);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Checks that deferred logging prints the same messages as immediate
+ *   logging, after the call and with copies of the arguments, and that
+ *   it drops messages when its queue is full.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uiplib.h"
+#include "unit-test.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "sys/log.h"
+#define LOG_MODULE "Test"
+#define LOG_LEVEL LOG_LEVEL_INFO
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define BENCH_ROUNDS  1000
+/* The number of records that the queue holds */
+#define CAPACITY      (LOG_DEFERRED_QUEUE_LEN - 1)
+
+static char output[1024];
+static size_t output_len;
+static enum { PASS, CAPTURE, DISCARD } output_mode;
+/*---------------------------------------------------------------------------*/
+int
+test_log_output(const char *fmt, ...)
+{
+  va_list ap;
+  int n;
+
+  va_start(ap, fmt);
+  if(output_mode == PASS) {
+    n = vprintf(fmt, ap);
+  } else if(output_mode == CAPTURE) {
+    n = vsnprintf(output + output_len, sizeof(output) - output_len, fmt, ap);
+    if(n > 0) {
+      output_len = MIN(output_len + n, sizeof(output) - 1);
+    }
+  } else {
+    n = 0;
+  }
+  va_end(ap);
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static void
+capture(void)
+{
+  log_deferred_flush();
+  output_len = 0;
+  output[0] = '\0';
+  output_mode = CAPTURE;
+}
+/*---------------------------------------------------------------------------*/
+static const char *
+captured(void)
+{
+  log_deferred_flush();
+  output_mode = PASS;
+  return output;
+}
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+log_other_module(void)
+{
+#undef LOG_MODULE
+#define LOG_MODULE "Other"
+  LOG_INFO("other\n");
+#undef LOG_MODULE
+#define LOG_MODULE "Test"
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(format, "Messages are formatted later");
+UNIT_TEST(format)
+{
+  char name[8];
+  char expected[128];
+
+  UNIT_TEST_BEGIN();
+
+  strcpy(name, "alpha");
+  snprintf(expected, sizeof(expected),
+           "[INFO: Test      ] n=%d u=%u l=%ld x=%04x s=%s c=%c %5.1f|%-3s|%*d%%\n",
+           -5, 7u, -100000L, 0xab, name, 'z', 2.25, "ab", 4, 42);
+
+  capture();
+  LOG_INFO("n=%d u=%u l=%ld x=%04x s=%s c=%c %5.1f|%-3s|%*d%%\n",
+           -5, 7u, -100000L, 0xab, name, 'z', 2.25, "ab", 4, 42);
+  /* Nothing is printed yet, and strings are copied. */
+  UNIT_TEST_ASSERT(output_len == 0);
+  strcpy(name, "XXXXX");
+  UNIT_TEST_ASSERT(strcmp(captured(), expected) == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(addresses, "Addresses and bytes are copied");
+UNIT_TEST(addresses)
+{
+  uip_ipaddr_t ipaddr;
+  linkaddr_t lladdr;
+  uint8_t bytes[4] = { 0xde, 0xad, 0xbe, 0xef };
+  char expected[128];
+  char addr[UIPLIB_IPV6_MAX_STR_LEN];
+
+  UNIT_TEST_BEGIN();
+
+  uip_ip6addr(&ipaddr, 0xfd00, 0, 0, 0, 0x212, 0x4b00, 0x615, 0xab25);
+  memset(&lladdr, 0, sizeof(lladdr));
+  lladdr.u8[0] = 0x01;
+  lladdr.u8[LINKADDR_SIZE - 1] = 0x25;
+  uiplib_ipaddr_snprint(addr, sizeof(addr), &ipaddr);
+  snprintf(expected, sizeof(expected),
+           "[INFO: Test      ] ip %s ll 0100.0000.0000.0025 deadbeef!1\n",
+           addr);
+
+  capture();
+  LOG_INFO("ip ");
+  LOG_INFO_6ADDR(&ipaddr);
+  LOG_INFO_(" ll ");
+  LOG_INFO_LLADDR(&lladdr);
+  LOG_INFO_(" ");
+  LOG_INFO_BYTES(bytes, sizeof(bytes));
+  /* Direct output stays in order with the messages */
+  LOG_OUTPUT("!%d", 1);
+  LOG_INFO_("\n");
+  memset(&ipaddr, 0, sizeof(ipaddr));
+  memset(&lladdr, 0, sizeof(lladdr));
+  memset(bytes, 0, sizeof(bytes));
+  UNIT_TEST_ASSERT(strcmp(captured(), expected) == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(truncation, "Arguments that do not fit are cut");
+UNIT_TEST(truncation)
+{
+  char text[100];
+  char expected[128];
+
+  UNIT_TEST_BEGIN();
+
+  memset(text, 'a', sizeof(text) - 1);
+  text[sizeof(text) - 1] = '\0';
+  /* An int and the terminating null leave this much of the string */
+  snprintf(expected, sizeof(expected), "[INFO: Test      ] 1 %.*s ...\n",
+           (int)(LOG_DEFERRED_ARGS_LEN - sizeof(int) - 1), text);
+
+  capture();
+  LOG_INFO("%d %s tail\n", 1, text);
+  UNIT_TEST_ASSERT(strcmp(captured(), expected) == 0);
+
+  /* The integers fill the arguments, no room is left for the string */
+  capture();
+  LOG_INFO("%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %s\n",
+           1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, "hello");
+  UNIT_TEST_ASSERT(LOG_DEFERRED_ARGS_LEN == 16 * sizeof(int));
+  UNIT_TEST_ASSERT(strcmp(captured(), "[INFO: Test      ] "
+                          "1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16  ...\n") == 0);
+
+  /* The same with the default argument space of 24 bytes */
+  capture();
+  LOG_INFO("%d %d %d %d %d %d %s\n", 1, 2, 3, 4, 5, 6, "hello");
+  UNIT_TEST_ASSERT(strcmp(captured(),
+                          "[INFO: Test      ] 1 2 3 4 5 6 hello\n") == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(drops, "Messages are dropped when the queue is full");
+UNIT_TEST(drops)
+{
+  unsigned long dropped;
+  unsigned long dropped_test;
+  int lines;
+  int i;
+  const char *p;
+
+  UNIT_TEST_BEGIN();
+
+  dropped = log_deferred_dropped(NULL);
+  dropped_test = log_deferred_dropped("Test");
+  capture();
+  for(i = 0; i < CAPACITY + 4; i++) {
+    LOG_INFO("line %d\n", i);
+  }
+  log_other_module();
+  log_other_module();
+  UNIT_TEST_ASSERT(log_deferred_dropped("Test") == dropped_test + 4);
+  UNIT_TEST_ASSERT(log_deferred_dropped("Other") == 2);
+  UNIT_TEST_ASSERT(log_deferred_dropped(NULL) == dropped + 6);
+
+  /* The queued messages are printed, then the drops per module */
+  p = captured();
+  for(lines = 0; (p = strchr(p, '\n')) != NULL; p++, lines++);
+  UNIT_TEST_ASSERT(lines == CAPACITY + 2);
+  UNIT_TEST_ASSERT(strstr(output, "line 14\n[WARN: LogDefer  ] 4 logs dropped from Test\n"
+                          "[WARN: LogDefer  ] 2 logs dropped from Other\n") != NULL);
+
+  /* A line that loses its tail is ended before the drops are reported. */
+  capture();
+  for(i = 0; i < CAPACITY - 1; i++) {
+    LOG_INFO("line %d\n", i);
+  }
+  LOG_INFO("head");
+  LOG_INFO_(" tail\n");
+  log_deferred_flush();
+  LOG_INFO("next\n");
+  UNIT_TEST_ASSERT(log_deferred_dropped("Test") == dropped_test + 5);
+  UNIT_TEST_ASSERT(strstr(captured(), "] head ...\n"
+                          "[WARN: LogDefer  ] 1 logs dropped from Test\n"
+                          "[INFO: Test      ] next\n") != NULL);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(idle, "The log process prints the queue");
+UNIT_TEST(idle)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(strcmp(output, "[INFO: Test      ] idle\n") == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(overhead, "Logging overhead");
+UNIT_TEST(overhead)
+{
+  uint64_t log_time;
+  uint64_t format_time;
+  uint64_t snprintf_time;
+  uint64_t start;
+  char buf[64];
+  int round;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  log_time = format_time = snprintf_time = 0;
+  output_mode = DISCARD;
+  for(round = 0; round < BENCH_ROUNDS; round++) {
+    start = now_ns();
+    for(i = 0; i < CAPACITY; i++) {
+      LOG_INFO("rx from %u len %u rssi %d\n", round, i, -70);
+    }
+    log_time += now_ns() - start;
+
+    start = now_ns();
+    log_deferred_flush();
+    format_time += now_ns() - start;
+
+    start = now_ns();
+    for(i = 0; i < CAPACITY; i++) {
+      snprintf(buf, sizeof(buf), "[%-4s: %-10s] rx from %u len %u rssi %d\n",
+               "INFO", LOG_MODULE, round, i, -70);
+    }
+    snprintf_time += now_ns() - start;
+  }
+  output_mode = PASS;
+
+  printf("Deferred log call: %lu ns, formatting later: %lu ns, "
+         "snprintf: %lu ns\n",
+         (unsigned long)(log_time / BENCH_ROUNDS / CAPACITY),
+         (unsigned long)(format_time / BENCH_ROUNDS / CAPACITY),
+         (unsigned long)(snprintf_time / BENCH_ROUNDS / CAPACITY));
+  UNIT_TEST_ASSERT(log_time < snprintf_time);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(format);
+  UNIT_TEST_RUN(addresses);
+  UNIT_TEST_RUN(truncation);
+  UNIT_TEST_RUN(drops);
+
+  /* Without a flush, the log process prints the message. */
+  capture();
+  LOG_INFO("idle\n");
+  PROCESS_PAUSE();
+  output_mode = PASS;
+  UNIT_TEST_RUN(idle);
+
+  UNIT_TEST_RUN(overhead);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Runs an RPL network of 25 nodes in one process and checks that the
+ *   DODAG spans the whole grid, that every node reaches the root over
+ *   multiple hops, and that no route is shorter than the topology
+ *   allows.
+ */
+
+#include "contiki.h"
+#include "native-sim.h"
+#include "net/routing/routing.h"
+#include "net/ipv6/simple-udp.h"
+#include "net/ipv6/uip-sr.h"
+#include "sys/node-id.h"
+#include "lib/random.h"
+#include "unit-test.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define UDP_PORT         5678
+#define GRID_SIDE        5
+#define SEND_INTERVAL    (20 * CLOCK_SECOND)
+/* Virtual time in which the network must form */
+#define CONVERGENCE_TIME (10 * 60 * CLOCK_SECOND)
+
+static struct simple_udp_connection udp_conn;
+/* Nodes heard by the root, indexed by node ID */
+static uint8_t heard[NATIVE_SIM_CONF_NODES + 1];
+static unsigned heard_count;
+static clock_time_t converged;
+/*---------------------------------------------------------------------------*/
+static uint16_t
+sr_node_id(const uip_sr_node_t *node)
+{
+  return (node->link_identifier[6] << 8) | node->link_identifier[7];
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+sr_node_depth(const uip_sr_node_t *node)
+{
+  unsigned depth = 0;
+
+  while(node->parent != NULL && depth < NATIVE_SIM_CONF_NODES) {
+    node = node->parent;
+    depth++;
+  }
+  return depth;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+grid_distance(uint16_t id)
+{
+  /* The root is node 1, in the corner of the grid */
+  return (id - 1) % GRID_SIDE + (id - 1) / GRID_SIDE;
+}
+/*---------------------------------------------------------------------------*/
+static void
+udp_rx_callback(struct simple_udp_connection *c,
+                const uip_ipaddr_t *sender_addr, uint16_t sender_port,
+                const uip_ipaddr_t *receiver_addr, uint16_t receiver_port,
+                const uint8_t *data, uint16_t datalen)
+{
+  uint16_t id = (sender_addr->u8[14] << 8) | sender_addr->u8[15];
+
+  if(id <= NATIVE_SIM_CONF_NODES && !heard[id]) {
+    heard[id] = 1;
+    heard_count++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(dodag, "The DODAG spans all nodes");
+UNIT_TEST(dodag)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("%d nodes in the DODAG after %lu s\n", uip_sr_num_nodes(),
+         (unsigned long)(converged / CLOCK_SECOND));
+  UNIT_TEST_ASSERT(uip_sr_num_nodes() == native_sim_node_count());
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(udp, "Every node reaches the root");
+UNIT_TEST(udp)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(heard_count == native_sim_node_count() - 1);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(depth, "Routes respect the radio range");
+UNIT_TEST(depth)
+{
+  uip_sr_node_t *node;
+  unsigned depth;
+  unsigned max_depth = 0;
+  int too_short = 0;
+
+  UNIT_TEST_BEGIN();
+
+  for(node = uip_sr_node_head(); node != NULL; node = uip_sr_node_next(node)) {
+    depth = sr_node_depth(node);
+    if(depth < grid_distance(sr_node_id(node))) {
+      printf("node %u at depth %u\n", sr_node_id(node), depth);
+      too_short++;
+    }
+    if(depth > max_depth) {
+      max_depth = depth;
+    }
+  }
+  printf("max depth %u\n", max_depth);
+  UNIT_TEST_ASSERT(too_short == 0);
+  UNIT_TEST_ASSERT(max_depth >= grid_distance(NATIVE_SIM_CONF_NODES));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(medium, "The medium delivers and acknowledges frames");
+UNIT_TEST(medium)
+{
+  const struct native_sim_stats *stats = native_sim_stats();
+
+  UNIT_TEST_BEGIN();
+
+  printf("%lu frames sent, %lu received, %lu collided, %lu acknowledged, "
+         "%llu events\n",
+         (unsigned long)stats->tx, (unsigned long)stats->rx,
+         (unsigned long)stats->collisions, (unsigned long)stats->acks,
+         (unsigned long long)stats->events);
+  UNIT_TEST_ASSERT(stats->rx > stats->tx);
+  UNIT_TEST_ASSERT(stats->acks > 0);
+  UNIT_TEST_ASSERT(stats->lost == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+static void
+root_check(void)
+{
+  if(uip_sr_num_nodes() == native_sim_node_count() &&
+     heard_count == native_sim_node_count() - 1) {
+    converged = clock_time();
+  } else if(clock_time() >= CONVERGENCE_TIME) {
+    converged = clock_time();
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer timer;
+  uip_ipaddr_t root;
+
+  PROCESS_BEGIN();
+
+  simple_udp_register(&udp_conn, UDP_PORT, NULL, UDP_PORT, udp_rx_callback);
+
+  if(node_id == 1) {
+    NETSTACK_ROUTING.root_start();
+
+    etimer_set(&timer, CLOCK_SECOND);
+    while(!converged) {
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&timer));
+      etimer_reset(&timer);
+      root_check();
+    }
+
+    printf("Run unit-test\n");
+    printf("---\n");
+
+    UNIT_TEST_RUN(dodag);
+    UNIT_TEST_RUN(udp);
+    UNIT_TEST_RUN(depth);
+    UNIT_TEST_RUN(medium);
+
+    printf("=check-me= DONE\n");
+    printf("---\n");
+
+    native_sim_stop();
+  } else {
+    etimer_set(&timer, random_rand() % SEND_INTERVAL);
+    while(1) {
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&timer));
+      etimer_set(&timer, SEND_INTERVAL);
+      if(NETSTACK_ROUTING.node_is_reachable() &&
+         NETSTACK_ROUTING.get_root_ipaddr(&root)) {
+        simple_udp_sendto(&udp_conn, "hello", 5, &root);
+      }
+    }
+  }
+
+  PROCESS_END();
+}
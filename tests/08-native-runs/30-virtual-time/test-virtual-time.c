@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Checks that with virtual time the native main loop skips idle time
+ *   and fires etimers, ctimers and rtimers exactly at their deadlines,
+ *   and that running code takes no virtual time.
+ */
+
+#include "contiki.h"
+#include "sys/ctimer.h"
+#include "sys/rtimer.h"
+#include "lib/trickle-timer.h"
+#include "unit-test.h"
+#include <stdio.h>
+
+PROCESS(test_process, "test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define HOUR          (60UL * 60 * CLOCK_SECOND)
+#define DAY           (24 * HOUR)
+#define CTIMERS       5
+#define RTIMER_DELAY  12345
+#define BUSYWAIT      500
+#define TICK          (CLOCK_SECOND / 10)
+
+static clock_time_t started;
+static uint32_t started_usec;
+static clock_time_t idle_virtual;
+static uint32_t idle_real;
+
+static struct ctimer ctimers[CTIMERS];
+static const uint8_t ctimer_seconds[CTIMERS] = { 5, 1, 3, 2, 4 };
+static clock_time_t ctimer_fired[CTIMERS];
+static int ctimer_order[CTIMERS];
+static int ctimer_count;
+
+static struct rtimer rt;
+static rtimer_clock_t rtimer_deadline;
+static rtimer_clock_t rtimer_fired;
+
+static rtimer_clock_t busywait_time;
+static clock_time_t compute_virtual;
+static uint32_t compute_real;
+
+static struct trickle_timer trickle;
+static unsigned long trickle_count;
+static unsigned long tick_count;
+static clock_time_t day_virtual;
+static uint32_t day_real;
+/*---------------------------------------------------------------------------*/
+static void
+ctimer_callback(void *ptr)
+{
+  int i = (int)(intptr_t)ptr;
+
+  ctimer_fired[i] = clock_time();
+  ctimer_order[ctimer_count++] = i;
+  if(ctimer_count == CTIMERS) {
+    process_poll(&test_process);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+rtimer_callback(struct rtimer *t, void *ptr)
+{
+  rtimer_fired = RTIMER_NOW();
+  process_poll(&test_process);
+}
+/*---------------------------------------------------------------------------*/
+static void
+trickle_callback(void *ptr, uint8_t suppress)
+{
+  trickle_count++;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(idle, "Idle time is skipped");
+UNIT_TEST(idle)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("one hour passed in %lu us\n", (unsigned long)idle_real);
+  UNIT_TEST_ASSERT(idle_virtual == HOUR);
+  UNIT_TEST_ASSERT(idle_real < 1000000);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(ctimers, "Timers fire in order at their deadline");
+UNIT_TEST(ctimers)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(ctimer_count == CTIMERS);
+  for(i = 0; i < CTIMERS; i++) {
+    UNIT_TEST_ASSERT(ctimer_fired[i] - started ==
+                     ctimer_seconds[i] * CLOCK_SECOND);
+    UNIT_TEST_ASSERT(ctimer_seconds[ctimer_order[i]] == i + 1);
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(rtimer, "Rtimers fire at their deadline");
+UNIT_TEST(rtimer)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(RTIMER_SECOND == 1000000);
+  UNIT_TEST_ASSERT(rtimer_fired == rtimer_deadline);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(busywait, "Busy-waiting takes virtual time");
+UNIT_TEST(busywait)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(busywait_time == BUSYWAIT);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(compute, "Running code takes no virtual time");
+UNIT_TEST(compute)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("computed for %lu us\n", (unsigned long)compute_real);
+  UNIT_TEST_ASSERT(compute_virtual == 0);
+  UNIT_TEST_ASSERT(compute_real > 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(day, "A day of timers runs in moments");
+UNIT_TEST(day)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("one day: %lu ticks, %lu trickle intervals in %lu ms\n",
+         tick_count, trickle_count, (unsigned long)(day_real / 1000));
+  UNIT_TEST_ASSERT(day_virtual == DAY);
+  UNIT_TEST_ASSERT(tick_count == DAY / TICK);
+  UNIT_TEST_ASSERT(trickle_count > 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer timer;
+  static struct etimer tick;
+  volatile uint32_t sum = 0;
+  uint32_t i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  started = clock_time();
+  started_usec = native_clock_usec();
+  etimer_set(&timer, HOUR);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&timer));
+  idle_virtual = clock_time() - started;
+  idle_real = native_clock_usec() - started_usec;
+  UNIT_TEST_RUN(idle);
+
+  started = clock_time();
+  for(i = 0; i < CTIMERS; i++) {
+    ctimer_set(&ctimers[i], ctimer_seconds[i] * CLOCK_SECOND,
+               ctimer_callback, (void *)(intptr_t)i);
+  }
+  PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+  UNIT_TEST_RUN(ctimers);
+
+  rtimer_deadline = RTIMER_NOW() + RTIMER_DELAY;
+  rtimer_set(&rt, rtimer_deadline, 0, rtimer_callback, NULL);
+  PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+  UNIT_TEST_RUN(rtimer);
+
+  busywait_time = RTIMER_NOW();
+  RTIMER_BUSYWAIT(BUSYWAIT);
+  busywait_time = RTIMER_NOW() - busywait_time;
+  UNIT_TEST_RUN(busywait);
+
+  started = clock_time();
+  started_usec = native_clock_usec();
+  for(i = 0; i < 10000000; i++) {
+    sum += i;
+  }
+  compute_virtual = clock_time() - started;
+  compute_real = native_clock_usec() - started_usec;
+  UNIT_TEST_RUN(compute);
+
+  started = clock_time();
+  started_usec = native_clock_usec();
+  trickle_timer_config(&trickle, CLOCK_SECOND, 10, 1);
+  trickle_timer_set(&trickle, trickle_callback, NULL);
+  etimer_set(&timer, DAY);
+  etimer_set(&tick, TICK);
+  while(!etimer_expired(&timer)) {
+    PROCESS_WAIT_EVENT();
+    if(etimer_expired(&tick)) {
+      etimer_reset(&tick);
+      /* Restart the trickle timer every hour */
+      if(++tick_count % (HOUR / TICK) == 0) {
+        trickle_timer_inconsistency(&trickle);
+      }
+    }
+  }
+  day_virtual = clock_time() - started;
+  day_real = native_clock_usec() - started_usec;
+  trickle_timer_stop(&trickle);
+  UNIT_TEST_RUN(day);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
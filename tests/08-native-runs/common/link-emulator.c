@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Emulated link for the native tests.
+ */
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/tcpip.h"
+#include "link-emulator.h"
+#include <string.h>
+
+PROCESS(link_emulator_process, "link emulator");
+
+struct delayed_packet {
+  clock_time_t due;
+  uint16_t len;
+  uint8_t data[UIP_BUFSIZE];
+};
+
+static struct delayed_packet queue[LINK_EMULATOR_QUEUE_SIZE];
+static uint8_t queue_start;
+static uint8_t queue_len;
+static clock_time_t link_delay;
+static struct link_emulator_stats *link_stats;
+static link_emulator_callback_t link_callback;
+/*---------------------------------------------------------------------------*/
+void
+link_emulator_set_delay(clock_time_t delay)
+{
+  link_delay = delay;
+}
+/*---------------------------------------------------------------------------*/
+void
+link_emulator_set_stats(struct link_emulator_stats *stats)
+{
+  link_stats = stats;
+}
+/*---------------------------------------------------------------------------*/
+void
+link_emulator_set_callback(link_emulator_callback_t callback)
+{
+  link_callback = callback;
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+  process_start(&link_emulator_process, NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
+input(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+output(const linkaddr_t *localdest)
+{
+  struct delayed_packet *p;
+
+  if(UIP_IP_BUF->proto != UIP_PROTO_TCP) {
+    return 1;
+  }
+  if(queue_len == LINK_EMULATOR_QUEUE_SIZE) {
+    if(link_stats != NULL) {
+      link_stats->drops++;
+    }
+    return 1;
+  }
+  if(link_stats != NULL) {
+    link_stats->bytes += uip_len;
+    link_stats->packets++;
+  }
+  if(link_callback != NULL) {
+    link_callback();
+  }
+  p = &queue[(queue_start + queue_len++) % LINK_EMULATOR_QUEUE_SIZE];
+  p->due = clock_time() + link_delay;
+  p->len = uip_len;
+  memcpy(p->data, uip_buf, uip_len);
+  process_poll(&link_emulator_process);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+const struct network_driver link_emulator_driver = {
+  "link emulator",
+  init,
+  input,
+  output
+};
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(link_emulator_process, ev, data)
+{
+  static struct etimer et;
+  struct delayed_packet *p;
+  uip_ipaddr_t addr;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT();
+
+    while(queue_len > 0) {
+      p = &queue[queue_start];
+      if(clock_time() < p->due) {
+        etimer_set(&et, p->due - clock_time());
+        break;
+      }
+      memcpy(uip_buf, p->data, p->len);
+      uip_len = p->len;
+      queue_start = (queue_start + 1) % LINK_EMULATOR_QUEUE_SIZE;
+      queue_len--;
+
+      uip_ipaddr_copy(&addr, &UIP_IP_BUF->srcipaddr);
+      uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &UIP_IP_BUF->destipaddr);
+      uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &addr);
+      tcpip_input();
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   A network driver for the native tests that emulates a link to a
+ *   peer at the node's own address. Each TCP packet is delayed, then
+ *   its addresses are swapped and it is fed back in, so a packet sent
+ *   to the peer address reaches a local listener, whose replies reach
+ *   the sender. Swapping the addresses keeps the checksum valid.
+ *
+ *   Select it with NETSTACK_CONF_NETWORK link_emulator_driver.
+ */
+
+#ifndef LINK_EMULATOR_H_
+#define LINK_EMULATOR_H_
+
+#include "contiki.h"
+#include "net/netstack.h"
+
+#ifdef LINK_EMULATOR_CONF_QUEUE_SIZE
+#define LINK_EMULATOR_QUEUE_SIZE LINK_EMULATOR_CONF_QUEUE_SIZE
+#else
+#define LINK_EMULATOR_QUEUE_SIZE 16
+#endif
+
+/* Counters of the packets put on the link */
+struct link_emulator_stats {
+  uint32_t bytes;
+  uint32_t packets;
+  unsigned drops;
+};
+
+/* Called for each packet put on the link, with the packet in uip_buf */
+typedef void (*link_emulator_callback_t)(void);
+
+extern const struct network_driver link_emulator_driver;
+
+/* Sets the delay of the packets sent from now on, 0 by default */
+void link_emulator_set_delay(clock_time_t delay);
+
+/* Counts the packets into stats, or stops counting them if NULL */
+void link_emulator_set_stats(struct link_emulator_stats *stats);
+
+void link_emulator_set_callback(link_emulator_callback_t callback);
+
+#endif /* LINK_EMULATOR_H_ */
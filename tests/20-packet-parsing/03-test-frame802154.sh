@@ -0,0 +1,37 @@
+#!/bin/bash
+source ../utils.sh
+
+# Contiki directory
+CONTIKI=$1
+
+# Fuzzer/benchmark code directory
+CODE_DIR=frame802154-fuzz
+CODE=frame802154-fuzz
+
+echo "Building native fuzzer"
+make -C $CODE_DIR TARGET=native > make.log 2> make.err
+
+timeout -k 1s 120s $CODE_DIR/$CODE.native > $CODE.log 2> $CODE.err
+FUZZ_EXIT_CODE=$?
+echo "exit code:" $FUZZ_EXIT_CODE
+
+if [ $FUZZ_EXIT_CODE -ne 0 ]; then
+  echo "==== make.log ====" ; cat make.log;
+  echo "==== make.err ====" ; cat make.err;
+  echo "==== $CODE.log ====" ; cat $CODE.log;
+  echo "==== $CODE.err ====" ; cat $CODE.err;
+
+  printf "%-32s TEST FAIL\n" "$CODE" | tee $CODE.testlog;
+else
+  grep "frames/s" $CODE.log
+  printf "%-32s TEST OK\n" "$CODE" | tee $CODE.testlog;
+fi
+
+rm make.log
+rm make.err
+rm $CODE.log
+rm $CODE.err
+
+# We do not want Make to stop -> Return 0
+# The Makefile will check if a log contains FAIL at the end
+exit 0
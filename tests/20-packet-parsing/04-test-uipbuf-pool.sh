@@ -0,0 +1,48 @@
+#!/bin/bash
+source ../utils.sh
+
+# Contiki directory
+CONTIKI=$1
+
+# Test/benchmark code directory
+CODE_DIR=uipbuf-pool
+CODE=uipbuf-pool
+
+FAILED=0
+
+# Run once with the uIP buffer pool and once with the single buffer
+for POOL in 4 0; do
+  echo "Building native test, pool size $POOL"
+  make -C $CODE_DIR TARGET=native clean > /dev/null 2>&1
+  make -C $CODE_DIR TARGET=native DEFINES=UIP_CONF_BUF_POOL_SIZE=$POOL > make.log 2> make.err
+
+  timeout -k 1s 120s $CODE_DIR/$CODE.native > $CODE.log 2> $CODE.err
+  EXIT_CODE=$?
+  echo "exit code:" $EXIT_CODE
+
+  if [ $EXIT_CODE -ne 0 ]; then
+    echo "==== make.log ====" ; cat make.log;
+    echo "==== make.err ====" ; cat make.err;
+    echo "==== $CODE.log ====" ; cat $CODE.log;
+    echo "==== $CODE.err ====" ; cat $CODE.err;
+    FAILED=1
+  else
+    grep "packets/s" $CODE.log
+  fi
+done
+
+if [ $FAILED -ne 0 ]; then
+  printf "%-32s TEST FAIL\n" "$CODE" | tee $CODE.testlog;
+else
+  printf "%-32s TEST OK\n" "$CODE" | tee $CODE.testlog;
+fi
+
+make -C $CODE_DIR TARGET=native clean > /dev/null 2>&1
+rm make.log
+rm make.err
+rm $CODE.log
+rm $CODE.err
+
+# We do not want Make to stop -> Return 0
+# The Makefile will check if a log contains FAIL at the end
+exit 0
@@ -0,0 +1,42 @@
+#!/bin/bash
+source ../utils.sh
+
+# Contiki directory
+CONTIKI=$1
+
+# Benchmark code directory
+CODE_DIR=packet-bench
+CODE=packet-bench
+
+# Packets per batch, lower it for a quicker run
+BENCH_ROUNDS=${BENCH_ROUNDS:-20000}
+
+echo "Building native benchmark"
+make -C $CODE_DIR TARGET=native clean > /dev/null 2>&1
+make -C $CODE_DIR TARGET=native > make.log 2> make.err
+
+BENCH_ROUNDS=$BENCH_ROUNDS timeout -k 1s 300s $CODE_DIR/$CODE.native > $CODE.log 2> $CODE.err
+EXIT_CODE=$?
+echo "exit code:" $EXIT_CODE
+
+if [ $EXIT_CODE -ne 0 ]; then
+  echo "==== make.log ====" ; cat make.log;
+  echo "==== make.err ====" ; cat make.err;
+  echo "==== $CODE.log ====" ; cat $CODE.log;
+  echo "==== $CODE.err ====" ; cat $CODE.err;
+  printf "%-32s TEST FAIL\n" "$CODE" | tee $CODE.testlog;
+else
+  # One line per path, to be compared from one commit to the next
+  grep "^BENCH" $CODE.log
+  printf "%-32s TEST OK\n" "$CODE" | tee $CODE.testlog;
+fi
+
+make -C $CODE_DIR TARGET=native clean > /dev/null 2>&1
+rm make.log
+rm make.err
+rm $CODE.log
+rm $CODE.err
+
+# We do not want Make to stop -> Return 0
+# The Makefile will check if a log contains FAIL at the end
+exit 0
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Fuzzer and benchmark for the IEEE 802.15.4 frame parser and creator.
+ *   Checks that created frames parse back to the same header, that random
+ *   input never makes the parsers claim more bytes than they were given,
+ *   and reports frames/s for the common data frame layouts.
+ */
+
+#include "contiki.h"
+#include "net/mac/framer/frame802154.h"
+#include "net/mac/framer/frame802154e-ie.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Log configuration */
+#include "sys/log.h"
+#define LOG_MODULE "Fuzz"
+#define LOG_LEVEL LOG_LEVEL_INFO
+
+#define FUZZ_ROUNDS     200000
+#define BENCH_ROUNDS    2000000
+#define FRAME_MAX_LEN   127
+
+static int failures;
+/*---------------------------------------------------------------------------*/
+PROCESS(frame802154_fuzz_process, "802.15.4 frame fuzzer");
+AUTOSTART_PROCESSES(&frame802154_fuzz_process);
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check(int cond, const char *what, int round)
+{
+  if(!cond) {
+    if(failures < 10) {
+      LOG_ERR("round %d: %s\n", round, what);
+    }
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+random_addr_mode(void)
+{
+  static const uint8_t modes[] = {
+    FRAME802154_NOADDR, FRAME802154_SHORTADDRMODE, FRAME802154_LONGADDRMODE
+  };
+  return modes[rand() % 3];
+}
+/*---------------------------------------------------------------------------*/
+static void
+random_frame(frame802154_t *f)
+{
+  int i;
+
+  memset(f, 0, sizeof(*f));
+  f->fcf.frame_type = rand() % 4;
+  f->fcf.frame_version = rand() % 3;
+  f->fcf.panid_compression = rand() & 1;
+  f->fcf.dest_addr_mode = random_addr_mode();
+  f->fcf.src_addr_mode = random_addr_mode();
+  if(f->fcf.frame_version == FRAME802154_IEEE802154_2015) {
+    f->fcf.sequence_number_suppression = rand() & 1;
+  }
+  f->seq = rand();
+  f->dest_pid = rand();
+  f->src_pid = (rand() & 1) ? f->dest_pid : rand();
+  for(i = 0; i < 8; i++) {
+    f->dest_addr[i] = rand();
+    f->src_addr[i] = rand();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+addr_len(uint8_t mode)
+{
+  return mode == FRAME802154_SHORTADDRMODE ? 2 :
+         (mode == FRAME802154_LONGADDRMODE ? 8 : 0);
+}
+/*---------------------------------------------------------------------------*/
+static void
+fuzz_roundtrip(void)
+{
+  static uint8_t buf[FRAME_MAX_LEN];
+  frame802154_t in, out;
+  int i, hdr_len, parsed_len, payload_len;
+  int has_src_pid, has_dest_pid;
+
+  for(i = 0; i < FUZZ_ROUNDS; i++) {
+    random_frame(&in);
+    hdr_len = frame802154_create(&in, buf);
+    check(hdr_len == frame802154_hdrlen(&in), "hdrlen mismatch", i);
+    payload_len = rand() % (FRAME_MAX_LEN - hdr_len + 1);
+    parsed_len = frame802154_parse(buf, hdr_len + payload_len, &out);
+    check(parsed_len == hdr_len, "parsed header length mismatch", i);
+    check(out.payload_len == payload_len, "payload length mismatch", i);
+    check(memcmp(&in.fcf, &out.fcf, sizeof(in.fcf)) == 0, "fcf mismatch", i);
+    if(!in.fcf.sequence_number_suppression) {
+      check(in.seq == out.seq, "seqno mismatch", i);
+    }
+    frame802154_has_panid(&in.fcf, &has_src_pid, &has_dest_pid);
+    if(has_dest_pid) {
+      check(in.dest_pid == out.dest_pid, "dest pan id mismatch", i);
+    }
+    if(has_src_pid) {
+      check(in.src_pid == out.src_pid, "src pan id mismatch", i);
+    }
+    /* Parsed addresses are stored MSB first in the first bytes */
+    check(memcmp(in.dest_addr, out.dest_addr,
+                 addr_len(in.fcf.dest_addr_mode)) == 0, "dest addr mismatch", i);
+    check(memcmp(in.src_addr, out.src_addr,
+                 addr_len(in.fcf.src_addr_mode)) == 0, "src addr mismatch", i);
+
+    /* Any truncation of the header must be rejected */
+    if(hdr_len > 2) {
+      check(frame802154_parse(buf, rand() % hdr_len, &out) == 0,
+            "truncated header accepted", i);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+fuzz_random_input(void)
+{
+  static uint8_t buf[FRAME_MAX_LEN];
+  struct ieee802154_ies ies;
+  frame802154_t f;
+  int i, j, len, ret;
+
+  for(i = 0; i < FUZZ_ROUNDS; i++) {
+    len = rand() % (FRAME_MAX_LEN + 1);
+    for(j = 0; j < len; j++) {
+      buf[j] = rand();
+    }
+    ret = frame802154_parse(buf, len, &f);
+    check(ret <= len, "parser consumed more than the frame", i);
+    if(ret > 0) {
+      check(f.payload_len >= 0 && f.payload == buf + ret,
+            "bad payload reference", i);
+    }
+    memset(&ies, 0, sizeof(ies));
+    ret = frame802154e_parse_information_elements(buf, len, &ies);
+    check(ret <= len, "IE parser consumed more than the frame", i);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+fuzz_eack_ie(void)
+{
+  static uint8_t buf[8];
+  struct ieee802154_ies in, out;
+  int i, len;
+
+  for(i = 0; i < FUZZ_ROUNDS; i++) {
+    memset(&in, 0, sizeof(in));
+    in.ie_time_correction = (rand() % 4096) - 2048;
+    in.ie_is_nack = rand() & 1;
+    len = frame80215e_create_ie_header_ack_nack_time_correction(buf,
+                                                                sizeof(buf),
+                                                                &in);
+    memset(&out, 0, sizeof(out));
+    check(frame802154e_parse_information_elements(buf, len, &out) == len,
+          "EACK IE length mismatch", i);
+    check(out.ie_time_correction == in.ie_time_correction &&
+          out.ie_is_nack == in.ie_is_nack, "EACK IE content mismatch", i);
+    check(out.ie_payload_ie_offset == len, "EACK IE offset mismatch", i);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(const char *name, uint8_t version, uint8_t dest_mode, uint8_t src_mode)
+{
+  static uint8_t buf[FRAME_MAX_LEN];
+  frame802154_t f;
+  double start, create_time, parse_time;
+  int i, hdr_len;
+  volatile int sink = 0;
+
+  memset(&f, 0, sizeof(f));
+  f.fcf.frame_type = FRAME802154_DATAFRAME;
+  f.fcf.frame_version = version;
+  f.fcf.panid_compression = 1;
+  f.fcf.dest_addr_mode = dest_mode;
+  f.fcf.src_addr_mode = src_mode;
+  f.dest_pid = f.src_pid = IEEE802154_PANID;
+  memset(f.dest_addr, 0x12, sizeof(f.dest_addr));
+  memset(f.src_addr, 0x34, sizeof(f.src_addr));
+
+  start = now();
+  for(i = 0; i < BENCH_ROUNDS; i++) {
+    f.seq = i;
+    sink += frame802154_create(&f, buf);
+  }
+  create_time = now() - start;
+
+  hdr_len = frame802154_create(&f, buf);
+  start = now();
+  for(i = 0; i < BENCH_ROUNDS; i++) {
+    sink += frame802154_parse(buf, hdr_len + 40, &f);
+  }
+  parse_time = now() - start;
+
+  LOG_INFO("%-18s create %.0f frames/s, parse %.0f frames/s\n", name,
+           BENCH_ROUNDS / create_time, BENCH_ROUNDS / parse_time);
+  (void)sink;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(frame802154_fuzz_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  srand(0x15d4);
+
+  fuzz_roundtrip();
+  fuzz_random_input();
+  fuzz_eack_ie();
+  LOG_INFO("Fuzzing done, %d failures\n", failures);
+
+  bench("2006 short->short", FRAME802154_IEEE802154_2006,
+        FRAME802154_SHORTADDRMODE, FRAME802154_SHORTADDRMODE);
+  bench("2006 long->long", FRAME802154_IEEE802154_2006,
+        FRAME802154_LONGADDRMODE, FRAME802154_LONGADDRMODE);
+  bench("2015 short->long", FRAME802154_IEEE802154_2015,
+        FRAME802154_SHORTADDRMODE, FRAME802154_LONGADDRMODE);
+  bench("2015 long->long", FRAME802154_IEEE802154_2015,
+        FRAME802154_LONGADDRMODE, FRAME802154_LONGADDRMODE);
+
+  exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
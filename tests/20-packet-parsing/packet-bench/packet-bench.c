@@ -0,0 +1,627 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Per-packet CPU cost of the IPv6/6LoWPAN stack on the native target.
+ *   Canned packet traces are fed through NETSTACK_NETWORK.input() and
+ *   output(), with a stub MAC that frames and captures the packets
+ *   instead of sending them. The node is the root of a non-storing RPL
+ *   DODAG and hosts a UDP socket and a CoAP resource. One line is
+ *   printed per path:
+ *
+ *   BENCH <path> <t> ns/packet <a> allocs/packet <f> frames/packet
+ *
+ *   The time is the best of BENCH_BATCHES batches, so that figures
+ *   taken on the same host can be compared from one commit to the next.
+ *   Allocations are memb and heap allocations, counted when the program
+ *   is linked with --wrap.
+ */
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/mac/mac.h"
+#include "net/mac/framer/frame802154.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uip-sr.h"
+#include "net/ipv6/simple-udp.h"
+#include "net/routing/routing.h"
+#include "net/routing/rpl-lite/rpl.h"
+#include "coap-engine.h"
+#include "lib/memb.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Log configuration */
+#include "sys/log.h"
+#define LOG_MODULE "Bench"
+#define LOG_LEVEL LOG_LEVEL_INFO
+
+#ifdef BENCH_CONF_COUNT_ALLOCS
+#define BENCH_COUNT_ALLOCS BENCH_CONF_COUNT_ALLOCS
+#else
+#define BENCH_COUNT_ALLOCS 0
+#endif
+
+#define BENCH_ROUNDS      20000
+#define BENCH_BATCHES     5
+
+#define UDP_PORT          5678
+#define PAYLOAD_LEN       64
+#define FRAG_PAYLOAD_LEN  512
+#define TRACE_FRAMES      8
+#define MAC_FRAME_LEN     (127 - 2) /* Without the FCS */
+
+/* The neighbor that sends all the traffic, a direct child of the root */
+#define CHILD             0x0a
+#define CHILD_RANK        512
+/* A route of three hops down the DODAG: root -> 0x0b -> 0x0c -> 0x0d */
+#define HOP1              0x0b
+#define HOP2              0x0c
+#define HOP3              0x0d
+#define SR_LIFETIME       3600
+
+/* The frames of one packet, as they would come from the radio */
+struct trace {
+  int count;
+  uint16_t len[TRACE_FRAMES];
+  uint8_t frame[TRACE_FRAMES][PACKETBUF_SIZE];
+};
+
+/* An IPv6 packet to be copied into uip_buf */
+struct packet {
+  uint16_t len;
+  uint8_t data[UIP_BUFSIZE];
+};
+
+static int failures;
+static int rounds;
+static unsigned long packets;
+static unsigned long frames_sent;
+static unsigned long accepted;
+static unsigned long allocs;
+static linkaddr_t last_receiver;
+static struct trace *capture;
+
+static linkaddr_t child_ll;
+static linkaddr_t hop1_ll;
+static uip_ipaddr_t root_addr;
+static uip_ipaddr_t child_addr;
+
+static struct packet out_packet;
+static struct packet out_frag_packet;
+static struct trace in_trace;
+static struct trace in_frag_trace;
+static struct trace forward_trace;
+static struct trace coap_trace;
+
+static uint8_t coap_request[COAP_MAX_HEADER_SIZE];
+static size_t coap_request_len;
+static uint8_t coap_response[COAP_MAX_HEADER_SIZE + 32];
+static size_t coap_response_len;
+
+static struct simple_udp_connection udp_conn;
+/*---------------------------------------------------------------------------*/
+#if BENCH_COUNT_ALLOCS
+void *__real_memb_alloc(struct memb *m);
+void *__wrap_memb_alloc(struct memb *m);
+void *__real_malloc(size_t size);
+void *__wrap_malloc(size_t size);
+
+void *
+__wrap_memb_alloc(struct memb *m)
+{
+  allocs++;
+  return __real_memb_alloc(m);
+}
+/*---------------------------------------------------------------------------*/
+void *
+__wrap_malloc(size_t size)
+{
+  allocs++;
+  return __real_malloc(size);
+}
+#endif /* BENCH_COUNT_ALLOCS */
+/*---------------------------------------------------------------------------*/
+PROCESS(packet_bench_process, "Packet processing benchmark");
+AUTOSTART_PROCESSES(&packet_bench_process);
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check(int cond, const char *what)
+{
+  if(!cond) {
+    if(failures < 10) {
+      LOG_ERR("%s\n", what);
+    }
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Stub MAC: frames the packet, records it in the capture trace if any
+   and reports a successful transmission */
+static void
+mac_send(mac_callback_t sent, void *ptr)
+{
+  static uint8_t seqno;
+
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &linkaddr_node_addr);
+  packetbuf_set_attr(PACKETBUF_ATTR_FRAME_TYPE, FRAME802154_DATAFRAME);
+  packetbuf_set_attr(PACKETBUF_ATTR_MAC_SEQNO, ++seqno);
+  if(NETSTACK_FRAMER.create() < 0) {
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR_FATAL, 1);
+    return;
+  }
+
+  frames_sent++;
+  linkaddr_copy(&last_receiver, packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+  if(capture != NULL && capture->count < TRACE_FRAMES) {
+    capture->len[capture->count] = packetbuf_totlen();
+    memcpy(capture->frame[capture->count], packetbuf_hdrptr(),
+           packetbuf_totlen());
+    capture->count++;
+  }
+  mac_call_sent_callback(sent, ptr, MAC_TX_OK, 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+mac_input(void)
+{
+  if(NETSTACK_FRAMER.parse() < 0) {
+    check(0, "mac: failed to parse frame");
+    return;
+  }
+  NETSTACK_NETWORK.input();
+}
+/*---------------------------------------------------------------------------*/
+static int
+mac_on(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+mac_off(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+mac_max_payload(void)
+{
+  int hdrlen;
+
+  hdrlen = NETSTACK_FRAMER.length();
+  return hdrlen < 0 ? 0 : MAC_FRAME_LEN - hdrlen;
+}
+/*---------------------------------------------------------------------------*/
+static void
+mac_init(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+const struct mac_driver bench_mac_driver = {
+  "bench",
+  mac_init,
+  mac_send,
+  mac_input,
+  mac_on,
+  mac_off,
+  mac_max_payload,
+};
+/*---------------------------------------------------------------------------*/
+static void
+node_lladdr(linkaddr_t *lladdr, uint8_t id)
+{
+  memset(lladdr, 0, sizeof(linkaddr_t));
+  lladdr->u8[0] = 0x02;
+  lladdr->u8[LINKADDR_SIZE - 1] = id;
+}
+/*---------------------------------------------------------------------------*/
+static void
+node_ipaddr(uip_ipaddr_t *ipaddr, const uip_ipaddr_t *prefix, uint8_t id)
+{
+  linkaddr_t lladdr;
+
+  node_lladdr(&lladdr, id);
+  uip_ipaddr_copy(ipaddr, prefix);
+  uip_ds6_set_addr_iid(ipaddr, (uip_lladdr_t *)&lladdr);
+}
+/*---------------------------------------------------------------------------*/
+/* A UDP datagram in uip_buf, optionally with the RPL hop-by-hop option
+   of a packet going up from the child */
+static void
+make_udp(const uip_ipaddr_t *src, const uip_ipaddr_t *dst, uint16_t port,
+         const uint8_t *payload, uint16_t payload_len, int with_hbh)
+{
+  struct uip_hbho_hdr *hbh;
+  struct uip_ext_hdr_opt_rpl *rpl_opt;
+  uint16_t ext_len;
+
+  ext_len = with_hbh ? RPL_HOP_BY_HOP_LEN : 0;
+  memset(uip_buf, 0, UIP_IPH_LEN + ext_len + UIP_UDPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, src);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, dst);
+  if(with_hbh) {
+    hbh = (struct uip_hbho_hdr *)UIP_IP_PAYLOAD(0);
+    rpl_opt = (struct uip_ext_hdr_opt_rpl *)UIP_IP_PAYLOAD(2);
+    UIP_IP_BUF->proto = UIP_PROTO_HBHO;
+    hbh->next = UIP_PROTO_UDP;
+    hbh->len = (RPL_HOP_BY_HOP_LEN - 8) / 8;
+    rpl_opt->opt_type = UIP_EXT_HDR_OPT_RPL;
+    rpl_opt->opt_len = RPL_HDR_OPT_LEN;
+    rpl_opt->instance = RPL_DEFAULT_INSTANCE;
+    rpl_opt->senderrank = UIP_HTONS(CHILD_RANK);
+  } else {
+    UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  }
+  uip_ext_len = ext_len;
+
+  UIP_UDP_BUF->srcport = UIP_HTONS(port);
+  UIP_UDP_BUF->destport = UIP_HTONS(port);
+  UIP_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + payload_len);
+  memcpy(&uip_buf[UIP_IPUDPH_LEN + ext_len], payload, payload_len);
+  uip_len = UIP_IPUDPH_LEN + ext_len + payload_len;
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+  UIP_UDP_BUF->udpchksum = ~uip_udpchksum();
+  if(UIP_UDP_BUF->udpchksum == 0) {
+    UIP_UDP_BUF->udpchksum = 0xffff;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+save_packet(struct packet *p)
+{
+  p->len = uip_len;
+  memcpy(p->data, uip_buf, uip_len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+load_packet(const struct packet *p)
+{
+  memcpy(uip_buf, p->data, p->len);
+  uip_len = p->len;
+  uip_ext_len = 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Records the frames of the packet in uip_buf as sent by another node */
+static void
+record(struct trace *t, uint8_t from, const linkaddr_t *to)
+{
+  linkaddr_t own_addr;
+
+  linkaddr_copy(&own_addr, &linkaddr_node_addr);
+  node_lladdr(&linkaddr_node_addr, from);
+  memcpy(&uip_lladdr, &linkaddr_node_addr, sizeof(uip_lladdr));
+
+  t->count = 0;
+  capture = t;
+  NETSTACK_NETWORK.output(to);
+  capture = NULL;
+
+  linkaddr_copy(&linkaddr_node_addr, &own_addr);
+  memcpy(&uip_lladdr, &linkaddr_node_addr, sizeof(uip_lladdr));
+  check(t->count > 0, "record: no frames were sent");
+}
+/*---------------------------------------------------------------------------*/
+static void
+replay(const struct trace *t)
+{
+  int i;
+
+  for(i = 0; i < t->count; i++) {
+    packetbuf_clear();
+    packetbuf_copyfrom(t->frame[i], t->len[i]);
+    NETSTACK_MAC.input();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+udp_rx(struct simple_udp_connection *c,
+       const uip_ipaddr_t *sender_addr, uint16_t sender_port,
+       const uip_ipaddr_t *receiver_addr, uint16_t receiver_port,
+       const uint8_t *data, uint16_t datalen)
+{
+  if(datalen == PAYLOAD_LEN || datalen == FRAG_PAYLOAD_LEN) {
+    accepted++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+res_bench_get_handler(coap_message_t *request, coap_message_t *response,
+                      uint8_t *buffer, uint16_t preferred_size,
+                      int32_t *offset)
+{
+  accepted++;
+  coap_set_header_content_format(response, TEXT_PLAIN);
+  coap_set_payload(response, "bench", 5);
+}
+RESOURCE(res_bench, "title=\"Benchmark\"", res_bench_get_handler,
+         NULL, NULL, NULL);
+/*---------------------------------------------------------------------------*/
+static void
+lowpan_out(void)
+{
+  load_packet(&out_packet);
+  NETSTACK_NETWORK.output(&child_ll);
+}
+/*---------------------------------------------------------------------------*/
+static void
+lowpan_out_frag(void)
+{
+  load_packet(&out_frag_packet);
+  NETSTACK_NETWORK.output(&child_ll);
+}
+/*---------------------------------------------------------------------------*/
+static void
+lowpan_in(void)
+{
+  replay(&in_trace);
+}
+/*---------------------------------------------------------------------------*/
+static void
+lowpan_in_frag(void)
+{
+  replay(&in_frag_trace);
+}
+/*---------------------------------------------------------------------------*/
+static void
+forward_rpl(void)
+{
+  replay(&forward_trace);
+}
+/*---------------------------------------------------------------------------*/
+static void
+coap_get(void)
+{
+  replay(&coap_trace);
+}
+/*---------------------------------------------------------------------------*/
+static void
+coap_parse(void)
+{
+  static coap_message_t message[1];
+  static int i;
+
+  /* Alternate between the request and the response */
+  if(i++ & 1) {
+    if(coap_parse_message(message, coap_response, coap_response_len) ==
+       NO_ERROR) {
+      accepted++;
+    }
+  } else {
+    if(coap_parse_message(message, coap_request, coap_request_len) ==
+       NO_ERROR) {
+      accepted++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(const char *name, void (*fn)(void))
+{
+  uint64_t best;
+  uint64_t start;
+  uint64_t elapsed;
+  int b;
+  int i;
+
+  frames_sent = 0;
+  accepted = 0;
+  allocs = 0;
+  best = UINT64_MAX;
+  for(b = 0; b < BENCH_BATCHES; b++) {
+    start = now_ns();
+    for(i = 0; i < rounds; i++) {
+      fn();
+    }
+    elapsed = now_ns() - start;
+    if(elapsed < best) {
+      best = elapsed;
+    }
+  }
+
+  printf("BENCH %-16s %8.1f ns/packet", name, (double)best / rounds);
+#if BENCH_COUNT_ALLOCS
+  printf(" %5.2f allocs/packet", (double)allocs / packets);
+#else /* BENCH_COUNT_ALLOCS */
+  printf("   n/a allocs/packet");
+#endif /* BENCH_COUNT_ALLOCS */
+  printf(" %5.2f frames/packet\n", (double)frames_sent / packets);
+}
+/*---------------------------------------------------------------------------*/
+static void
+setup_traces(void)
+{
+  static uint8_t payload[FRAG_PAYLOAD_LEN];
+  coap_message_t message[1];
+  static const uint8_t token[] = { 0xbe, 0x0c, 0x4a, 0x11 };
+  static const uint8_t etag[] = { 0x01, 0x02, 0x03, 0x04 };
+  linkaddr_t own_ll;
+  uip_ipaddr_t dst_addr;
+  int i;
+
+  for(i = 0; i < sizeof(payload); i++) {
+    payload[i] = i;
+  }
+  linkaddr_copy(&own_ll, &linkaddr_node_addr);
+
+  /* Compression and fragmentation, towards the child */
+  make_udp(&root_addr, &child_addr, UDP_PORT, payload, PAYLOAD_LEN, 0);
+  save_packet(&out_packet);
+  make_udp(&root_addr, &child_addr, UDP_PORT, payload, FRAG_PAYLOAD_LEN, 0);
+  save_packet(&out_frag_packet);
+
+  /* Decompression and reassembly, from the child to our UDP socket */
+  make_udp(&child_addr, &root_addr, UDP_PORT, payload, PAYLOAD_LEN, 0);
+  record(&in_trace, CHILD, &own_ll);
+  make_udp(&child_addr, &root_addr, UDP_PORT, payload, FRAG_PAYLOAD_LEN, 0);
+  record(&in_frag_trace, CHILD, &own_ll);
+
+  /* Forwarding: going up with a hop-by-hop option, down with a SRH */
+  node_ipaddr(&dst_addr, &root_addr, HOP3);
+  make_udp(&child_addr, &dst_addr, UDP_PORT, payload, PAYLOAD_LEN, 1);
+  record(&forward_trace, CHILD, &own_ll);
+
+  /* CoAP */
+  coap_init_message(message, COAP_TYPE_CON, COAP_GET, 0x1234);
+  coap_set_token(message, token, sizeof(token));
+  coap_set_header_uri_path(message, "bench");
+  coap_set_header_uri_query(message, "n=1");
+  coap_request_len = coap_serialize_message(message, coap_request);
+  make_udp(&child_addr, &root_addr, COAP_DEFAULT_PORT,
+           coap_request, coap_request_len, 0);
+  record(&coap_trace, CHILD, &own_ll);
+
+  coap_init_message(message, COAP_TYPE_ACK, CONTENT_2_05, 0x1234);
+  coap_set_token(message, token, sizeof(token));
+  coap_set_header_content_format(message, TEXT_PLAIN);
+  coap_set_header_etag(message, etag, sizeof(etag));
+  coap_set_header_max_age(message, 60);
+  coap_set_header_block2(message, 0, 0, 32);
+  coap_set_payload(message, payload, 32);
+  coap_response_len = coap_serialize_message(message, coap_response);
+
+  check(in_frag_trace.count > 1, "setup: datagram was not fragmented");
+  check(coap_request_len > 0 && coap_response_len > 0,
+        "setup: failed to serialize CoAP messages");
+}
+/*---------------------------------------------------------------------------*/
+static int
+setup_dodag(void)
+{
+  uip_ipaddr_t addr;
+  uip_ipaddr_t parent;
+
+  NETSTACK_ROUTING.root_start();
+  if(!NETSTACK_ROUTING.get_root_ipaddr(&root_addr)) {
+    return 0;
+  }
+
+  /* The source routes known to the root */
+  node_ipaddr(&child_addr, &root_addr, CHILD);
+  if(uip_sr_update_node(NULL, &child_addr, &root_addr, SR_LIFETIME) == NULL) {
+    return 0;
+  }
+  node_ipaddr(&addr, &root_addr, HOP1);
+  uip_sr_update_node(NULL, &addr, &root_addr, SR_LIFETIME);
+  uip_ipaddr_copy(&parent, &addr);
+  node_ipaddr(&addr, &root_addr, HOP2);
+  uip_sr_update_node(NULL, &addr, &parent, SR_LIFETIME);
+  uip_ipaddr_copy(&parent, &addr);
+  node_ipaddr(&addr, &root_addr, HOP3);
+  if(uip_sr_update_node(NULL, &addr, &parent, SR_LIFETIME) == NULL) {
+    return 0;
+  }
+
+  /* The two neighbors on the path */
+  node_lladdr(&child_ll, CHILD);
+  uip_create_linklocal_prefix(&addr);
+  node_ipaddr(&addr, &addr, CHILD);
+  if(uip_ds6_nbr_add(&addr, (uip_lladdr_t *)&child_ll, 0, NBR_REACHABLE,
+                     NBR_TABLE_REASON_UNDEFINED, NULL) == NULL) {
+    return 0;
+  }
+  node_lladdr(&hop1_ll, HOP1);
+  node_ipaddr(&addr, &addr, HOP1);
+  return uip_ds6_nbr_add(&addr, (uip_lladdr_t *)&hop1_ll, 0, NBR_REACHABLE,
+                         NBR_TABLE_REASON_UNDEFINED, NULL) != NULL;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(packet_bench_process, ev, data)
+{
+  const char *env;
+
+  PROCESS_BEGIN();
+
+  env = getenv("BENCH_ROUNDS");
+  rounds = env != NULL ? atoi(env) : BENCH_ROUNDS;
+  if(rounds <= 0) {
+    rounds = BENCH_ROUNDS;
+  }
+  packets = (unsigned long)rounds * BENCH_BATCHES;
+
+  simple_udp_register(&udp_conn, UDP_PORT, NULL, UDP_PORT, udp_rx);
+  coap_activate_resource(&res_bench, "bench");
+
+  if(!setup_dodag()) {
+    LOG_ERR("setup: could not create the DODAG\n");
+    exit(EXIT_FAILURE);
+  }
+  setup_traces();
+
+  LOG_INFO("%d rounds x %d batches per path\n", rounds, BENCH_BATCHES);
+
+  bench("lowpan-out", lowpan_out);
+  check(frames_sent == packets, "lowpan-out: frames were not sent");
+
+  bench("lowpan-out-frag", lowpan_out_frag);
+  check(frames_sent > packets && frames_sent % packets == 0,
+        "lowpan-out-frag: fragments were not sent");
+
+  bench("lowpan-in", lowpan_in);
+  check(accepted == packets, "lowpan-in: datagrams were not delivered");
+
+  bench("lowpan-in-frag", lowpan_in_frag);
+  check(accepted == packets, "lowpan-in-frag: datagrams were not delivered");
+
+  bench("forward-rpl", forward_rpl);
+  check(frames_sent == packets && linkaddr_cmp(&last_receiver, &hop1_ll),
+        "forward-rpl: packets were not source routed");
+
+  bench("coap-get", coap_get);
+  check(accepted == packets && frames_sent == packets &&
+        linkaddr_cmp(&last_receiver, &child_ll),
+        "coap-get: requests were not answered");
+
+  bench("coap-parse", coap_parse);
+  check(accepted == packets, "coap-parse: failed to parse messages");
+
+  LOG_INFO("Done, %d failures\n", failures);
+  exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Checks for the uIP buffer pool and the packet queue on top of it,
+ *   and a forwarding throughput measurement on the native target. The
+ *   same program runs with and without UIP_CONF_BUF_POOL_SIZE so the
+ *   figures of the copying and the zero-copy queue can be compared.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include "net/ipv6/uip-packetqueue.h"
+#include "net/ipv6/uiplib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Log configuration */
+#include "sys/log.h"
+#define LOG_MODULE "BufPool"
+#define LOG_LEVEL LOG_LEVEL_INFO
+
+#define BENCH_ROUNDS    200000
+#define PAYLOAD_LEN     64
+
+static int failures;
+static uip_ipaddr_t src_addr;
+static uip_ipaddr_t dst_addr;
+static uip_ipaddr_t nexthop_addr;
+/*---------------------------------------------------------------------------*/
+PROCESS(uipbuf_pool_process, "uIP buffer pool test");
+AUTOSTART_PROCESSES(&uipbuf_pool_process);
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check(int cond, const char *what)
+{
+  if(!cond) {
+    if(failures < 10) {
+      LOG_ERR("%s\n", what);
+    }
+    failures++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* A UDP datagram from another node that must be forwarded to dst_addr */
+static void
+make_packet(uint8_t seq)
+{
+  uint8_t *payload;
+
+  memset(UIP_IP_BUF, 0, UIP_IPUDPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &src_addr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &dst_addr);
+  uipbuf_set_len_field(UIP_IP_BUF, UIP_UDPH_LEN + PAYLOAD_LEN);
+  UIP_UDP_BUF->srcport = UIP_HTONS(5678);
+  UIP_UDP_BUF->destport = UIP_HTONS(8765);
+  UIP_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + PAYLOAD_LEN);
+  payload = &uip_buf[UIP_IPUDPH_LEN];
+  memset(payload, seq, PAYLOAD_LEN);
+  uip_len = UIP_IPUDPH_LEN + PAYLOAD_LEN;
+  uip_ext_len = 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+packet_matches(uint8_t seq)
+{
+  int i;
+
+  if(uip_len != UIP_IPUDPH_LEN + PAYLOAD_LEN ||
+     !uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &dst_addr)) {
+    return 0;
+  }
+  for(i = 0; i < PAYLOAD_LEN; i++) {
+    if(uip_buf[UIP_IPUDPH_LEN + i] != seq) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+test_pool(void)
+{
+#if UIP_BUF_POOL_SIZE > 0
+  union uip_buf_data *bufs[UIP_BUF_POOL_SIZE];
+  union uip_buf_data *cur;
+  int i;
+  int n;
+
+  check(uipbuf_pool_num_free() == UIP_BUF_POOL_SIZE - 1,
+        "pool: initial free count");
+  for(n = 0; n < UIP_BUF_POOL_SIZE; n++) {
+    bufs[n] = uipbuf_pool_alloc();
+    if(bufs[n] == NULL) {
+      break;
+    }
+    check(bufs[n] != uip_current_buf, "pool: allocated the current buffer");
+  }
+  check(n == UIP_BUF_POOL_SIZE - 1, "pool: wrong number of buffers");
+  check(uipbuf_pool_detach() == NULL, "pool: detach with empty pool");
+  for(i = 0; i < n; i++) {
+    uipbuf_pool_free(bufs[i]);
+  }
+
+  cur = uip_current_buf;
+  uipbuf_pool_free(cur);
+  check(uip_current_buf == cur && uipbuf_pool_num_free() == n,
+        "pool: freeing the current buffer");
+
+  make_packet(0x5a);
+  bufs[0] = uipbuf_pool_detach();
+  check(bufs[0] == cur && uip_current_buf != cur, "pool: detach");
+  memset(uip_buf, 0, UIP_BUFSIZE);
+  uipbuf_pool_attach(bufs[0]);
+  check(uip_current_buf == cur && packet_matches(0x5a), "pool: attach");
+  check(uipbuf_pool_num_free() == n, "pool: attach leaked a buffer");
+#endif /* UIP_BUF_POOL_SIZE > 0 */
+}
+/*---------------------------------------------------------------------------*/
+static void
+test_packetqueue(void)
+{
+  struct uip_packetqueue_handle h1;
+  struct uip_packetqueue_handle h2;
+
+  uip_packetqueue_new(&h1);
+  uip_packetqueue_new(&h2);
+
+  make_packet(1);
+  check(uip_packetqueue_put(&h1, CLOCK_SECOND) != NULL, "queue: put 1");
+  check(uip_packetqueue_put(&h1, CLOCK_SECOND) == NULL, "queue: put twice");
+  make_packet(2);
+  check(uip_packetqueue_put(&h2, CLOCK_SECOND) != NULL, "queue: put 2");
+
+  /* uip_buf is free for other traffic while packets are queued */
+  memset(uip_buf, 0xff, UIP_BUFSIZE);
+
+  check(uip_packetqueue_get(&h1) != 0 && packet_matches(1), "queue: get 1");
+  check(uip_packetqueue_get(&h1) == 0, "queue: get twice");
+  check(uip_packetqueue_get(&h2) != 0 && packet_matches(2), "queue: get 2");
+
+  make_packet(3);
+  check(uip_packetqueue_put(&h1, CLOCK_SECOND) != NULL, "queue: put 3");
+  uip_packetqueue_free(&h1);
+  check(uip_packetqueue_buflen(&h1) == 0, "queue: free");
+#if UIP_BUF_POOL_SIZE > 0
+  check(uipbuf_pool_num_free() == UIP_BUF_POOL_SIZE - 1,
+        "queue: leaked a pool buffer");
+#endif /* UIP_BUF_POOL_SIZE > 0 */
+  uipbuf_clear();
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_forward(void)
+{
+  uip_ds6_nbr_t *nbr;
+  uint32_t forwarded;
+  double start;
+  double elapsed;
+  int i;
+
+  nbr = uip_ds6_nbr_lookup(&nexthop_addr);
+  forwarded = uip_stat.ip.forwarded;
+  start = now();
+  for(i = 0; i < BENCH_ROUNDS; i++) {
+    make_packet(i);
+    tcpip_input();
+  }
+  elapsed = now() - start;
+  check(uip_stat.ip.forwarded - forwarded == BENCH_ROUNDS,
+        "forward: packets were not forwarded");
+  LOG_INFO("forward (6LoWPAN out): %.0f packets/s\n", BENCH_ROUNDS / elapsed);
+
+  /* The neighbor is being resolved: every packet is queued, then sent
+     out once the neighbor becomes reachable */
+  start = now();
+  for(i = 0; i < BENCH_ROUNDS; i++) {
+    nbr->state = NBR_INCOMPLETE;
+    make_packet(i);
+    tcpip_input();
+    nbr->state = NBR_REACHABLE;
+    if(uip_packetqueue_get(&nbr->packethandle) == 0 || !packet_matches(i)) {
+      check(0, "forward: packet was not queued");
+      break;
+    }
+    tcpip_output(uip_ds6_nbr_get_ll(nbr));
+  }
+  elapsed = now() - start;
+  uipbuf_clear();
+  LOG_INFO("forward (ND queued): %.0f packets/s\n", BENCH_ROUNDS / elapsed);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(uipbuf_pool_process, ev, data)
+{
+  static uip_lladdr_t lladdr = { { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02 } };
+
+  PROCESS_BEGIN();
+
+  uiplib_ipaddrconv("fd00:1::1", &src_addr);
+  uiplib_ipaddrconv("fd00:2::2", &dst_addr);
+  uiplib_ipaddrconv("fe80::2", &nexthop_addr);
+
+  test_pool();
+  test_packetqueue();
+
+  if(uip_ds6_nbr_add(&nexthop_addr, &lladdr, 1, NBR_REACHABLE,
+                     NBR_TABLE_REASON_UNDEFINED, NULL) == NULL ||
+     uip_ds6_route_add(&dst_addr, 64, &nexthop_addr) == NULL) {
+    check(0, "setup: could not add neighbor and route");
+  } else {
+    bench_forward();
+  }
+
+  LOG_INFO("Done, pool size %d, %d failures\n", UIP_BUF_POOL_SIZE, failures);
+  exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
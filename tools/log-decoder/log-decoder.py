@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026, Contiki-NG contributors.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+# SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+# HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+# STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+# OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Formats the records that a node prints with LOG_CONF_DEFERRED and
+# LOG_DEFERRED_CONF_BINARY. The format strings and module names are read
+# from the ELF file of the firmware. Other lines are copied as they are.
+#
+# Usage: log-decoder.py [--compact] firmware.elf [log-file]
+
+import argparse
+import ipaddress
+import re
+import struct
+import sys
+
+# Record flags, as in os/sys/log-deferred.h and log-deferred.c
+KIND_MASK = 0x0f
+KIND_FORMAT, KIND_6ADDR, KIND_LLADDR, KIND_BYTES = range(4)
+FLAG_NEWLINE = 0x10
+FLAG_TRUNCATED = 0x20
+FLAG_AFTER_DROP = 0x40
+
+LEVEL_NAMES = ['PRI', 'ERR', 'WARN', 'INFO', 'DBG']
+
+CONVERSION = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?'
+                        r'(hh|h|ll|l|j|z|t|L)?([diouxXcpsfFeEgGaA%])')
+
+
+class Elf:
+    """The allocated sections and the symbols of an ELF file"""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF':
+            raise ValueError('%s is not an ELF file' % path)
+        self.is64 = self.data[4] == 2
+        self.endian = '<' if self.data[5] == 1 else '>'
+        if self.is64:
+            shoff, = self.unpack('Q', 0x28)
+            shentsize, shnum, shstrndx = self.unpack('HHH', 0x3a)
+        else:
+            shoff, = self.unpack('I', 0x20)
+            shentsize, shnum, shstrndx = self.unpack('HHH', 0x2e)
+        self.sections = []
+        for i in range(shnum):
+            at = shoff + i * shentsize
+            if self.is64:
+                name, type, flags, addr, offset, size, link = \
+                    self.unpack('IIQQQQI', at)
+            else:
+                name, type, flags, addr, offset, size, link = \
+                    self.unpack('IIIIIII', at)
+            self.sections.append((name, type, flags, addr, offset, size, link))
+        self.symbols = self.read_symbols()
+
+    def unpack(self, fmt, offset):
+        return struct.unpack_from(self.endian + fmt, self.data, offset)
+
+    def cstring(self, offset):
+        end = self.data.index(b'\0', offset)
+        return self.data[offset:end].decode('utf-8', 'replace')
+
+    def read_symbols(self):
+        symbols = {}
+        for _, type, _, _, offset, size, link in self.sections:
+            if type != 2:  # SHT_SYMTAB
+                continue
+            strtab = self.sections[link][4]
+            entsize = 24 if self.is64 else 16
+            for at in range(offset, offset + size, entsize):
+                if self.is64:
+                    name, _, _, _, value = self.unpack('IBBHQ', at)
+                else:
+                    name, value = self.unpack('II', at)
+                if name:
+                    symbols[self.cstring(strtab + name)] = value
+        return symbols
+
+    def string_at(self, addr):
+        for _, type, flags, start, offset, size, _ in self.sections:
+            # Allocated sections with contents
+            if flags & 0x2 and type != 8 and start <= addr < start + size:
+                return self.cstring(offset + addr - start)
+        return None
+
+
+class Decoder:
+    def __init__(self, elf, compact, out):
+        self.elf = elf
+        self.compact = compact
+        self.out = out
+        self.bias = 0
+        self.sizes = {'int': 4, 'long': 4, 'llong': 8, 'intmax': 8,
+                      'size': 4, 'ptr': 4, 'double': 8}
+        self.endian = '<'
+
+    def header(self, words):
+        """#LOG-DEFERRED int 4 long 8 ... le anchor 55d0c2a4e0"""
+        for name, value in zip(words, words[1:] + ['']):
+            if name in self.sizes:
+                self.sizes[name] = int(value)
+            elif name == 'anchor':
+                anchor = self.elf.symbols.get('log_deferred_process')
+                if anchor is not None:
+                    self.bias = int(value, 16) - anchor
+        self.endian = '<' if 'le' in words else '>'
+
+    def string(self, addr):
+        if addr == 0:
+            return None
+        s = self.elf.string_at(addr - self.bias)
+        return s if s is not None else '<%x>' % addr
+
+    def integer(self, args, pos, size, signed):
+        codes = {1: 'b', 2: 'h', 4: 'i', 8: 'q'}
+        code = codes[size] if signed else codes[size].upper()
+        return struct.unpack_from(self.endian + code, args, pos)[0], pos + size
+
+    def format(self, fmt, args, truncated):
+        out = []
+        pos = 0
+        last = 0
+        for m in CONVERSION.finditer(fmt):
+            out.append(fmt[last:m.start()])
+            last = m.end()
+            flags, width, precision, length, conv = m.groups()
+            if conv == '%':
+                out.append('%')
+                continue
+            try:
+                if width == '*':
+                    width, pos = self.integer(args, pos, self.sizes['int'], True)
+                if precision == '*':
+                    precision, pos = self.integer(args, pos, self.sizes['int'], True)
+                if conv == 's':
+                    end = args.index(b'\0', pos)
+                    value = args[pos:end].decode('utf-8', 'replace')
+                    pos = end + 1
+                elif conv in 'fFeEgGaA':
+                    if length == 'L':
+                        raise IndexError
+                    value, = struct.unpack_from(self.endian + 'd', args, pos)
+                    pos += 8
+                elif conv == 'p':
+                    value, pos = self.integer(args, pos, self.sizes['ptr'], False)
+                else:
+                    size = {'l': 'long', 'll': 'llong', 'j': 'intmax',
+                            'z': 'size', 't': 'size'}.get(length, 'int')
+                    value, pos = self.integer(args, pos, self.sizes[size],
+                                              conv in 'dic')
+            except (IndexError, ValueError, struct.error):
+                out.append(' ...\n' if fmt.endswith('\n') else ' ...')
+                return ''.join(out)
+            spec = '%' + flags + (str(width) if width is not None else '')
+            if precision is not None:
+                spec += '.' + str(precision or 0)
+            if conv == 'p':
+                out.append(('%' + flags + (str(width) if width else '') + 's')
+                           % ('0x%x' % value if value else '(nil)'))
+            elif conv in 'aA':
+                out.append(float.hex(value))
+            else:
+                out.append((spec + conv) % value)
+            if conv == 's' and truncated and pos >= len(args):
+                out.append(' ...\n' if fmt.endswith('\n') else ' ...')
+                return ''.join(out)
+        out.append(fmt[last:])
+        return ''.join(out)
+
+    def ip6addr(self, data):
+        if not data:
+            return '6A-NULL' if self.compact else '(NULL IP addr)'
+        addr = ipaddress.IPv6Address(bytes(data))
+        if not self.compact:
+            return addr.compressed
+        prefix = '6M' if addr.is_multicast else \
+            '6L' if addr.is_link_local else '6G'
+        return '%s-%04x' % (prefix, int.from_bytes(data[-2:], 'big'))
+
+    def lladdr(self, data):
+        if self.compact:
+            if not data or not any(data):
+                return 'LL-NULL'
+            return 'LL-%04x' % int.from_bytes(data[-2:], 'big')
+        if not data:
+            return '(NULL LL addr)'
+        return '.'.join(data[i:i + 2].hex() for i in range(0, len(data), 2))
+
+    def record(self, words):
+        """#L <module> <fmt> <level> <flags> <args>"""
+        module = self.string(int(words[1], 16))
+        fmt = self.string(int(words[2], 16))
+        level = int(words[3])
+        flags = int(words[4], 16)
+        args = bytes.fromhex(words[5]) if len(words) > 5 else b''
+        truncated = flags & FLAG_TRUNCATED
+
+        text = ''
+        if flags & FLAG_AFTER_DROP:
+            text += ' ...\n'
+        if flags & FLAG_NEWLINE:
+            name = LEVEL_NAMES[level] if level < len(LEVEL_NAMES) else '?'
+            text += '[%-4s: %-10s] ' % (name, module or '')
+        kind = flags & KIND_MASK
+        if kind == KIND_FORMAT:
+            text += self.format(fmt or '', args, truncated)
+            truncated = False
+        elif kind == KIND_6ADDR:
+            text += self.ip6addr(args)
+        elif kind == KIND_LLADDR:
+            text += self.lladdr(args)
+        elif kind == KIND_BYTES:
+            text += args.hex()
+        if truncated:
+            text += '...'
+        self.out.write(text)
+
+    def line(self, line):
+        words = line.split()
+        if words and words[0] == '#L':
+            self.record(words)
+        elif words and words[0] == '#LOG-DEFERRED':
+            self.header(words)
+        else:
+            self.out.write(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Format the binary records of deferred logging')
+    parser.add_argument('--compact', action='store_true',
+                        help='addresses are logged with LOG_CONF_WITH_COMPACT_ADDR')
+    parser.add_argument('elf', help='the ELF file of the firmware')
+    parser.add_argument('log', nargs='?', type=argparse.FileType('r'),
+                        default=sys.stdin, help='the log (default: stdin)')
+    args = parser.parse_args()
+
+    decoder = Decoder(Elf(args.elf), args.compact, sys.stdout)
+    for line in args.log:
+        decoder.line(line)
+        sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    main()